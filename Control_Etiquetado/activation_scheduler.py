@@ -0,0 +1,281 @@
+# Control_Etiquetado/activation_scheduler.py
+"""
+Planificador de Activaciones de Etiquetadores - VisiFruit System
+================================================================
+
+Planificador de alta precisión para disparar etiquetadores en el instante
+calculado por el sincronizador posicional:
+
+- Montículo mínimo de plazos sobre el reloj monotónico (time.monotonic),
+  inmune a ajustes NTP del reloj de pared
+- Hilo dedicado que duerme exactamente hasta el siguiente plazo (no sondea
+  cada N ms) y se despierta antes si llega una activación más temprana
+- Los últimos cientos de microsegundos se esperan activamente para absorber
+  la holgura de los temporizadores del kernel
+- Poco antes de cada plazo se reduce el intervalo de cambio del GIL
+  (sys.setswitchinterval) para que otro hilo de Python ocupado no retrase
+  la activación hasta 5 ms; se restaura al quedar sin plazos próximos
+- Histogramas de retraso por activación (global y por etiquetador)
+
+A 1 m/s cada milisegundo de retraso es un milímetro de error en la etiqueta.
+
+Uso:
+    scheduler = ActivationScheduler()
+    scheduler.start()
+    handle = scheduler.schedule_in(0.850, activar, key=etiquetador_id)
+    scheduler.cancel(handle)
+    scheduler.get_stats()
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import heapq
+import itertools
+import logging
+import sys
+import threading
+import time
+from collections import defaultdict
+from typing import Any, Callable, Dict, Hashable, List, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+# Límites superiores de los buckets del histograma de retraso (microsegundos)
+LATENESS_BUCKETS_US = (50, 100, 250, 500, 1000, 2000, 5000, 10000)
+
+# sys.setswitchinterval es global al proceso: los planificadores armados se
+# registran aquí; el primero guarda el valor original y el último lo restaura
+_switch_lock = threading.Lock()
+_switch_requests: Dict[int, float] = {}
+_switch_original: Optional[float] = None
+
+
+def _request_switch_interval(owner: int, interval_s: float):
+    global _switch_original
+    with _switch_lock:
+        if not _switch_requests:
+            _switch_original = sys.getswitchinterval()
+        _switch_requests[owner] = interval_s
+        sys.setswitchinterval(min(_switch_requests.values()))
+
+
+def _release_switch_interval(owner: int):
+    global _switch_original
+    with _switch_lock:
+        if _switch_requests.pop(owner, None) is None:
+            return
+        if _switch_requests:
+            sys.setswitchinterval(min(_switch_requests.values()))
+        else:
+            sys.setswitchinterval(_switch_original)
+            _switch_original = None
+
+
+class LatenessHistogram:
+    """Histograma acumulado de retrasos de activación."""
+
+    def __init__(self):
+        self.counts = [0] * (len(LATENESS_BUCKETS_US) + 1)
+        self.total = 0
+        self.sum_us = 0.0
+        self.max_us = 0.0
+
+    def record(self, lateness_us: float):
+        lateness_us = max(0.0, lateness_us)
+        bucket = 0
+        while bucket < len(LATENESS_BUCKETS_US) and lateness_us > LATENESS_BUCKETS_US[bucket]:
+            bucket += 1
+        self.counts[bucket] += 1
+        self.total += 1
+        self.sum_us += lateness_us
+        self.max_us = max(self.max_us, lateness_us)
+
+    def percentile_us(self, percentile: float) -> float:
+        """Cota superior del percentil (límite del bucket que lo contiene)."""
+        if self.total == 0:
+            return 0.0
+        target = percentile / 100.0 * self.total
+        accumulated = 0
+        for bucket, count in enumerate(self.counts):
+            accumulated += count
+            if accumulated >= target:
+                return float(LATENESS_BUCKETS_US[bucket]) if bucket < len(LATENESS_BUCKETS_US) else self.max_us
+        return self.max_us
+
+    def to_dict(self) -> Dict[str, Any]:
+        labels = [f"<={limit}us" for limit in LATENESS_BUCKETS_US] + [f">{LATENESS_BUCKETS_US[-1]}us"]
+        return {
+            'activations': self.total,
+            'mean_us': self.sum_us / self.total if self.total else 0.0,
+            'p99_us': self.percentile_us(99),
+            'max_us': self.max_us,
+            'buckets': dict(zip(labels, self.counts)),
+        }
+
+
+class ActivationScheduler:
+    """Planificador de callbacks a plazos absolutos del reloj monotónico."""
+
+    def __init__(self, name: str = "ActivationScheduler", spin_s: float = 0.0003,
+                 late_warning_ms: float = 5.0, prearm_s: float = 0.020,
+                 switch_interval_s: Optional[float] = 0.0002):
+        """
+        Args:
+            name: Nombre del hilo
+            spin_s: Tramo final antes del plazo que se espera activamente
+            late_warning_ms: Retraso a partir del cual se registra una advertencia
+            prearm_s: Anticipación con la que se reduce el intervalo del GIL
+            switch_interval_s: Intervalo del GIL cerca de un plazo (None = no tocarlo)
+        """
+        self.name = name
+        self.spin_s = max(0.0, spin_s)
+        self.late_warning_ms = late_warning_ms
+        self.prearm_s = max(prearm_s, self.spin_s)
+        self.switch_interval_s = switch_interval_s
+        self._switch_armed = False
+
+        self._heap: List[Tuple[float, int]] = []
+        self._entries: Dict[int, Tuple[float, Hashable, Callable[[], Any]]] = {}
+        self._handles = itertools.count(1)
+        self._condition = threading.Condition()
+        self._running = False
+        self._thread: Optional[threading.Thread] = None
+
+        self.histogram = LatenessHistogram()
+        self.histograms_by_key: Dict[Hashable, LatenessHistogram] = defaultdict(LatenessHistogram)
+        self.stats = {'scheduled': 0, 'fired': 0, 'cancelled': 0, 'callback_errors': 0}
+
+    def __len__(self) -> int:
+        return len(self._entries)
+
+    def start(self):
+        """Inicia el hilo del planificador."""
+        with self._condition:
+            if self._running:
+                return
+            self._running = True
+        self._thread = threading.Thread(target=self._run, name=self.name, daemon=True)
+        self._thread.start()
+
+    def stop(self, timeout: float = 2.0):
+        """Detiene el hilo; las activaciones pendientes se conservan."""
+        with self._condition:
+            self._running = False
+            self._condition.notify()
+        if self._thread and self._thread.is_alive():
+            self._thread.join(timeout=timeout)
+        self._thread = None
+
+    def schedule_at(self, deadline: float, callback: Callable[[], Any],
+                    key: Hashable = None) -> int:
+        """
+        Programa un callback en un instante absoluto de time.monotonic().
+
+        Returns:
+            Identificador para cancel()
+        """
+        with self._condition:
+            handle = next(self._handles)
+            self._entries[handle] = (deadline, key, callback)
+            heapq.heappush(self._heap, (deadline, handle))
+            self.stats['scheduled'] += 1
+            # Despertar al hilo solo si el nuevo plazo es el más próximo
+            if self._heap[0][1] == handle:
+                self._condition.notify()
+        return handle
+
+    def schedule_in(self, delay_s: float, callback: Callable[[], Any],
+                    key: Hashable = None) -> int:
+        """Programa un callback dentro de delay_s segundos."""
+        return self.schedule_at(time.monotonic() + max(0.0, delay_s), callback, key)
+
+    def cancel(self, handle: int) -> bool:
+        """Cancela una activación pendiente (se descarta al llegar al tope del montículo)."""
+        with self._condition:
+            if self._entries.pop(handle, None) is None:
+                return False
+            self.stats['cancelled'] += 1
+            return True
+
+    def _next_deadline(self) -> Optional[float]:
+        """Plazo más próximo vigente (llamar con el lock tomado)."""
+        while self._heap and self._heap[0][1] not in self._entries:
+            heapq.heappop(self._heap)
+        return self._heap[0][0] if self._heap else None
+
+    def _arm(self):
+        """Reduce el intervalo del GIL ante un plazo próximo."""
+        if self.switch_interval_s is not None and not self._switch_armed:
+            _request_switch_interval(id(self), self.switch_interval_s)
+            self._switch_armed = True
+
+    def _disarm(self):
+        if self._switch_armed:
+            _release_switch_interval(id(self))
+            self._switch_armed = False
+
+    def _run(self):
+        logger.info(f"⏱️ Planificador de activaciones iniciado ({self.name})")
+        while True:
+            with self._condition:
+                while self._running:
+                    deadline = self._next_deadline()
+                    if deadline is None:
+                        self._disarm()
+                        self._condition.wait()
+                        continue
+                    now = time.monotonic()
+                    if deadline - now > self.prearm_s:
+                        self._disarm()
+                        self._condition.wait(deadline - self.prearm_s - now)
+                        continue
+                    self._arm()
+                    remaining = deadline - self.spin_s - now
+                    if remaining <= 0:
+                        break
+                    self._condition.wait(remaining)
+                if not self._running:
+                    self._disarm()
+                    break
+
+            # Tramo final en espera activa, fuera del lock
+            while time.monotonic() < deadline:
+                pass
+
+            due = []
+            with self._condition:
+                now = time.monotonic()
+                while self._heap and self._heap[0][0] <= now:
+                    _, handle = heapq.heappop(self._heap)
+                    entry = self._entries.pop(handle, None)
+                    if entry is not None:
+                        due.append(entry)
+
+            for entry_deadline, key, callback in due:
+                self._fire(entry_deadline, key, callback)
+
+        logger.info(f"⏱️ Planificador de activaciones detenido ({self.name})")
+
+    def _fire(self, deadline: float, key: Hashable, callback: Callable[[], Any]):
+        lateness_us = (time.monotonic() - deadline) * 1e6
+        try:
+            callback()
+        except Exception as e:
+            self.stats['callback_errors'] += 1
+            logger.error(f"Error en activación programada ({key}): {e}")
+
+        self.stats['fired'] += 1
+        self.histogram.record(lateness_us)
+        self.histograms_by_key[key].record(lateness_us)
+        if lateness_us > self.late_warning_ms * 1000:
+            logger.warning(f"⚠️ Activación {key} con {lateness_us / 1000:.2f}ms de retraso")
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Contadores y histogramas de retraso."""
+        return {
+            **self.stats,
+            'pending': len(self._entries),
+            'lateness': self.histogram.to_dict(),
+            'lateness_by_key': {str(key): hist.to_dict() for key, hist in self.histograms_by_key.items()},
+        }
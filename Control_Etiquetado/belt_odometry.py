@@ -0,0 +1,254 @@
+# Control_Etiquetado/belt_odometry.py
+"""
+Odometría de Banda Transportadora - VisiFruit System
+====================================================
+
+Integra la línea de tiempo de velocidades de la banda (comandadas o medidas,
+incluidas las pausas) en una función posición-tiempo, de modo que la
+predicción de cuándo una fruta llega a un actuador sigue siendo válida
+aunque la banda cambie de velocidad o se detenga mientras la fruta viaja.
+
+- La velocidad es constante por tramos: cada cambio agrega un tramo
+  (instante, posición acumulada, velocidad) sobre time.monotonic()
+- Las activaciones se guardan por POSICIÓN objetivo de la banda, no por
+  tiempo: un cambio de velocidad no invalida ninguna de ellas
+- Solo la activación más próxima (tope del montículo por posición) se
+  programa en el ActivationScheduler; un cambio de velocidad recalcula ese
+  único plazo en O(log n), sin recorrer las frutas en tránsito
+
+Uso:
+    odometry = BeltOdometry(speed_mps=0.15, scheduler=scheduler)
+    odometry.schedule_at_distance(0.60, activar, key=etiquetador_id)
+    odometry.set_speed(0.10)      # la fruta en tránsito se reprograma
+    odometry.pause()              # banda detenida: nada se dispara
+    odometry.resume()
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import bisect
+import heapq
+import itertools
+import logging
+import threading
+import time
+from typing import Any, Callable, Dict, Hashable, List, Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+# Tolerancia al comparar posiciones alcanzadas (1 µm)
+POSITION_EPSILON_M = 1e-6
+
+
+class BeltOdometry:
+    """Posición acumulada de la banda y activaciones por posición objetivo."""
+
+    def __init__(self, speed_mps: float = 0.0, scheduler: Optional[Any] = None,
+                 max_segments: int = 1024):
+        """
+        Args:
+            speed_mps: Velocidad inicial de la banda
+            scheduler: ActivationScheduler para disparar activaciones (opcional;
+                       sin él solo se ofrece la consulta de posición)
+            max_segments: Tramos de historia conservados para position_at()
+        """
+        self.scheduler = scheduler
+        self.max_segments = max(2, max_segments)
+
+        now = time.monotonic()
+        self._times: List[float] = [now]
+        self._positions: List[float] = [0.0]
+        self._speeds: List[float] = [float(speed_mps)]
+        self._paused = False
+        self._resume_speed = float(speed_mps)
+
+        # Activaciones pendientes ordenadas por posición objetivo
+        self._heap: List[Tuple[float, int]] = []
+        self._targets: Dict[int, Tuple[float, Hashable, Callable[[], Any]]] = {}
+        self._handles = itertools.count(1)
+        self._armed: Optional[int] = None
+
+        self._lock = threading.RLock()
+        self.stats = {'speed_changes': 0, 'pauses': 0, 'rearms': 0, 'fired': 0, 'callback_errors': 0}
+
+    def __len__(self) -> int:
+        return len(self._targets)
+
+    @property
+    def speed(self) -> float:
+        """Velocidad actual en m/s (0 si está en pausa)."""
+        return self._speeds[-1]
+
+    @property
+    def paused(self) -> bool:
+        return self._paused
+
+    # --- Línea de tiempo de velocidad ---
+
+    def _append_segment(self, timestamp: Optional[float], speed_mps: float):
+        """Agrega un tramo de velocidad (llamar con el lock tomado)."""
+        t_last, p_last, v_last = self._times[-1], self._positions[-1], self._speeds[-1]
+        # Muestras fuera de orden se aplican en el último instante conocido
+        t = max(t_last, time.monotonic() if timestamp is None else timestamp)
+        if t == t_last:
+            self._speeds[-1] = speed_mps
+        else:
+            self._times.append(t)
+            self._positions.append(p_last + v_last * (t - t_last))
+            self._speeds.append(speed_mps)
+
+        if len(self._times) > self.max_segments:
+            drop = len(self._times) - self.max_segments // 2
+            del self._times[:drop], self._positions[:drop], self._speeds[:drop]
+
+    def set_speed(self, speed_mps: float, timestamp: Optional[float] = None):
+        """
+        Registra una velocidad comandada o medida.
+
+        Durante una pausa solo actualiza la velocidad con la que se reanudará.
+
+        Args:
+            speed_mps: Velocidad en m/s
+            timestamp: Instante time.monotonic() del cambio (None = ahora)
+        """
+        speed_mps = float(speed_mps)
+        with self._lock:
+            if self._paused:
+                self._resume_speed = speed_mps
+                return
+            if speed_mps == self._speeds[-1]:
+                return
+            self._append_segment(timestamp, speed_mps)
+            self.stats['speed_changes'] += 1
+            self._rearm()
+
+    def pause(self, timestamp: Optional[float] = None):
+        """Banda detenida: la posición deja de avanzar."""
+        with self._lock:
+            if self._paused:
+                return
+            self._resume_speed = self._speeds[-1]
+            self._append_segment(timestamp, 0.0)
+            self._paused = True
+            self.stats['pauses'] += 1
+            self._rearm()
+
+    def resume(self, timestamp: Optional[float] = None):
+        """Banda en marcha con la última velocidad registrada."""
+        with self._lock:
+            if not self._paused:
+                return
+            self._paused = False
+            self._append_segment(timestamp, self._resume_speed)
+            self._rearm()
+
+    def position_at(self, timestamp: Optional[float] = None) -> float:
+        """Posición acumulada de la banda (m) en un instante time.monotonic()."""
+        with self._lock:
+            t = time.monotonic() if timestamp is None else timestamp
+            index = max(0, bisect.bisect_right(self._times, t) - 1)
+            return self._positions[index] + self._speeds[index] * (t - self._times[index])
+
+    def time_at_position(self, position_m: float) -> Optional[float]:
+        """
+        Instante time.monotonic() en que la banda alcanzará una posición con la
+        velocidad actual (None si está detenida o en reversa). Una posición ya
+        superada devuelve el inicio del tramo actual.
+        """
+        with self._lock:
+            t_last, p_last, v_last = self._times[-1], self._positions[-1], self._speeds[-1]
+            if position_m <= p_last:
+                return t_last
+            if v_last <= 0:
+                return None
+            return t_last + (position_m - p_last) / v_last
+
+    def time_to_travel(self, distance_m: float) -> Optional[float]:
+        """Segundos desde ahora hasta recorrer distance_m (None si la banda no avanza)."""
+        now = time.monotonic()
+        reach = self.time_at_position(self.position_at(now) + distance_m)
+        return None if reach is None else max(0.0, reach - now)
+
+    # --- Activaciones por posición ---
+
+    def schedule_at_position(self, position_m: float, callback: Callable[[], Any],
+                             key: Hashable = None) -> int:
+        """Programa un callback para cuando la banda alcance position_m."""
+        with self._lock:
+            handle = next(self._handles)
+            self._targets[handle] = (position_m, key, callback)
+            heapq.heappush(self._heap, (position_m, handle))
+            # Solo hay que reprogramar si la nueva activación es la más próxima
+            if self._heap[0][1] == handle:
+                self._rearm()
+        return handle
+
+    def schedule_at_distance(self, distance_m: float, callback: Callable[[], Any],
+                             key: Hashable = None, origin_time: Optional[float] = None) -> int:
+        """
+        Programa un callback para cuando la banda avance distance_m desde
+        origin_time (None = ahora).
+
+        Returns:
+            Identificador para cancel()
+        """
+        return self.schedule_at_position(self.position_at(origin_time) + distance_m, callback, key)
+
+    def cancel(self, handle: int) -> bool:
+        """Cancela una activación pendiente."""
+        with self._lock:
+            return self._targets.pop(handle, None) is not None
+
+    def _rearm(self):
+        """Programa en el planificador solo la activación más próxima (con el lock tomado)."""
+        if self.scheduler is None:
+            return
+        if self._armed is not None:
+            self.scheduler.cancel(self._armed)
+            self._armed = None
+
+        while self._heap and self._heap[0][1] not in self._targets:
+            heapq.heappop(self._heap)
+        if not self._heap:
+            return
+
+        position_m, handle = self._heap[0]
+        deadline = self.time_at_position(position_m)
+        if deadline is None:
+            return  # Banda detenida: se reprogramará al reanudar
+        self._armed = self.scheduler.schedule_at(deadline, self._on_deadline,
+                                                 key=self._targets[handle][1])
+        self.stats['rearms'] += 1
+
+    def _on_deadline(self):
+        """Dispara todas las activaciones cuya posición ya fue alcanzada."""
+        due = []
+        with self._lock:
+            self._armed = None
+            reached = self.position_at() + POSITION_EPSILON_M
+            while self._heap and self._heap[0][0] <= reached:
+                _, handle = heapq.heappop(self._heap)
+                target = self._targets.pop(handle, None)
+                if target is not None:
+                    due.append(target)
+            self._rearm()
+
+        for _, key, callback in due:
+            try:
+                callback()
+            except Exception as e:
+                self.stats['callback_errors'] += 1
+                logger.error(f"Error en activación por posición ({key}): {e}")
+            self.stats['fired'] += 1
+
+    def get_stats(self) -> Dict[str, Any]:
+        with self._lock:
+            return {
+                **self.stats,
+                'position_m': self.position_at(),
+                'speed_mps': self.speed,
+                'paused': self._paused,
+                'pending': len(self._targets),
+                'segments': len(self._times),
+            }
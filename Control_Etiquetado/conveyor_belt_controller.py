@@ -48,7 +48,7 @@ import os
 import asyncio
 import threading
 from abc import ABC, abstractmethod
-from typing import Dict, Any, Optional, Union
+from typing import Callable, Dict, Any, List, Optional, Tuple, Union
 from dataclasses import dataclass, field
 from enum import Enum
 import psutil
@@ -747,6 +747,10 @@ class ConveyorBeltController:
         self._error_history = []
         self._recovery_in_progress = False
         
+        # Observadores de movimiento (odometría): callback(running, speed_percent)
+        self._motion_listeners: List[Callable[[bool, float], None]] = []
+        self._last_motion: Optional[Tuple[bool, float]] = None
+        
     async def initialize(self) -> bool:
         """Inicializar el controlador de banda."""
         try:
@@ -885,6 +889,22 @@ class ConveyorBeltController:
                 self.logger.error(f"Error en loop de monitoreo: {e}")
                 await asyncio.sleep(1.0)
     
+    def add_motion_listener(self, callback: Callable[[bool, float], None]) -> None:
+        """Registrar un observador de arranques, paradas y cambios de velocidad."""
+        self._motion_listeners.append(callback)
+    
+    def _notify_motion(self, running: bool, speed_percent: float) -> None:
+        """Notificar un cambio de movimiento a los observadores (solo si cambió)."""
+        motion = (running, float(speed_percent) if running else 0.0)
+        if motion == self._last_motion:
+            return
+        self._last_motion = motion
+        for callback in self._motion_listeners:
+            try:
+                callback(*motion)
+            except Exception as e:
+                self.logger.error(f"Error en observador de movimiento: {e}")
+    
     async def _update_status(self) -> None:
         """Actualizar estado actual."""
         try:
@@ -892,6 +912,8 @@ class ConveyorBeltController:
                 driver_status = await self.driver.get_status()
                 self.status.is_running = driver_status.get('running', False)
                 self.status.speed_percent = driver_status.get('speed_percent', 0.0)
+                # Detecta paradas que no pasan por la API (p. ej. timeout de seguridad)
+                self._notify_motion(self.status.is_running, self.status.speed_percent)
                 
             # Actualizar uptime
             self.status.uptime_s = time.time() - self._start_time
@@ -1012,6 +1034,7 @@ class ConveyorBeltController:
                 if success:
                     self.status.state = BeltState.RUNNING
                     self.metrics.start_count += 1
+                    self._notify_motion(True, speed_percent or self.config.default_speed_percent)
                     self.logger.info(f"Banda iniciada exitosamente a {speed_percent or self.config.default_speed_percent}% velocidad")
                 else:
                     self.status.state = BeltState.ERROR
@@ -1046,6 +1069,7 @@ class ConveyorBeltController:
                 
                 if success:
                     self.status.state = BeltState.IDLE
+                    self._notify_motion(False, 0.0)
                     self.logger.info("Banda detenida exitosamente")
                 else:
                     self.status.state = BeltState.ERROR
@@ -1074,6 +1098,8 @@ class ConveyorBeltController:
             success = await self.driver.set_speed(speed_percent)
             
             if success:
+                if self._last_motion and self._last_motion[0]:
+                    self._notify_motion(True, speed_percent)
                 self.logger.info(f"Velocidad establecida a {speed_percent}%")
             else:
                 self.logger.error("Error estableciendo velocidad")
@@ -1126,6 +1152,7 @@ class ConveyorBeltController:
             
             if self.driver:
                 await self.driver.stop_belt()
+            self._notify_motion(False, 0.0)
                 
             return True
             
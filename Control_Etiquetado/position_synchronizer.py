@@ -24,6 +24,10 @@ SOLUCIÓN MATEMÁTICA:
 - Distancia cámara-etiquetador: d (m)
 - Tiempo de tránsito: t = d/v
 - Delay de activación = t + tiempo_procesamiento + margen_seguridad
+
+Con velocidad variable la fruta se sigue por posición de banda (odometría):
+la activación ocurre cuando la banda avanzó d + v·(procesamiento + margen)
+desde la detección, aunque la velocidad cambie o la banda se pause en medio.
 """
 
 import asyncio
@@ -38,8 +42,16 @@ from enum import Enum, auto
 from pathlib import Path
 import numpy as np
 from collections import deque
+from functools import partial
 import math
 
+try:
+    from .activation_scheduler import ActivationScheduler
+    from .belt_odometry import BeltOdometry
+except ImportError:
+    from activation_scheduler import ActivationScheduler
+    from belt_odometry import BeltOdometry
+
 # Configuración de logging
 logger = logging.getLogger(__name__)
 
@@ -99,7 +111,9 @@ class PositionSynchronizer:
         
         # Cola de eventos de detección
         self.detection_queue = deque(maxlen=100)
-        self.pending_activations: Dict[float, List[int]] = {}  # timestamp -> [etiquetador_ids]
+        
+        # Activaciones pendientes: plazos en reloj monotónico con hilo dedicado
+        self.scheduler = ActivationScheduler(name="PositionSynchronizer")
         
         # Callbacks para activación de etiquetadores
         self.activation_callbacks: Dict[int, Callable] = {}
@@ -115,12 +129,14 @@ class PositionSynchronizer:
         
         # Control de threads
         self._running = False
-        self._sync_thread = None
         self._lock = threading.Lock()
         
         # Cargar configuración
         self.load_configuration()
         
+        # Odometría de banda: las activaciones se programan por posición
+        self.odometry = BeltOdometry(self.calibration.belt_speed_mps, scheduler=self.scheduler)
+        
     def load_configuration(self):
         """Cargar configuración desde archivo."""
         try:
@@ -223,11 +239,12 @@ class PositionSynchronizer:
         except Exception as e:
             logger.error(f"Error guardando configuración: {e}")
     
-    def calculate_activation_delay(self, detection: DetectionEvent, etiquetador_id: int) -> float:
+    def calculate_activation_distance(self, detection: DetectionEvent, etiquetador_id: int) -> float:
         """
-        Calcular delay de activación para un etiquetador específico.
+        Calcular cuánto debe avanzar la banda antes de activar un etiquetador.
         
-        FÓRMULA PRINCIPAL:
+        Los márgenes temporales se convierten a distancia con la velocidad
+        actual, de modo que a velocidad constante el resultado equivale a:
         delay = (distancia / velocidad) + delay_procesamiento + margen_seguridad
         
         Args:
@@ -235,7 +252,7 @@ class PositionSynchronizer:
             etiquetador_id: ID del etiquetador
             
         Returns:
-            Delay en segundos
+            Avance de banda en metros
         """
         
         if etiquetador_id not in self.etiquetador_zones:
@@ -244,28 +261,49 @@ class PositionSynchronizer:
         
         zone = self.etiquetador_zones[etiquetador_id]
         
-        # Distancia que debe recorrer la fruta
-        travel_distance_m = zone.distance_from_camera_m
+        # Delays adicionales expresados como avance a la velocidad actual
+        margin_s = (self.calibration.processing_delay_ms + self.calibration.safety_margin_ms) / 1000.0
+        margin_m = self.odometry.speed * margin_s
         
-        # Tiempo de tránsito base
-        travel_time_s = travel_distance_m / self.calibration.belt_speed_mps
+        logger.debug(f"Cálculo avance para etiquetador {etiquetador_id}:")
+        logger.debug(f"  - Distancia: {zone.distance_from_camera_m:.3f}m")
+        logger.debug(f"  - Velocidad banda: {self.odometry.speed:.3f}m/s")
+        logger.debug(f"  - Margen ({margin_s:.3f}s): {margin_m:.3f}m")
         
-        # Delays adicionales
-        processing_delay_s = self.calibration.processing_delay_ms / 1000.0
-        safety_margin_s = self.calibration.safety_margin_ms / 1000.0
+        return zone.distance_from_camera_m + margin_m
+    
+    def calculate_activation_delay(self, detection: DetectionEvent, etiquetador_id: int) -> float:
+        """
+        Estimar el delay de activación con la velocidad actual de la banda.
         
-        # Delay total
-        total_delay_s = travel_time_s + processing_delay_s + safety_margin_s
+        Returns:
+            Delay en segundos (inf si la banda está detenida)
+        """
+        delay_s = self.odometry.time_to_travel(self.calculate_activation_distance(detection, etiquetador_id))
+        return math.inf if delay_s is None else delay_s
+    
+    def set_belt_speed(self, speed_mps: float, timestamp: Optional[float] = None):
+        """
+        Registrar una velocidad de banda comandada o medida.
         
-        logger.debug(f"Cálculo delay para etiquetador {etiquetador_id}:")
-        logger.debug(f"  - Distancia: {travel_distance_m:.3f}m")
-        logger.debug(f"  - Velocidad banda: {self.calibration.belt_speed_mps:.3f}m/s")
-        logger.debug(f"  - Tiempo tránsito: {travel_time_s:.3f}s")
-        logger.debug(f"  - Delay procesamiento: {processing_delay_s:.3f}s")
-        logger.debug(f"  - Margen seguridad: {safety_margin_s:.3f}s")
-        logger.debug(f"  - DELAY TOTAL: {total_delay_s:.3f}s")
+        Las frutas en tránsito mantienen su posición objetivo; solo se
+        recalcula el plazo de la próxima activación.
         
-        return total_delay_s
+        Args:
+            speed_mps: Velocidad en m/s
+            timestamp: Instante time.monotonic() del cambio (None = ahora)
+        """
+        if speed_mps > 0:
+            self.calibration.belt_speed_mps = speed_mps
+        self.odometry.set_speed(speed_mps, timestamp)
+    
+    def pause_belt(self, timestamp: Optional[float] = None):
+        """Registrar una detención de la banda (las activaciones quedan en espera)."""
+        self.odometry.pause(timestamp)
+    
+    def resume_belt(self, timestamp: Optional[float] = None):
+        """Registrar la reanudación de la banda."""
+        self.odometry.resume(timestamp)
     
     def process_detection(self, detection: DetectionEvent):
         """
@@ -287,18 +325,22 @@ class PositionSynchronizer:
                     logger.warning(f"No hay etiquetadores para {detection.fruit_type}")
                     return
                 
-                # Calcular delays y programar activaciones
+                # Calcular avances y programar activaciones por posición de banda
+                origin = time.monotonic()
                 for etiquetador_id in target_etiquetadores:
-                    delay_s = self.calculate_activation_delay(detection, etiquetador_id)
-                    activation_time = time.time() + delay_s
+                    distance_m = self.calculate_activation_distance(detection, etiquetador_id)
+                    target_position = self.odometry.position_at(origin) + distance_m
                     
-                    # Agregar a cola de activaciones pendientes
-                    if activation_time not in self.pending_activations:
-                        self.pending_activations[activation_time] = []
-                    self.pending_activations[activation_time].append(etiquetador_id)
+                    self.odometry.schedule_at_position(
+                        target_position,
+                        partial(self._activate_etiquetador, etiquetador_id, target_position),
+                        key=etiquetador_id
+                    )
                     
+                    delay_s = self.odometry.time_to_travel(distance_m)
+                    eta = f"en {delay_s:.3f}s" if delay_s is not None else "al reanudar la banda"
                     logger.info(f"Etiquetador {etiquetador_id} programado para activar "
-                               f"en {delay_s:.3f}s (a las {activation_time:.3f})")
+                               f"tras {distance_m:.3f}m de banda ({eta})")
                 
                 # Actualizar estadísticas
                 self.stats['detections_processed'] += 1
@@ -353,8 +395,7 @@ class PositionSynchronizer:
         
         self._running = True
         self.state = SyncState.READY
-        self._sync_thread = threading.Thread(target=self._synchronization_loop, daemon=True)
-        self._sync_thread.start()
+        self.scheduler.start()
         
         logger.info("✓ Sistema de sincronización iniciado")
     
@@ -363,56 +404,24 @@ class PositionSynchronizer:
         
         self._running = False
         self.state = SyncState.OFFLINE
-        
-        if self._sync_thread and self._sync_thread.is_alive():
-            self._sync_thread.join(timeout=2.0)
+        self.scheduler.stop(timeout=2.0)
         
         logger.info("✓ Sistema de sincronización detenido")
     
-    def _synchronization_loop(self):
-        """Loop principal de sincronización."""
-        
-        logger.info("Iniciando loop de sincronización...")
-        
-        while self._running:
-            try:
-                current_time = time.time()
-                
-                # Verificar activaciones pendientes
-                activations_to_process = []
-                
-                with self._lock:
-                    for activation_time in list(self.pending_activations.keys()):
-                        if current_time >= activation_time:
-                            activations_to_process.append((activation_time, self.pending_activations[activation_time]))
-                            del self.pending_activations[activation_time]
-                
-                # Ejecutar activaciones
-                for activation_time, etiquetador_ids in activations_to_process:
-                    for etiquetador_id in etiquetador_ids:
-                        self._activate_etiquetador(etiquetador_id, activation_time)
-                
-                # Dormir un poco para no saturar CPU
-                time.sleep(0.010)  # 10ms
-                
-            except Exception as e:
-                logger.error(f"Error en loop de sincronización: {e}")
-                time.sleep(0.1)
-        
-        logger.info("Loop de sincronización finalizado")
-    
-    def _activate_etiquetador(self, etiquetador_id: int, scheduled_time: float):
+    def _activate_etiquetador(self, etiquetador_id: int, target_position: float):
         """
         Activar etiquetador específico.
         
         Args:
             etiquetador_id: ID del etiquetador
-            scheduled_time: Tiempo programado para activación
+            target_position: Posición de banda programada para la activación (m)
         """
         
         try:
-            current_time = time.time()
-            actual_delay_ms = (current_time - scheduled_time) * 1000
+            # Retraso expresado en tiempo a la velocidad actual
+            overshoot_m = self.odometry.position_at() - target_position
+            speed = self.odometry.speed
+            actual_delay_ms = overshoot_m / speed * 1000 if speed > 0 else 0.0
             
             logger.info(f"🏷️  ACTIVANDO ETIQUETADOR {etiquetador_id} "
                        f"(delay real: {actual_delay_ms:.1f}ms)")
@@ -452,7 +461,7 @@ class PositionSynchronizer:
         """
         
         if manual_speed is not None:
-            self.calibration.belt_speed_mps = manual_speed
+            self.set_belt_speed(manual_speed)
             logger.info(f"✓ Velocidad manual configurada: {manual_speed:.3f} m/s")
             
         else:
@@ -509,7 +518,9 @@ class PositionSynchronizer:
                 for zone_id, zone in self.etiquetador_zones.items()
             },
             'statistics': self.stats,
-            'pending_activations': len(self.pending_activations),
+            'pending_activations': len(self.odometry),
+            'odometry': self.odometry.get_stats(),
+            'activation_lateness': self.scheduler.get_stats()['lateness'],
             'recent_detections': len(self.detection_queue)
         }
     
@@ -553,7 +564,7 @@ def create_mockup_synchronizer() -> PositionSynchronizer:
     # Configuración específica para maqueta
     sync.calibration.belt_length_m = 1.0
     sync.calibration.belt_width_m = 0.25
-    sync.calibration.belt_speed_mps = 0.15  # 15 cm/s
+    sync.set_belt_speed(0.15)  # 15 cm/s
     sync.calibration.camera_position_m = 0.2  # Cámara a 20cm del inicio
     
     # Etiquetador al final de la banda
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+# benchmark_denoise.py
+"""
+Benchmark de Reducción de Ruido - FramePreprocessor
+===================================================
+
+Compara velocidad y calidad de los métodos de reducción de ruido del
+pre-procesador (bilateral BGR original, bilateral de luminancia y filtro
+guiado) sobre un frame limpio al que se añade ruido gaussiano.
+
+Métricas por método:
+- Tiempo por frame (mediana y p95)
+- PSNR respecto al frame limpio (mayor = mejor)
+- PSNR respecto a la salida bilateral original (parecido al método actual)
+
+Uso:
+    python Demos/benchmark_denoise.py [--image foto.jpg] [--size 1296x972]
+                                      [--noise 15] [--iterations 20]
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import sys
+import time
+import argparse
+from pathlib import Path
+
+import cv2
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+from utils.frame_preprocessor import FramePreprocessor, DenoiseMethod
+
+
+def build_clean_frame(size, image_path=None) -> np.ndarray:
+    """Frame de referencia: imagen real o escena sintética con bordes."""
+    width, height = size
+    if image_path:
+        image = cv2.imread(image_path)
+        if image is None:
+            raise SystemExit(f"❌ No se pudo leer {image_path}")
+        return cv2.resize(image, (width, height), interpolation=cv2.INTER_AREA)
+    
+    rng = np.random.default_rng(7)
+    frame = np.full((height, width, 3), (70, 90, 80), dtype=np.uint8)
+    for _ in range(25):
+        center = (int(rng.integers(0, width)), int(rng.integers(0, height)))
+        radius = int(rng.integers(20, height // 6))
+        color = tuple(int(c) for c in rng.integers(30, 230, 3))
+        cv2.circle(frame, center, radius, color, -1, lineType=cv2.LINE_AA)
+    return cv2.GaussianBlur(frame, (3, 3), 0)
+
+
+def add_noise(frame: np.ndarray, sigma: float) -> np.ndarray:
+    noise = np.random.default_rng(11).normal(0, sigma, frame.shape)
+    return np.clip(frame.astype(np.float32) + noise, 0, 255).astype(np.uint8)
+
+
+def measure(preprocessor, frame, noise_level, method, iterations):
+    output = preprocessor.denoise(frame, noise_level, method)
+    times = []
+    for _ in range(iterations):
+        start = time.perf_counter()
+        output = preprocessor.denoise(frame, noise_level, method)
+        times.append((time.perf_counter() - start) * 1000)
+    return output, float(np.median(times)), float(np.percentile(times, 95))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark de reducción de ruido")
+    parser.add_argument("--image", help="Imagen limpia de referencia (opcional)")
+    parser.add_argument("--size", default="1296x972", help="Resolución ANCHOxALTO")
+    parser.add_argument("--noise", type=float, default=15.0, help="Sigma del ruido gaussiano")
+    parser.add_argument("--iterations", type=int, default=20, help="Repeticiones por método")
+    args = parser.parse_args()
+    
+    size = tuple(int(v) for v in args.size.lower().split("x"))
+    clean = build_clean_frame(size, args.image)
+    noisy = add_noise(clean, args.noise)
+    
+    preprocessor = FramePreprocessor({"denoise": True})
+    noise_level = preprocessor.analyze_frame(noisy).noise_level
+    
+    print(f"=== Benchmark de reducción de ruido ({size[0]}x{size[1]}) ===")
+    print(f"   Ruido añadido σ={args.noise}, estimado {noise_level:.1f}")
+    print(f"   PSNR sin filtrar: {cv2.PSNR(clean, noisy):.2f} dB")
+    print()
+    print(f"{'método':<12}{'p50 ms':>10}{'p95 ms':>10}{'PSNR dB':>10}{'vs bilateral':>14}")
+    
+    reference = None
+    for method in DenoiseMethod:
+        output, p50, p95 = measure(preprocessor, noisy, noise_level, method, args.iterations)
+        if reference is None:
+            reference = output
+        similarity = "-" if output is reference else f"{cv2.PSNR(reference, output):.2f}"
+        print(f"{method.value:<12}{p50:>10.2f}{p95:>10.2f}{cv2.PSNR(clean, output):>10.2f}{similarity:>14}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,58 @@
+#!/bin/bash
+# =============================================================================
+# Script para compilar los benchmarks del launcher nativo en Linux / Raspberry Pi
+# =============================================================================
+#
+# Genera en dist_cpp/:
+#   - visifruit_launcher_bench   (benchmarks del núcleo, salida JSON)
+#   - visifruit_mock_service     (servicio hijo simulado para los benchmarks)
+#   - visifruit_launcher_replay  (reproductor de trazas del supervisor)
+#
+# Uso:
+#   ./compile_cpp_bench.sh                 # solo compilar
+#   ./compile_cpp_bench.sh --run           # compilar y ejecutar
+#   ./compile_cpp_bench.sh --run --baseline launcher_bench_baseline.json
+#
+# Para guardar una línea base en el equipo de producción:
+#   dist_cpp/visifruit_launcher_bench --write-baseline launcher_bench_baseline.json
+#
+# Para reproducir una traza grabada con VISIFRUIT_TRACE=launcher.trace:
+#   dist_cpp/visifruit_launcher_replay launcher.trace --speed 0
+#   dist_cpp/visifruit_launcher_replay --synthesize rafagas.trace --seconds 120
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+cd "$SCRIPT_DIR"
+
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:--std=c++17 -O3 -pthread -Wall -Wextra}"
+
+echo ""
+echo "========================================"
+echo "   BENCHMARKS DEL LAUNCHER NATIVO"
+echo "========================================"
+echo ""
+
+echo "[1/3] Verificando compilador $CXX..."
+if ! command -v "$CXX" >/dev/null 2>&1; then
+    echo "ERROR: $CXX no está instalado (sudo apt install g++)"
+    exit 1
+fi
+
+echo "[2/3] Preparando directorio de salida..."
+mkdir -p dist_cpp
+
+echo "[3/3] Compilando..."
+$CXX $CXXFLAGS visifruit_mock_service.cpp -o dist_cpp/visifruit_mock_service
+$CXX $CXXFLAGS visifruit_launcher_bench.cpp -o dist_cpp/visifruit_launcher_bench
+$CXX $CXXFLAGS visifruit_launcher_replay.cpp -o dist_cpp/visifruit_launcher_replay
+
+echo ""
+echo "✅ Compilación exitosa: dist_cpp/visifruit_launcher_bench"
+echo ""
+
+if [ "$1" == "--run" ]; then
+    shift
+    ./dist_cpp/visifruit_launcher_bench "$@"
+fi
@@ -0,0 +1,67 @@
+#!/bin/bash
+# =============================================================================
+# Script para compilar el servidor de inferencia nativo (ONNX Runtime CPU)
+# =============================================================================
+#
+# Genera en dist_cpp/:
+#   - visifruit_inference_server   (mismo contrato HTTP que ai_inference_server.py)
+#
+# Requisitos:
+#   - libjpeg-turbo:  sudo apt install libjpeg-dev
+#   - ONNX Runtime C/C++ (release oficial descomprimida, p. ej.
+#     onnxruntime-linux-aarch64-1.x.y.tgz en la Raspberry Pi 5):
+#       export ORT_ROOT=$HOME/onnxruntime-linux-aarch64-1.x.y
+#
+# Uso:
+#   ./compile_cpp_inference_server.sh          # solo compilar
+#   ./compile_cpp_inference_server.sh --run    # compilar y ejecutar con weights/best.onnx
+#
+# El modelo se exporta antes con:
+#   python IA_Etiquetado/IATraining/Export_Onnx.py --weights weights/best.pt
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+cd "$SCRIPT_DIR"
+
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:--std=c++17 -O3 -pthread -Wall -Wextra}"
+ORT_ROOT="${ORT_ROOT:-/usr/local}"
+
+echo ""
+echo "========================================"
+echo "   SERVIDOR DE INFERENCIA NATIVO"
+echo "========================================"
+echo ""
+
+echo "[1/4] Verificando compilador $CXX..."
+if ! command -v "$CXX" >/dev/null 2>&1; then
+    echo "ERROR: $CXX no está instalado (sudo apt install g++)"
+    exit 1
+fi
+
+echo "[2/4] Verificando ONNX Runtime en $ORT_ROOT..."
+if [ ! -f "$ORT_ROOT/include/onnxruntime_cxx_api.h" ] && [ ! -f "$ORT_ROOT/include/onnxruntime/onnxruntime_cxx_api.h" ]; then
+    echo "ERROR: no se encontró onnxruntime_cxx_api.h"
+    echo "       Descargar la release de ONNX Runtime y exportar ORT_ROOT"
+    exit 1
+fi
+
+echo "[3/4] Preparando directorio de salida..."
+mkdir -p dist_cpp
+
+echo "[4/4] Compilando..."
+$CXX $CXXFLAGS \
+    -I"$ORT_ROOT/include" -I"$ORT_ROOT/include/onnxruntime" \
+    visifruit_inference_server.cpp -o dist_cpp/visifruit_inference_server \
+    -L"$ORT_ROOT/lib" -Wl,-rpath,"$ORT_ROOT/lib" -lonnxruntime -ljpeg -lrt
+
+echo ""
+echo "✅ Compilación exitosa: dist_cpp/visifruit_inference_server"
+echo ""
+
+if [ "$1" == "--run" ]; then
+    shift
+    cd "$SCRIPT_DIR/.."
+    ./Extras/dist_cpp/visifruit_inference_server --model weights/best.onnx "$@"
+fi
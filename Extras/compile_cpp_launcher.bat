@@ -52,8 +52,7 @@ g++ -std=c++17 ^
     -luser32 ^
     -lkernel32 ^
     -lgdi32 ^
-    -lws2_32 ^
-    -lwininet
+    -lws2_32
 
 if errorlevel 1 (
     echo.
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Prueba del Hash Perceptual - VisiFruit
+======================================
+
+Comprueba que utils/perceptual_hash distingue una fruta desplazada sobre la
+banda (no debe reutilizarse el resultado del frame anterior) y que el ruido
+del sensor no cambia el hash de la misma escena. La distancia de Hamming se
+evalúa sola, sin la comprobación de color de la caché.
+
+Uso:
+    python Extras/test_perceptual_hash.py
+"""
+
+import sys
+from pathlib import Path
+
+import cv2
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+from utils.perceptual_hash import PerceptualHash  # noqa: E402
+
+MAX_DISTANCE = 4   # Valor por defecto de PerceptualHashCache
+
+# Colores ANSI
+RED = '\033[0;31m'
+GREEN = '\033[0;32m'
+NC = '\033[0m'
+
+
+def print_success(text):
+    print(f"{GREEN}✓ {text}{NC}")
+
+
+def print_error(text):
+    print(f"{RED}✗ {text}{NC}")
+
+
+def make_frame(rng: np.random.Generator, background: np.ndarray, fruit_x: int, noise: float = 3.0) -> np.ndarray:
+    """Banda con dos frutas y ruido gaussiano de sensor."""
+    frame = background.copy()
+    cv2.circle(frame, (fruit_x, 240), 45, (40, 60, 200), -1)
+    cv2.circle(frame, (fruit_x + 300, 300), 40, (30, 160, 220), -1)
+    noisy = frame.astype(np.float32) + rng.normal(0.0, noise, frame.shape)
+    return np.clip(noisy, 0, 255).astype(np.uint8)
+
+
+def main() -> int:
+    rng = np.random.default_rng(39)
+    backgrounds = {
+        "banda vacía": np.full((480, 640, 3), 110, np.uint8),
+        "banda texturizada": cv2.GaussianBlur(rng.integers(60, 140, (480, 640, 3)).astype(np.uint8), (0, 0), 6),
+    }
+
+    ok = True
+    for name, background in backgrounds.items():
+        reference = PerceptualHash.compute(make_frame(rng, background, 150))
+
+        for noise in (3.0, 6.0, 10.0):
+            distance = reference.distance(PerceptualHash.compute(make_frame(rng, background, 150, noise)))
+            if distance > MAX_DISTANCE:
+                print_error(f"{name}: misma escena con ruido {noise} a distancia {distance}")
+                ok = False
+
+        for shift in (20, 40, 80):
+            distance = reference.distance(PerceptualHash.compute(make_frame(rng, background, 150 + shift)))
+            if distance <= MAX_DISTANCE:
+                print_error(f"{name}: fruta desplazada {shift} px a distancia {distance} (acierto de caché)")
+                ok = False
+
+        if ok:
+            print_success(f"{name}: ruido tolerado y fruta desplazada detectada")
+
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
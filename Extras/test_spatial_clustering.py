@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Prueba del Agrupamiento Espacial - VisiFruit
+=============================================
+
+Comprueba que IA_Etiquetado/spatial_clustering.grid_dbscan da las mismas
+etiquetas que sklearn DBSCAN, con especial atención a los puntos separados
+exactamente eps (empates), tanto con pocos puntos (fuerza bruta en
+sklearn) como con muchos (árbol KD en sklearn).
+
+Sin sklearn instalado solo se ejecutan los casos con resultado conocido.
+
+Uso:
+    python Extras/test_spatial_clustering.py
+"""
+
+import sys
+from pathlib import Path
+
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "IA_Etiquetado"))
+from spatial_clustering import grid_dbscan  # noqa: E402
+
+try:
+    from sklearn.cluster import DBSCAN
+    SKLEARN_AVAILABLE = True
+except ImportError:
+    SKLEARN_AVAILABLE = False
+
+# Colores ANSI
+RED = '\033[0;31m'
+GREEN = '\033[0;32m'
+YELLOW = '\033[1;33m'
+NC = '\033[0m'
+
+
+def print_success(text):
+    print(f"{GREEN}✓ {text}{NC}")
+
+
+def print_error(text):
+    print(f"{RED}✗ {text}{NC}")
+
+
+def print_warning(text):
+    print(f"{YELLOW}⚠ {text}{NC}")
+
+
+def test_exact_eps_chain() -> bool:
+    """Puntos en línea a exactamente eps (valores representables sin error)."""
+    ok = True
+    for n in (4, 15):   # 4: fuerza bruta en sklearn; 15: árbol KD
+        points = np.column_stack([np.arange(n) * 0.5, np.zeros(n)])
+        labels = grid_dbscan(points, eps=0.5, min_samples=2)
+        if not np.array_equal(labels, np.zeros(n, dtype=np.int64)):
+            print_error(f"Cadena de {n} puntos a eps: {labels.tolist()}")
+            ok = False
+        # Justo por encima de eps: cada punto queda aislado (ruido)
+        labels = grid_dbscan(points * (1.0 + 1e-12), eps=0.5, min_samples=2)
+        if not np.array_equal(labels, np.full(n, -1, dtype=np.int64)):
+            print_error(f"Cadena de {n} puntos sobre eps: {labels.tolist()}")
+            ok = False
+    if ok:
+        print_success("Cadenas a distancia exactamente eps")
+    return ok
+
+
+def test_ties_against_sklearn(scenes: int = 3000) -> bool:
+    """Escenas con coordenadas múltiplo de eps (muchos empates) frente a sklearn."""
+    rng = np.random.default_rng(41)
+    failures = 0
+    for scene in range(scenes):
+        n = int(rng.integers(1, 40))
+        eps = float(rng.choice([0.05, 0.1, 0.15, 0.3, 1.0]))
+        min_samples = int(rng.integers(1, 5))
+        points = np.round(rng.random((n, 2)) * rng.choice([0.5, 2.0, 10.0]) / eps) * eps
+        if scene % 2 == 0:
+            # Diagonales 3-4-5 (distancia eps en aritmética exacta)
+            points[: n // 2] += np.array([0.6, 0.8]) * eps * rng.integers(0, 3, (n // 2, 1))
+
+        expected = DBSCAN(eps=eps, min_samples=min_samples).fit(points).labels_
+        labels = grid_dbscan(points, eps, min_samples)
+        if not np.array_equal(labels, expected):
+            failures += 1
+            if failures <= 3:
+                print_error(f"Escena {scene} (n={n}, eps={eps}, min_samples={min_samples}) distinta de sklearn")
+
+    if failures:
+        print_error(f"{failures}/{scenes} escenas con empates distintas de sklearn")
+        return False
+    print_success(f"{scenes} escenas con empates idénticas a sklearn")
+    return True
+
+
+def main() -> int:
+    ok = test_exact_eps_chain()
+    if SKLEARN_AVAILABLE:
+        ok = test_ties_against_sklearn() and ok
+    else:
+        print_warning("sklearn no instalado: se omite la comparación con DBSCAN")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
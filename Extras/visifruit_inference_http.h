@@ -0,0 +1,307 @@
+/**
+ * VisiFruit Servidor de Inferencia Nativo - HTTP/1.1 Mínimo
+ * ==========================================================
+ *
+ * Lectura de peticiones HTTP/1.1 con keep-alive y cuerpo por
+ * Content-Length, formularios multipart/form-data y
+ * application/x-www-form-urlencoded (los que acepta el servidor FastAPI
+ * en /infer) y construcción de respuestas.
+ *
+ * Los campos del formulario son vistas sobre el cuerpo de la petición: la
+ * imagen no se copia entre la lectura del socket y el decodificador JPEG.
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#include "visifruit_launcher_probe.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace visifruit {
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::string query;
+    std::vector<std::pair<std::string, std::string>> headers;   // nombres en minúsculas
+    std::string body;
+    bool keepAlive = true;
+
+    const std::string* Header(const std::string& name) const {
+        for (const auto& header : headers) {
+            if (header.first == name) return &header.second;
+        }
+        return nullptr;
+    }
+};
+
+enum class ReadStatus { Ok, Idle, Closed, Timeout, BadRequest, TooLarge };
+
+/**
+ * Lee la siguiente petición de una conexión keep-alive. pending conserva
+ * los bytes ya recibidos que pertenecen a la petición siguiente.
+ *
+ * idleDeadline limita la espera del primer byte (Idle si no llega nada);
+ * una vez iniciada, la petición completa debe llegar antes de
+ * requestTimeoutMs.
+ */
+inline ReadStatus ReadHttpRequest(socket_t sock, std::string& pending, std::vector<char>& scratch,
+                                  SteadyClock::time_point idleDeadline, int requestTimeoutMs,
+                                  size_t maxBody, HttpRequest& request) {
+    const size_t kMaxHeader = 64 * 1024;
+    SteadyClock::time_point deadline = idleDeadline;
+    bool started = !pending.empty();
+    if (started) deadline = SteadyClock::now() + std::chrono::milliseconds(requestTimeoutMs);
+
+    size_t headerEnd;
+    while ((headerEnd = pending.find("\r\n\r\n")) == std::string::npos) {
+        if (pending.size() > kMaxHeader) return ReadStatus::TooLarge;
+        int n = detail::RecvSome(sock, scratch.data(), scratch.size(), deadline);
+        if (n == 0) return ReadStatus::Closed;
+        if (n < 0) return started ? ReadStatus::Timeout : ReadStatus::Idle;
+        pending.append(scratch.data(), static_cast<size_t>(n));
+        if (!started) {
+            started = true;
+            deadline = SteadyClock::now() + std::chrono::milliseconds(requestTimeoutMs);
+        }
+    }
+
+    request = HttpRequest();
+    size_t lineEnd = pending.find("\r\n");
+    std::string requestLine = pending.substr(0, lineEnd);
+    size_t first = requestLine.find(' ');
+    size_t second = requestLine.find(' ', first == std::string::npos ? first : first + 1);
+    if (first == std::string::npos || second == std::string::npos) return ReadStatus::BadRequest;
+    request.method = requestLine.substr(0, first);
+    std::string target = requestLine.substr(first + 1, second - first - 1);
+    size_t question = target.find('?');
+    request.path = target.substr(0, question);
+    if (question != std::string::npos) request.query = target.substr(question + 1);
+    bool http10 = requestLine.compare(second + 1, std::string::npos, "HTTP/1.0") == 0;
+
+    size_t cursor = lineEnd + 2;
+    while (cursor < headerEnd) {
+        size_t end = pending.find("\r\n", cursor);
+        if (end == std::string::npos || end > headerEnd) end = headerEnd;
+        size_t colon = pending.find(':', cursor);
+        if (colon != std::string::npos && colon < end) {
+            std::string name = detail::ToLower(pending.substr(cursor, colon - cursor));
+            size_t valueStart = colon + 1;
+            while (valueStart < end && (pending[valueStart] == ' ' || pending[valueStart] == '\t')) ++valueStart;
+            request.headers.emplace_back(std::move(name), pending.substr(valueStart, end - valueStart));
+        }
+        cursor = end + 2;
+    }
+
+    const std::string* connection = request.Header("connection");
+    std::string connectionValue = connection ? detail::ToLower(*connection) : std::string();
+    request.keepAlive = http10 ? connectionValue == "keep-alive" : connectionValue != "close";
+
+    if (request.Header("transfer-encoding")) return ReadStatus::BadRequest;   // Sin cuerpos chunked
+    size_t bodyLength = 0;
+    if (const std::string* length = request.Header("content-length")) {
+        bodyLength = static_cast<size_t>(std::strtoull(length->c_str(), nullptr, 10));
+    }
+    if (bodyLength > maxBody) return ReadStatus::TooLarge;
+
+    size_t bodyStart = headerEnd + 4;
+    request.body.reserve(bodyLength);
+    request.body.assign(pending, bodyStart, std::min(bodyLength, pending.size() - bodyStart));
+    while (request.body.size() < bodyLength) {
+        int n = detail::RecvSome(sock, scratch.data(), scratch.size(), deadline);
+        if (n == 0) return ReadStatus::Closed;
+        if (n < 0) return ReadStatus::Timeout;
+        size_t take = std::min(static_cast<size_t>(n), bodyLength - request.body.size());
+        request.body.append(scratch.data(), take);
+        if (take < static_cast<size_t>(n)) {
+            // Bytes de la petición siguiente (pipelining)
+            pending.assign(scratch.data() + take, static_cast<size_t>(n) - take);
+            return ReadStatus::Ok;
+        }
+    }
+    pending.erase(0, std::min(pending.size(), bodyStart + bodyLength));
+    return ReadStatus::Ok;
+}
+
+struct FormField {
+    std::string name;
+    std::string filename;
+    const char* data = nullptr;
+    size_t size = 0;
+    std::string decoded;            // Valor decodificado (solo urlencoded)
+
+    std::string Text() const { return data ? std::string(data, size) : decoded; }
+};
+
+inline std::string HeaderParameter(const std::string& header, const std::string& key) {
+    std::string lower = detail::ToLower(header);
+    size_t pos = 0;
+    while ((pos = lower.find(key + "=", pos)) != std::string::npos) {
+        // Evitar coincidencias parciales (p. ej. "filename=" al buscar "name=")
+        if (pos > 0 && lower[pos - 1] != ' ' && lower[pos - 1] != ';') {
+            pos += key.size();
+            continue;
+        }
+        size_t start = pos + key.size() + 1;
+        if (start < header.size() && header[start] == '"') {
+            size_t end = header.find('"', start + 1);
+            return header.substr(start + 1, end == std::string::npos ? std::string::npos : end - start - 1);
+        }
+        size_t end = header.find_first_of("; ", start);
+        return header.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    }
+    return std::string();
+}
+
+// multipart/form-data: los campos apuntan al interior de body
+inline bool ParseMultipart(const std::string& body, const std::string& boundary, std::vector<FormField>& fields) {
+    fields.clear();
+    if (boundary.empty()) return false;
+    const std::string delimiter = "--" + boundary;
+
+    size_t pos = body.find(delimiter);
+    if (pos == std::string::npos) return false;
+    for (;;) {
+        pos += delimiter.size();
+        if (body.compare(pos, 2, "--") == 0) return true;        // Delimitador final
+        if (body.compare(pos, 2, "\r\n") != 0) return false;
+        pos += 2;
+
+        size_t headersEnd = body.find("\r\n\r\n", pos);
+        if (headersEnd == std::string::npos) return false;
+        FormField field;
+        size_t line = pos;
+        while (line < headersEnd) {
+            size_t end = body.find("\r\n", line);
+            if (end == std::string::npos || end > headersEnd) end = headersEnd;
+            std::string header = body.substr(line, end - line);
+            if (detail::ToLower(header.substr(0, 20)) == "content-disposition:") {
+                field.name = HeaderParameter(header, "name");
+                field.filename = HeaderParameter(header, "filename");
+            }
+            line = end + 2;
+        }
+
+        size_t dataStart = headersEnd + 4;
+        size_t next = body.find("\r\n" + delimiter, dataStart);
+        if (next == std::string::npos) return false;
+        field.data = body.data() + dataStart;
+        field.size = next - dataStart;
+        fields.push_back(std::move(field));
+        pos = next + 2;
+    }
+}
+
+inline std::string UrlDecode(const std::string& text, size_t start, size_t end) {
+    std::string out;
+    out.reserve(end - start);
+    for (size_t i = start; i < end; ++i) {
+        char c = text[i];
+        if (c == '+') {
+            out += ' ';
+        } else if (c == '%' && i + 2 < end) {
+            char hex[3] = {text[i + 1], text[i + 2], 0};
+            out += static_cast<char>(std::strtol(hex, nullptr, 16));
+            i += 2;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+inline void ParseUrlEncoded(const std::string& body, std::vector<FormField>& fields) {
+    fields.clear();
+    size_t pos = 0;
+    while (pos < body.size()) {
+        size_t end = body.find('&', pos);
+        if (end == std::string::npos) end = body.size();
+        size_t equals = body.find('=', pos);
+        FormField field;
+        if (equals == std::string::npos || equals > end) {
+            field.name = UrlDecode(body, pos, end);
+        } else {
+            field.name = UrlDecode(body, pos, equals);
+            field.decoded = UrlDecode(body, equals + 1, end);
+        }
+        if (!field.name.empty()) fields.push_back(std::move(field));
+        pos = end + 1;
+    }
+}
+
+inline const FormField* FindField(const std::vector<FormField>& fields, const std::string& name) {
+    for (const auto& field : fields) {
+        if (field.name == name) return &field;
+    }
+    return nullptr;
+}
+
+inline const char* StatusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 413: return "Payload Too Large";
+        case 422: return "Unprocessable Entity";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "Unknown";
+    }
+}
+
+inline std::string BuildHttpResponse(int status, const std::string& contentType, const std::string& body,
+                                     bool keepAlive) {
+    std::string response;
+    response.reserve(body.size() + 160);
+    response += "HTTP/1.1 " + std::to_string(status) + " " + StatusText(status) + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    response += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    response += body;
+    return response;
+}
+
+inline void AppendJsonString(std::string& out, const std::string& text) {
+    out += '"';
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    out += '"';
+}
+
+// Cuerpo de error con el mismo formato que HTTPException de FastAPI
+inline std::string JsonDetail(const std::string& detail) {
+    std::string body = "{\"detail\":";
+    AppendJsonString(body, detail);
+    body += "}";
+    return body;
+}
+
+}  // namespace visifruit
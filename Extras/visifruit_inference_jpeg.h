@@ -0,0 +1,141 @@
+/**
+ * VisiFruit Servidor de Inferencia Nativo - Decodificación JPEG
+ * ==============================================================
+ *
+ * Decodificación de los frames recibidos en /infer con libjpeg(-turbo),
+ * directamente a RGB (el orden que espera el modelo) en un buffer que el
+ * llamador reutiliza entre peticiones.
+ *
+ * Si el frame es mucho mayor que la entrada del modelo se decodifica ya
+ * reducido en el dominio DCT (1/2, 1/4 o 1/8), lo que ahorra la mayor
+ * parte del IDCT y de la conversión de color sin bajar del tamaño que
+ * después usa el letterbox.
+ *
+ * Los errores de libjpeg (que por defecto llaman a exit()) se recuperan
+ * con setjmp/longjmp y se devuelven como texto.
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <csetjmp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <jpeglib.h>
+
+namespace visifruit {
+
+struct DecodedImage {
+    std::vector<uint8_t> pixels;    // RGB intercalado, filas contiguas
+    int width = 0;                  // Tamaño decodificado
+    int height = 0;
+    int sourceWidth = 0;            // Tamaño original del JPEG
+    int sourceHeight = 0;
+};
+
+namespace detail {
+
+struct JpegErrorManager {
+    jpeg_error_mgr base;
+    std::jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+inline void JpegErrorExit(j_common_ptr info) {
+    JpegErrorManager* manager = reinterpret_cast<JpegErrorManager*>(info->err);
+    (*info->err->format_message)(info, manager->message);
+    std::longjmp(manager->jump, 1);
+}
+
+inline void JpegSilence(j_common_ptr, int) {}
+
+}  // namespace detail
+
+/**
+ * Decodifica un JPEG a RGB.
+ *
+ * Args:
+ *   data, size: bytes del archivo
+ *   fitWidth, fitHeight: entrada del modelo; el escalado DCT nunca baja
+ *                        del tamaño al que el letterbox (o el estiramiento,
+ *                        si stretch) llevará la imagen (0 = tamaño completo)
+ *   image: destino (su buffer se reutiliza)
+ *   error: descripción si devuelve false
+ */
+inline bool DecodeJpeg(const uint8_t* data, size_t size, int fitWidth, int fitHeight, bool stretch,
+                       DecodedImage& image, std::string& error) {
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        error = "no es un JPEG";
+        return false;
+    }
+
+    jpeg_decompress_struct info;
+    detail::JpegErrorManager errorManager;
+    info.err = jpeg_std_error(&errorManager.base);
+    errorManager.base.error_exit = detail::JpegErrorExit;
+    errorManager.base.emit_message = detail::JpegSilence;
+
+    if (setjmp(errorManager.jump)) {
+        error = errorManager.message;
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+    jpeg_read_header(&info, TRUE);
+
+    image.sourceWidth = static_cast<int>(info.image_width);
+    image.sourceHeight = static_cast<int>(info.image_height);
+
+    info.out_color_space = JCS_RGB;
+    info.dct_method = JDCT_ISLOW;
+    info.scale_num = 1;
+    info.scale_denom = 1;
+    if (fitWidth > 0 && fitHeight > 0) {
+        double minWidth = fitWidth, minHeight = fitHeight;
+        if (!stretch) {
+            double gain = std::min(static_cast<double>(fitWidth) / info.image_width,
+                                   static_cast<double>(fitHeight) / info.image_height);
+            minWidth = std::ceil(info.image_width * gain);
+            minHeight = std::ceil(info.image_height * gain);
+        }
+        for (unsigned denom = 8; denom > 1; denom /= 2) {
+            unsigned w = (info.image_width + denom - 1) / denom;
+            unsigned h = (info.image_height + denom - 1) / denom;
+            if (w >= minWidth && h >= minHeight) {
+                info.scale_denom = denom;
+                break;
+            }
+        }
+    }
+
+    jpeg_start_decompress(&info);
+    image.width = static_cast<int>(info.output_width);
+    image.height = static_cast<int>(info.output_height);
+    const size_t stride = static_cast<size_t>(image.width) * 3;
+    image.pixels.resize(stride * static_cast<size_t>(image.height));
+
+    while (info.output_scanline < info.output_height) {
+        JSAMPROW rows[4];
+        JDIMENSION count = 0;
+        for (; count < 4 && info.output_scanline + count < info.output_height; ++count) {
+            rows[count] = image.pixels.data() + stride * (info.output_scanline + count);
+        }
+        jpeg_read_scanlines(&info, rows, count);
+    }
+
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    return true;
+}
+
+}  // namespace visifruit
@@ -0,0 +1,562 @@
+/**
+ * VisiFruit Servidor de Inferencia Nativo - Pre y Post-procesamiento
+ * ===================================================================
+ *
+ * Todo lo que rodea a la sesión del modelo, sin dependencias externas:
+ *
+ * - Letterbox (YOLOv8) o estiramiento (RT-DETR) con la misma geometría que
+ *   Ultralytics, fusionado con la conversión de color (RGB, BGR, gris o
+ *   YUV 4:2:0), la normalización a [0, 1] (o u8 para entradas cuantizadas)
+ *   y el paso de HWC a CHW en una sola pasada sobre un tensor reutilizado.
+ *   La geometría (tablas de interpolación por columna y fila) se cachea
+ *   por tamaño de imagen, que en la banda no cambia entre frames.
+ * - Decodificación de las salidas exportadas a ONNX:
+ *     YOLOv8      [1, 4+nc, N]  cx,cy,w,h en píxeles de entrada + puntuaciones
+ *     YOLOv8 NMS  [1, K, 6]     x1,y1,x2,y2,conf,clase (export con nms=True)
+ *     RT-DETR     [1, Q, 4+nc]  cx,cy,w,h normalizados + puntuaciones
+ * - NMS por clase (como Ultralytics con agnostic=False) y reescalado de
+ *   cajas al espacio de la imagen original.
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace visifruit {
+
+enum class ModelLayout { Yolov8, Yolov8Nms, Rtdetr };
+
+inline bool ParseModelLayout(const std::string& name, ModelLayout& layout) {
+    if (name == "yolov8" || name == "yolo") layout = ModelLayout::Yolov8;
+    else if (name == "yolov8_nms") layout = ModelLayout::Yolov8Nms;
+    else if (name == "rtdetr") layout = ModelLayout::Rtdetr;
+    else return false;
+    return true;
+}
+
+/**
+ * Salida [1, K, 6]: YOLOv8 exportado con nms=True (x1 y1 x2 y2 conf clase).
+ * Solo sirve para confirmar un modelo ya declarado como YOLOv8: un RT-DETR
+ * de 2 clases tiene la misma forma ([1, 300, 4 + 2]).
+ */
+inline bool HasNmsOutput(const std::vector<int64_t>& outputShape) {
+    return outputShape.size() == 3 && outputShape[2] == 6;
+}
+
+/**
+ * Deduce el formato a partir de la forma de la salida cuando el modelo no
+ * trae metadatos: [1, C, N] con C < N es la salida cruda de YOLOv8
+ * (84 x 8400); [1, Q, C] con Q > C es RT-DETR. Devuelve false si la forma
+ * es ambigua ([1, K, 6]: YOLOv8 con NMS o RT-DETR de 2 clases); en ese caso
+ * hay que indicar el tipo (MODEL_TYPE o <modelo>.onnx.json).
+ */
+inline bool GuessModelLayout(const std::vector<int64_t>& outputShape, ModelLayout& layout) {
+    if (HasNmsOutput(outputShape)) return false;
+    if (outputShape.size() == 3 && outputShape[1] > 0 && outputShape[2] > 0 &&
+        outputShape[1] > outputShape[2]) {
+        layout = ModelLayout::Rtdetr;
+    } else {
+        layout = ModelLayout::Yolov8;
+    }
+    return true;
+}
+
+struct Detection {
+    int classId = 0;
+    float confidence = 0.0f;
+    float x1 = 0.0f, y1 = 0.0f, x2 = 0.0f, y2 = 0.0f;
+};
+
+/**
+ * Geometría de la transformación imagen -> tensor de entrada.
+ *
+ * width/height: tamaño lógico de la imagen (el de las cajas de respuesta).
+ * pixelWidth/pixelHeight: tamaño real del buffer, que puede ser menor si
+ * el JPEG se decodificó ya reducido (escalado DCT 1/2, 1/4, 1/8).
+ */
+struct LetterboxGeometry {
+    int width = 0, height = 0;
+    int pixelWidth = 0, pixelHeight = 0;
+    int inputWidth = 0, inputHeight = 0;
+    bool stretch = false;
+
+    float gainX = 1.0f, gainY = 1.0f;   // Lógico -> entrada
+    int padX = 0, padY = 0;
+    int resizedWidth = 0, resizedHeight = 0;
+
+    // Interpolación bilineal (convención de OpenCV: centros de píxel alineados)
+    std::vector<int32_t> xOffset;       // Índice del byte del píxel izquierdo en la fila
+    std::vector<float> xWeight;         // Peso del píxel derecho
+    std::vector<int32_t> yRow;          // Fila superior
+    std::vector<float> yWeight;         // Peso de la fila inferior
+
+    bool Matches(int w, int h, int pw, int ph, int iw, int ih, bool s) const {
+        return width == w && height == h && pixelWidth == pw && pixelHeight == ph &&
+               inputWidth == iw && inputHeight == ih && stretch == s;
+    }
+
+    void Build(int w, int h, int pw, int ph, int iw, int ih, bool s) {
+        width = w;
+        height = h;
+        pixelWidth = pw;
+        pixelHeight = ph;
+        inputWidth = iw;
+        inputHeight = ih;
+        stretch = s;
+
+        if (stretch) {
+            // RT-DETR: escalado sin relleno (scaleFill de Ultralytics)
+            gainX = static_cast<float>(iw) / static_cast<float>(w);
+            gainY = static_cast<float>(ih) / static_cast<float>(h);
+            resizedWidth = iw;
+            resizedHeight = ih;
+            padX = padY = 0;
+        } else {
+            float gain = std::min(static_cast<float>(ih) / static_cast<float>(h),
+                                  static_cast<float>(iw) / static_cast<float>(w));
+            gainX = gainY = gain;
+            resizedWidth = static_cast<int>(std::lround(w * gain));
+            resizedHeight = static_cast<int>(std::lround(h * gain));
+            // Mismo redondeo que LetterBox: round(d - 0.1) con d = relleno / 2
+            padX = static_cast<int>(std::lround((iw - resizedWidth) / 2.0 - 0.1));
+            padY = static_cast<int>(std::lround((ih - resizedHeight) / 2.0 - 0.1));
+        }
+
+        BuildAxis(pw, resizedWidth, xOffset, xWeight);
+        BuildAxis(ph, resizedHeight, yRow, yWeight);
+        for (auto& offset : xOffset) offset *= 3;
+    }
+
+private:
+    static void BuildAxis(int source, int target, std::vector<int32_t>& index, std::vector<float>& weight) {
+        index.resize(static_cast<size_t>(target));
+        weight.resize(static_cast<size_t>(target));
+        double scale = static_cast<double>(source) / static_cast<double>(target);
+        for (int i = 0; i < target; ++i) {
+            double position = (i + 0.5) * scale - 0.5;
+            int lower = static_cast<int>(std::floor(position));
+            double fraction = position - lower;
+            if (lower < 0) {
+                lower = 0;
+                fraction = 0.0;
+            }
+            if (lower >= source - 1) {
+                lower = std::max(0, source - 2);
+                fraction = source > 1 ? 1.0 : 0.0;
+            }
+            index[static_cast<size_t>(i)] = lower;
+            weight[static_cast<size_t>(i)] = static_cast<float>(fraction);
+        }
+    }
+};
+
+/**
+ * Formatos de píxel que el preprocesado lee directamente, sin conversión
+ * previa del frame completo:
+ *   Rgb / Bgr  intercalado de 3 bytes (JPEG decodificado / frames de OpenCV)
+ *   Gray       1 byte por píxel
+ *   I420       YUV 4:2:0 planar (Y, U, V), p. ej. YUV420 de picamera2
+ *   Nv12       YUV 4:2:0 con U y V intercalados tras el plano Y
+ * En YUV, stride es el del plano Y y los planos de croma le siguen sin
+ * relleno (la disposición de cv2.COLOR_YUV2BGR_I420 / _NV12).
+ */
+enum class PixelFormat { Rgb, Bgr, Gray, I420, Nv12 };
+
+inline bool ParsePixelFormat(const std::string& name, PixelFormat& format) {
+    if (name == "rgb") format = PixelFormat::Rgb;
+    else if (name == "bgr") format = PixelFormat::Bgr;
+    else if (name == "gray") format = PixelFormat::Gray;
+    else if (name == "i420" || name == "yuv420") format = PixelFormat::I420;
+    else if (name == "nv12") format = PixelFormat::Nv12;
+    else return false;
+    return true;
+}
+
+/**
+ * Frame de entrada sin copiar: puede apuntar al buffer de decodificación
+ * JPEG o directamente a un slot de memoria compartida.
+ */
+struct PixelSource {
+    const uint8_t* data = nullptr;
+    size_t stride = 0;              // Bytes por fila (del plano Y en YUV)
+    int width = 0;                  // Tamaño en píxeles del buffer
+    int height = 0;
+    PixelFormat format = PixelFormat::Rgb;
+
+    // Bytes que ocupa el frame completo (YUV requiere ancho y alto pares)
+    size_t ByteSize() const {
+        size_t luma = stride * static_cast<size_t>(height);
+        switch (format) {
+            case PixelFormat::I420: return luma + (stride / 2) * static_cast<size_t>(height / 2) * 2;
+            case PixelFormat::Nv12: return luma + stride * static_cast<size_t>(height / 2);
+            default: return luma;
+        }
+    }
+};
+
+namespace detail {
+
+inline uint8_t ClampByte(int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// BT.601 de rango limitado en coma fija, los mismos coeficientes que cv2.cvtColor(COLOR_YUV2RGB_*)
+inline void YuvToRgb(int y, int u, int v, uint8_t* out) {
+    const int kShift = 20;
+    const int kRound = 1 << (kShift - 1);
+    int luma = std::max(0, y - 16) * 1220542;
+    u -= 128;
+    v -= 128;
+    out[0] = ClampByte((luma + kRound + 1673527 * v) >> kShift);
+    out[1] = ClampByte((luma + kRound - 852492 * v - 409993 * u) >> kShift);
+    out[2] = ClampByte((luma + kRound + 2116026 * u) >> kShift);
+}
+
+/**
+ * Fila de origen en RGB/BGR intercalado: directa en Rgb/Bgr; para gris y
+ * YUV se convierte en scratch (solo las filas que usa la interpolación).
+ */
+inline const uint8_t* SourceRow(const PixelSource& source, int row, uint8_t* scratch) {
+    const uint8_t* luma = source.data + static_cast<size_t>(row) * source.stride;
+    const int width = source.width;
+    switch (source.format) {
+        case PixelFormat::Rgb:
+        case PixelFormat::Bgr:
+            return luma;
+        case PixelFormat::Gray:
+            for (int x = 0; x < width; ++x) {
+                scratch[x * 3] = scratch[x * 3 + 1] = scratch[x * 3 + 2] = luma[x];
+            }
+            return scratch;
+        case PixelFormat::I420: {
+            const size_t chromaStride = source.stride / 2;
+            const uint8_t* u = source.data + source.stride * static_cast<size_t>(source.height) +
+                               chromaStride * static_cast<size_t>(row / 2);
+            const uint8_t* v = u + chromaStride * static_cast<size_t>(source.height / 2);
+            for (int x = 0; x < width; ++x) YuvToRgb(luma[x], u[x / 2], v[x / 2], scratch + x * 3);
+            return scratch;
+        }
+        case PixelFormat::Nv12: {
+            const uint8_t* uv = source.data + source.stride * static_cast<size_t>(source.height) +
+                                source.stride * static_cast<size_t>(row / 2);
+            for (int x = 0; x < width; ++x) {
+                const uint8_t* pair = uv + (x / 2) * 2;
+                YuvToRgb(luma[x], pair[0], pair[1], scratch + x * 3);
+            }
+            return scratch;
+        }
+    }
+    return luma;
+}
+
+}  // namespace detail
+
+/**
+ * Tipo de elemento del tensor de entrada: float normalizado a [0, 1] o u8
+ * en [0, 255] para modelos cuantizados con la entrada en uint8 (escala
+ * 1/255, punto cero 0), que así reciben el tensor sin QuantizeLinear.
+ */
+template <typename T>
+struct TensorStore;
+
+template <>
+struct TensorStore<float> {
+    static float Pad() { return 114.0f / 255.0f; }
+    static float From(float value) { return value * (1.0f / 255.0f); }
+};
+
+template <>
+struct TensorStore<uint8_t> {
+    static uint8_t Pad() { return 114; }
+    static uint8_t From(float value) { return static_cast<uint8_t>(value + 0.5f); }
+};
+
+// Buffers de trabajo del preprocesado, reutilizados por el llamador
+struct PreprocessScratch {
+    std::vector<float> mixed;       // Fila de origen mezclada en vertical
+    std::vector<uint8_t> rgb;       // Dos filas de origen convertidas (gris / YUV)
+};
+
+/**
+ * Redimensiona un frame al área útil del tensor [3, H, W] en una sola
+ * pasada: conversión de color por fila, interpolación bilineal,
+ * normalización y paso de HWC a CHW, rellenando el borde con 114 como
+ * Ultralytics. Sin temporales del tamaño del frame.
+ *
+ * swapChannels invierte el orden de los planos (corrección de cámaras que
+ * entregan BGR/RGB cruzados) sin coste adicional; un origen Bgr se trata
+ * igual, por lo que el tensor siempre queda en RGB.
+ */
+template <typename T>
+inline void LetterboxToTensor(const PixelSource& source, const LetterboxGeometry& geometry,
+                              bool swapChannels, T* tensor, PreprocessScratch& scratch) {
+    const int iw = geometry.inputWidth;
+    const int ih = geometry.inputHeight;
+    const size_t plane = static_cast<size_t>(iw) * static_cast<size_t>(ih);
+    const T pad = TensorStore<T>::Pad();
+
+    const bool swap = swapChannels != (source.format == PixelFormat::Bgr);
+    T* planes[3];
+    for (int c = 0; c < 3; ++c) planes[swap ? 2 - c : c] = tensor + plane * static_cast<size_t>(c);
+
+    // Relleno solo de las franjas fuera del área útil
+    if (geometry.padX > 0 || geometry.padY > 0 ||
+        geometry.resizedWidth != iw || geometry.resizedHeight != ih) {
+        for (int c = 0; c < 3; ++c) {
+            T* p = tensor + plane * static_cast<size_t>(c);
+            for (int y = 0; y < ih; ++y) {
+                T* row = p + static_cast<size_t>(y) * static_cast<size_t>(iw);
+                bool inside = y >= geometry.padY && y < geometry.padY + geometry.resizedHeight;
+                if (!inside) {
+                    std::fill(row, row + iw, pad);
+                    continue;
+                }
+                std::fill(row, row + geometry.padX, pad);
+                std::fill(row + geometry.padX + geometry.resizedWidth, row + iw, pad);
+            }
+        }
+    }
+
+    // Vertical primero: la mezcla de las dos filas de origen recorre bytes
+    // contiguos (vectorizable) y la interpolación horizontal, con accesos
+    // indexados, se hace una sola vez por fila de salida
+    const int rw = geometry.resizedWidth;
+    const size_t rowBytes = static_cast<size_t>(geometry.pixelWidth) * 3;
+    scratch.mixed.resize(rowBytes);
+    const bool converted = source.format != PixelFormat::Rgb && source.format != PixelFormat::Bgr;
+    if (converted) scratch.rgb.resize(rowBytes * 2);
+    int convertedRow[2] = {-1, -1};
+
+    // Filas de gris / YUV convertidas a RGB, cacheadas por índice (al ampliar se repiten)
+    auto sourceRow = [&](int row) -> const uint8_t* {
+        if (!converted) return source.data + static_cast<size_t>(row) * source.stride;
+        for (int k = 0; k < 2; ++k) {
+            if (convertedRow[k] == row) return scratch.rgb.data() + rowBytes * static_cast<size_t>(k);
+        }
+        int slot = (convertedRow[0] < convertedRow[1]) ? 0 : 1;
+        convertedRow[slot] = row;
+        return detail::SourceRow(source, row, scratch.rgb.data() + rowBytes * static_cast<size_t>(slot));
+    };
+
+    // Casos degenerados de 1 px de ancho o alto: sin vecino derecho / inferior
+    const bool singleColumn = geometry.pixelWidth < 2;
+    const bool singleRow = geometry.pixelHeight < 2;
+    const int32_t* offsets = geometry.xOffset.data();
+    const float* weights = geometry.xWeight.data();
+    float* mixed = scratch.mixed.data();
+
+    for (int y = 0; y < geometry.resizedHeight; ++y) {
+        int top = geometry.yRow[static_cast<size_t>(y)];
+        float wy = singleRow ? 0.0f : geometry.yWeight[static_cast<size_t>(y)];
+        const uint8_t* upper = sourceRow(top);
+        const uint8_t* lower = singleRow ? upper : sourceRow(top + 1);
+        for (size_t i = 0; i < rowBytes; ++i) {
+            mixed[i] = upper[i] + (static_cast<float>(lower[i]) - upper[i]) * wy;
+        }
+
+        size_t rowOffset = static_cast<size_t>(y + geometry.padY) * static_cast<size_t>(iw) +
+                           static_cast<size_t>(geometry.padX);
+        T* r = planes[0] + rowOffset;
+        T* g = planes[1] + rowOffset;
+        T* b = planes[2] + rowOffset;
+        if (singleColumn) {
+            std::fill(r, r + rw, TensorStore<T>::From(mixed[0]));
+            std::fill(g, g + rw, TensorStore<T>::From(mixed[1]));
+            std::fill(b, b + rw, TensorStore<T>::From(mixed[2]));
+            continue;
+        }
+        for (int x = 0; x < rw; ++x) {
+            const float* left = mixed + offsets[x];
+            float w = weights[x];
+            r[x] = TensorStore<T>::From(left[0] + (left[3] - left[0]) * w);
+            g[x] = TensorStore<T>::From(left[1] + (left[4] - left[1]) * w);
+            b[x] = TensorStore<T>::From(left[2] + (left[5] - left[2]) * w);
+        }
+    }
+}
+
+/**
+ * Heurística del servidor Python (_verify_color_space): con el rojo
+ * dominante sobre el azul o tonos magenta, los canales llegan cruzados.
+ * Se evalúa sobre una muestra 1 de cada 10 en cada eje. Gris y YUV no
+ * tienen orden de canales que corregir.
+ */
+inline bool NeedsChannelSwap(const PixelSource& source) {
+    if (source.format != PixelFormat::Rgb && source.format != PixelFormat::Bgr) return false;
+    const int red = source.format == PixelFormat::Rgb ? 0 : 2;
+    double sum[3] = {0.0, 0.0, 0.0};
+    size_t count = 0;
+    for (int y = 0; y < source.height; y += 10) {
+        const uint8_t* row = source.data + static_cast<size_t>(y) * source.stride;
+        for (int x = 0; x < source.width; x += 10) {
+            const uint8_t* p = row + static_cast<size_t>(x) * 3;
+            sum[0] += p[0];
+            sum[1] += p[1];
+            sum[2] += p[2];
+            ++count;
+        }
+    }
+    if (count == 0) return false;
+    double r = sum[red] / count, g = sum[1] / count, b = sum[2 - red] / count;
+    if (r > b * 1.2 && r > 100) return true;
+    double magenta = (r + b) / 2.0;
+    return magenta > g * 1.5 && magenta > 120;
+}
+
+inline float BoxIou(const Detection& a, const Detection& b) {
+    float ix1 = std::max(a.x1, b.x1), iy1 = std::max(a.y1, b.y1);
+    float ix2 = std::min(a.x2, b.x2), iy2 = std::min(a.y2, b.y2);
+    float inter = std::max(0.0f, ix2 - ix1) * std::max(0.0f, iy2 - iy1);
+    float areaA = (a.x2 - a.x1) * (a.y2 - a.y1);
+    float areaB = (b.x2 - b.x1) * (b.y2 - b.y1);
+    float uni = areaA + areaB - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+/**
+ * NMS por clase sobre candidatos ya filtrados por confianza. Conserva como
+ * máximo maxDet detecciones, en orden de confianza descendente.
+ */
+inline void NonMaxSuppression(std::vector<Detection>& candidates, float iouThreshold, size_t maxDet,
+                              size_t maxCandidates = 30000) {
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Detection& a, const Detection& b) { return a.confidence > b.confidence; });
+    if (candidates.size() > maxCandidates) candidates.resize(maxCandidates);
+
+    std::vector<Detection> kept;
+    kept.reserve(std::min(candidates.size(), maxDet));
+    for (const Detection& candidate : candidates) {
+        bool suppressed = false;
+        for (const Detection& k : kept) {
+            if (k.classId == candidate.classId && BoxIou(k, candidate) > iouThreshold) {
+                suppressed = true;
+                break;
+            }
+        }
+        if (suppressed) continue;
+        kept.push_back(candidate);
+        if (kept.size() >= maxDet) break;
+    }
+    candidates.swap(kept);
+}
+
+// Espacio de entrada -> imagen lógica, recortando al borde como scale_boxes
+inline void ScaleToImage(Detection& d, const LetterboxGeometry& g) {
+    d.x1 = std::min(std::max((d.x1 - g.padX) / g.gainX, 0.0f), static_cast<float>(g.width));
+    d.x2 = std::min(std::max((d.x2 - g.padX) / g.gainX, 0.0f), static_cast<float>(g.width));
+    d.y1 = std::min(std::max((d.y1 - g.padY) / g.gainY, 0.0f), static_cast<float>(g.height));
+    d.y2 = std::min(std::max((d.y2 - g.padY) / g.gainY, 0.0f), static_cast<float>(g.height));
+}
+
+struct DecodeParams {
+    float conf = 0.25f;
+    float iou = 0.45f;
+    size_t maxDet = 100;
+};
+
+/**
+ * Salida cruda de YOLOv8 [1, 4+nc, N]. La mejor clase por ancla se busca
+ * recorriendo la salida por filas (clase a clase), que es el orden en
+ * memoria, en lugar de saltar nc*N floats por ancla.
+ */
+inline void DecodeYolov8(const float* output, int64_t channels, int64_t anchors, const LetterboxGeometry& g,
+                         const DecodeParams& params, std::vector<float>& bestScore,
+                         std::vector<int32_t>& bestClass, std::vector<Detection>& out) {
+    out.clear();
+    const int64_t classes = channels - 4;
+    if (classes <= 0 || anchors <= 0) return;
+    const size_t n = static_cast<size_t>(anchors);
+
+    bestScore.assign(output + 4 * n, output + 5 * n);
+    bestClass.assign(n, 0);
+    for (int64_t c = 1; c < classes; ++c) {
+        const float* scores = output + static_cast<size_t>(4 + c) * n;
+        for (size_t i = 0; i < n; ++i) {
+            if (scores[i] > bestScore[i]) {
+                bestScore[i] = scores[i];
+                bestClass[i] = static_cast<int32_t>(c);
+            }
+        }
+    }
+
+    const float* cx = output;
+    const float* cy = output + n;
+    const float* w = output + 2 * n;
+    const float* h = output + 3 * n;
+    for (size_t i = 0; i < n; ++i) {
+        if (!(bestScore[i] > params.conf)) continue;
+        Detection d;
+        d.classId = bestClass[i];
+        d.confidence = bestScore[i];
+        d.x1 = cx[i] - w[i] * 0.5f;
+        d.y1 = cy[i] - h[i] * 0.5f;
+        d.x2 = cx[i] + w[i] * 0.5f;
+        d.y2 = cy[i] + h[i] * 0.5f;
+        out.push_back(d);
+    }
+
+    NonMaxSuppression(out, params.iou, params.maxDet);
+    for (Detection& d : out) ScaleToImage(d, g);
+}
+
+// Export con NMS integrado [1, K, 6]: x1,y1,x2,y2,conf,clase en píxeles de entrada
+inline void DecodeYolov8Nms(const float* output, int64_t rows, const LetterboxGeometry& g,
+                            const DecodeParams& params, std::vector<Detection>& out) {
+    out.clear();
+    for (int64_t r = 0; r < rows && out.size() < params.maxDet; ++r) {
+        const float* row = output + r * 6;
+        if (!(row[4] > params.conf)) continue;
+        Detection d;
+        d.x1 = row[0];
+        d.y1 = row[1];
+        d.x2 = row[2];
+        d.y2 = row[3];
+        d.confidence = row[4];
+        d.classId = static_cast<int>(row[5]);
+        ScaleToImage(d, g);
+        out.push_back(d);
+    }
+}
+
+/**
+ * RT-DETR [1, Q, 4+nc]: cajas cx,cy,w,h normalizadas a la imagen y
+ * puntuaciones ya activadas. Sin NMS (las consultas no se solapan); se
+ * ordena por confianza y se limita a maxDet.
+ */
+inline void DecodeRtdetr(const float* output, int64_t queries, int64_t channels, const LetterboxGeometry& g,
+                         const DecodeParams& params, std::vector<Detection>& out) {
+    out.clear();
+    const int64_t classes = channels - 4;
+    if (classes <= 0) return;
+    const float w = static_cast<float>(g.width);
+    const float h = static_cast<float>(g.height);
+
+    for (int64_t q = 0; q < queries; ++q) {
+        const float* row = output + q * channels;
+        const float* scores = row + 4;
+        int best = static_cast<int>(std::max_element(scores, scores + classes) - scores);
+        if (!(scores[best] > params.conf)) continue;
+        Detection d;
+        d.classId = best;
+        d.confidence = scores[best];
+        d.x1 = std::min(std::max((row[0] - row[2] * 0.5f) * w, 0.0f), w);
+        d.y1 = std::min(std::max((row[1] - row[3] * 0.5f) * h, 0.0f), h);
+        d.x2 = std::min(std::max((row[0] + row[2] * 0.5f) * w, 0.0f), w);
+        d.y2 = std::min(std::max((row[1] + row[3] * 0.5f) * h, 0.0f), h);
+        out.push_back(d);
+    }
+
+    std::sort(out.begin(), out.end(),
+              [](const Detection& a, const Detection& b) { return a.confidence > b.confidence; });
+    if (out.size() > params.maxDet) out.resize(params.maxDet);
+}
+
+}  // namespace visifruit
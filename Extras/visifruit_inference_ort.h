@@ -0,0 +1,212 @@
+/**
+ * VisiFruit Servidor de Inferencia Nativo - Sesión ONNX Runtime
+ * ==============================================================
+ *
+ * Envoltura de una sesión de ONNX Runtime (backend CPU) para los modelos
+ * YOLOv8 / RT-DETR exportados con IA_Etiquetado/IATraining/Export_Onnx.py:
+ *
+ * - Hilos intra-op configurables, inter-op a 1 y ejecución secuencial:
+ *   en la Pi las peticiones se sirven de una en una y todos los núcleos
+ *   trabajan en el mismo frame
+ * - Tensor de entrada (alineado a 64 bytes) y, si la forma de salida es
+ *   estática, tensor de salida preasignados y reutilizados en cada Run
+ *   (sin asignaciones por petición)
+ * - Entrada float o uint8 (modelos cuantizados cuya entrada acepta el
+ *   frame en [0, 255] directamente)
+ *
+ * Requiere los headers y la biblioteca de ONNX Runtime (ver
+ * compile_cpp_inference_server.sh).
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#include <onnxruntime_cxx_api.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace visifruit {
+
+/**
+ * Buffer de tamaño fijo alineado a línea de caché (y al ancho de los
+ * registros SIMD), para que el preprocesado y el primer operador del
+ * modelo recorran el tensor sin accesos partidos.
+ */
+template <typename T>
+class AlignedBuffer {
+public:
+    static constexpr size_t kAlignment = 64;
+
+    AlignedBuffer() = default;
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    ~AlignedBuffer() { Release(); }
+
+    void Assign(size_t count, T value) {
+        Release();
+        if (count == 0) return;
+        values = static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(kAlignment)));
+        size = count;
+        std::fill(values, values + size, value);
+    }
+
+    T* Data() { return values; }
+    size_t Size() const { return size; }
+
+private:
+    T* values = nullptr;
+    size_t size = 0;
+
+    void Release() {
+        if (values) ::operator delete(values, std::align_val_t(kAlignment));
+        values = nullptr;
+        size = 0;
+    }
+};
+
+class OrtDetector {
+public:
+    OrtDetector() : env(ORT_LOGGING_LEVEL_WARNING, "visifruit_inference") {}
+
+    /**
+     * Carga el modelo. inputSize se usa solo si la entrada tiene
+     * dimensiones espaciales dinámicas.
+     */
+    bool Load(const std::string& modelPath, int threads, int inputSize, std::string& error) {
+        try {
+            Ort::SessionOptions options;
+            options.SetIntraOpNumThreads(std::max(1, threads));
+            options.SetInterOpNumThreads(1);
+            options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+            options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+
+#ifdef _WIN32
+            std::wstring widePath(modelPath.begin(), modelPath.end());
+            session.reset(new Ort::Session(env, widePath.c_str(), options));
+#else
+            session.reset(new Ort::Session(env, modelPath.c_str(), options));
+#endif
+
+            Ort::AllocatorWithDefaultOptions allocator;
+            if (session->GetInputCount() != 1 || session->GetOutputCount() < 1) {
+                error = "se esperaba 1 entrada y al menos 1 salida";
+                return false;
+            }
+            inputName = session->GetInputNameAllocated(0, allocator).get();
+            outputName = session->GetOutputNameAllocated(0, allocator).get();
+
+            // TypeInfo debe seguir vivo mientras se consulta su vista de forma
+            Ort::TypeInfo inputType = session->GetInputTypeInfo(0);
+            Ort::TypeInfo outputType = session->GetOutputTypeInfo(0);
+            auto inputInfo = inputType.GetTensorTypeAndShapeInfo();
+            auto outputInfo = outputType.GetTensorTypeAndShapeInfo();
+            inputElementType = inputInfo.GetElementType();
+            if ((inputElementType != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT &&
+                 inputElementType != ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8) ||
+                outputInfo.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+                error = "el modelo debe tener entrada FP32 o UINT8 y salida FP32 (exportar con half=False)";
+                return false;
+            }
+
+            inputShape = inputInfo.GetShape();
+            if (inputShape.size() != 4) {
+                error = "entrada con forma inesperada (se esperaba NCHW)";
+                return false;
+            }
+            inputShape[0] = 1;
+            inputShape[1] = 3;
+            if (inputShape[2] <= 0) inputShape[2] = inputSize;
+            if (inputShape[3] <= 0) inputShape[3] = inputSize;
+
+            declaredOutputShape = outputInfo.GetShape();
+            if (!declaredOutputShape.empty() && declaredOutputShape[0] <= 0) declaredOutputShape[0] = 1;
+
+            size_t inputCount = static_cast<size_t>(inputShape[1] * inputShape[2] * inputShape[3]);
+            inputTensor.Assign(inputCount * (QuantizedInput() ? sizeof(uint8_t) : sizeof(float)), 0);
+            memoryInfo.reset(new Ort::MemoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)));
+            inputValue.reset(new Ort::Value(Ort::Value::CreateTensor(
+                *memoryInfo, inputTensor.Data(), inputTensor.Size(), inputShape.data(), inputShape.size(),
+                inputElementType)));
+
+            // Salida estática: buffer propio que ONNX Runtime rellena en cada Run
+            bool staticOutput = !declaredOutputShape.empty() &&
+                std::all_of(declaredOutputShape.begin(), declaredOutputShape.end(),
+                            [](int64_t d) { return d > 0; });
+            if (staticOutput) {
+                size_t count = 1;
+                for (int64_t d : declaredOutputShape) count *= static_cast<size_t>(d);
+                outputTensor.assign(count, 0.0f);
+                outputValue.reset(new Ort::Value(Ort::Value::CreateTensor<float>(
+                    *memoryInfo, outputTensor.data(), outputTensor.size(),
+                    declaredOutputShape.data(), declaredOutputShape.size())));
+            }
+            return true;
+        } catch (const std::exception& e) {
+            error = e.what();
+            session.reset();
+            return false;
+        }
+    }
+
+    bool IsLoaded() const { return session != nullptr; }
+    int InputWidth() const { return static_cast<int>(inputShape[3]); }
+    int InputHeight() const { return static_cast<int>(inputShape[2]); }
+    const std::vector<int64_t>& DeclaredOutputShape() const { return declaredOutputShape; }
+
+    // Entrada uint8: el tensor lleva el frame en [0, 255] en lugar de [0, 1]
+    bool QuantizedInput() const { return inputElementType == ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8; }
+
+    // Tensor [1, 3, H, W] que el preprocesado rellena antes de Run() (T según QuantizedInput())
+    template <typename T>
+    T* Input() { return reinterpret_cast<T*>(inputTensor.Data()); }
+
+    /**
+     * Ejecuta el modelo sobre Input(). output apunta a la salida y
+     * outputShape recibe su forma; válidos hasta la siguiente llamada.
+     */
+    bool Run(const float*& output, std::vector<int64_t>& outputShape, std::string& error) {
+        const char* inputNames[] = {inputName.c_str()};
+        const char* outputNames[] = {outputName.c_str()};
+        try {
+            if (outputValue) {
+                session->Run(runOptions, inputNames, inputValue.get(), 1, outputNames, outputValue.get(), 1);
+                output = outputTensor.data();
+                outputShape = declaredOutputShape;
+                return true;
+            }
+            dynamicOutputs = session->Run(runOptions, inputNames, inputValue.get(), 1, outputNames, 1);
+            output = dynamicOutputs[0].GetTensorData<float>();
+            outputShape = dynamicOutputs[0].GetTensorTypeAndShapeInfo().GetShape();
+            return true;
+        } catch (const std::exception& e) {
+            error = e.what();
+            return false;
+        }
+    }
+
+private:
+    Ort::Env env;
+    Ort::RunOptions runOptions{nullptr};
+    std::unique_ptr<Ort::Session> session;
+    std::unique_ptr<Ort::MemoryInfo> memoryInfo;
+    std::string inputName;
+    std::string outputName;
+    std::vector<int64_t> inputShape;
+    std::vector<int64_t> declaredOutputShape;
+    ONNXTensorElementDataType inputElementType = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+    AlignedBuffer<uint8_t> inputTensor;
+    std::vector<float> outputTensor;
+    std::unique_ptr<Ort::Value> inputValue;
+    std::unique_ptr<Ort::Value> outputValue;
+    std::vector<Ort::Value> dynamicOutputs;
+};
+
+}  // namespace visifruit
@@ -0,0 +1,1068 @@
+/**
+ * VisiFruit - Servidor de Inferencia Nativo (ONNX Runtime CPU)
+ * =============================================================
+ *
+ * Sustituto nativo de ai_inference_server.py para equipos sin GPU (Raspberry
+ * Pi 5): mismo contrato HTTP y mismo esquema InferenceResponse, pero sin
+ * FastAPI, PyTorch ni Ultralytics en el proceso.
+ *
+ *   GET  /         Identificación del servicio
+ *   GET  /health   HealthResponse (sondas del launcher)
+ *   POST /infer    multipart: image (JPEG), imgsz, conf, iou, max_det,
+ *                  class_names_json, use_cache. La entrada del modelo ONNX
+ *                  es fija: imgsz, si se envía, debe coincidir con ella
+ *                  (422 si no; reexportar con ese --imgsz)
+ *   POST /infer_shm  ring, slot, seq (anillo de utils/shared_frame_ring.py),
+ *                  pixel_format opcional (bgr, rgb, gray, i420, nv12) y el
+ *                  resto de campos de /infer; solo clientes locales. El
+ *                  frame se preprocesa directamente desde el slot.
+ *   GET  /stats    Estadísticas (token si AUTH_ENABLED), con p50/p99
+ *   GET  /perf     Rendimiento sin autenticación
+ *
+ * /stream no existe aquí (404): el streaming sigue en el servidor Python.
+ *
+ * Modelos: exportar con IA_Etiquetado/IATraining/Export_Onnx.py, que deja
+ * junto al .onnx un <modelo>.onnx.json con tipo, tamaño de entrada y clases.
+ * Sin ese archivo ni MODEL_TYPE el tipo se deduce de la forma de la salida,
+ * salvo [1, K, 6] (YOLOv8 con NMS o RT-DETR de 2 clases), que no arranca.
+ * MODEL_PRECISION=int8 carga en su lugar <modelo>.int8.onnx, generado por
+ * IA_Etiquetado/IATraining/Quantize_Onnx.py (calibración e informe de
+ * precisión/latencia frente a FP32).
+ *
+ * Configuración: las mismas variables de entorno que el servidor Python
+ * (también desde .env): MODEL_PATH, MODEL_TYPE, MODEL_PRECISION, SERVER_HOST, SERVER_PORT,
+ * AUTH_ENABLED, AUTH_TOKENS, MAX_IMAGE_SIZE, LOG_EVERY_N_FRAMES,
+ * ENABLE_SHARED_MEMORY, MAX_SHARED_RINGS, más NUM_THREADS y MAX_CONNECTIONS. Los argumentos tienen prioridad:
+ *
+ *   visifruit_inference_server --model weights/best.onnx [--type yolov8|rtdetr] [--precision fp32|int8]
+ *                              [--port 9000] [--host 0.0.0.0] [--threads 4] [--imgsz 640]
+ *
+ * Compilar con compile_cpp_inference_server.sh
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#include "visifruit_launcher_probe.h"
+#include "visifruit_launcher_json.h"
+#include "visifruit_launcher_metrics.h"
+#include "visifruit_inference_http.h"
+#include "visifruit_inference_jpeg.h"
+#include "visifruit_inference_model.h"
+#include "visifruit_inference_ort.h"
+#include "visifruit_inference_shm.h"
+
+#ifdef _WIN32
+#  include <psapi.h>
+#else
+#  include <arpa/inet.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using visifruit::SteadyClock;
+
+std::atomic<bool> g_stop{false};
+
+void OnSignal(int) {
+    g_stop = true;
+}
+
+// ==================== REGISTRO ====================
+
+void Log(const char* level, const char* format, ...) {
+    char message[1024];
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    char stamp[16];
+    std::strftime(stamp, sizeof(stamp), "%H:%M:%S", &local);
+    std::printf("%s - %s - visifruit_inference_server - %s\n", stamp, level, message);
+    std::fflush(stdout);
+}
+
+// Fecha local en formato datetime.isoformat() de Python
+std::string IsoTimestamp() {
+    auto now = std::chrono::system_clock::now();
+    std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    long micros = static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(
+        now.time_since_epoch()).count() % 1000000);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    char buffer[40];
+    size_t len = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &local);
+    std::snprintf(buffer + len, sizeof(buffer) - len, ".%06ld", micros);
+    return buffer;
+}
+
+double UnixSeconds() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+double ElapsedMs(SteadyClock::time_point since) {
+    return std::chrono::duration<double, std::milli>(SteadyClock::now() - since).count();
+}
+
+// ==================== CONFIGURACIÓN ====================
+
+// Carga KEY=VALUE de .env sin pisar variables ya definidas (como load_dotenv)
+void LoadDotEnv(const char* path) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#') continue;
+        size_t equals = line.find('=', start);
+        if (equals == std::string::npos) continue;
+        std::string key = line.substr(start, equals - start);
+        std::string value = line.substr(equals + 1);
+        while (!key.empty() && (key.back() == ' ' || key.back() == '\t')) key.pop_back();
+        if (key.compare(0, 7, "export ") == 0) key = key.substr(7);
+        if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front()) {
+            value = value.substr(1, value.size() - 2);
+        }
+        if (std::getenv(key.c_str())) continue;
+#ifdef _WIN32
+        _putenv_s(key.c_str(), value.c_str());
+#else
+        setenv(key.c_str(), value.c_str(), 0);
+#endif
+    }
+}
+
+std::string EnvOr(const char* name, const std::string& fallback) {
+    const char* value = std::getenv(name);
+    return (value && *value) ? std::string(value) : fallback;
+}
+
+int EnvInt(const char* name, int fallback) {
+    const char* value = std::getenv(name);
+    return (value && *value) ? std::atoi(value) : fallback;
+}
+
+bool EnvBool(const char* name, bool fallback) {
+    const char* value = std::getenv(name);
+    if (!value || !*value) return fallback;
+    return visifruit::detail::ToLower(value) == "true";
+}
+
+struct ServerConfig {
+    std::string modelPath;
+    std::string modelType;
+    std::string precision;
+    std::string host;
+    int port = 9000;
+    int threads = 4;
+    int inputSize = 640;
+    int maxImageSize = 1920;
+    int maxConnections = 64;
+    int logEveryNFrames = 30;
+    int maxSharedRings = 4;
+    size_t maxBodyBytes = 16 * 1024 * 1024;
+    bool sharedMemoryEnabled = true;
+    bool authEnabled = true;
+    std::vector<std::string> authTokens;
+
+    void Load(int argc, char** argv) {
+        LoadDotEnv(".env");
+
+        // MODEL_PATH del servidor Python apunta al .pt: se usa el .onnx exportado al lado
+        modelPath = EnvOr("MODEL_PATH", "weights/best.onnx");
+        size_t dot = modelPath.find_last_of('.');
+        if (dot != std::string::npos && modelPath.substr(dot) == ".pt") modelPath = modelPath.substr(0, dot) + ".onnx";
+        modelType = visifruit::detail::ToLower(EnvOr("MODEL_TYPE", ""));
+        precision = visifruit::detail::ToLower(EnvOr("MODEL_PRECISION", "fp32"));
+        host = EnvOr("SERVER_HOST", "0.0.0.0");
+        port = EnvInt("SERVER_PORT", port);
+        unsigned cores = std::thread::hardware_concurrency();
+        threads = EnvInt("NUM_THREADS", cores > 0 ? static_cast<int>(cores) : threads);
+        maxImageSize = EnvInt("MAX_IMAGE_SIZE", maxImageSize);
+        maxConnections = EnvInt("MAX_CONNECTIONS", maxConnections);
+        logEveryNFrames = EnvInt("LOG_EVERY_N_FRAMES", logEveryNFrames);
+        sharedMemoryEnabled = EnvBool("ENABLE_SHARED_MEMORY", true);
+        maxSharedRings = EnvInt("MAX_SHARED_RINGS", maxSharedRings);
+
+        authEnabled = EnvBool("AUTH_ENABLED", true);
+        std::stringstream tokens(EnvOr("AUTH_TOKENS", ""));
+        std::string token;
+        while (std::getline(tokens, token, ',')) {
+            size_t a = token.find_first_not_of(" \t");
+            size_t b = token.find_last_not_of(" \t");
+            if (a != std::string::npos) authTokens.push_back(token.substr(a, b - a + 1));
+        }
+        if (authEnabled && authTokens.empty()) {
+            Log("WARNING", "⚠️ AUTH_TOKENS no configurado. Autenticación deshabilitada temporalmente.");
+            authEnabled = false;
+        }
+
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string flag = argv[i];
+            std::string value = argv[i + 1];
+            if (flag == "--model") modelPath = value;
+            else if (flag == "--type") modelType = visifruit::detail::ToLower(value);
+            else if (flag == "--port") port = std::atoi(value.c_str());
+            else if (flag == "--host") host = value;
+            else if (flag == "--threads") threads = std::atoi(value.c_str());
+            else if (flag == "--imgsz") inputSize = std::atoi(value.c_str());
+            else if (flag == "--precision") precision = visifruit::detail::ToLower(value);
+        }
+
+        // El modelo INT8 de Quantize_Onnx.py vive junto al FP32: best.onnx -> best.int8.onnx
+        if (precision == "int8") {
+            const std::string suffix = ".onnx";
+            const std::string quantizedSuffix = ".int8.onnx";
+            bool quantized = modelPath.size() >= quantizedSuffix.size() &&
+                             modelPath.compare(modelPath.size() - quantizedSuffix.size(), quantizedSuffix.size(),
+                                               quantizedSuffix) == 0;
+            bool onnx = modelPath.size() >= suffix.size() &&
+                        modelPath.compare(modelPath.size() - suffix.size(), suffix.size(), suffix) == 0;
+            if (onnx && !quantized) modelPath = modelPath.substr(0, modelPath.size() - suffix.size()) + quantizedSuffix;
+        } else if (precision != "fp32") {
+            Log("WARNING", "⚠️ MODEL_PRECISION '%s' no válido. Usando fp32.", precision.c_str());
+            precision = "fp32";
+        }
+    }
+};
+
+// ==================== MÉTRICAS DEL SISTEMA ====================
+
+/**
+ * CPU y memoria del sistema para /health sin bloquear la petición (el
+ * servidor Python espera 100 ms en psutil.cpu_percent): el porcentaje de
+ * CPU es el del intervalo desde la consulta anterior.
+ */
+class SystemMonitor {
+public:
+    SystemMonitor() { Sample(lastBusy, lastTotal); }
+
+    double CpuPercent() {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t busy = 0, total = 0;
+        if (!Sample(busy, total) || total <= lastTotal) return lastPercent;
+        lastPercent = 100.0 * static_cast<double>(busy - lastBusy) / static_cast<double>(total - lastTotal);
+        lastBusy = busy;
+        lastTotal = total;
+        return lastPercent;
+    }
+
+    static double MemoryPercent() {
+#ifdef _WIN32
+        MEMORYSTATUSEX status;
+        status.dwLength = sizeof(status);
+        return GlobalMemoryStatusEx(&status) ? static_cast<double>(status.dwMemoryLoad) : 0.0;
+#else
+        std::ifstream meminfo("/proc/meminfo");
+        std::string key;
+        double value = 0.0, total = 0.0, available = 0.0;
+        std::string unit;
+        while (meminfo >> key >> value >> unit) {
+            if (key == "MemTotal:") total = value;
+            else if (key == "MemAvailable:") available = value;
+        }
+        return total > 0.0 ? 100.0 * (total - available) / total : 0.0;
+#endif
+    }
+
+    // Memoria residente del propio proceso (MB)
+    static double ResidentMb() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0.0;
+        return static_cast<double>(counters.WorkingSetSize) / (1024.0 * 1024.0);
+#else
+        std::ifstream statm("/proc/self/statm");
+        long pages = 0, resident = 0;
+        statm >> pages >> resident;
+        return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+#endif
+    }
+
+private:
+    std::mutex mutex;
+    uint64_t lastBusy = 0, lastTotal = 0;
+    double lastPercent = 0.0;
+
+    static bool Sample(uint64_t& busy, uint64_t& total) {
+#ifdef _WIN32
+        FILETIME idle, kernel, user;
+        if (!GetSystemTimes(&idle, &kernel, &user)) return false;
+        auto value = [](const FILETIME& t) {
+            return (static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime;
+        };
+        total = value(kernel) + value(user);      // kernel incluye idle
+        busy = total - value(idle);
+        return true;
+#else
+        std::ifstream stat("/proc/stat");
+        std::string cpu;
+        uint64_t user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+        if (!(stat >> cpu >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal)) return false;
+        total = user + nice + system + idle + iowait + irq + softirq + steal;
+        busy = total - idle - iowait;
+        return true;
+#endif
+    }
+};
+
+// ==================== MOTOR DE INFERENCIA ====================
+
+struct InferParams {
+    int imgsz = 640;
+    double conf = 0.2;
+    double iou = 0.45;
+    int maxDet = 100;
+    std::vector<std::string> classNames;
+};
+
+struct InferResult {
+    std::vector<visifruit::Detection> detections;
+    double preMs = 0.0;
+    double inferenceMs = 0.0;
+    double postMs = 0.0;
+    bool stale = false;             // El origen cambió durante el preprocesado (slot reutilizado)
+};
+
+class InferenceEngine {
+public:
+    bool Load(const ServerConfig& config, std::string& error) {
+        // Metadatos del export (tipo de modelo, tamaño de entrada y clases)
+        visifruit::JsonValue metadata;
+        std::string metadataPath = config.modelPath + ".json";
+        std::string metadataType;
+        int inputSize = config.inputSize;
+        if (visifruit::JsonParser::ParseFile(metadataPath, metadata) && metadata.IsObject()) {
+            metadataType = visifruit::detail::ToLower(metadata.StringOr("model_type", ""));
+            int8Model = visifruit::detail::ToLower(metadata.StringOr("precision", "fp32")) == "int8";
+            inputSize = static_cast<int>(metadata.NumberOr("imgsz", inputSize));
+            if (const visifruit::JsonValue* classes = metadata.Get("classes")) {
+                for (const auto& item : classes->items) {
+                    if (item.type == visifruit::JsonValue::Type::String) classNames.push_back(item.text);
+                }
+            }
+        }
+        if (classNames.empty()) classNames = {"apple", "pear", "lemon"};
+
+        if (!detector.Load(config.modelPath, config.threads, inputSize, error)) return false;
+
+        std::string type = !config.modelType.empty() ? config.modelType : metadataType;
+        const std::vector<int64_t>& outputShape = detector.DeclaredOutputShape();
+        if (type.empty() || !visifruit::ParseModelLayout(type, layout)) {
+            if (!visifruit::GuessModelLayout(outputShape, layout)) {
+                error = "salida [1, " + std::to_string(outputShape[1]) +
+                        ", 6] ambigua (YOLOv8 con NMS o RT-DETR de 2 clases): "
+                        "defina MODEL_TYPE o " + metadataPath;
+                return false;
+            }
+        }
+        // Un YOLOv8 exportado con nms=True tiene salida [1, K, 6]
+        if (layout == visifruit::ModelLayout::Yolov8 && visifruit::HasNmsOutput(outputShape)) {
+            layout = visifruit::ModelLayout::Yolov8Nms;
+        }
+        return true;
+    }
+
+    int InputWidth() const { return detector.InputWidth(); }
+    int InputHeight() const { return detector.InputHeight(); }
+    bool Stretch() const { return layout == visifruit::ModelLayout::Rtdetr; }
+    const std::vector<std::string>& ClassNames() const { return classNames; }
+
+    const char* InputTypeName() const { return detector.QuantizedInput() ? "UINT8" : "FP32"; }
+    const char* PrecisionName() const { return int8Model ? "INT8" : "FP32"; }
+
+    const char* LayoutName() const {
+        switch (layout) {
+            case visifruit::ModelLayout::Rtdetr: return "RT-DETR";
+            case visifruit::ModelLayout::Yolov8Nms: return "YOLOv8 (NMS integrado)";
+            default: return "YOLOv8";
+        }
+    }
+
+    /**
+     * Inferencia sobre un frame (JPEG decodificado o slot de memoria
+     * compartida). width/height son el tamaño lógico (el de las cajas de la
+     * respuesta); el frame puede estar reducido respecto a él. sourceValid,
+     * si se indica, se comprueba tras el preprocesado: el tensor ya es una
+     * copia propia y el origen puede reutilizarse. Una sola inferencia a la
+     * vez: todos los núcleos trabajan en el mismo frame.
+     */
+    bool Infer(const visifruit::PixelSource& source, int width, int height, bool swapChannels,
+               const InferParams& params, InferResult& result, std::string& error,
+               const std::function<bool()>& sourceValid = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto preStart = SteadyClock::now();
+        if (!geometry.Matches(width, height, source.width, source.height,
+                              detector.InputWidth(), detector.InputHeight(), Stretch())) {
+            geometry.Build(width, height, source.width, source.height,
+                           detector.InputWidth(), detector.InputHeight(), Stretch());
+        }
+        if (detector.QuantizedInput()) {
+            visifruit::LetterboxToTensor(source, geometry, swapChannels, detector.Input<uint8_t>(), scratch);
+        } else {
+            visifruit::LetterboxToTensor(source, geometry, swapChannels, detector.Input<float>(), scratch);
+        }
+        result.preMs = ElapsedMs(preStart);
+        if (sourceValid && !sourceValid()) {
+            result.stale = true;
+            error = "origen sobrescrito durante el preprocesado";
+            return false;
+        }
+
+        auto inferenceStart = SteadyClock::now();
+        const float* output = nullptr;
+        if (!detector.Run(output, outputShape, error)) return false;
+        result.inferenceMs = ElapsedMs(inferenceStart);
+
+        auto postStart = SteadyClock::now();
+        visifruit::DecodeParams decode;
+        decode.conf = static_cast<float>(params.conf);
+        decode.iou = static_cast<float>(params.iou);
+        decode.maxDet = static_cast<size_t>(params.maxDet);
+        if (outputShape.size() != 3) {
+            error = "salida del modelo con forma inesperada";
+            return false;
+        }
+        switch (layout) {
+            case visifruit::ModelLayout::Yolov8:
+                visifruit::DecodeYolov8(output, outputShape[1], outputShape[2], geometry, decode,
+                                        bestScore, bestClass, result.detections);
+                break;
+            case visifruit::ModelLayout::Yolov8Nms:
+                visifruit::DecodeYolov8Nms(output, outputShape[1], geometry, decode, result.detections);
+                break;
+            case visifruit::ModelLayout::Rtdetr:
+                visifruit::DecodeRtdetr(output, outputShape[1], outputShape[2], geometry, decode,
+                                        result.detections);
+                break;
+        }
+        result.postMs = ElapsedMs(postStart);
+        return true;
+    }
+
+    // Tres inferencias sobre un frame gris, como el warmup del servidor Python
+    void Warmup() {
+        std::vector<uint8_t> pixels(static_cast<size_t>(detector.InputWidth()) * detector.InputHeight() * 3, 114);
+        visifruit::PixelSource dummy;
+        dummy.data = pixels.data();
+        dummy.width = detector.InputWidth();
+        dummy.height = detector.InputHeight();
+        dummy.stride = static_cast<size_t>(dummy.width) * 3;
+        InferParams params;
+        for (int i = 0; i < 3; ++i) {
+            InferResult result;
+            std::string error;
+            auto start = SteadyClock::now();
+            Infer(dummy, dummy.width, dummy.height, false, params, result, error);
+            Log("INFO", "   Warmup %d/3: %.1fms", i + 1, ElapsedMs(start));
+        }
+    }
+
+private:
+    visifruit::OrtDetector detector;
+    visifruit::ModelLayout layout = visifruit::ModelLayout::Yolov8;
+    bool int8Model = false;         // Metadatos de Quantize_Onnx.py ("precision": "int8")
+    std::vector<std::string> classNames;
+
+    std::mutex mutex;
+    visifruit::LetterboxGeometry geometry;
+    visifruit::PreprocessScratch scratch;
+    std::vector<int64_t> outputShape;
+    std::vector<float> bestScore;
+    std::vector<int32_t> bestClass;
+};
+
+// ==================== SERVIDOR ====================
+
+class InferenceHttpServer {
+public:
+    InferenceHttpServer(const ServerConfig& serverConfig, InferenceEngine& inferenceEngine)
+        : config(serverConfig), engine(inferenceEngine), sharedRings(static_cast<size_t>(serverConfig.maxSharedRings)),
+          latency("infer", visifruit::SloConfig()), startupTime(UnixSeconds()),
+          startupSteady(SteadyClock::now()) {}
+
+    bool Listen() {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener == visifruit::kInvalidSocket) return false;
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(config.port));
+        if (inet_pton(AF_INET, config.host.c_str(), &addr.sin_addr) != 1) addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, 128) != 0) {
+            visifruit::detail::CloseSocket(listener);
+            listener = visifruit::kInvalidSocket;
+            return false;
+        }
+        return true;
+    }
+
+    void Run() {
+        while (!g_stop) {
+            // Despertar periódicamente para atender la señal de parada
+            auto deadline = SteadyClock::now() + std::chrono::milliseconds(200);
+            if (!visifruit::detail::WaitFor(listener, false, deadline)) continue;
+            sockaddr_in peer{};
+            socklen_t peerLength = sizeof(peer);
+            visifruit::socket_t client = accept(listener, reinterpret_cast<sockaddr*>(&peer), &peerLength);
+            if (client == visifruit::kInvalidSocket) continue;
+            // /infer_shm solo para clientes en la misma máquina (127.0.0.0/8)
+            bool local = peer.sin_family == AF_INET && (ntohl(peer.sin_addr.s_addr) >> 24) == 127;
+
+            visifruit::detail::SetNonBlocking(client);
+            int one = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+
+            if (activeConnections.load() >= config.maxConnections) {
+                Send(client, 503, visifruit::JsonDetail("Demasiadas conexiones"), false);
+                visifruit::detail::CloseSocket(client);
+                continue;
+            }
+            ReapConnections(false);
+            activeConnections++;
+            auto done = std::make_shared<std::atomic<bool>>(false);
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            connections.push_back({std::thread([this, client, local, done] {
+                ServeConnection(client, local);
+                activeConnections--;
+                *done = true;
+            }), client, done});
+        }
+
+        visifruit::detail::CloseSocket(listener);
+        listener = visifruit::kInvalidSocket;
+        // Las conexiones salen en su siguiente espera; shutdown() despierta las que
+        // están enviando. Se esperan todas: usan el motor, que muere al volver de Run()
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            for (const Connection& connection : connections) {
+                if (!*connection.done) ShutdownSocket(connection.socket);
+            }
+        }
+        ReapConnections(true);
+    }
+
+private:
+    static constexpr int kKeepAliveS = 75;          // timeout_keep_alive de uvicorn
+    static constexpr int kRequestTimeoutMs = 10000;
+    static constexpr int kIdleSliceMs = 250;
+
+    const ServerConfig& config;
+    InferenceEngine& engine;
+    visifruit::socket_t listener = visifruit::kInvalidSocket;
+    std::atomic<int> activeConnections{0};
+
+    // Hilo por conexión; el socket lo cierra quien hace join (nunca se reutiliza el
+    // descriptor mientras el hilo puede usarlo o recibir shutdown())
+    struct Connection {
+        std::thread thread;
+        visifruit::socket_t socket;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+    std::mutex connectionsMutex;
+    std::vector<Connection> connections;
+    visifruit::SharedFrameRingRegistry sharedRings;
+
+    std::mutex statsMutex;
+    uint64_t requestsTotal = 0;
+    uint64_t requestsSuccess = 0;
+    uint64_t requestsFailed = 0;
+    uint64_t detectionsCount = 0;
+    double totalInferenceMs = 0.0;
+    visifruit::ServiceLatencyTracker latency;
+    double startupTime;
+    SteadyClock::time_point startupSteady;
+    SystemMonitor systemMonitor;
+
+    // Une los hilos terminados (o todos, en la parada) y cierra sus sockets
+    void ReapConnections(bool all) {
+        std::vector<Connection> finished;
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            for (auto it = connections.begin(); it != connections.end();) {
+                if (all || *it->done) {
+                    finished.push_back(std::move(*it));
+                    it = connections.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for (Connection& connection : finished) {
+            connection.thread.join();
+            visifruit::detail::CloseSocket(connection.socket);
+        }
+    }
+
+    static void ShutdownSocket(visifruit::socket_t sock) {
+#ifdef _WIN32
+        shutdown(sock, SD_BOTH);
+#else
+        shutdown(sock, SHUT_RDWR);
+#endif
+    }
+
+    static void Send(visifruit::socket_t client, int status, const std::string& body, bool keepAlive,
+                     const char* contentType = "application/json") {
+        std::string response = visifruit::BuildHttpResponse(status, contentType, body, keepAlive);
+        auto deadline = SteadyClock::now() + std::chrono::seconds(10);
+        visifruit::detail::SendAll(client, response.data(), response.size(), deadline);
+    }
+
+    void ServeConnection(visifruit::socket_t client, bool local) {
+        std::string pending;
+        std::vector<char> scratch(64 * 1024);
+        visifruit::HttpRequest request;
+        visifruit::DecodedImage image;          // Buffer de decodificación reutilizado por conexión
+        std::vector<visifruit::FormField> fields;
+        auto idleSince = SteadyClock::now();
+
+        while (!g_stop) {
+            auto slice = SteadyClock::now() + std::chrono::milliseconds(kIdleSliceMs);
+            visifruit::ReadStatus status = visifruit::ReadHttpRequest(
+                client, pending, scratch, slice, kRequestTimeoutMs, config.maxBodyBytes, request);
+
+            if (status == visifruit::ReadStatus::Idle) {
+                if (SteadyClock::now() - idleSince > std::chrono::seconds(kKeepAliveS)) return;
+                continue;
+            }
+            if (status == visifruit::ReadStatus::Closed) return;
+            if (status == visifruit::ReadStatus::Timeout) {
+                Send(client, 408, visifruit::JsonDetail("Petición incompleta"), false);
+                return;
+            }
+            if (status == visifruit::ReadStatus::TooLarge) {
+                Send(client, 413, visifruit::JsonDetail("Petición demasiado grande"), false);
+                return;
+            }
+            if (status == visifruit::ReadStatus::BadRequest) {
+                Send(client, 400, visifruit::JsonDetail("Petición HTTP inválida"), false);
+                return;
+            }
+
+            int code = 200;
+            std::string body = Route(request, image, fields, local, code);
+            Send(client, code, body, request.keepAlive);
+            if (!request.keepAlive) return;
+            idleSince = SteadyClock::now();
+        }
+    }
+
+    std::string Route(const visifruit::HttpRequest& request, visifruit::DecodedImage& image,
+                      std::vector<visifruit::FormField>& fields, bool local, int& code) {
+        const std::string& path = request.path;
+        bool get = request.method == "GET";
+
+        if (path == "/" && get) {
+            return "{\"service\":\"VisiFruit AI Inference Server\",\"version\":\"2.0\","
+                   "\"status\":\"running\",\"backend\":\"onnxruntime-native\"}";
+        }
+        if (path == "/health" && get) return Health();
+        if (path == "/perf" && get) return Perf();
+        if (path == "/stats" && get) {
+            if (!Authorized(request, code)) return Denied(code);
+            return Stats();
+        }
+        if (path == "/infer" || path == "/infer_shm") {
+            if (request.method != "POST") {
+                code = 405;
+                return visifruit::JsonDetail("Method Not Allowed");
+            }
+            if (!Authorized(request, code)) return Denied(code);
+            return Infer(request, image, fields, path == "/infer_shm", local, code);
+        }
+        code = 404;
+        return visifruit::JsonDetail("Not Found");
+    }
+
+    bool Authorized(const visifruit::HttpRequest& request, int& code) {
+        if (!config.authEnabled) return true;
+        const std::string* header = request.Header("authorization");
+        if (!header || visifruit::detail::ToLower(header->substr(0, 7)) != "bearer ") {
+            code = 403;
+            return false;
+        }
+        std::string token = header->substr(7);
+        for (const auto& allowed : config.authTokens) {
+            if (token == allowed) return true;
+        }
+        code = 401;
+        return false;
+    }
+
+    static std::string Denied(int& code) {
+        // Mismos mensajes que HTTPBearer / verify_token (ambos con 403)
+        std::string detail = (code == 401) ? "Token inválido" : "Not authenticated";
+        code = 403;
+        return visifruit::JsonDetail(detail);
+    }
+
+    static bool ParseClassNames(const std::string& text, std::vector<std::string>& names) {
+        visifruit::JsonValue value;
+        if (!visifruit::JsonParser::Parse(text, value) || !value.IsArray()) return false;
+        names.clear();
+        for (const auto& item : value.items) {
+            if (item.type != visifruit::JsonValue::Type::String) return false;
+            names.push_back(item.text);
+        }
+        return true;
+    }
+
+    std::string Infer(const visifruit::HttpRequest& request, visifruit::DecodedImage& image,
+                      std::vector<visifruit::FormField>& fields, bool sharedMemory, bool local, int& code) {
+        auto start = SteadyClock::now();
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            requestsTotal++;
+        }
+        auto fail = [&](int status, const std::string& detail) {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            requestsFailed++;
+            code = status;
+            return visifruit::JsonDetail(detail);
+        };
+
+        // Formulario multipart (clientes) o urlencoded
+        const std::string* contentType = request.Header("content-type");
+        std::string type = contentType ? visifruit::detail::ToLower(*contentType) : std::string();
+        if (type.compare(0, 19, "multipart/form-data") == 0) {
+            if (!visifruit::ParseMultipart(request.body, visifruit::HeaderParameter(*contentType, "boundary"), fields)) {
+                return fail(400, "Formulario multipart inválido");
+            }
+        } else if (type.compare(0, 33, "application/x-www-form-urlencoded") == 0) {
+            visifruit::ParseUrlEncoded(request.body, fields);
+        } else {
+            return fail(422, "Se esperaba multipart/form-data");
+        }
+
+        if (sharedMemory) {
+            if (!config.sharedMemoryEnabled) return fail(404, "Memoria compartida deshabilitada");
+            if (!local) return fail(403, "Memoria compartida solo para clientes locales");
+        }
+
+        InferParams params;
+        auto number = [&](const char* name, double fallback) {
+            const visifruit::FormField* field = visifruit::FindField(fields, name);
+            return field ? std::atof(field->Text().c_str()) : fallback;
+        };
+        int modelSize = std::max(engine.InputWidth(), engine.InputHeight());
+        params.imgsz = static_cast<int>(number("imgsz", modelSize));
+        params.conf = number("conf", 0.2);
+        params.iou = number("iou", 0.45);
+        params.maxDet = static_cast<int>(number("max_det", 100));
+        if (params.imgsz < 320 || params.imgsz > 1280 || params.conf < 0.0 || params.conf > 1.0 ||
+            params.iou < 0.0 || params.iou > 1.0 || params.maxDet < 1 || params.maxDet > 300) {
+            return fail(422, "Parámetros fuera de rango");
+        }
+        if (params.imgsz != modelSize) {
+            return fail(422, "imgsz " + std::to_string(params.imgsz) + " no coincide con la entrada del modelo (" +
+                             std::to_string(modelSize) + ")");
+        }
+        params.classNames = engine.ClassNames();
+        if (const visifruit::FormField* names = visifruit::FindField(fields, "class_names_json")) {
+            std::vector<std::string> parsed;
+            if (ParseClassNames(names->Text(), parsed)) params.classNames = parsed;
+        }
+
+        // Obtención del frame (fuera del lock del modelo: se solapa con otra inferencia)
+        auto decodeStart = SteadyClock::now();
+        std::string error;
+        visifruit::PixelSource source;
+        int width = 0, height = 0;
+        std::shared_ptr<visifruit::SharedFrameRing> ring;
+        uint32_t slot = 0;
+        uint64_t seq = 0;
+        if (sharedMemory) {
+            // Vista directa del slot: el preprocesado lee el frame sin copiarlo
+            const visifruit::FormField* ringField = visifruit::FindField(fields, "ring");
+            const visifruit::FormField* slotField = visifruit::FindField(fields, "slot");
+            const visifruit::FormField* seqField = visifruit::FindField(fields, "seq");
+            if (!ringField || !slotField || !seqField) return fail(422, "Faltan los campos ring, slot y seq");
+            slot = static_cast<uint32_t>(std::strtoul(slotField->Text().c_str(), nullptr, 10));
+            seq = static_cast<uint64_t>(std::strtoull(seqField->Text().c_str(), nullptr, 10));
+
+            bool attached = false;
+            ring = sharedRings.Get(ringField->Text(), error, attached);
+            if (!ring) return fail(400, "Anillo no disponible: " + error);
+            if (attached) Log("INFO", "🧠 Cliente local conectado por memoria compartida: %s", ringField->Text().c_str());
+
+            visifruit::SharedFrame frame;
+            if (!ring->Read(slot, seq, frame)) return fail(409, "Slot sobrescrito o inválido");
+            const visifruit::FormField* formatField = visifruit::FindField(fields, "pixel_format");
+            if (!SharedFrameSource(frame, formatField ? visifruit::detail::ToLower(formatField->Text()) : "",
+                                   source)) {
+                return fail(422, "Formato de píxel incompatible con el frame");
+            }
+            width = source.width;
+            height = source.height;
+        } else {
+            const visifruit::FormField* imageField = visifruit::FindField(fields, "image");
+            if (!imageField || imageField->size == 0) return fail(422, "Falta el campo image");
+            if (!visifruit::DecodeJpeg(reinterpret_cast<const uint8_t*>(imageField->data), imageField->size,
+                                       engine.InputWidth(), engine.InputHeight(), engine.Stretch(), image, error)) {
+                return fail(400, "Imagen inválida");
+            }
+            source.data = image.pixels.data();
+            source.stride = static_cast<size_t>(image.width) * 3;
+            source.width = image.width;
+            source.height = image.height;
+            source.format = visifruit::PixelFormat::Rgb;
+            width = image.sourceWidth;
+            height = image.sourceHeight;
+        }
+
+        // Tamaño lógico: el servidor Python reduce a MAX_IMAGE_SIZE antes de inferir
+        int longest = std::max(width, height);
+        if (config.maxImageSize > 0 && longest > config.maxImageSize) {
+            double scale = static_cast<double>(config.maxImageSize) / longest;
+            width = static_cast<int>(width * scale);
+            height = static_cast<int>(height * scale);
+        }
+        bool swap = visifruit::NeedsChannelSwap(source);
+        double decodeMs = ElapsedMs(decodeStart);
+
+        InferResult result;
+        std::function<bool()> sourceValid;
+        if (ring) sourceValid = [&] { return ring->IsValid(slot, seq); };
+        if (!engine.Infer(source, width, height, swap, params, result, error, sourceValid)) {
+            if (result.stale) return fail(409, "Slot sobrescrito durante la inferencia");
+            Log("ERROR", "❌ Error en inferencia: %s", error.c_str());
+            return fail(500, error);
+        }
+
+        std::string body = BuildInferenceResponse(result, params, decodeMs + result.preMs, ElapsedMs(start));
+        double totalMs = ElapsedMs(start);
+        latency.Record(totalMs, true);
+
+        uint64_t frames;
+        double fps, avgLatency;
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            requestsSuccess++;
+            totalInferenceMs += result.inferenceMs;
+            detectionsCount += result.detections.size();
+            frames = requestsSuccess;
+            double elapsed = std::chrono::duration<double>(SteadyClock::now() - startupSteady).count();
+            fps = elapsed > 0.0 ? static_cast<double>(frames) / elapsed : 0.0;
+            avgLatency = totalInferenceMs / static_cast<double>(requestsSuccess);
+        }
+        if (config.logEveryNFrames > 0 && frames % static_cast<uint64_t>(config.logEveryNFrames) == 0) {
+            Log("INFO", "📊 FPS: %.1f | Latencia: %.1fms | Frames: %llu | Detecciones: %llu",
+                fps, avgLatency, static_cast<unsigned long long>(frames),
+                static_cast<unsigned long long>(detectionsCount));
+        }
+        return body;
+    }
+
+    /**
+     * Origen del preprocesado para un slot del anillo. Sin pixel_format, 3
+     * canales son BGR (frames de OpenCV) y 1 canal es gris; en YUV 4:2:0
+     * el slot tiene forma (alto * 3/2, ancho) con un canal.
+     */
+    static bool SharedFrameSource(const visifruit::SharedFrame& frame, const std::string& pixelFormat,
+                                  visifruit::PixelSource& source) {
+        visifruit::PixelFormat format = frame.channels == 3 ? visifruit::PixelFormat::Bgr : visifruit::PixelFormat::Gray;
+        if (!pixelFormat.empty() && !visifruit::ParsePixelFormat(pixelFormat, format)) return false;
+
+        source.data = frame.data;
+        source.format = format;
+        source.width = frame.width;
+        source.height = frame.height;
+        switch (format) {
+            case visifruit::PixelFormat::Rgb:
+            case visifruit::PixelFormat::Bgr:
+                if (frame.channels != 3) return false;
+                source.stride = static_cast<size_t>(frame.width) * 3;
+                break;
+            case visifruit::PixelFormat::Gray:
+                if (frame.channels != 1) return false;
+                source.stride = static_cast<size_t>(frame.width);
+                break;
+            case visifruit::PixelFormat::I420:
+            case visifruit::PixelFormat::Nv12:
+                if (frame.channels != 1 || frame.height % 3 != 0) return false;
+                source.height = frame.height / 3 * 2;
+                source.stride = static_cast<size_t>(frame.width);
+                if (source.width % 2 != 0 || source.height % 2 != 0) return false;
+                break;
+        }
+        return source.width > 0 && source.height > 0 && source.ByteSize() <= frame.bytes;
+    }
+
+    static std::string BuildInferenceResponse(const InferResult& result, const InferParams& params,
+                                              double preMs, double totalMs) {
+        std::string body;
+        body.reserve(256 + result.detections.size() * 160);
+        body += "{\"success\":true,\"detections\":[";
+        char number[160];
+        for (size_t i = 0; i < result.detections.size(); ++i) {
+            const visifruit::Detection& d = result.detections[i];
+            // Mismas conversiones que el servidor Python: int() trunca
+            int x1 = static_cast<int>(d.x1), y1 = static_cast<int>(d.y1);
+            int x2 = static_cast<int>(d.x2), y2 = static_cast<int>(d.y2);
+            const std::string& name = (d.classId >= 0 && static_cast<size_t>(d.classId) < params.classNames.size())
+                ? params.classNames[static_cast<size_t>(d.classId)] : std::string("unknown");
+            if (i) body += ',';
+            std::snprintf(number, sizeof(number), "{\"class_id\":%d,\"class_name\":", d.classId);
+            body += number;
+            visifruit::AppendJsonString(body, name);
+            std::snprintf(number, sizeof(number),
+                          ",\"confidence\":%.6g,\"bbox\":[%d,%d,%d,%d],\"area\":%d,\"center\":[%d,%d]}",
+                          d.confidence, x1, y1, x2, y2, (x2 - x1) * (y2 - y1), (x1 + x2) / 2, (y1 + y2) / 2);
+            body += number;
+        }
+        std::snprintf(number, sizeof(number),
+                      "],\"inference_ms\":%.3f,\"pre_ms\":%.3f,\"post_ms\":%.3f,\"total_ms\":%.3f,"
+                      "\"model_device\":\"cpu\",\"timestamp\":\"",
+                      result.inferenceMs, preMs, result.postMs, totalMs);
+        body += number;
+        body += IsoTimestamp();
+        body += "\"}";
+        return body;
+    }
+
+    std::string Health() {
+        char body[512];
+        uint64_t served;
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            served = requestsSuccess;
+        }
+        std::snprintf(body, sizeof(body),
+                      "{\"status\":\"ok\",\"model_loaded\":true,\"device\":\"cpu\",\"gpu_available\":false,"
+                      "\"cpu_percent\":%.1f,\"memory_percent\":%.1f,\"gpu_memory_mb\":null,"
+                      "\"uptime_seconds\":%.3f,\"requests_served\":%llu}",
+                      systemMonitor.CpuPercent(), SystemMonitor::MemoryPercent(),
+                      UnixSeconds() - startupTime, static_cast<unsigned long long>(served));
+        return body;
+    }
+
+    std::string Stats() {
+        visifruit::LatencySummary window = latency.Window(1);
+        std::lock_guard<std::mutex> lock(statsMutex);
+        double elapsed = std::chrono::duration<double>(SteadyClock::now() - startupSteady).count();
+        double avg = requestsSuccess ? totalInferenceMs / static_cast<double>(requestsSuccess) : 0.0;
+        double successRate = requestsTotal ? static_cast<double>(requestsSuccess) / static_cast<double>(requestsTotal) : 0.0;
+        char body[1024];
+        std::snprintf(body, sizeof(body),
+                      "{\"requests_total\":%llu,\"requests_success\":%llu,\"requests_failed\":%llu,"
+                      "\"requests_cached\":0,\"total_inference_time_ms\":%.3f,\"startup_time\":%.3f,"
+                      "\"avg_inference_ms\":%.3f,\"success_rate\":%.4f,\"fps\":%.2f,"
+                      "\"total_detections\":%llu,\"frames_processed\":%llu,\"cache\":{\"enabled\":false},"
+                      "\"backend\":\"onnxruntime-native\",\"model\":\"%s\",\"precision\":\"%s\",\"rss_mb\":%.1f,"
+                      "\"latency_1m\":{\"count\":%llu,\"p50_ms\":%.3f,\"p99_ms\":%.3f,\"p999_ms\":%.3f}}",
+                      static_cast<unsigned long long>(requestsTotal), static_cast<unsigned long long>(requestsSuccess),
+                      static_cast<unsigned long long>(requestsFailed), totalInferenceMs, startupTime, avg,
+                      successRate, elapsed > 0.0 ? static_cast<double>(requestsSuccess) / elapsed : 0.0,
+                      static_cast<unsigned long long>(detectionsCount), static_cast<unsigned long long>(requestsSuccess),
+                      engine.LayoutName(), engine.PrecisionName(), SystemMonitor::ResidentMb(),
+                      static_cast<unsigned long long>(window.count), window.p50Ms, window.p99Ms, window.p999Ms);
+        return body;
+    }
+
+    std::string Perf() {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        double elapsed = std::chrono::duration<double>(SteadyClock::now() - startupSteady).count();
+        char body[512];
+        std::snprintf(body, sizeof(body),
+                      "{\"fps\":%.2f,\"avg_latency_ms\":%.2f,\"frames_processed\":%llu,\"total_detections\":%llu,"
+                      "\"uptime_seconds\":%.1f,\"requests_total\":%llu,\"requests_success\":%llu,\"timestamp\":\"%s\"}",
+                      elapsed > 0.0 ? static_cast<double>(requestsSuccess) / elapsed : 0.0,
+                      requestsSuccess ? totalInferenceMs / static_cast<double>(requestsSuccess) : 0.0,
+                      static_cast<unsigned long long>(requestsSuccess), static_cast<unsigned long long>(detectionsCount),
+                      elapsed, static_cast<unsigned long long>(requestsTotal),
+                      static_cast<unsigned long long>(requestsSuccess), IsoTimestamp().c_str());
+        return body;
+    }
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+#ifdef SIGBREAK
+    std::signal(SIGBREAK, OnSignal);
+#endif
+
+    ServerConfig config;
+    config.Load(argc, argv);
+
+    visifruit::SocketRuntime runtime;
+    if (!runtime.IsReady()) {
+        Log("ERROR", "❌ Error inicializando la pila de red");
+        return 1;
+    }
+
+    Log("INFO", "🚀 Iniciando servidor de inferencia nativo VisiFruit...");
+    InferenceEngine engine;
+    std::string error;
+    auto loadStart = SteadyClock::now();
+    if (!engine.Load(config, error)) {
+        Log("ERROR", "❌ Error cargando modelo %s: %s", config.modelPath.c_str(), error.c_str());
+        return 1;
+    }
+    Log("INFO", "✅ Modelo cargado en %.0fms: %s (%s, entrada %dx%d %s, %d hilos)",
+        ElapsedMs(loadStart), config.modelPath.c_str(), engine.LayoutName(),
+        engine.InputWidth(), engine.InputHeight(), engine.InputTypeName(), config.threads);
+
+    Log("INFO", "🔥 Realizando warmup del modelo...");
+    engine.Warmup();
+
+    InferenceHttpServer server(config, engine);
+    if (!server.Listen()) {
+        Log("ERROR", "❌ No se pudo escuchar en %s:%d", config.host.c_str(), config.port);
+        return 1;
+    }
+
+    Log("INFO", "============================================================");
+    Log("INFO", "🎯 CONFIGURACIÓN DEL SERVIDOR");
+    Log("INFO", "   Arquitectura: %s (ONNX Runtime CPU)", engine.LayoutName());
+    Log("INFO", "   Modelo: %s", config.modelPath.c_str());
+    Log("INFO", "   Precisión: %s", engine.PrecisionName());
+    Log("INFO", "   Autenticación: %s", config.authEnabled ? "True" : "False");
+    Log("INFO", "   Memoria compartida: %s", config.sharedMemoryEnabled ? "True" : "False");
+    Log("INFO", "   Memoria residente: %.1f MB", SystemMonitor::ResidentMb());
+    Log("INFO", "🌐 ENDPOINTS DISPONIBLES");
+    Log("INFO", "   http://%s:%d/health", config.host.c_str(), config.port);
+    Log("INFO", "   http://%s:%d/infer", config.host.c_str(), config.port);
+    if (config.sharedMemoryEnabled) Log("INFO", "   http://%s:%d/infer_shm", config.host.c_str(), config.port);
+    Log("INFO", "   http://%s:%d/stats", config.host.c_str(), config.port);
+    Log("INFO", "   http://%s:%d/perf", config.host.c_str(), config.port);
+    Log("INFO", "============================================================");
+
+    server.Run();
+    Log("INFO", "🛑 Servidor detenido");
+    return 0;
+}
@@ -0,0 +1,227 @@
+/**
+ * VisiFruit Servidor de Inferencia Nativo - Anillo de Frames Compartido
+ * ======================================================================
+ *
+ * Lector del anillo de memoria compartida de utils/shared_frame_ring.py,
+ * con el mismo formato binario: el cliente local copia el frame (BGR, gris
+ * o YUV) a un slot y /infer_shm solo recibe (anillo, slot, secuencia). El
+ * preprocesado lee el slot directamente, sin JPEG ni copias intermedias.
+ *
+ * Formato (little-endian):
+ *   Cabecera (64 B): magic "VFRING01", slots u32, bytes por slot u32,
+ *                    última secuencia u64
+ *   Slot: cabecera (64 B): seqlock u64, alto u32, ancho u32, canales u32,
+ *         bytes u64; después los datos
+ *
+ * Seqlock: el productor deja el marcador impar mientras escribe y en
+ * 2*seq al terminar. El lector lo comprueba antes de usar el frame y otra
+ * vez después de leerlo; si cambió, el frame se descarta.
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace visifruit {
+
+struct SharedFrame {
+    const uint8_t* data = nullptr;
+    int height = 0;
+    int width = 0;
+    int channels = 0;
+    size_t bytes = 0;
+};
+
+class SharedFrameRing {
+public:
+    static constexpr const char* kNamePrefix = "visifruit_ring_";
+
+    SharedFrameRing() = default;
+    SharedFrameRing(const SharedFrameRing&) = delete;
+    SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+    ~SharedFrameRing() { Close(); }
+
+    // Mismo filtro que SharedFrameRing.attach (más caracteres seguros para shm_open)
+    static bool ValidName(const std::string& name) {
+        if (name.compare(0, std::strlen(kNamePrefix), kNamePrefix) != 0 || name.size() > 200) return false;
+        for (char c : name) {
+            bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                        c == '_' || c == '-';
+            if (!safe) return false;
+        }
+        return true;
+    }
+
+    bool Attach(const std::string& name, std::string& error) {
+        if (!ValidName(name)) {
+            error = "Nombre de anillo no permitido: " + name;
+            return false;
+        }
+#ifdef _WIN32
+        mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+        if (!mapping) {
+            error = "no existe el segmento " + name;
+            return false;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        MEMORY_BASIC_INFORMATION info;
+        if (!view || !VirtualQuery(view, &info, sizeof(info))) {
+            if (view) UnmapViewOfFile(view);
+            error = "no se pudo mapear " + name;
+            Close();
+            return false;
+        }
+        base = static_cast<const uint8_t*>(view);
+        size = info.RegionSize;
+#else
+        int fd = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            error = "no existe el segmento " + name;
+            return false;
+        }
+        struct stat info;
+        void* view = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (view == MAP_FAILED) {
+            error = "no se pudo mapear " + name;
+            return false;
+        }
+        base = static_cast<const uint8_t*>(view);
+        size = static_cast<size_t>(info.st_size);
+#endif
+        if (size < kHeaderSize || std::memcmp(base, "VFRING01", 8) != 0) {
+            error = "Segmento " + name + " no es un anillo de frames VisiFruit";
+            Close();
+            return false;
+        }
+        std::memcpy(&slotCount, base + 8, sizeof(slotCount));
+        std::memcpy(&slotBytes, base + 12, sizeof(slotBytes));
+        if (slotCount == 0 || kHeaderSize + static_cast<size_t>(slotCount) * SlotStride() > size) {
+            error = "Segmento " + name + " con cabecera inconsistente";
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Vista sin copia del frame; false si el slot ya no contiene esa
+     * secuencia o su cabecera no es coherente.
+     */
+    bool Read(uint32_t slot, uint64_t seq, SharedFrame& frame) const {
+        if (!base || slot >= slotCount || Marker(slot) != 2 * seq) return false;
+        const uint8_t* header = base + SlotOffset(slot);
+        uint32_t height = 0, width = 0, channels = 0;
+        uint64_t bytes = 0;
+        std::memcpy(&height, header + 8, 4);
+        std::memcpy(&width, header + 12, 4);
+        std::memcpy(&channels, header + 16, 4);
+        std::memcpy(&bytes, header + 20, 8);
+        if (bytes != static_cast<uint64_t>(height) * width * channels || bytes > slotBytes) return false;
+
+        frame.data = header + kSlotHeaderSize;
+        frame.height = static_cast<int>(height);
+        frame.width = static_cast<int>(width);
+        frame.channels = static_cast<int>(channels);
+        frame.bytes = static_cast<size_t>(bytes);
+        return true;
+    }
+
+    // El slot sigue conteniendo la secuencia (llamar después de leer los datos)
+    bool IsValid(uint32_t slot, uint64_t seq) const {
+        return base && slot < slotCount && Marker(slot) == 2 * seq;
+    }
+
+private:
+    static constexpr size_t kHeaderSize = 64;
+    static constexpr size_t kSlotHeaderSize = 64;
+
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    uint32_t slotCount = 0;
+    uint32_t slotBytes = 0;
+#ifdef _WIN32
+    HANDLE mapping = nullptr;
+#endif
+
+    size_t SlotStride() const { return kSlotHeaderSize + slotBytes; }
+    size_t SlotOffset(uint32_t slot) const { return kHeaderSize + static_cast<size_t>(slot) * SlotStride(); }
+
+    uint64_t Marker(uint32_t slot) const {
+        // La lectura de los datos no puede adelantarse a la del marcador (ni retrasarse la siguiente)
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t marker = *reinterpret_cast<const volatile uint64_t*>(base + SlotOffset(slot));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return marker;
+    }
+
+    void Close() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        mapping = nullptr;
+#else
+        if (base) munmap(const_cast<uint8_t*>(base), size);
+#endif
+        base = nullptr;
+        size = 0;
+    }
+};
+
+/**
+ * Anillos abiertos por nombre, compartidos entre conexiones (como
+ * InferenceServer.get_shared_ring): al llegar al máximo se cierra el más
+ * antiguo (cliente probablemente reiniciado). Las peticiones en curso
+ * mantienen vivo su mapeo hasta terminar.
+ */
+class SharedFrameRingRegistry {
+public:
+    explicit SharedFrameRingRegistry(size_t maxRings = 4) : capacity(std::max<size_t>(1, maxRings)) {}
+
+    std::shared_ptr<SharedFrameRing> Get(const std::string& name, std::string& error, bool& attached) {
+        std::lock_guard<std::mutex> lock(mutex);
+        attached = false;
+        for (const auto& entry : rings) {
+            if (entry.first == name) return entry.second;
+        }
+        std::shared_ptr<SharedFrameRing> ring = std::make_shared<SharedFrameRing>();
+        if (!ring->Attach(name, error)) return nullptr;
+        if (rings.size() >= capacity) rings.erase(rings.begin());
+        rings.emplace_back(name, ring);
+        attached = true;
+        return ring;
+    }
+
+private:
+    size_t capacity;
+    std::mutex mutex;
+    std::vector<std::pair<std::string, std::shared_ptr<SharedFrameRing>>> rings;   // Orden de apertura
+};
+
+}  // namespace visifruit
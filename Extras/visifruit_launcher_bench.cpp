@@ -0,0 +1,290 @@
+/**
+ * VisiFruit Launcher - Benchmarks del Núcleo Nativo
+ * ==================================================
+ *
+ * Mide los costes propios del launcher con un servicio simulado
+ * (visifruit_mock_service) y emite los resultados en JSON:
+ *
+ * - addlog_*        : throughput de AddLog (formato + anillo de líneas)
+ * - probe_*         : coste de una sonda HTTP keep-alive / TCP y de un ciclo completo
+ * - latency_record_ns: registro en el histograma de latencias
+ *
+ * No mide el lanzamiento ni la parada de servicios: el launcher los arranca
+ * con ShellExecuteEx y los detiene por puerto (taskkill), rutas solo de
+ * Windows. ChildProcess solo lanza aquí el servicio simulado.
+ *
+ * Todas las métricas son "menor es mejor". Con --baseline se comparan con
+ * una línea base guardada y se sale con código 1 si alguna empeora más
+ * que la tolerancia. Las sondas fallidas no entran en los percentiles: se
+ * cuentan en probe_*_failures y en "failures", que debe ser 0 para pasar
+ * la comparación.
+ *
+ * Uso:
+ *   visifruit_launcher_bench [--mock RUTA] [--output resultados.json]
+ *                            [--baseline base.json] [--tolerance 0.20]
+ *                            [--write-baseline base.json] [--quick]
+ *
+ * Compilar con: Extras/compile_cpp_bench.sh
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#include "visifruit_launcher_json.h"
+#include "visifruit_launcher_log.h"
+#include "visifruit_launcher_metrics.h"
+#include "visifruit_launcher_probe.h"
+#include "visifruit_launcher_process.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using visifruit::SteadyClock;
+
+struct BenchOptions {
+    std::string mockPath;
+    std::string outputPath;
+    std::string baselinePath;
+    std::string writeBaselinePath;
+    double tolerance = 0.20;
+    bool quick = false;
+    int basePort = 18500;
+};
+
+double ElapsedMs(SteadyClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(SteadyClock::now() - start).count();
+}
+
+double Percentile(std::vector<double> values, double percentile) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(values.size() - 1) + 0.5);
+    return values[std::min(rank, values.size() - 1)];
+}
+
+// Espera a que el puerto acepte conexiones; devuelve false si vence el timeout
+bool WaitUntilReady(int port, int timeoutMs) {
+    visifruit::ProbeTarget target;
+    target.kind = visifruit::ProbeKind::Tcp;
+    target.port = port;
+    target.timeoutMs = 50;
+    visifruit::ServiceProber prober(target);
+    auto deadline = SteadyClock::now() + std::chrono::milliseconds(timeoutMs);
+    while (SteadyClock::now() < deadline) {
+        if (prober.Probe().ok) return true;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    return false;
+}
+
+std::vector<std::string> MockCommand(const BenchOptions& options, int port) {
+    return {options.mockPath, "--port", std::to_string(port)};
+}
+
+void BenchAddLog(const BenchOptions& options, std::map<std::string, double>& metrics) {
+    visifruit::LogBuffer buffer(2000);
+    const int lines = options.quick ? 50000 : 500000;
+    const std::wstring message = L"✅ Backend iniciado (PID 12345) - sonda HTTP keep-alive OK";
+
+    auto start = SteadyClock::now();
+    size_t checksum = 0;
+    for (int i = 0; i < lines; ++i) {
+        checksum += buffer.Append(message).size();
+    }
+    double elapsedMs = ElapsedMs(start);
+    if (checksum == 0) std::fprintf(stderr, "checksum inesperado\n");
+
+    metrics["addlog_ns_per_line"] = elapsedMs * 1e6 / lines;
+}
+
+void BenchLatencyRecord(const BenchOptions& options, std::map<std::string, double>& metrics) {
+    visifruit::ServiceLatencyTracker tracker("bench", visifruit::SloConfig());
+    const int records = options.quick ? 200000 : 2000000;
+    auto now = SteadyClock::now();
+
+    auto start = SteadyClock::now();
+    for (int i = 0; i < records; ++i) {
+        tracker.Record(0.5 + (i % 1000) * 0.01, true, now);
+    }
+    metrics["latency_record_ns"] = ElapsedMs(start) * 1e6 / records;
+}
+
+bool BenchProbes(const BenchOptions& options, std::map<std::string, double>& metrics) {
+    const int port = options.basePort;
+    visifruit::ChildProcess mock;
+    if (!mock.Spawn(MockCommand(options, port)) || !WaitUntilReady(port, 5000)) {
+        std::fprintf(stderr, "❌ No se pudo arrancar el servicio simulado: %s\n", options.mockPath.c_str());
+        return false;
+    }
+
+    const int probes = options.quick ? 500 : 5000;
+    auto runProbes = [&](const std::string& spec, const char* name) {
+        visifruit::ProbeTarget target;
+        visifruit::ParseProbeSpec(spec, target);
+        visifruit::ServiceProber prober(target);
+        std::vector<double> samples;
+        samples.reserve(probes);
+        int failures = 0;
+        for (int i = 0; i < probes; ++i) {
+            auto result = prober.Probe();
+            if (!result.ok) {
+                failures++;
+                continue;
+            }
+            samples.push_back(result.latencyMs * 1000.0);
+        }
+        if (failures > 0) std::fprintf(stderr, "⚠️ %d/%d sondas %s fallidas\n", failures, probes, name);
+        metrics[std::string("probe_") + name + "_failures"] = failures;
+        metrics["failures"] += failures;
+        metrics[std::string("probe_") + name + "_us_p50"] = Percentile(samples, 50);
+        metrics[std::string("probe_") + name + "_us_p99"] = Percentile(samples, 99);
+        if (target.kind == visifruit::ProbeKind::Http) {
+            metrics[std::string("probe_") + name + "_connections"] = static_cast<double>(prober.ConnectionsOpened());
+        }
+    };
+
+    std::string portText = std::to_string(port);
+    runProbes("http://127.0.0.1:" + portText + "/health", "http_keepalive");
+    runProbes("tcp://127.0.0.1:" + portText, "tcp");
+
+    // Ciclo completo con la configuración por defecto del launcher (HTTP + TCP + HTTP)
+    std::vector<std::unique_ptr<visifruit::ServiceProber>> cycle;
+    for (const char* spec : {"http://127.0.0.1:%d/health", "tcp://127.0.0.1:%d", "http://127.0.0.1:%d/health"}) {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), spec, port);
+        visifruit::ProbeTarget target;
+        visifruit::ParseProbeSpec(buffer, target);
+        cycle.emplace_back(new visifruit::ServiceProber(target));
+    }
+    std::vector<double> cycleSamples;
+    int cycleFailures = 0;
+    for (int i = 0; i < probes / 3; ++i) {
+        auto start = SteadyClock::now();
+        bool ok = true;
+        for (auto& prober : cycle) ok = prober->Probe().ok && ok;
+        if (!ok) {
+            cycleFailures++;
+            continue;
+        }
+        cycleSamples.push_back(ElapsedMs(start) * 1000.0);
+    }
+    if (cycleFailures > 0) std::fprintf(stderr, "⚠️ %d/%d ciclos de sondas con fallos\n", cycleFailures, probes / 3);
+    metrics["probe_cycle_failures"] = cycleFailures;
+    metrics["failures"] += cycleFailures;
+    metrics["probe_cycle_us_p50"] = Percentile(cycleSamples, 50);
+    metrics["probe_cycle_us_p99"] = Percentile(cycleSamples, 99);
+
+    mock.Stop(1000);
+    return true;
+}
+
+std::string RenderJson(const std::map<std::string, double>& metrics) {
+    std::ostringstream out;
+    out << "{\n  \"benchmark\": \"visifruit_launcher_core\",\n  \"version\": 1,\n  \"metrics\": {\n";
+    size_t i = 0;
+    for (const auto& metric : metrics) {
+        out << "    \"" << metric.first << "\": " << metric.second << (++i < metrics.size() ? ",\n" : "\n");
+    }
+    out << "  }\n}\n";
+    return out.str();
+}
+
+// Devuelve el número de métricas que empeoran por encima de la tolerancia
+int CompareWithBaseline(const std::map<std::string, double>& metrics, const BenchOptions& options) {
+    visifruit::JsonValue baseline;
+    if (!visifruit::JsonParser::ParseFile(options.baselinePath, baseline) || !baseline.Get("metrics")) {
+        std::fprintf(stderr, "❌ Línea base inválida: %s\n", options.baselinePath.c_str());
+        return -1;
+    }
+
+    int regressions = 0;
+    // Percentiles calculados sin las sondas fallidas: cualquier fallo invalida la comparación
+    auto failures = metrics.find("failures");
+    if (failures != metrics.end() && failures->second > 0.0) {
+        std::fprintf(stderr, "❌ %.0f sondas fallidas durante la medición\n", failures->second);
+        regressions++;
+    }
+    std::fprintf(stderr, "\n%-32s %12s %12s %9s\n", "métrica", "base", "actual", "cambio");
+    for (const auto& member : baseline.Get("metrics")->members) {
+        auto current = metrics.find(member.first);
+        if (current == metrics.end() || member.second.number <= 0.0) continue;
+        // Las cuentas de conexiones son deterministas: no aplicar tolerancia relativa
+        bool exact = member.first.find("_connections") != std::string::npos;
+        double change = current->second / member.second.number - 1.0;
+        bool regressed = exact ? current->second > member.second.number : change > options.tolerance;
+        if (regressed) regressions++;
+        std::fprintf(stderr, "%-32s %12.3f %12.3f %+8.1f%% %s\n", member.first.c_str(),
+                     member.second.number, current->second, change * 100.0, regressed ? "❌" : "✅");
+    }
+    return regressions;
+}
+
+std::string DefaultMockPath(const char* argv0) {
+    std::string self(argv0);
+    auto slash = self.find_last_of("/\\");
+    std::string dir = (slash == std::string::npos) ? "." : self.substr(0, slash);
+#ifdef _WIN32
+    return dir + "\\visifruit_mock_service.exe";
+#else
+    return dir + "/visifruit_mock_service";
+#endif
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    options.mockPath = DefaultMockPath(argv[0]);
+
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        auto value = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : std::string(); };
+        if (flag == "--mock") options.mockPath = value();
+        else if (flag == "--output") options.outputPath = value();
+        else if (flag == "--baseline") options.baselinePath = value();
+        else if (flag == "--write-baseline") options.writeBaselinePath = value();
+        else if (flag == "--tolerance") options.tolerance = std::atof(value().c_str());
+        else if (flag == "--port") options.basePort = std::atoi(value().c_str());
+        else if (flag == "--quick") options.quick = true;
+        else {
+            std::fprintf(stderr, "Uso: %s [--mock RUTA] [--output F] [--baseline F] [--tolerance 0.20] "
+                                 "[--write-baseline F] [--port 18500] [--quick]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    visifruit::SocketRuntime runtime;
+    std::map<std::string, double> metrics;
+
+    std::fprintf(stderr, "⏱️  AddLog...\n");
+    BenchAddLog(options, metrics);
+    std::fprintf(stderr, "⏱️  Histograma de latencias...\n");
+    BenchLatencyRecord(options, metrics);
+    std::fprintf(stderr, "⏱️  Sondas...\n");
+    if (!BenchProbes(options, metrics)) return 1;
+
+    std::string json = RenderJson(metrics);
+    std::fputs(json.c_str(), stdout);
+    if (!options.outputPath.empty()) std::ofstream(options.outputPath) << json;
+    if (!options.writeBaselinePath.empty()) {
+        std::ofstream(options.writeBaselinePath) << json;
+        std::fprintf(stderr, "💾 Línea base guardada en %s\n", options.writeBaselinePath.c_str());
+    }
+
+    if (!options.baselinePath.empty()) {
+        int regressions = CompareWithBaseline(metrics, options);
+        if (regressions != 0) {
+            std::fprintf(stderr, "\n❌ %d regresiones respecto a la línea base\n", regressions);
+            return 1;
+        }
+        std::fprintf(stderr, "\n✅ Sin regresiones respecto a la línea base\n");
+    }
+    return 0;
+}
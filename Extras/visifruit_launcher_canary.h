@@ -0,0 +1,356 @@
+/**
+ * VisiFruit Launcher - Canario de Inferencia Extremo a Extremo
+ * =============================================================
+ *
+ * Envía periódicamente un conjunto fijo de frames de referencia
+ * (weights/canary/canary.json) al endpoint /infer del servidor de IA,
+ * comprueba el número y las clases de las detecciones frente a lo esperado
+ * y mide la latencia extremo a extremo. Detecta regresiones del camino
+ * crítico (modelo cambiado, throttling térmico) que /health no ve.
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#include "visifruit_launcher_json.h"
+#include "visifruit_launcher_probe.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace visifruit {
+
+struct CanaryFrame {
+    std::string name;
+    std::string jpeg;
+    int expectedCount = 0;
+    int countTolerance = 0;
+    std::vector<std::pair<std::string, int>> expectedClasses;
+    std::string requestBody;        // multipart precalculado
+};
+
+struct CanaryConfig {
+    std::string host = "127.0.0.1";
+    int port = 9000;
+    std::string path = "/infer";
+    int intervalS = 60;
+    int timeoutMs = 5000;
+    int imgsz = 640;
+    double conf = 0.5;
+    double iou = 0.45;
+    double maxLatencyMs = 500.0;
+    std::string authToken;
+    std::vector<CanaryFrame> frames;
+};
+
+struct CanaryFrameResult {
+    std::string name;
+    bool httpOk = false;
+    bool countOk = false;
+    bool classesOk = false;
+    int detections = 0;
+    double latencyMs = 0.0;
+    double serverInferenceMs = 0.0;
+    std::string detail;
+
+    bool Passed() const { return httpOk && countOk && classesOk; }
+};
+
+class InferenceCanary {
+public:
+    static constexpr const char* kBoundary = "----VisiFruitCanaryBoundary7d1f";
+
+    /**
+     * Carga el manifiesto y las imágenes (rutas relativas al manifiesto).
+     * Los frames cuya imagen no existe se omiten y se reportan en error;
+     * un manifiesto sin frames (la plantilla del repositorio) devuelve false
+     * con error "no configurado".
+     */
+    static bool LoadManifest(const std::string& manifestPath, CanaryConfig& config, std::string& error) {
+        JsonValue root;
+        if (!JsonParser::ParseFile(manifestPath, root) || !root.IsObject()) {
+            error = "manifiesto no encontrado o inválido: " + manifestPath;
+            return false;
+        }
+
+        ProbeTarget endpoint;
+        if (ParseProbeSpec(root.StringOr("endpoint", "http://127.0.0.1:9000/infer"), endpoint)) {
+            config.host = endpoint.host;
+            config.port = endpoint.port;
+            config.path = endpoint.path;
+        }
+        config.intervalS = static_cast<int>(root.NumberOr("interval_s", config.intervalS));
+        config.timeoutMs = static_cast<int>(root.NumberOr("timeout_ms", config.timeoutMs));
+        config.imgsz = static_cast<int>(root.NumberOr("imgsz", config.imgsz));
+        config.conf = root.NumberOr("conf", config.conf);
+        config.iou = root.NumberOr("iou", config.iou);
+        config.maxLatencyMs = root.NumberOr("max_latency_ms", config.maxLatencyMs);
+
+        // El token se toma de la variable indicada o del primero de AUTH_TOKENS
+        std::string tokenEnv = root.StringOr("auth_token_env", "CANARY_AUTH_TOKEN");
+        if (const char* token = std::getenv(tokenEnv.c_str())) {
+            config.authToken = token;
+        } else if (const char* tokens = std::getenv("AUTH_TOKENS")) {
+            std::string all(tokens);
+            config.authToken = all.substr(0, all.find(','));
+        }
+
+        std::string baseDir;
+        auto slash = manifestPath.find_last_of("/\\");
+        if (slash != std::string::npos) baseDir = manifestPath.substr(0, slash + 1);
+
+        const JsonValue* frames = root.Get("frames");
+        if (!frames || !frames->IsArray()) {
+            error = "el manifiesto no define 'frames'";
+            return false;
+        }
+        if (frames->items.empty()) {
+            error = "no configurado (" + manifestPath + " no lista frames de referencia)";
+            return false;
+        }
+
+        for (const JsonValue& entry : frames->items) {
+            CanaryFrame frame;
+            frame.name = entry.StringOr("image", "");
+            std::ifstream file(baseDir + frame.name, std::ios::binary);
+            if (frame.name.empty() || !file) {
+                error += (error.empty() ? "" : ", ") + std::string("falta ") + frame.name;
+                continue;
+            }
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            frame.jpeg = buffer.str();
+            frame.expectedCount = static_cast<int>(entry.NumberOr("expected_count", 0));
+            frame.countTolerance = static_cast<int>(entry.NumberOr("count_tolerance", 0));
+            if (const JsonValue* classes = entry.Get("expected_classes")) {
+                for (const auto& member : classes->members) {
+                    frame.expectedClasses.emplace_back(member.first, static_cast<int>(member.second.number));
+                }
+            }
+            frame.requestBody = BuildMultipart(config, frame);
+            config.frames.push_back(std::move(frame));
+        }
+        return !config.frames.empty();
+    }
+
+    explicit InferenceCanary(CanaryConfig canaryConfig) : config(std::move(canaryConfig)) {}
+    ~InferenceCanary() { detail::CloseSocket(sock); }
+
+    InferenceCanary(const InferenceCanary&) = delete;
+    InferenceCanary& operator=(const InferenceCanary&) = delete;
+
+    const CanaryConfig& Config() const { return config; }
+
+    std::vector<CanaryFrameResult> RunOnce() {
+        std::vector<CanaryFrameResult> results;
+        results.reserve(config.frames.size());
+        for (const CanaryFrame& frame : config.frames) {
+            results.push_back(RunFrame(frame));
+        }
+        return results;
+    }
+
+private:
+    CanaryConfig config;
+    socket_t sock = kInvalidSocket;
+    std::vector<char> scratch = std::vector<char>(16 * 1024);
+
+    static std::string BuildMultipart(const CanaryConfig& config, const CanaryFrame& frame) {
+        std::ostringstream body;
+        auto field = [&](const char* name, const std::string& value) {
+            body << "--" << kBoundary << "\r\n"
+                 << "Content-Disposition: form-data; name=\"" << name << "\"\r\n\r\n"
+                 << value << "\r\n";
+        };
+        field("imgsz", std::to_string(config.imgsz));
+        field("conf", std::to_string(config.conf));
+        field("iou", std::to_string(config.iou));
+        // El canario debe medir el modelo, no la caché de resultados del servidor
+        field("use_cache", "false");
+        body << "--" << kBoundary << "\r\n"
+             << "Content-Disposition: form-data; name=\"image\"; filename=\"" << frame.name << "\"\r\n"
+             << "Content-Type: image/jpeg\r\n\r\n"
+             << frame.jpeg << "\r\n"
+             << "--" << kBoundary << "--\r\n";
+        return body.str();
+    }
+
+    bool Connect(SteadyClock::time_point deadline) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* info = nullptr;
+        std::string port = std::to_string(config.port);
+        if (getaddrinfo(config.host.c_str(), port.c_str(), &hints, &info) != 0 || !info) return false;
+        sock = detail::ConnectWithTimeout(info->ai_addr, static_cast<int>(info->ai_addrlen), SOCK_STREAM, deadline);
+        freeaddrinfo(info);
+        return sock != kInvalidSocket;
+    }
+
+    CanaryFrameResult RunFrame(const CanaryFrame& frame) {
+        CanaryFrameResult result;
+        result.name = frame.name;
+
+        std::string header = "POST " + config.path + " HTTP/1.1\r\n"
+                             "Host: " + config.host + ":" + std::to_string(config.port) + "\r\n"
+                             "User-Agent: VisiFruit-Launcher-Canary\r\n"
+                             "Connection: keep-alive\r\n"
+                             "Content-Type: multipart/form-data; boundary=" + kBoundary + "\r\n"
+                             "Content-Length: " + std::to_string(frame.requestBody.size()) + "\r\n";
+        if (!config.authToken.empty()) header += "Authorization: Bearer " + config.authToken + "\r\n";
+        header += "\r\n";
+
+        auto start = SteadyClock::now();
+        auto deadline = start + std::chrono::milliseconds(config.timeoutMs);
+        int status = 0;
+        std::string body;
+
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            bool reused = (sock != kInvalidSocket);
+            if (!reused && !Connect(deadline)) {
+                result.detail = "sin conexión con el servidor de inferencia";
+                return result;
+            }
+
+            bool keepAlive = false;
+            if (detail::SendAll(sock, header.data(), header.size(), deadline) &&
+                detail::SendAll(sock, frame.requestBody.data(), frame.requestBody.size(), deadline) &&
+                detail::ReadHttpResponse(sock, scratch, deadline, status, keepAlive, &body)) {
+                if (!keepAlive) {
+                    detail::CloseSocket(sock);
+                    sock = kInvalidSocket;
+                }
+                break;
+            }
+
+            detail::CloseSocket(sock);
+            sock = kInvalidSocket;
+            status = 0;
+            // Reintentar solo si la conexión keep-alive estaba caducada
+            if (!reused) break;
+        }
+        result.latencyMs = std::chrono::duration<double, std::milli>(SteadyClock::now() - start).count();
+
+        if (status != 200) {
+            result.detail = status ? "HTTP " + std::to_string(status) : "timeout o conexión cerrada";
+            return result;
+        }
+
+        JsonValue response;
+        if (!JsonParser::Parse(body, response) || !response.BoolOr("success", false)) {
+            result.detail = "respuesta inválida";
+            return result;
+        }
+        result.httpOk = true;
+        result.serverInferenceMs = response.NumberOr("inference_ms", 0.0);
+
+        std::vector<std::pair<std::string, int>> seen;
+        if (const JsonValue* detections = response.Get("detections")) {
+            for (const JsonValue& det : detections->items) {
+                std::string cls = det.StringOr("class_name", "?");
+                auto it = std::find_if(seen.begin(), seen.end(),
+                                       [&](const std::pair<std::string, int>& p) { return p.first == cls; });
+                if (it == seen.end()) seen.emplace_back(cls, 1);
+                else it->second++;
+                result.detections++;
+            }
+        }
+
+        result.countOk = std::abs(result.detections - frame.expectedCount) <= frame.countTolerance;
+        result.classesOk = true;
+        for (const auto& expected : frame.expectedClasses) {
+            int count = 0;
+            for (const auto& s : seen) {
+                if (s.first == expected.first) count = s.second;
+            }
+            if (std::abs(count - expected.second) > frame.countTolerance) {
+                result.classesOk = false;
+                result.detail = expected.first + ": " + std::to_string(count) +
+                                " (esperado " + std::to_string(expected.second) + ")";
+            }
+        }
+        if (!result.countOk) {
+            result.detail = std::to_string(result.detections) + " detecciones (esperado " +
+                            std::to_string(frame.expectedCount) + ")";
+        }
+        return result;
+    }
+};
+
+/**
+ * Hilo que ejecuta el canario cada intervalS segundos y entrega los
+ * resultados de cada ciclo al callback. Arranca en pausa: solo ejecuta
+ * ciclos mientras SetActive(true), es decir, mientras el servidor de
+ * inferencia está en marcha; un ciclo en curso al pausar se descarta.
+ */
+class CanaryRunner {
+public:
+    using Callback = std::function<void(const std::vector<CanaryFrameResult>& results)>;
+
+    CanaryRunner(CanaryConfig config, Callback onResults)
+        : canary(std::move(config)), callback(std::move(onResults)) {}
+    ~CanaryRunner() { Stop(); }
+
+    void Start() {
+        if (running.exchange(true)) return;
+        worker = std::thread([this] { Loop(); });
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running.exchange(false)) return;
+        }
+        wakeup.notify_all();
+        if (worker.joinable()) worker.join();
+    }
+
+    // Reanuda (con un ciclo inmediato) o pausa el canario
+    void SetActive(bool value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (active.exchange(value) == value) return;
+        }
+        wakeup.notify_all();
+    }
+
+private:
+    InferenceCanary canary;
+    Callback callback;
+    std::atomic<bool> running{false};
+    std::atomic<bool> active{false};
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+
+    void Loop() {
+        while (running) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait(lock, [this] { return !running || active; });
+            }
+            if (!running) break;
+
+            auto results = canary.RunOnce();
+            if (callback && running && active) callback(results);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait_for(lock, std::chrono::seconds(canary.Config().intervalS), [this] { return !running || !active; });
+        }
+    }
+};
+
+}  // namespace visifruit
@@ -10,7 +10,24 @@
  * - Integración completa con el sistema
  * 
  * Compilar con:
- * g++ -std=c++17 -static -mwindows visifruit_launcher_cpp.cpp -o VisiFruit_Launcher_Native.exe -lcomctl32 -lshell32 -luser32 -lkernel32 -lgdi32 -lws2_32 -lwininet
+ * g++ -std=c++17 -static -mwindows visifruit_launcher_cpp.cpp -o VisiFruit_Launcher_Native.exe -lcomctl32 -lshell32 -luser32 -lkernel32 -lgdi32 -lws2_32
+ *
+ * Sondas de salud configurables en launcher_probes.cfg (una línea por servicio):
+ *   <servicio> <spec> [intervalo_ms] [timeout_ms] [slo_ms] [objetivo_slo]
+ *   backend http://127.0.0.1:8001/health 500 300 100 0.99
+ *   frontend tcp://127.0.0.1:3000 1000
+ *
+ * Métricas de latencia/SLO en http://127.0.0.1:8090/metrics (Prometheus) y /status (JSON),
+ * solo de servicios arrancados desde el launcher o vistos en marcha
+ *
+ * Canario de inferencia: frames de referencia en weights/canary/canary.json
+ *
+ * Servidor de inferencia nativo (ONNX Runtime CPU, puerto 9000): botón "IA Nativa",
+ * ejecutable en Extras\dist_cpp\visifruit_inference_server.exe (ver
+ * compile_cpp_inference_server.sh) con el modelo exportado en weights\best.onnx
+ *
+ * Grabación de eventos del supervisor: definir VISIFRUIT_TRACE=archivo.trace y
+ * reproducir con visifruit_launcher_replay (ver compile_cpp_bench.sh)
  * 
  * Autor: Asistente IA para VisiFruit
  * Versión: 1.0.0
@@ -20,7 +37,6 @@
 #include <windows.h>
 #include <commctrl.h>
 #include <shellapi.h>
-#include <wininet.h>
 #include <string>
 #include <vector>
 #include <map>
@@ -29,6 +45,18 @@
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "visifruit_launcher_log.h"
+#include "visifruit_launcher_probe.h"
+#include "visifruit_launcher_metrics.h"
+#include "visifruit_launcher_canary.h"
+#include "visifruit_launcher_supervisor.h"
 
 #pragma comment(lib, "comctl32.lib")
 #pragma comment(lib, "shell32.lib")
@@ -36,7 +64,6 @@
 #pragma comment(lib, "kernel32.lib")
 #pragma comment(lib, "gdi32.lib")
 #pragma comment(lib, "ws2_32.lib")
-#pragma comment(lib, "wininet.lib")
 
 // IDs de controles
 #define ID_START_ALL        1001
@@ -51,9 +78,32 @@
 #define ID_STATUS_BACKEND   1010
 #define ID_STATUS_FRONTEND  1011
 #define ID_STATUS_SYSTEM    1012
+#define ID_LATENCY_SUMMARY  1013
+#define ID_START_INFERENCE  1014
+#define ID_STATUS_INFERENCE 1015
 
 // Timer IDs
-#define TIMER_STATUS_UPDATE 2001
+#define TIMER_METRICS_REFRESH 2002
+
+// Mensajes propios
+#define WM_PROBE_RESULT     (WM_APP + 1)
+#define WM_CANARY_RESULT    (WM_APP + 2)
+
+// Archivo opcional con la configuración de sondas por servicio
+#define PROBES_CONFIG_FILE  "launcher_probes.cfg"
+
+// Puerto local del endpoint de métricas del launcher
+#define METRICS_PORT        8090
+
+// Manifiesto de frames de referencia del canario de inferencia
+#define CANARY_MANIFEST     "weights/canary/canary.json"
+
+// Variable de entorno con la ruta de la traza de eventos del supervisor
+#define TRACE_ENV_VAR       "VISIFRUIT_TRACE"
+
+// Servidor de inferencia nativo y modelo ONNX que carga
+#define INFERENCE_SERVER_EXE L"Extras\\dist_cpp\\visifruit_inference_server.exe"
+#define INFERENCE_SERVER_ARGS L"--model weights\\best.onnx --port 9000"
 
 class VisiFruitLauncher {
 private:
@@ -62,14 +112,39 @@ private:
     HWND hStatusBackend;
     HWND hStatusFrontend;
     HWND hStatusSystem;
+    HWND hStatusInference;
+    HWND hLatencySummary;
     
     HBRUSH hBrushBackground;
     HBRUSH hBrushGreen;
     HBRUSH hBrushRed;
     
+    visifruit::LogBuffer logBuffer;
     std::map<std::string, bool> serviceStatus;
     std::vector<PROCESS_INFORMATION> processes;
     
+    visifruit::SocketRuntime socketRuntime;
+    std::vector<visifruit::ProbeTarget> probeTargets;
+    std::vector<visifruit::SloConfig> probeSlos;
+    std::unique_ptr<visifruit::ProbeScheduler> probeScheduler;
+    
+    visifruit::LatencyRegistry latencyRegistry;
+    std::vector<visifruit::SloAlert> lastAlerts;
+    std::unique_ptr<visifruit::MetricsServer> metricsServer;
+    
+    std::unique_ptr<visifruit::CanaryRunner> canaryRunner;
+    std::mutex canaryMutex;
+    std::wstring canaryFailure;
+    double canaryWorstLatencyMs = 0.0;
+    bool canaryPassing = true;
+    bool canaryActive = false;
+    size_t canaryService = 0;
+    
+    // Todos los eventos de entrada pasan por el núcleo del supervisor (y la traza, si está activa)
+    std::unique_ptr<visifruit::SupervisorCore> supervisor;
+    visifruit::TraceRecorder traceRecorder;
+    std::vector<std::pair<uint32_t, HANDLE>> watchedProcesses;
+    
 public:
     VisiFruitLauncher() {
         serviceStatus["backend"] = false;
@@ -134,11 +209,11 @@ public:
         ShowWindow(hwnd, SW_SHOW);
         UpdateWindow(hwnd);
         
-        // Iniciar timer para actualizar estado
-        SetTimer(hwnd, TIMER_STATUS_UPDATE, 3000, NULL);
-        
         AddLog(L"🚀 VisiFruit Launcher (C++ Native) iniciado");
         
+        // Iniciar sondas de salud en segundo plano
+        StartProbes();
+        
         return true;
     }
     
@@ -172,6 +247,11 @@ public:
             240, 130, 150, 40,
             hwnd, (HMENU)ID_STOP_ALL, GetModuleHandle(NULL), NULL);
         
+        CreateWindow(L"BUTTON", L"🧠 IA Nativa",
+            WS_VISIBLE | WS_CHILD | BS_PUSHBUTTON,
+            400, 130, 90, 40,
+            hwnd, (HMENU)ID_START_INFERENCE, GetModuleHandle(NULL), NULL);
+        
         // Botones individuales
         CreateWindow(L"BUTTON", L"🔧 Backend",
             WS_VISIBLE | WS_CHILD | BS_PUSHBUTTON,
@@ -224,6 +304,21 @@ public:
             620, 180, 30, 20,
             hwnd, (HMENU)ID_STATUS_SYSTEM, GetModuleHandle(NULL), NULL);
         
+        CreateWindow(L"STATIC", L"IA (9000):",
+            WS_VISIBLE | WS_CHILD,
+            500, 205, 120, 20,
+            hwnd, NULL, GetModuleHandle(NULL), NULL);
+        
+        hStatusInference = CreateWindow(L"STATIC", L"●",
+            WS_VISIBLE | WS_CHILD | SS_CENTER,
+            620, 205, 30, 20,
+            hwnd, (HMENU)ID_STATUS_INFERENCE, GetModuleHandle(NULL), NULL);
+        
+        hLatencySummary = CreateWindow(L"STATIC", L"⏱️ p99 (1 min): sin datos",
+            WS_VISIBLE | WS_CHILD,
+            500, 230, 480, 20,
+            hwnd, (HMENU)ID_LATENCY_SUMMARY, GetModuleHandle(NULL), NULL);
+        
         // Enlaces rápidos
         CreateWindow(L"STATIC", L"🔗 Enlaces Rápidos",
             WS_VISIBLE | WS_CHILD,
@@ -255,53 +350,374 @@ public:
             WS_VISIBLE | WS_CHILD | WS_BORDER | WS_VSCROLL | ES_MULTILINE | ES_READONLY,
             20, 270, 960, 380,
             hwnd, (HMENU)ID_LOGS_TEXTBOX, GetModuleHandle(NULL), NULL);
+        
+        // El límite por defecto del EDIT (30000 caracteres) corta el registro en silencio
+        SendMessage(hLogsTextBox, EM_SETLIMITTEXT, 0, 0);
     }
     
     void AddLog(const std::wstring& message) {
-        // Obtener timestamp
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto tm = *std::localtime(&time_t);
-        
-        std::wstringstream ss;
-        ss << L"[" << std::setfill(L'0') << std::setw(2) << tm.tm_hour
-           << L":" << std::setfill(L'0') << std::setw(2) << tm.tm_min
-           << L":" << std::setfill(L'0') << std::setw(2) << tm.tm_sec
-           << L"] " << message << L"\r\n";
+        const std::wstring& line = logBuffer.Append(message);
         
-        // Agregar al textbox
-        int len = GetWindowTextLength(hLogsTextBox);
-        SendMessage(hLogsTextBox, EM_SETSEL, len, len);
-        SendMessage(hLogsTextBox, EM_REPLACESEL, FALSE, (LPARAM)ss.str().c_str());
+        if (logBuffer.TotalAppended() % logBuffer.Capacity() == 0) {
+            // Recortar el control a las líneas retenidas para que no crezca sin límite
+            SetWindowText(hLogsTextBox, logBuffer.Text().c_str());
+        } else {
+            // Agregar al textbox
+            int len = GetWindowTextLength(hLogsTextBox);
+            SendMessage(hLogsTextBox, EM_SETSEL, len, len);
+            SendMessage(hLogsTextBox, EM_REPLACESEL, FALSE, (LPARAM)line.c_str());
+        }
         
         // Auto-scroll
         SendMessage(hLogsTextBox, EM_SCROLLCARET, 0, 0);
     }
     
-    bool CheckPort(int port) {
-        HINTERNET hInternet = InternetOpen(L"VisiFruit", INTERNET_OPEN_TYPE_DIRECT, NULL, NULL, 0);
-        if (!hInternet) return false;
+    void LoadProbeTargets() {
+        // Configuración por defecto: HTTP keep-alive para las APIs, TCP para Vite
+        probeTargets.clear();
+        probeSlos.clear();
+        const std::pair<const char*, const char*> defaults[] = {
+            {"backend", "http://127.0.0.1:8001/health"},
+            {"frontend", "tcp://127.0.0.1:3000"},
+            {"system", "http://127.0.0.1:8000/health"},
+            {"inference", "http://127.0.0.1:9000/health"},
+        };
+        for (const auto& entry : defaults) {
+            visifruit::ProbeTarget target;
+            target.name = entry.first;
+            visifruit::ParseProbeSpec(entry.second, target);
+            probeTargets.push_back(target);
+            probeSlos.push_back(visifruit::SloConfig());
+        }
+        
+        std::ifstream config(PROBES_CONFIG_FILE);
+        std::string line;
+        while (std::getline(config, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            
+            std::istringstream fields(line);
+            std::string name, spec;
+            int intervalMs = 0, timeoutMs = 0;
+            double sloMs = 0.0, sloObjective = 0.0;
+            if (!(fields >> name >> spec)) continue;
+            fields >> intervalMs >> timeoutMs >> sloMs >> sloObjective;
+            
+            for (size_t i = 0; i < probeTargets.size(); ++i) {
+                visifruit::ProbeTarget& target = probeTargets[i];
+                if (target.name != name) continue;
+                visifruit::ProbeTarget updated = target;
+                if (!visifruit::ParseProbeSpec(spec, updated)) {
+                    AddLog(L"⚠️ Sonda inválida para " + std::wstring(name.begin(), name.end()));
+                    break;
+                }
+                if (intervalMs > 0) updated.intervalMs = intervalMs;
+                if (timeoutMs > 0) updated.timeoutMs = timeoutMs;
+                target = updated;
+                if (sloMs > 0.0) probeSlos[i].thresholdMs = sloMs;
+                if (sloObjective > 0.0 && sloObjective < 1.0) probeSlos[i].objective = sloObjective;
+            }
+        }
+    }
+    
+    void StartProbes() {
+        if (!socketRuntime.IsReady()) {
+            AddLog(L"❌ Error inicializando Winsock, sondas desactivadas");
+            return;
+        }
+        
+        LoadProbeTargets();
+        
+        // Un tracker por sonda, creados antes de arrancar el hilo para acceder por índice
+        for (size_t i = 0; i < probeTargets.size(); ++i) {
+            latencyRegistry.Add(probeTargets[i].name, probeSlos[i]);
+        }
+        
+        // El tracker del canario también debe existir antes de arrancar cualquier hilo
+        visifruit::CanaryConfig canaryConfig;
+        bool canaryEnabled = LoadCanary(canaryConfig);
+        if (canaryEnabled) {
+            visifruit::SloConfig canarySlo;
+            canarySlo.thresholdMs = canaryConfig.maxLatencyMs;
+            latencyRegistry.Add("canary", canarySlo);
+        }
+        lastAlerts.assign(latencyRegistry.Size(), visifruit::SloAlert::None);
+        
+        StartSupervisor(canaryEnabled);
+        
+        // Los hilos de sondas (uno por servicio) solo publican resultados; el supervisor los
+        // aplica en el hilo de UI y registra latencias solo de servicios que deben estar en marcha
+        HWND target = hwnd;
+        probeScheduler.reset(new visifruit::ProbeScheduler(probeTargets,
+            [target](size_t index, const visifruit::ProbeResult& result) {
+                // lParam: latencia en µs desplazada un bit + bit de estado
+                LPARAM latencyUs = static_cast<LPARAM>((std::min)(result.latencyMs * 1000.0, 1.0e9));
+                PostMessage(target, WM_PROBE_RESULT, static_cast<WPARAM>(index), (latencyUs << 1) | (result.ok ? 1 : 0));
+            }));
+        probeScheduler->Start();
+        
+        if (canaryEnabled) StartCanary(canaryConfig);
+        
+        StartMetricsServer();
+        SetTimer(hwnd, TIMER_METRICS_REFRESH, 1000, NULL);
+    }
+    
+    void StartSupervisor(bool withCanary) {
+        std::vector<std::string> names;
+        for (const auto& target : probeTargets) names.push_back(target.name);
+        if (withCanary) {
+            canaryService = names.size();
+            names.push_back("canary");
+        }
+        
+        supervisor.reset(new visifruit::SupervisorCore(names));
+        supervisor->SetStatusCallback([this](uint32_t service, bool up) { HandleStatusChange(service, up); });
+        supervisor->SetLogCallback([this](const std::wstring& message) { AddLog(L"⚠️ " + message); });
+        
+        if (const char* tracePath = std::getenv(TRACE_ENV_VAR)) {
+            if (traceRecorder.Open(tracePath, names)) {
+                AddLog(L"🎞️ Grabando eventos del supervisor en " + std::wstring(tracePath, tracePath + strlen(tracePath)));
+            } else {
+                AddLog(L"⚠️ No se pudo crear la traza " + std::wstring(tracePath, tracePath + strlen(tracePath)));
+            }
+        }
+        // Las marcas de tiempo de los eventos son relativas al origen de la traza
+        supervisor->SetLatencyRegistry(&latencyRegistry, traceRecorder.Origin());
+    }
+    
+    void DispatchEvent(visifruit::SupervisorEvent& event) {
+        if (!supervisor) return;
+        event.timestampUs = traceRecorder.NowUs();
+        traceRecorder.Record(event);
+        supervisor->Apply(event);
+        // Fuera de Apply (sin reentrar en el supervisor): el nuevo estado puede pausar o reanudar el canario
+        UpdateCanaryGate();
+    }
+    
+    int ServiceIndex(const std::string& name) const {
+        for (size_t i = 0; i < probeTargets.size(); ++i) {
+            if (probeTargets[i].name == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+    
+    // Arranque/parada pedidos desde el launcher: decide qué sondas cuentan para el SLO
+    void SetExpected(const std::string& serviceKey, bool expected) {
+        int index = ServiceIndex(serviceKey);
+        if (index < 0) return;
+        visifruit::SupervisorEvent event;
+        event.type = visifruit::EventType::Expect;
+        event.service = static_cast<uint32_t>(index);
+        event.value = expected ? 1 : 0;
+        DispatchEvent(event);
+    }
+    
+    // El canario solo se ejecuta (y cuenta para su SLO) con el servidor de inferencia en marcha y sano
+    void UpdateCanaryGate() {
+        int inference = ServiceIndex("inference");
+        if (!canaryRunner || !supervisor || inference < 0) return;
+        const visifruit::ServiceState& state = supervisor->State(static_cast<uint32_t>(inference));
+        bool active = state.expected && state.up;
+        if (active == canaryActive) return;
+        canaryActive = active;
+        
+        visifruit::SupervisorEvent event;
+        event.type = visifruit::EventType::Expect;
+        event.service = static_cast<uint32_t>(canaryService);
+        event.value = active ? 1 : 0;
+        DispatchEvent(event);
+        canaryRunner->SetActive(active);
+    }
+    
+    void WatchProcess(const std::string& serviceKey, HANDLE process) {
+        int index = ServiceIndex(serviceKey);
+        if (!process) return;
+        if (index < 0) {
+            CloseHandle(process);
+            return;
+        }
+        watchedProcesses.emplace_back(static_cast<uint32_t>(index), process);
+    }
+    
+    void CheckWatchedProcesses() {
+        for (size_t i = 0; i < watchedProcesses.size();) {
+            HANDLE process = watchedProcesses[i].second;
+            if (WaitForSingleObject(process, 0) != WAIT_OBJECT_0) {
+                ++i;
+                continue;
+            }
+            DWORD exitCode = 0;
+            GetExitCodeProcess(process, &exitCode);
+            CloseHandle(process);
+            
+            visifruit::SupervisorEvent event;
+            event.type = visifruit::EventType::ChildExit;
+            event.service = watchedProcesses[i].first;
+            event.value = static_cast<int32_t>(exitCode);
+            watchedProcesses.erase(watchedProcesses.begin() + i);
+            DispatchEvent(event);
+        }
+    }
+    
+    bool LoadCanary(visifruit::CanaryConfig& config) {
+        std::string error;
+        bool loaded = visifruit::InferenceCanary::LoadManifest(CANARY_MANIFEST, config, error);
+        if (!error.empty()) {
+            AddLog(L"⚠️ Canario de inferencia: " + std::wstring(error.begin(), error.end()));
+        }
+        if (!loaded) {
+            AddLog(L"ℹ️ Canario de inferencia desactivado: no se ejecuta hasta que el manifiesto tenga frames válidos");
+        }
+        return loaded;
+    }
+    
+    void StartCanary(const visifruit::CanaryConfig& config) {
+        HWND target = hwnd;
+        std::mutex* failureMutex = &canaryMutex;
+        std::wstring* failure = &canaryFailure;
+        double* worstLatency = &canaryWorstLatencyMs;
+        
+        // El ciclo llega al supervisor como evento Canary, que lo registra en el tracker "canary"
+        canaryRunner.reset(new visifruit::CanaryRunner(config,
+            [target, failureMutex, failure, worstLatency](const std::vector<visifruit::CanaryFrameResult>& results) {
+                size_t failed = 0;
+                double worst = 0.0;
+                std::string firstFailure;
+                for (const auto& result : results) {
+                    worst = (std::max)(worst, result.latencyMs);
+                    if (!result.Passed()) {
+                        if (failed++ == 0) firstFailure = result.name + ": " + result.detail;
+                    }
+                }
+                {
+                    std::lock_guard<std::mutex> lock(*failureMutex);
+                    failure->assign(firstFailure.begin(), firstFailure.end());
+                    *worstLatency = worst;
+                }
+                PostMessage(target, WM_CANARY_RESULT, static_cast<WPARAM>(failed), static_cast<LPARAM>(results.size()));
+            }));
+        canaryRunner->Start();
         
-        std::wstring url = L"http://localhost:" + std::to_wstring(port) + L"/health";
-        HINTERNET hUrl = InternetOpenUrl(hInternet, url.c_str(), NULL, 0, INTERNET_FLAG_RELOAD, 0);
+        AddLog(L"🐤 Canario de inferencia activo: " + std::to_wstring(config.frames.size()) +
+               L" frames cada " + std::to_wstring(config.intervalS) + L" s con el servidor de IA en marcha");
+    }
+    
+    void HandleCanaryResult(size_t failed, size_t total) {
+        visifruit::SupervisorEvent event;
+        event.type = visifruit::EventType::Canary;
+        event.service = static_cast<uint32_t>(canaryService);
+        event.value = static_cast<int32_t>(failed);
+        {
+            std::lock_guard<std::mutex> lock(canaryMutex);
+            event.latencyMs = static_cast<float>(canaryWorstLatencyMs);
+        }
+        DispatchEvent(event);
         
-        bool isRunning = (hUrl != NULL);
+        bool passing = (failed == 0);
+        if (passing) {
+            if (!canaryPassing) AddLog(L"✅ Canario de inferencia recuperado");
+        } else {
+            std::wstring detail;
+            {
+                std::lock_guard<std::mutex> lock(canaryMutex);
+                detail = canaryFailure;
+            }
+            AddLog(L"🐤 Canario: " + std::to_wstring(failed) + L"/" + std::to_wstring(total) +
+                   L" frames fallidos (" + detail + L")");
+        }
+        canaryPassing = passing;
+    }
+    
+    void StartMetricsServer() {
+        visifruit::LatencyRegistry* registry = &latencyRegistry;
+        metricsServer.reset(new visifruit::MetricsServer(
+            [registry](const std::string& path, std::string& contentType) -> std::string {
+                if (path == "/metrics") {
+                    contentType = "text/plain; version=0.0.4";
+                    return registry->RenderPrometheus();
+                }
+                if (path == "/status") {
+                    contentType = "application/json";
+                    return registry->RenderJson();
+                }
+                return std::string();
+            }));
         
-        if (hUrl) InternetCloseHandle(hUrl);
-        InternetCloseHandle(hInternet);
+        if (metricsServer->Start(METRICS_PORT)) {
+            AddLog(L"📈 Métricas disponibles en http://127.0.0.1:" + std::to_wstring(METRICS_PORT) + L"/metrics");
+        } else {
+            AddLog(L"⚠️ No se pudo abrir el puerto de métricas " + std::to_wstring(METRICS_PORT));
+            metricsServer.reset();
+        }
+    }
+    
+    void RefreshLatencySummary() {
+        std::wstringstream ss;
+        ss << L"⏱️ p99 (1 min):";
+        ss << std::fixed << std::setprecision(1);
+        
+        for (size_t i = 0; i < latencyRegistry.Size(); ++i) {
+            const visifruit::ServiceLatencyTracker& tracker = latencyRegistry.At(i);
+            std::wstring name(tracker.Name().begin(), tracker.Name().end());
+            visifruit::LatencySummary summary = tracker.Window(1);
+            ss << L"  " << name << L" ";
+            if (summary.count > summary.failed) ss << summary.p99Ms << L" ms";
+            else ss << L"-";
+            
+            // Registrar solo las transiciones de alerta del SLO
+            visifruit::SloAlert alert = tracker.Alert();
+            if (alert != lastAlerts[i]) {
+                if (alert == visifruit::SloAlert::Critical) {
+                    AddLog(L"🚨 SLO crítico en " + name + L": consumo acelerado del presupuesto de error");
+                } else if (alert == visifruit::SloAlert::Warning) {
+                    AddLog(L"⚠️ SLO en riesgo en " + name);
+                } else {
+                    AddLog(L"✅ SLO recuperado en " + name);
+                }
+                lastAlerts[i] = alert;
+            }
+        }
         
-        return isRunning;
+        SetWindowText(hLatencySummary, ss.str().c_str());
     }
     
-    void UpdateServiceStatus() {
-        serviceStatus["backend"] = CheckPort(8001);
-        serviceStatus["frontend"] = CheckPort(3000);
-        serviceStatus["system"] = CheckPort(8000);
+    void StopProbes() {
+        KillTimer(hwnd, TIMER_METRICS_REFRESH);
+        if (canaryRunner) {
+            canaryRunner->Stop();
+            canaryRunner.reset();
+        }
+        if (metricsServer) {
+            metricsServer->Stop();
+            metricsServer.reset();
+        }
+        if (probeScheduler) {
+            probeScheduler->Stop();
+            probeScheduler.reset();
+        }
+    }
+    
+    void HandleProbeResult(size_t index, LPARAM packed) {
+        if (index >= probeTargets.size()) return;
+        
+        visifruit::SupervisorEvent event;
+        event.type = visifruit::EventType::Probe;
+        event.service = static_cast<uint32_t>(index);
+        event.value = static_cast<int32_t>(packed & 1);
+        event.latencyMs = static_cast<float>(packed >> 1) / 1000.0f;
+        DispatchEvent(event);
+    }
+    
+    void HandleStatusChange(uint32_t service, bool isRunning) {
+        if (service >= probeTargets.size()) return;
         
-        // Actualizar indicadores visuales
-        UpdateStatusIndicator(hStatusBackend, serviceStatus["backend"]);
-        UpdateStatusIndicator(hStatusFrontend, serviceStatus["frontend"]);
-        UpdateStatusIndicator(hStatusSystem, serviceStatus["system"]);
+        const std::string& name = probeTargets[service].name;
+        serviceStatus[name] = isRunning;
+        
+        // Actualizar indicador visual solo cuando cambia el estado
+        if (name == "backend") UpdateStatusIndicator(hStatusBackend, isRunning);
+        else if (name == "frontend") UpdateStatusIndicator(hStatusFrontend, isRunning);
+        else if (name == "system") UpdateStatusIndicator(hStatusSystem, isRunning);
+        else if (name == "inference") UpdateStatusIndicator(hStatusInference, isRunning);
     }
     
     void UpdateStatusIndicator(HWND hStatus, bool isRunning) {
@@ -337,6 +753,7 @@ public:
         
         if (ShellExecuteEx(&sei)) {
             AddLog(L"✅ Sistema completo iniciado");
+            for (const char* key : {"backend", "frontend", "system"}) SetExpected(key, true);
             
             // Programar apertura del navegador
             SetTimer(hwnd, 3001, 8000, NULL);  // 8 segundos después
@@ -348,8 +765,11 @@ public:
     void StopAllServices() {
         AddLog(L"⏹️ Deteniendo todos los servicios...");
         
+        // Desde aquí las sondas fallidas son esperadas y no consumen presupuesto de error
+        for (const auto& target : probeTargets) SetExpected(target.name, false);
+        
         // Terminar procesos por puerto usando taskkill
-        std::vector<int> ports = {8000, 8001, 3000};
+        std::vector<int> ports = {8000, 8001, 3000, 9000};
         for (int port : ports) {
             std::wstring cmd = L"taskkill /F /FI \"PID eq $(Get-NetTCPConnection -LocalPort " + 
                               std::to_wstring(port) + L" | Select-Object -ExpandProperty OwningProcess)\"";
@@ -369,7 +789,7 @@ public:
         AddLog(L"✅ Servicios detenidos");
     }
     
-    void StartIndividualService(const std::wstring& service, const std::wstring& scriptName) {
+    void StartIndividualService(const std::wstring& service, const std::wstring& scriptName, const std::string& serviceKey) {
         AddLog(L"🔧 Iniciando " + service + L"...");
         
         SHELLEXECUTEINFO sei = {0};
@@ -382,11 +802,44 @@ public:
         
         if (ShellExecuteEx(&sei)) {
             AddLog(L"✅ " + service + L" iniciado");
+            SetExpected(serviceKey, true);
+            // Vigilar la salida del proceso para registrarla como evento del supervisor
+            WatchProcess(serviceKey, sei.hProcess);
         } else {
             AddLog(L"❌ Error iniciando " + service);
         }
     }
     
+    void StartInferenceServer() {
+        AddLog(L"🧠 Iniciando servidor de inferencia nativo...");
+        
+        if (GetFileAttributes(INFERENCE_SERVER_EXE) == INVALID_FILE_ATTRIBUTES) {
+            AddLog(L"❌ Error: No se encuentra " + std::wstring(INFERENCE_SERVER_EXE));
+            return;
+        }
+        if (GetFileAttributes(L"weights\\best.onnx") == INVALID_FILE_ATTRIBUTES) {
+            AddLog(L"❌ Error: No se encuentra weights\\best.onnx (exportar con IA_Etiquetado\\IATraining\\Export_Onnx.py)");
+            return;
+        }
+        
+        SHELLEXECUTEINFO sei = {0};
+        sei.cbSize = sizeof(SHELLEXECUTEINFO);
+        sei.fMask = SEE_MASK_NOCLOSEPROCESS;
+        sei.hwnd = hwnd;
+        sei.lpVerb = L"open";
+        sei.lpFile = INFERENCE_SERVER_EXE;
+        sei.lpParameters = INFERENCE_SERVER_ARGS;
+        sei.nShow = SW_SHOW;
+        
+        if (ShellExecuteEx(&sei)) {
+            AddLog(L"✅ Servidor de inferencia nativo iniciado en el puerto 9000");
+            SetExpected("inference", true);
+            WatchProcess("inference", sei.hProcess);
+        } else {
+            AddLog(L"❌ Error iniciando servidor de inferencia nativo");
+        }
+    }
+    
     void OpenURL(const std::wstring& url) {
         ShellExecute(hwnd, L"open", url.c_str(), NULL, NULL, SW_SHOWNORMAL);
         AddLog(L"🌐 Abierto: " + url);
@@ -403,15 +856,19 @@ public:
                 break;
                 
             case ID_START_BACKEND:
-                StartIndividualService(L"Backend", L"start_backend.bat");
+                StartIndividualService(L"Backend", L"start_backend.bat", "backend");
                 break;
                 
             case ID_START_FRONTEND:
-                StartIndividualService(L"Frontend", L"start_frontend.bat");
+                StartIndividualService(L"Frontend", L"start_frontend.bat", "frontend");
                 break;
                 
             case ID_START_SYSTEM:
-                StartIndividualService(L"Sistema Principal", L"main_etiquetadora.py");
+                StartIndividualService(L"Sistema Principal", L"main_etiquetadora.py", "system");
+                break;
+                
+            case ID_START_INFERENCE:
+                StartInferenceServer();
                 break;
                 
             case ID_OPEN_FRONTEND:
@@ -430,8 +887,9 @@ public:
     
     void HandleTimer(UINT_PTR timerId) {
         switch (timerId) {
-            case TIMER_STATUS_UPDATE:
-                UpdateServiceStatus();
+            case TIMER_METRICS_REFRESH:
+                RefreshLatencySummary();
+                CheckWatchedProcesses();
                 break;
                 
             case 3001:  // Timer para abrir navegador
@@ -469,6 +927,14 @@ public:
                 HandleTimer(wParam);
                 break;
                 
+            case WM_PROBE_RESULT:
+                HandleProbeResult(static_cast<size_t>(wParam), lParam);
+                break;
+                
+            case WM_CANARY_RESULT:
+                HandleCanaryResult(static_cast<size_t>(wParam), static_cast<size_t>(lParam));
+                break;
+                
             case WM_CTLCOLORSTATIC: {
                 HDC hdc = reinterpret_cast<HDC>(wParam);
                 HWND hControl = reinterpret_cast<HWND>(lParam);
@@ -500,7 +966,8 @@ public:
                 break;
                 
             case WM_DESTROY:
-                KillTimer(hwnd, TIMER_STATUS_UPDATE);
+                StopProbes();
+                traceRecorder.Flush();
                 PostQuitMessage(0);
                 break;
                 
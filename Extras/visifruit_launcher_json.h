@@ -0,0 +1,194 @@
+/**
+ * VisiFruit Launcher - Lector JSON mínimo
+ * ========================================
+ *
+ * Parser JSON recursivo y sin dependencias para leer los manifiestos del
+ * launcher (canario de inferencia, líneas base de benchmarks) y las
+ * respuestas de /infer. No pretende ser completo: sin escapes \u fuera
+ * de ASCII ni validación estricta de números.
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace visifruit {
+
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    bool IsObject() const { return type == Type::Object; }
+    bool IsArray() const { return type == Type::Array; }
+
+    const JsonValue* Get(const std::string& key) const {
+        for (const auto& member : members) {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+
+    double NumberOr(const std::string& key, double fallback) const {
+        const JsonValue* value = Get(key);
+        return (value && value->type == Type::Number) ? value->number : fallback;
+    }
+
+    std::string StringOr(const std::string& key, const std::string& fallback) const {
+        const JsonValue* value = Get(key);
+        return (value && value->type == Type::String) ? value->text : fallback;
+    }
+
+    bool BoolOr(const std::string& key, bool fallback) const {
+        const JsonValue* value = Get(key);
+        return (value && value->type == Type::Bool) ? value->boolean : fallback;
+    }
+};
+
+class JsonParser {
+public:
+    static bool Parse(const std::string& input, JsonValue& out) {
+        JsonParser parser(input);
+        parser.SkipSpace();
+        if (!parser.ParseValue(out, 0)) return false;
+        parser.SkipSpace();
+        return parser.pos == input.size();
+    }
+
+    static bool ParseFile(const std::string& path, JsonValue& out) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return Parse(buffer.str(), out);
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    const std::string& src;
+    size_t pos = 0;
+
+    explicit JsonParser(const std::string& input) : src(input) {}
+
+    void SkipSpace() {
+        while (pos < src.size() && (src[pos] == ' ' || src[pos] == '\t' || src[pos] == '\n' || src[pos] == '\r')) {
+            ++pos;
+        }
+    }
+
+    bool Consume(const char* literal) {
+        size_t len = std::char_traits<char>::length(literal);
+        if (src.compare(pos, len, literal) != 0) return false;
+        pos += len;
+        return true;
+    }
+
+    bool ParseValue(JsonValue& out, int depth) {
+        if (pos >= src.size() || depth > kMaxDepth) return false;
+        char c = src[pos];
+        if (c == '{') return ParseObject(out, depth);
+        if (c == '[') return ParseArray(out, depth);
+        if (c == '"') {
+            out.type = JsonValue::Type::String;
+            return ParseString(out.text);
+        }
+        if (Consume("true")) { out.type = JsonValue::Type::Bool; out.boolean = true; return true; }
+        if (Consume("false")) { out.type = JsonValue::Type::Bool; out.boolean = false; return true; }
+        if (Consume("null")) { out.type = JsonValue::Type::Null; return true; }
+
+        const char* begin = src.c_str() + pos;
+        char* end = nullptr;
+        out.number = std::strtod(begin, &end);
+        if (end == begin) return false;
+        out.type = JsonValue::Type::Number;
+        pos += static_cast<size_t>(end - begin);
+        return true;
+    }
+
+    bool ParseString(std::string& out) {
+        ++pos;  // comilla inicial
+        while (pos < src.size()) {
+            char c = src[pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos >= src.size()) return false;
+            char esc = src[pos++];
+            switch (esc) {
+                case 'n': out.push_back('\n'); break;
+                case 't': out.push_back('\t'); break;
+                case 'r': out.push_back('\r'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'u': {
+                    if (pos + 4 > src.size()) return false;
+                    long code = std::strtol(src.substr(pos, 4).c_str(), nullptr, 16);
+                    pos += 4;
+                    out.push_back(code < 0x80 ? static_cast<char>(code) : '?');
+                    break;
+                }
+                default: out.push_back(esc); break;
+            }
+        }
+        return false;
+    }
+
+    bool ParseArray(JsonValue& out, int depth) {
+        out.type = JsonValue::Type::Array;
+        ++pos;
+        SkipSpace();
+        if (pos < src.size() && src[pos] == ']') { ++pos; return true; }
+        while (pos < src.size()) {
+            out.items.emplace_back();
+            SkipSpace();
+            if (!ParseValue(out.items.back(), depth + 1)) return false;
+            SkipSpace();
+            if (pos < src.size() && src[pos] == ',') { ++pos; continue; }
+            if (pos < src.size() && src[pos] == ']') { ++pos; return true; }
+            return false;
+        }
+        return false;
+    }
+
+    bool ParseObject(JsonValue& out, int depth) {
+        out.type = JsonValue::Type::Object;
+        ++pos;
+        SkipSpace();
+        if (pos < src.size() && src[pos] == '}') { ++pos; return true; }
+        while (pos < src.size()) {
+            SkipSpace();
+            if (pos >= src.size() || src[pos] != '"') return false;
+            std::string key;
+            if (!ParseString(key)) return false;
+            SkipSpace();
+            if (pos >= src.size() || src[pos] != ':') return false;
+            ++pos;
+            SkipSpace();
+            out.members.emplace_back(std::move(key), JsonValue());
+            if (!ParseValue(out.members.back().second, depth + 1)) return false;
+            SkipSpace();
+            if (pos < src.size() && src[pos] == ',') { ++pos; continue; }
+            if (pos < src.size() && src[pos] == '}') { ++pos; return true; }
+            return false;
+        }
+        return false;
+    }
+};
+
+}  // namespace visifruit
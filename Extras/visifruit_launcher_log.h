@@ -0,0 +1,88 @@
+/**
+ * VisiFruit Launcher - Buffer de Registro
+ * ========================================
+ *
+ * Formatea las líneas del registro de actividad ("[HH:MM:SS] mensaje") y
+ * conserva las últimas N en un anillo de capacidad fija, de forma que el
+ * coste de AddLog no crece con la antigüedad de la sesión. Portable para
+ * poder medirlo en los benchmarks de Linux.
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <cwchar>
+#include <string>
+#include <vector>
+
+namespace visifruit {
+
+class LogBuffer {
+public:
+    explicit LogBuffer(size_t maxLines = 2000) : lines(maxLines ? maxLines : 1) {}
+
+    /**
+     * Añade un mensaje con marca de tiempo local y devuelve la línea
+     * formateada (terminada en "\r\n", lista para el control de texto).
+     */
+    const std::wstring& Append(const std::wstring& message) {
+        auto now = std::chrono::system_clock::now();
+        std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+
+        // localtime solo se recalcula cuando cambia el segundo
+        if (seconds != cachedSecond) {
+            std::tm tm = LocalTime(seconds);
+            std::swprintf(cachedStamp, sizeof(cachedStamp) / sizeof(cachedStamp[0]),
+                          L"[%02d:%02d:%02d] ", tm.tm_hour, tm.tm_min, tm.tm_sec);
+            cachedSecond = seconds;
+        }
+
+        std::wstring& line = lines[next];
+        line.assign(cachedStamp);
+        line.append(message);
+        line.append(L"\r\n");
+
+        next = (next + 1) % lines.size();
+        if (count < lines.size()) count++;
+        total++;
+        return line;
+    }
+
+    size_t Size() const { return count; }
+    size_t Capacity() const { return lines.size(); }
+    unsigned long long TotalAppended() const { return total; }
+
+    // Texto completo retenido, de la línea más antigua a la más reciente
+    std::wstring Text() const {
+        std::wstring text;
+        size_t first = (next + lines.size() - count) % lines.size();
+        for (size_t i = 0; i < count; ++i) {
+            text += lines[(first + i) % lines.size()];
+        }
+        return text;
+    }
+
+private:
+    std::vector<std::wstring> lines;
+    size_t next = 0;
+    size_t count = 0;
+    unsigned long long total = 0;
+    std::time_t cachedSecond = static_cast<std::time_t>(-1);
+    wchar_t cachedStamp[16] = {0};
+
+    static std::tm LocalTime(std::time_t seconds) {
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &seconds);
+#else
+        localtime_r(&seconds, &tm);
+#endif
+        return tm;
+    }
+};
+
+}  // namespace visifruit
@@ -0,0 +1,409 @@
+/**
+ * VisiFruit Launcher - Métricas de Latencia y SLO
+ * ================================================
+ *
+ * Histogramas de latencia tipo HDR (log-lineales, ~3% de precisión) por
+ * servicio, con ventanas deslizantes de 1 min / 15 min / 1 h, percentiles
+ * p50/p99/p999 y alertas por tasa de consumo (burn rate) del presupuesto
+ * de error del SLO.
+ *
+ * Las sondas fallidas (conexión rechazada, timeout) cuentan para la
+ * disponibilidad del SLO pero no entran en el histograma: su "latencia" es
+ * la del rechazo o la del timeout, no la del servicio.
+ *
+ * El registro es lock-free y de tiempo constante: un incremento atómico en
+ * el bucket del minuto actual. Los lectores (UI, endpoint /metrics) agregan
+ * los minutos de la ventana sin bloquear a las sondas.
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#include "visifruit_launcher_probe.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace visifruit {
+
+/**
+ * Histograma log-lineal en microsegundos: 32 sub-buckets por potencia de 2,
+ * desde 1 µs hasta ~67 s. Los valores mayores se acumulan en el último bucket.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;
+    static constexpr int kSubCount = 1 << kSubBits;
+    static constexpr int kMaxExponent = 26;
+    static constexpr int kBucketCount = kSubCount + (kMaxExponent - kSubBits + 1) * kSubCount;
+
+    static int BucketIndex(uint64_t micros) {
+        if (micros < static_cast<uint64_t>(kSubCount)) return static_cast<int>(micros);
+        int exponent = HighestBit(micros);
+        if (exponent > kMaxExponent) return kBucketCount - 1;
+        int shift = exponent - kSubBits;
+        return kSubCount + shift * kSubCount + static_cast<int>((micros >> shift) & (kSubCount - 1));
+    }
+
+    // Valor representativo (punto medio) del bucket, en microsegundos
+    static double BucketValue(int index) {
+        if (index < kSubCount) return static_cast<double>(index);
+        int shift = (index - kSubCount) / kSubCount;
+        uint64_t mantissa = static_cast<uint64_t>(kSubCount + (index - kSubCount) % kSubCount);
+        uint64_t lower = mantissa << shift;
+        return static_cast<double>(lower) + static_cast<double>((uint64_t(1) << shift) - 1) / 2.0;
+    }
+
+    void Record(uint64_t micros) {
+        counts[BucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Clear() {
+        for (auto& count : counts) count.store(0, std::memory_order_relaxed);
+    }
+
+    void AddTo(std::vector<uint64_t>& totals) const {
+        for (int i = 0; i < kBucketCount; ++i) {
+            totals[i] += counts[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Percentil (0-100) sobre un vector de cuentas agregadas, en milisegundos
+    static double Percentile(const std::vector<uint64_t>& totals, uint64_t totalCount, double percentile) {
+        if (totalCount == 0) return 0.0;
+        uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(totalCount));
+        if (rank >= totalCount) rank = totalCount - 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount; ++i) {
+            seen += totals[i];
+            if (seen > rank) return BucketValue(i) / 1000.0;
+        }
+        return BucketValue(kBucketCount - 1) / 1000.0;
+    }
+
+private:
+    std::array<std::atomic<uint32_t>, kBucketCount> counts{};
+
+    static int HighestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        int bit = 0;
+        while (value >>= 1) ++bit;
+        return bit;
+#endif
+    }
+};
+
+struct SloConfig {
+    double thresholdMs = 250.0;    // Una sonda más lenta que esto cuenta como "mala"
+    double objective = 0.99;       // Fracción objetivo de sondas buenas
+};
+
+enum class SloAlert { None, Warning, Critical };
+
+struct LatencySummary {
+    uint64_t count = 0;             // Todas las sondas de la ventana
+    uint64_t bad = 0;               // Fallidas o más lentas que el umbral del SLO
+    uint64_t failed = 0;            // Fallidas (fuera de los percentiles)
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double p999Ms = 0.0;
+    double burnRate = 0.0;
+};
+
+/**
+ * Latencias de un servicio agrupadas por minuto en un anillo de 61 slots
+ * (1 h + el minuto en curso). Cada slot se reinicia de forma perezosa
+ * cuando el primer registro de un minuto nuevo lo reclama con un CAS.
+ * Una ventana de N minutos agrega los N minutos completos más el actual.
+ */
+class ServiceLatencyTracker {
+public:
+    static constexpr int kWindowMinutes[3] = {1, 15, 60};
+    static constexpr int kSlotCount = 61;
+
+    ServiceLatencyTracker(std::string serviceName, SloConfig sloConfig,
+                          SteadyClock::time_point origin = SteadyClock::now())
+        : name(std::move(serviceName)), slo(sloConfig), start(origin) {}
+
+    const std::string& Name() const { return name; }
+    const SloConfig& Slo() const { return slo; }
+
+    void Record(double latencyMs, bool ok, SteadyClock::time_point now = SteadyClock::now()) {
+        Slot& slot = SlotFor(MinuteOf(now));
+        slot.total.fetch_add(1, std::memory_order_relaxed);
+        if (!ok) {
+            slot.failed.fetch_add(1, std::memory_order_relaxed);
+            slot.bad.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        slot.hist.Record(static_cast<uint64_t>(latencyMs * 1000.0));
+        if (latencyMs > slo.thresholdMs) {
+            slot.bad.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    LatencySummary Window(int minutes, SteadyClock::time_point now = SteadyClock::now()) const {
+        LatencySummary summary;
+        std::vector<uint64_t> totals(LatencyHistogram::kBucketCount, 0);
+        int64_t current = MinuteOf(now);
+
+        for (const Slot& slot : slots) {
+            int64_t minute = slot.minute.load(std::memory_order_acquire);
+            if (minute < 0 || minute > current || current - minute > minutes) continue;
+            slot.hist.AddTo(totals);
+            summary.count += slot.total.load(std::memory_order_relaxed);
+            summary.bad += slot.bad.load(std::memory_order_relaxed);
+            summary.failed += slot.failed.load(std::memory_order_relaxed);
+        }
+
+        uint64_t measured = summary.count - summary.failed;
+        summary.p50Ms = LatencyHistogram::Percentile(totals, measured, 50.0);
+        summary.p99Ms = LatencyHistogram::Percentile(totals, measured, 99.0);
+        summary.p999Ms = LatencyHistogram::Percentile(totals, measured, 99.9);
+        if (summary.count > 0) {
+            double errorBudget = 1.0 - slo.objective;
+            double badRatio = static_cast<double>(summary.bad) / static_cast<double>(summary.count);
+            summary.burnRate = errorBudget > 0.0 ? badRatio / errorBudget : 0.0;
+        }
+        return summary;
+    }
+
+    /**
+     * Alerta multi-ventana: crítica si se consume el presupuesto a >14.4x
+     * en 1 min y 1 h (2% del presupuesto mensual en 1 h); aviso si >6x en
+     * 15 min y 1 h.
+     */
+    SloAlert Alert(SteadyClock::time_point now = SteadyClock::now()) const {
+        double burn1m = Window(1, now).burnRate;
+        double burn15m = Window(15, now).burnRate;
+        double burn1h = Window(60, now).burnRate;
+        if (burn1m >= 14.4 && burn1h >= 14.4) return SloAlert::Critical;
+        if (burn15m >= 6.0 && burn1h >= 6.0) return SloAlert::Warning;
+        return SloAlert::None;
+    }
+
+private:
+    struct Slot {
+        std::atomic<int64_t> minute{-1};
+        std::atomic<uint64_t> total{0};
+        std::atomic<uint64_t> bad{0};
+        std::atomic<uint64_t> failed{0};
+        LatencyHistogram hist;
+    };
+
+    std::string name;
+    SloConfig slo;
+    SteadyClock::time_point start;
+    std::array<Slot, kSlotCount> slots;
+
+    int64_t MinuteOf(SteadyClock::time_point now) const {
+        return std::chrono::duration_cast<std::chrono::minutes>(now - start).count();
+    }
+
+    Slot& SlotFor(int64_t minute) {
+        Slot& slot = slots[static_cast<size_t>(minute % kSlotCount)];
+        int64_t seen = slot.minute.load(std::memory_order_acquire);
+        if (seen < minute &&
+            slot.minute.compare_exchange_strong(seen, minute, std::memory_order_acq_rel)) {
+            // Solo el hilo que gana el CAS limpia el slot del minuto antiguo
+            slot.hist.Clear();
+            slot.total.store(0, std::memory_order_relaxed);
+            slot.bad.store(0, std::memory_order_relaxed);
+            slot.failed.store(0, std::memory_order_relaxed);
+        }
+        return slot;
+    }
+};
+
+inline const char* SloAlertName(SloAlert alert) {
+    switch (alert) {
+        case SloAlert::Critical: return "critical";
+        case SloAlert::Warning: return "warning";
+        default: return "ok";
+    }
+}
+
+/**
+ * Conjunto fijo de trackers (uno por servicio) creado al arrancar, de modo
+ * que las sondas acceden por índice sin bloqueos.
+ */
+class LatencyRegistry {
+public:
+    ServiceLatencyTracker& Add(const std::string& name, const SloConfig& slo) {
+        trackers.emplace_back(new ServiceLatencyTracker(name, slo));
+        return *trackers.back();
+    }
+
+    size_t Size() const { return trackers.size(); }
+    ServiceLatencyTracker& At(size_t index) { return *trackers[index]; }
+    const ServiceLatencyTracker& At(size_t index) const { return *trackers[index]; }
+
+    // Formato de exposición de Prometheus
+    std::string RenderPrometheus() const {
+        static const char* kWindowNames[] = {"1m", "15m", "1h"};
+        std::ostringstream out;
+        out << "# TYPE visifruit_probe_latency_ms gauge\n"
+               "# TYPE visifruit_probe_total gauge\n"
+               "# TYPE visifruit_probe_bad_total gauge\n"
+               "# TYPE visifruit_probe_failed_total gauge\n"
+               "# TYPE visifruit_slo_burn_rate gauge\n"
+               "# TYPE visifruit_slo_alert gauge\n";
+        auto now = SteadyClock::now();
+        for (const auto& tracker : trackers) {
+            const std::string& service = tracker->Name();
+            for (int w = 0; w < 3; ++w) {
+                LatencySummary s = tracker->Window(ServiceLatencyTracker::kWindowMinutes[w], now);
+                std::string labels = "service=\"" + service + "\",window=\"" + kWindowNames[w] + "\"";
+                out << "visifruit_probe_latency_ms{" << labels << ",quantile=\"0.5\"} " << s.p50Ms << "\n"
+                    << "visifruit_probe_latency_ms{" << labels << ",quantile=\"0.99\"} " << s.p99Ms << "\n"
+                    << "visifruit_probe_latency_ms{" << labels << ",quantile=\"0.999\"} " << s.p999Ms << "\n"
+                    << "visifruit_probe_total{" << labels << "} " << s.count << "\n"
+                    << "visifruit_probe_bad_total{" << labels << "} " << s.bad << "\n"
+                    << "visifruit_probe_failed_total{" << labels << "} " << s.failed << "\n"
+                    << "visifruit_slo_burn_rate{" << labels << "} " << s.burnRate << "\n";
+            }
+            out << "visifruit_slo_alert{service=\"" << service << "\"} "
+                << static_cast<int>(tracker->Alert(now)) << "\n";
+        }
+        return out.str();
+    }
+
+    std::string RenderJson() const {
+        static const char* kWindowNames[] = {"1m", "15m", "1h"};
+        std::ostringstream out;
+        auto now = SteadyClock::now();
+        out << "{\"services\":{";
+        for (size_t i = 0; i < trackers.size(); ++i) {
+            const auto& tracker = trackers[i];
+            if (i) out << ",";
+            out << "\"" << tracker->Name() << "\":{"
+                << "\"slo\":{\"threshold_ms\":" << tracker->Slo().thresholdMs
+                << ",\"objective\":" << tracker->Slo().objective << "},"
+                << "\"alert\":\"" << SloAlertName(tracker->Alert(now)) << "\",\"windows\":{";
+            for (int w = 0; w < 3; ++w) {
+                LatencySummary s = tracker->Window(ServiceLatencyTracker::kWindowMinutes[w], now);
+                if (w) out << ",";
+                out << "\"" << kWindowNames[w] << "\":{\"count\":" << s.count << ",\"bad\":" << s.bad
+                    << ",\"failed\":" << s.failed
+                    << ",\"p50_ms\":" << s.p50Ms << ",\"p99_ms\":" << s.p99Ms
+                    << ",\"p999_ms\":" << s.p999Ms << ",\"burn_rate\":" << s.burnRate << "}";
+            }
+            out << "}}";
+        }
+        out << "}}";
+        return out.str();
+    }
+
+private:
+    std::vector<std::unique_ptr<ServiceLatencyTracker>> trackers;
+};
+
+/**
+ * Servidor HTTP mínimo (solo GET, Connection: close) para exponer
+ * /metrics y /status en localhost desde un hilo propio.
+ */
+class MetricsServer {
+public:
+    // Devuelve el cuerpo para la ruta pedida; contentType vacío = 404
+    using Handler = std::function<std::string(const std::string& path, std::string& contentType)>;
+
+    explicit MetricsServer(Handler requestHandler) : handler(std::move(requestHandler)) {}
+    ~MetricsServer() { Stop(); }
+
+    bool Start(int port) {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener == kInvalidSocket) return false;
+
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(listener, 8) != 0) {
+            detail::CloseSocket(listener);
+            listener = kInvalidSocket;
+            return false;
+        }
+
+        running = true;
+        worker = std::thread([this] { Loop(); });
+        return true;
+    }
+
+    void Stop() {
+        if (!running.exchange(false)) return;
+        if (worker.joinable()) worker.join();
+        detail::CloseSocket(listener);
+        listener = kInvalidSocket;
+    }
+
+private:
+    Handler handler;
+    socket_t listener = kInvalidSocket;
+    std::atomic<bool> running{false};
+    std::thread worker;
+
+    void Loop() {
+        while (running) {
+            // Despertar periódicamente para poder detener el hilo
+            auto deadline = SteadyClock::now() + std::chrono::milliseconds(200);
+            if (!detail::WaitFor(listener, false, deadline)) continue;
+
+            socket_t client = accept(listener, nullptr, nullptr);
+            if (client == kInvalidSocket) continue;
+            detail::SetNonBlocking(client);
+            Serve(client);
+            detail::CloseSocket(client);
+        }
+    }
+
+    void Serve(socket_t client) {
+        auto deadline = SteadyClock::now() + std::chrono::milliseconds(500);
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            int n = detail::RecvSome(client, buffer, sizeof(buffer), deadline);
+            if (n <= 0) return;
+            request.append(buffer, static_cast<size_t>(n));
+        }
+
+        std::string path;
+        if (request.compare(0, 4, "GET ") == 0) {
+            auto end = request.find(' ', 4);
+            if (end != std::string::npos) path = request.substr(4, end - 4);
+        }
+
+        std::string contentType;
+        std::string body = path.empty() ? std::string() : handler(path, contentType);
+        std::string status = "200 OK";
+        if (contentType.empty()) {
+            status = "404 Not Found";
+            contentType = "text/plain";
+            body = "not found\n";
+        }
+
+        std::string response = "HTTP/1.1 " + status + "\r\n"
+                               "Content-Type: " + contentType + "\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                               "Connection: close\r\n\r\n" + body;
+        detail::SendAll(client, response.data(), response.size(), deadline);
+    }
+};
+
+}  // namespace visifruit
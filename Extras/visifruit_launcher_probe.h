@@ -0,0 +1,615 @@
+/**
+ * VisiFruit Launcher - Sondas de Salud de Servicios
+ * ==================================================
+ *
+ * Sondas ligeras para vigilar los servicios lanzados por el launcher nativo.
+ * Sustituye al antiguo CheckPort() (una sesión WinInet + conexión HTTP nueva
+ * en cada llamada) por sondas persistentes seleccionables por servicio:
+ *
+ * - http://host:puerto/ruta  -> GET keep-alive sobre una conexión reutilizada
+ * - tcp://host:puerto        -> solo connect(), sin petición HTTP (sin ruido en logs)
+ * - udp://host:puerto        -> datagrama "PING" y espera de cualquier respuesta
+ * - unix:///ruta/al/socket   -> "PING\n" sobre un socket unix persistente
+ *
+ * Header-only y portable (Winsock / BSD sockets) para que el mismo código
+ * se compile en el launcher de Windows y en las herramientas de Linux.
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#  if defined(__has_include)
+#    if __has_include(<afunix.h>)
+#      include <afunix.h>
+#      define VISIFRUIT_HAS_AF_UNIX 1
+#    endif
+#  endif
+#else
+#  include <sys/socket.h>
+#  include <sys/un.h>
+#  include <sys/select.h>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <netdb.h>
+#  include <unistd.h>
+#  include <fcntl.h>
+#  include <errno.h>
+#  include <signal.h>
+#  define VISIFRUIT_HAS_AF_UNIX 1
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace visifruit {
+
+#ifdef _WIN32
+using socket_t = SOCKET;
+static const socket_t kInvalidSocket = INVALID_SOCKET;
+#else
+using socket_t = int;
+static const socket_t kInvalidSocket = -1;
+#endif
+
+using SteadyClock = std::chrono::steady_clock;
+
+// Tipos de sonda disponibles por servicio
+enum class ProbeKind { Http, Tcp, Udp, Unix };
+
+struct ProbeTarget {
+    std::string name;
+    ProbeKind kind = ProbeKind::Http;
+    std::string host = "127.0.0.1";
+    int port = 0;
+    std::string path = "/health";   // Http: ruta del endpoint; Unix: ruta del socket
+    int intervalMs = 1000;
+    int timeoutMs = 500;
+};
+
+struct ProbeResult {
+    bool ok = false;
+    bool reused = false;            // Se reutilizó una conexión keep-alive
+    int httpStatus = 0;
+    double latencyMs = 0.0;
+};
+
+/**
+ * Inicialización de la pila de red (WSAStartup en Windows, ignorar SIGPIPE en POSIX).
+ * Debe existir una instancia mientras se usen sondas.
+ */
+class SocketRuntime {
+public:
+    SocketRuntime() {
+#ifdef _WIN32
+        WSADATA wsaData;
+        ready = (WSAStartup(MAKEWORD(2, 2), &wsaData) == 0);
+#else
+        signal(SIGPIPE, SIG_IGN);
+        ready = true;
+#endif
+    }
+
+    ~SocketRuntime() {
+#ifdef _WIN32
+        if (ready) WSACleanup();
+#endif
+    }
+
+    SocketRuntime(const SocketRuntime&) = delete;
+    SocketRuntime& operator=(const SocketRuntime&) = delete;
+
+    bool IsReady() const { return ready; }
+
+private:
+    bool ready = false;
+};
+
+namespace detail {
+
+inline void CloseSocket(socket_t sock) {
+    if (sock == kInvalidSocket) return;
+#ifdef _WIN32
+    closesocket(sock);
+#else
+    close(sock);
+#endif
+}
+
+inline bool SetNonBlocking(socket_t sock) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(sock, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+    return flags >= 0 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+inline bool WouldBlock() {
+#ifdef _WIN32
+    int err = WSAGetLastError();
+    return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS;
+#else
+    return errno == EINPROGRESS || errno == EWOULDBLOCK || errno == EAGAIN;
+#endif
+}
+
+inline int RemainingMs(SteadyClock::time_point deadline) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - SteadyClock::now()).count();
+    return left > 0 ? static_cast<int>(left) : 0;
+}
+
+// Espera a que el socket sea legible/escribible antes del deadline
+inline bool WaitFor(socket_t sock, bool forWrite, SteadyClock::time_point deadline) {
+    int timeoutMs = RemainingMs(deadline);
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(sock, &fds);
+    fd_set errFds;
+    FD_ZERO(&errFds);
+    FD_SET(sock, &errFds);
+    timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    int rc = select(static_cast<int>(sock) + 1,
+                    forWrite ? nullptr : &fds,
+                    forWrite ? &fds : nullptr,
+                    &errFds, &tv);
+    return rc > 0 && FD_ISSET(sock, &fds);
+}
+
+inline socket_t ConnectWithTimeout(const sockaddr* addr, int addrLen, int type,
+                                   SteadyClock::time_point deadline) {
+    socket_t sock = socket(addr->sa_family, type, 0);
+    if (sock == kInvalidSocket) return kInvalidSocket;
+    if (!SetNonBlocking(sock)) {
+        CloseSocket(sock);
+        return kInvalidSocket;
+    }
+
+    if (type == SOCK_STREAM && addr->sa_family != AF_UNIX) {
+        int one = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+    }
+
+    if (connect(sock, addr, addrLen) != 0) {
+        if (!WouldBlock() || !WaitFor(sock, true, deadline)) {
+            CloseSocket(sock);
+            return kInvalidSocket;
+        }
+        int soError = 0;
+        socklen_t len = sizeof(soError);
+        getsockopt(sock, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&soError), &len);
+        if (soError != 0) {
+            CloseSocket(sock);
+            return kInvalidSocket;
+        }
+    }
+    return sock;
+}
+
+inline bool SendAll(socket_t sock, const char* data, size_t len, SteadyClock::time_point deadline) {
+    size_t sent = 0;
+    while (sent < len) {
+        int n = static_cast<int>(send(sock, data + sent, static_cast<int>(len - sent), 0));
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && WouldBlock() && WaitFor(sock, true, deadline)) continue;
+        return false;
+    }
+    return true;
+}
+
+// Devuelve bytes leídos, 0 si el par cerró, -1 en error/timeout
+inline int RecvSome(socket_t sock, char* buffer, size_t capacity, SteadyClock::time_point deadline) {
+    for (;;) {
+        int n = static_cast<int>(recv(sock, buffer, static_cast<int>(capacity), 0));
+        if (n >= 0) return n;
+        if (!WouldBlock() || !WaitFor(sock, false, deadline)) return -1;
+    }
+}
+
+inline std::string ToLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+/**
+ * Lee una respuesta HTTP/1.x completa. El cuerpo se delimita por
+ * Content-Length o chunked; 1xx intermedios se descartan y 204, 304 y las
+ * respuestas a HEAD no tienen cuerpo. Sin longitud solo se lee hasta el
+ * cierre si el servidor lo anuncia (Connection: close o HTTP/1.0) y falla si
+ * vence el deadline antes; una respuesta keep-alive sin longitud no puede
+ * delimitarse y se rechaza. Si body no es nulo se devuelve el cuerpo;
+ * keepAlive indica si la conexión puede reutilizarse.
+ */
+inline bool ReadHttpResponse(socket_t sock, std::vector<char>& scratch, SteadyClock::time_point deadline,
+                             int& status, bool& keepAlive, std::string* body = nullptr,
+                             bool headRequest = false) {
+    std::string data;
+    std::string headers;
+
+    auto readMore = [&]() -> bool {
+        int n = RecvSome(sock, scratch.data(), scratch.size(), deadline);
+        if (n <= 0) return false;
+        data.append(scratch.data(), static_cast<size_t>(n));
+        return true;
+    };
+
+    for (;;) {
+        size_t headerEnd;
+        while ((headerEnd = data.find("\r\n\r\n")) == std::string::npos) {
+            if (data.size() > 64 * 1024 || !readMore()) return false;
+        }
+
+        headers = ToLower(data.substr(0, headerEnd));
+        data.erase(0, headerEnd + 4);
+        if (headers.compare(0, 5, "http/") != 0) return false;
+        auto space = headers.find(' ');
+        if (space == std::string::npos) return false;
+        status = std::atoi(headers.c_str() + space + 1);
+        // 100 Continue / 103 Early Hints: la respuesta final viene a continuación
+        if (status < 100 || status >= 200 || status == 101) break;
+    }
+
+    bool http10 = headers.compare(0, 8, "http/1.0") == 0;
+    bool closeAnnounced = headers.find("\r\nconnection: close") != std::string::npos;
+    keepAlive = !http10 && !closeAnnounced;
+    if (body) body->clear();
+
+    if (headRequest || status == 101 || status == 204 || status == 304) return true;
+
+    auto lengthPos = headers.find("\r\ncontent-length:");
+    bool chunked = headers.find("\r\ntransfer-encoding: chunked") != std::string::npos;
+
+    if (chunked) {
+        size_t cursor = 0;
+        for (;;) {
+            size_t lineEnd;
+            while ((lineEnd = data.find("\r\n", cursor)) == std::string::npos) {
+                if (!readMore()) return false;
+            }
+            size_t chunkSize = static_cast<size_t>(std::strtoull(data.c_str() + cursor, nullptr, 16));
+            cursor = lineEnd + 2;
+            while (data.size() < cursor + chunkSize + 2) {
+                if (!readMore()) return false;
+            }
+            if (chunkSize == 0) return true;
+            if (body) body->append(data, cursor, chunkSize);
+            cursor += chunkSize + 2;
+        }
+    }
+
+    if (lengthPos != std::string::npos) {
+        size_t bodyLength = static_cast<size_t>(std::strtoull(headers.c_str() + lengthPos + 17, nullptr, 10));
+        while (data.size() < bodyLength) {
+            if (!readMore()) return false;
+        }
+        if (body) body->assign(data, 0, bodyLength);
+        return true;
+    }
+
+    // Sin longitud: el cuerpo termina al cerrar la conexión, solo si el servidor la cierra
+    keepAlive = false;
+    if (!http10 && !closeAnnounced) return false;
+    for (;;) {
+        int n = RecvSome(sock, scratch.data(), scratch.size(), deadline);
+        if (n == 0) break;
+        if (n < 0) return false;
+        data.append(scratch.data(), static_cast<size_t>(n));
+    }
+    if (body) *body = data;
+    return true;
+}
+
+}  // namespace detail
+
+/**
+ * Interpreta especificaciones del tipo:
+ *   http://127.0.0.1:8001/health, tcp://127.0.0.1:3000,
+ *   udp://127.0.0.1:9999, unix:///tmp/visifruit.sock
+ */
+inline bool ParseProbeSpec(const std::string& spec, ProbeTarget& target) {
+    auto schemeEnd = spec.find("://");
+    if (schemeEnd == std::string::npos) return false;
+
+    std::string scheme = detail::ToLower(spec.substr(0, schemeEnd));
+    std::string rest = spec.substr(schemeEnd + 3);
+
+    if (scheme == "unix") {
+        if (rest.empty()) return false;
+        target.kind = ProbeKind::Unix;
+        target.path = rest;
+        target.port = 0;
+        return true;
+    }
+
+    if (scheme == "http") target.kind = ProbeKind::Http;
+    else if (scheme == "tcp") target.kind = ProbeKind::Tcp;
+    else if (scheme == "udp") target.kind = ProbeKind::Udp;
+    else return false;
+
+    auto slash = rest.find('/');
+    std::string hostPort = rest.substr(0, slash);
+    if (target.kind == ProbeKind::Http) {
+        target.path = (slash == std::string::npos) ? "/" : rest.substr(slash);
+    }
+
+    auto colon = hostPort.rfind(':');
+    if (colon == std::string::npos) return false;
+    target.host = hostPort.substr(0, colon);
+    try {
+        target.port = std::stoi(hostPort.substr(colon + 1));
+    } catch (...) {
+        return false;
+    }
+    return !target.host.empty() && target.port > 0 && target.port < 65536;
+}
+
+/**
+ * Sonda de un servicio. Mantiene abierta la conexión (HTTP keep-alive o
+ * socket unix) entre ciclos y solo reconecta cuando el servidor la cierra.
+ * No es thread-safe: cada sonda la usa un único hilo (ProbeScheduler).
+ */
+class ServiceProber {
+public:
+    explicit ServiceProber(ProbeTarget probeTarget) : target(std::move(probeTarget)) {}
+    ~ServiceProber() { Disconnect(); }
+
+    ServiceProber(const ServiceProber&) = delete;
+    ServiceProber& operator=(const ServiceProber&) = delete;
+
+    const ProbeTarget& Target() const { return target; }
+    uint64_t ConnectionsOpened() const { return connectionsOpened; }
+    uint64_t ProbesSent() const { return probesSent; }
+
+    ProbeResult Probe() {
+        auto start = SteadyClock::now();
+        auto deadline = start + std::chrono::milliseconds(target.timeoutMs);
+        ProbeResult result;
+
+        switch (target.kind) {
+            case ProbeKind::Http: result = ProbeHttp(deadline); break;
+            case ProbeKind::Tcp:  result = ProbeTcp(deadline); break;
+            case ProbeKind::Udp:  result = ProbeUdp(deadline); break;
+            case ProbeKind::Unix: result = ProbeUnix(deadline); break;
+        }
+
+        probesSent++;
+        result.latencyMs = std::chrono::duration<double, std::milli>(SteadyClock::now() - start).count();
+        return result;
+    }
+
+    void Disconnect() {
+        detail::CloseSocket(sock);
+        sock = kInvalidSocket;
+    }
+
+private:
+    ProbeTarget target;
+    socket_t sock = kInvalidSocket;
+    sockaddr_storage cachedAddr{};
+    int cachedAddrLen = 0;
+    uint64_t connectionsOpened = 0;
+    uint64_t probesSent = 0;
+    std::string request;
+    std::vector<char> recvBuffer = std::vector<char>(4096);
+
+    bool Resolve(int type) {
+        if (cachedAddrLen > 0) return true;
+
+        if (target.kind == ProbeKind::Unix) {
+#ifdef VISIFRUIT_HAS_AF_UNIX
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            if (target.path.size() >= sizeof(addr.sun_path)) return false;
+            std::memcpy(addr.sun_path, target.path.c_str(), target.path.size() + 1);
+            std::memcpy(&cachedAddr, &addr, sizeof(addr));
+            cachedAddrLen = static_cast<int>(sizeof(addr));
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = type;
+        addrinfo* info = nullptr;
+        std::string port = std::to_string(target.port);
+        if (getaddrinfo(target.host.c_str(), port.c_str(), &hints, &info) != 0 || !info) {
+            return false;
+        }
+        std::memcpy(&cachedAddr, info->ai_addr, info->ai_addrlen);
+        cachedAddrLen = static_cast<int>(info->ai_addrlen);
+        freeaddrinfo(info);
+        return true;
+    }
+
+    bool EnsureConnected(int type, SteadyClock::time_point deadline, bool& reused) {
+        reused = (sock != kInvalidSocket);
+        if (reused) return true;
+        if (!Resolve(type)) return false;
+
+        sock = detail::ConnectWithTimeout(reinterpret_cast<const sockaddr*>(&cachedAddr),
+                                          cachedAddrLen, type, deadline);
+        if (sock == kInvalidSocket) return false;
+        connectionsOpened++;
+        return true;
+    }
+
+    ProbeResult ProbeTcp(SteadyClock::time_point deadline) {
+        ProbeResult result;
+        bool reused = false;
+        // Conexión efímera: solo se comprueba que el puerto acepta conexiones
+        result.ok = EnsureConnected(SOCK_STREAM, deadline, reused);
+        if (result.ok) {
+            // Cierre con RST: evita acumular sockets en TIME_WAIT con intervalos cortos
+            linger abortive;
+            abortive.l_onoff = 1;
+            abortive.l_linger = 0;
+            setsockopt(sock, SOL_SOCKET, SO_LINGER, reinterpret_cast<const char*>(&abortive), sizeof(abortive));
+        }
+        Disconnect();
+        return result;
+    }
+
+    ProbeResult ProbeUdp(SteadyClock::time_point deadline) {
+        ProbeResult result;
+        bool reused = false;
+        if (!EnsureConnected(SOCK_DGRAM, deadline, reused)) return result;
+        result.reused = reused;
+
+        static const char kPing[] = "PING";
+        if (!detail::SendAll(sock, kPing, sizeof(kPing) - 1, deadline)) {
+            Disconnect();
+            return result;
+        }
+        // Un ICMP "port unreachable" llega como error de recv en sockets UDP conectados
+        int n = detail::RecvSome(sock, recvBuffer.data(), recvBuffer.size(), deadline);
+        result.ok = n > 0;
+        if (n < 0) Disconnect();
+        return result;
+    }
+
+    ProbeResult ProbeUnix(SteadyClock::time_point deadline) {
+        ProbeResult result;
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            bool reused = false;
+            if (!EnsureConnected(SOCK_STREAM, deadline, reused)) return result;
+            result.reused = reused;
+
+            static const char kPing[] = "PING\n";
+            if (detail::SendAll(sock, kPing, sizeof(kPing) - 1, deadline)) {
+                int n = detail::RecvSome(sock, recvBuffer.data(), recvBuffer.size(), deadline);
+                if (n > 0) {
+                    result.ok = true;
+                    return result;
+                }
+            }
+            Disconnect();
+            // Solo se reintenta si la conexión reutilizada estaba caducada
+            if (!reused) break;
+        }
+        return result;
+    }
+
+    ProbeResult ProbeHttp(SteadyClock::time_point deadline) {
+        ProbeResult result;
+        if (request.empty()) {
+            request = "GET " + target.path + " HTTP/1.1\r\n"
+                      "Host: " + target.host + ":" + std::to_string(target.port) + "\r\n"
+                      "User-Agent: VisiFruit-Launcher\r\n"
+                      "Connection: keep-alive\r\n\r\n";
+        }
+
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            bool reused = false;
+            if (!EnsureConnected(SOCK_STREAM, deadline, reused)) return result;
+            result.reused = reused;
+
+            bool keepAlive = false;
+            if (detail::SendAll(sock, request.data(), request.size(), deadline) &&
+                detail::ReadHttpResponse(sock, recvBuffer, deadline, result.httpStatus, keepAlive)) {
+                if (!keepAlive) Disconnect();
+                result.ok = result.httpStatus > 0 && result.httpStatus < 500;
+                return result;
+            }
+
+            Disconnect();
+            // El servidor puede haber cerrado la conexión keep-alive por inactividad
+            if (!reused) break;
+        }
+        return result;
+    }
+};
+
+/**
+ * Ejecuta las sondas según el intervalo de cada servicio (admite intervalos
+ * por debajo del segundo) y notifica cada resultado. Cada sonda tiene su
+ * propio hilo: una sonda bloqueada hasta su timeout no retrasa a las demás
+ * ni altera la latencia que miden. El callback se invoca desde esos hilos.
+ */
+class ProbeScheduler {
+public:
+    using Callback = std::function<void(size_t index, const ProbeResult& result)>;
+
+    ProbeScheduler(const std::vector<ProbeTarget>& targets, Callback onResult)
+        : callback(std::move(onResult)) {
+        for (const auto& target : targets) {
+            probers.emplace_back(new ServiceProber(target));
+        }
+    }
+
+    ~ProbeScheduler() { Stop(); }
+
+    void Start() {
+        if (running.exchange(true)) return;
+        for (size_t i = 0; i < probers.size(); ++i) {
+            workers.emplace_back([this, i] { Loop(i); });
+        }
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running.exchange(false)) return;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers) {
+            if (worker.joinable()) worker.join();
+        }
+        workers.clear();
+    }
+
+    size_t Size() const { return probers.size(); }
+    const ServiceProber& Prober(size_t index) const { return *probers[index]; }
+
+private:
+    std::vector<std::unique_ptr<ServiceProber>> probers;
+    Callback callback;
+    std::atomic<bool> running{false};
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+
+    void Loop(size_t index) {
+        ServiceProber& prober = *probers[index];
+        auto interval = std::chrono::milliseconds(prober.Target().intervalMs);
+
+        while (running) {
+            auto start = SteadyClock::now();
+            ProbeResult result = prober.Probe();
+            if (callback && running) callback(index, result);
+
+            // Intervalo entre inicios de sonda; si la sonda tardó más, la siguiente sale ya
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait_until(lock, start + interval, [this] { return !running; });
+        }
+    }
+};
+
+}  // namespace visifruit
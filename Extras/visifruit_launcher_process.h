@@ -0,0 +1,157 @@
+/**
+ * VisiFruit Launcher - Procesos Hijos
+ * ====================================
+ *
+ * Lanzamiento y parada de procesos hijos de forma portable:
+ * CreateProcess (con grupo de procesos propio para CTRL_BREAK) en Windows
+ * y posix_spawnp + SIGTERM/SIGKILL en Linux. La parada es ordenada con un
+ * periodo de gracia y después forzada.
+ *
+ * Lo usan los benchmarks para arrancar el servicio simulado. El launcher
+ * no lo usa: arranca los servicios con ShellExecuteEx.
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <windows.h>
+#else
+#  include <spawn.h>
+#  include <signal.h>
+#  include <sys/types.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+extern char** environ;
+#endif
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace visifruit {
+
+class ChildProcess {
+public:
+    ChildProcess() = default;
+    ~ChildProcess() { Stop(0); }
+
+    ChildProcess(const ChildProcess&) = delete;
+    ChildProcess& operator=(const ChildProcess&) = delete;
+
+    bool Spawn(const std::vector<std::string>& argv) {
+        if (argv.empty() || IsRunning()) return false;
+        exitCode = -1;
+
+#ifdef _WIN32
+        std::string commandLine;
+        for (const auto& arg : argv) {
+            if (!commandLine.empty()) commandLine += ' ';
+            commandLine += (arg.find(' ') != std::string::npos) ? "\"" + arg + "\"" : arg;
+        }
+        STARTUPINFOA si = {0};
+        si.cb = sizeof(si);
+        PROCESS_INFORMATION pi = {0};
+        if (!CreateProcessA(NULL, &commandLine[0], NULL, NULL, FALSE,
+                            CREATE_NEW_PROCESS_GROUP, NULL, NULL, &si, &pi)) {
+            return false;
+        }
+        CloseHandle(pi.hThread);
+        process = pi.hProcess;
+        pid = pi.dwProcessId;
+        return true;
+#else
+        std::vector<char*> args;
+        for (const auto& arg : argv) args.push_back(const_cast<char*>(arg.c_str()));
+        args.push_back(nullptr);
+
+        pid_t child = 0;
+        if (posix_spawnp(&child, args[0], nullptr, nullptr, args.data(), environ) != 0) {
+            return false;
+        }
+        pid = child;
+        return true;
+#endif
+    }
+
+    bool IsRunning() {
+#ifdef _WIN32
+        if (!process) return false;
+        if (WaitForSingleObject(process, 0) == WAIT_TIMEOUT) return true;
+        Reap();
+        return false;
+#else
+        if (pid <= 0) return false;
+        int status = 0;
+        pid_t rc = waitpid(pid, &status, WNOHANG);
+        if (rc == 0) return true;
+        if (rc == pid) exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        pid = 0;
+        return false;
+#endif
+    }
+
+    /**
+     * Parada ordenada: señal de terminación, espera hasta graceMs y, si el
+     * proceso sigue vivo, terminación forzada. Devuelve true si salió por sí mismo.
+     */
+    bool Stop(int graceMs = 3000) {
+        if (!IsRunning()) return true;
+
+#ifdef _WIN32
+        if (graceMs > 0) GenerateConsoleCtrlEvent(CTRL_BREAK_EVENT, pid);
+        if (graceMs > 0 && WaitForSingleObject(process, static_cast<DWORD>(graceMs)) == WAIT_OBJECT_0) {
+            Reap();
+            return true;
+        }
+        TerminateProcess(process, 1);
+        WaitForSingleObject(process, INFINITE);
+        Reap();
+        return false;
+#else
+        if (graceMs > 0) {
+            kill(pid, SIGTERM);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(graceMs);
+            while (std::chrono::steady_clock::now() < deadline) {
+                if (!IsRunning()) return true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        kill(pid, SIGKILL);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        exitCode = 128 + SIGKILL;
+        pid = 0;
+        return false;
+#endif
+    }
+
+    long Pid() const { return static_cast<long>(pid); }
+    int ExitCode() const { return exitCode; }
+
+private:
+    int exitCode = -1;
+#ifdef _WIN32
+    HANDLE process = NULL;
+    DWORD pid = 0;
+
+    void Reap() {
+        DWORD code = 0;
+        GetExitCodeProcess(process, &code);
+        exitCode = static_cast<int>(code);
+        CloseHandle(process);
+        process = NULL;
+        pid = 0;
+    }
+#else
+    pid_t pid = 0;
+#endif
+};
+
+}  // namespace visifruit
@@ -0,0 +1,237 @@
+/**
+ * VisiFruit Launcher - Reproductor de Trazas del Supervisor
+ * ==========================================================
+ *
+ * Reproduce una traza grabada por el launcher (VISIFRUIT_TRACE=archivo)
+ * sobre la misma máquina de estados (SupervisorCore), a velocidad real,
+ * acelerada o sin esperas, y emite un resumen JSON con el coste por evento
+ * y la huella del estado final. Dos reproducciones de la misma traza deben
+ * producir la misma huella (--expect-hash lo verifica).
+ *
+ * También puede sintetizar trazas de ráfagas (reinicios, inundaciones de
+ * logs, timeouts de sondas) para perfilar sin hardware.
+ *
+ * Uso:
+ *   visifruit_launcher_replay TRAZA [--speed 0|1|N] [--expect-hash HEX] [--verbose]
+ *   visifruit_launcher_replay --synthesize TRAZA [--seconds 120] [--seed 1]
+ *
+ * Compilar con: Extras/compile_cpp_bench.sh
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#include "visifruit_launcher_supervisor.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using visifruit::EventType;
+using visifruit::SteadyClock;
+using visifruit::SupervisorEvent;
+
+// Generador congruencial: las trazas sintéticas deben ser reproducibles por semilla
+struct Lcg {
+    uint64_t state;
+    explicit Lcg(uint64_t seed) : state(seed * 6364136223846793005ULL + 1442695040888963407ULL) {}
+    uint32_t Next() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(state >> 33);
+    }
+    bool Chance(uint32_t perMille) { return Next() % 1000 < perMille; }
+};
+
+int Synthesize(const std::string& path, int seconds, uint64_t seed) {
+    const std::vector<std::string> services = {"backend", "frontend", "system", "canary"};
+    visifruit::TraceRecorder recorder;
+    if (!recorder.Open(path, services)) {
+        std::fprintf(stderr, "❌ No se pudo crear %s\n", path.c_str());
+        return 1;
+    }
+
+    Lcg rng(seed);
+    const uint64_t tickUs = 100000;     // sondas cada 100 ms
+    std::vector<uint64_t> downUntil(3, 0);
+    std::vector<uint64_t> floodUntil(3, 0);
+    uint64_t events = 0;
+
+    for (uint64_t t = 0; t < static_cast<uint64_t>(seconds) * 1000000ULL; t += tickUs) {
+        for (uint32_t s = 0; s < 3; ++s) {
+            // Ráfaga de reinicios: el proceso sale y la sonda falla un rato
+            if (t >= downUntil[s] && rng.Chance(3)) {
+                SupervisorEvent exit;
+                exit.timestampUs = t;
+                exit.type = EventType::ChildExit;
+                exit.service = s;
+                exit.value = rng.Chance(500) ? 1 : -1073741510;
+                recorder.Record(exit);
+                events++;
+                downUntil[s] = t + (1 + rng.Next() % 30) * tickUs;
+            }
+            // Inundación de logs con errores
+            if (t >= floodUntil[s] && rng.Chance(5)) floodUntil[s] = t + (5 + rng.Next() % 20) * tickUs;
+            if (t < floodUntil[s]) {
+                SupervisorEvent output;
+                output.timestampUs = t + 10;
+                output.type = EventType::ChildOutput;
+                output.service = s;
+                for (int line = 0; line < 50; ++line) {
+                    output.payload += (line % 3 == 0) ? "ERROR conexión rechazada por el servicio\n"
+                                                      : "INFO petición atendida en 3 ms\n";
+                }
+                // Cortar a mitad de línea para ejercitar el reensamblado
+                output.payload += "INFO línea partida ";
+                recorder.Record(output);
+                events++;
+            }
+
+            SupervisorEvent probe;
+            probe.timestampUs = t + 20 + s;
+            probe.type = EventType::Probe;
+            probe.service = s;
+            bool down = t < downUntil[s];
+            bool timeout = !down && rng.Chance(20);
+            probe.value = (down || timeout) ? 0 : 1;
+            probe.latencyMs = timeout ? 500.0f : down ? 0.2f : 2.0f + static_cast<float>(rng.Next() % 4000) / 1000.0f;
+            recorder.Record(probe);
+            events++;
+        }
+
+        if (t % (10 * 1000000ULL) == 0) {
+            SupervisorEvent canary;
+            canary.timestampUs = t + 50;
+            canary.type = EventType::Canary;
+            canary.service = 3;
+            canary.value = rng.Chance(100) ? 1 : 0;
+            canary.latencyMs = 80.0f + static_cast<float>(rng.Next() % 200);
+            recorder.Record(canary);
+            events++;
+        }
+    }
+
+    recorder.Flush();
+    std::fprintf(stderr, "✅ Traza sintética: %" PRIu64 " eventos, %d s -> %s\n", events, seconds, path.c_str());
+    return 0;
+}
+
+double Percentile(std::vector<double>& values, double percentile) {
+    if (values.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<long>(rank), values.end());
+    return values[rank];
+}
+
+int Replay(const std::string& path, double speed, const std::string& expectHash, bool verbose) {
+    visifruit::TraceReader reader;
+    if (!reader.Open(path)) {
+        std::fprintf(stderr, "❌ Traza inválida: %s\n", path.c_str());
+        return 1;
+    }
+
+    visifruit::SupervisorCore core(reader.ServiceNames());
+    visifruit::LatencyRegistry registry;
+    for (const auto& name : reader.ServiceNames()) registry.Add(name, visifruit::SloConfig());
+    auto origin = SteadyClock::now();
+    core.SetLatencyRegistry(&registry, origin);
+
+    uint64_t logMessages = 0, statusChanges = 0;
+    core.SetLogCallback([&](const std::wstring& message) {
+        logMessages++;
+        if (verbose) std::fprintf(stderr, "%ls\n", message.c_str());
+    });
+    core.SetStatusCallback([&](uint32_t, bool) { statusChanges++; });
+
+    std::vector<double> applyNs;
+    uint64_t countByType[6] = {0};
+    uint64_t lastUs = 0;
+    SupervisorEvent event;
+    auto wallStart = SteadyClock::now();
+
+    while (reader.Next(event)) {
+        if (speed > 0.0) {
+            auto due = wallStart + std::chrono::microseconds(static_cast<int64_t>(event.timestampUs / speed));
+            std::this_thread::sleep_until(due);
+        }
+        auto start = SteadyClock::now();
+        core.Apply(event);
+        applyNs.push_back(std::chrono::duration<double, std::nano>(SteadyClock::now() - start).count());
+        if (static_cast<uint8_t>(event.type) < 6) countByType[static_cast<uint8_t>(event.type)]++;
+        lastUs = event.timestampUs;
+    }
+
+    double wallMs = std::chrono::duration<double, std::milli>(SteadyClock::now() - wallStart).count();
+    char hash[32];
+    std::snprintf(hash, sizeof(hash), "%016" PRIx64, core.StateHash());
+    auto traceEnd = origin + std::chrono::microseconds(lastUs);
+
+    std::printf("{\n  \"trace\": \"%s\",\n  \"events\": %" PRIu64 ",\n", path.c_str(), core.EventsApplied());
+    std::printf("  \"events_by_type\": {\"probe\": %" PRIu64 ", \"output\": %" PRIu64 ", \"exit\": %" PRIu64
+                ", \"canary\": %" PRIu64 ", \"expect\": %" PRIu64 "},\n",
+                countByType[1], countByType[2], countByType[3], countByType[4], countByType[5]);
+    std::printf("  \"trace_seconds\": %.3f,\n  \"replay_ms\": %.3f,\n  \"speed\": %g,\n",
+                static_cast<double>(lastUs) / 1e6, wallMs, speed);
+    std::printf("  \"events_per_s\": %.0f,\n", wallMs > 0 ? static_cast<double>(core.EventsApplied()) / (wallMs / 1000.0) : 0.0);
+    std::printf("  \"apply_ns_p50\": %.0f,\n  \"apply_ns_p99\": %.0f,\n  \"apply_ns_max\": %.0f,\n",
+                Percentile(applyNs, 50), Percentile(applyNs, 99),
+                applyNs.empty() ? 0.0 : *std::max_element(applyNs.begin(), applyNs.end()));
+    std::printf("  \"log_messages\": %" PRIu64 ",\n  \"status_changes\": %" PRIu64 ",\n", logMessages, statusChanges);
+    std::printf("  \"state_hash\": \"%s\",\n  \"services\": {\n", hash);
+    for (uint32_t i = 0; i < reader.ServiceNames().size(); ++i) {
+        const visifruit::ServiceState& s = core.State(i);
+        visifruit::LatencySummary latency = registry.At(i).Window(60, traceEnd);
+        std::printf("    \"%s\": {\"up\": %s, \"transitions\": %" PRIu64 ", \"probes\": %" PRIu64
+                    ", \"exits\": %" PRIu64 ", \"output_lines\": %" PRIu64 ", \"error_lines\": %" PRIu64
+                    ", \"suppressed_lines\": %" PRIu64 ", \"p99_ms\": %.3f}%s\n",
+                    reader.ServiceNames()[i].c_str(), s.up ? "true" : "false", s.transitions, s.probes,
+                    s.exits, s.outputLines, s.errorLines, s.suppressedLines, latency.p99Ms,
+                    i + 1 < reader.ServiceNames().size() ? "," : "");
+    }
+    std::printf("  }\n}\n");
+
+    if (!expectHash.empty() && expectHash != hash) {
+        std::fprintf(stderr, "❌ Huella distinta: esperada %s, obtenida %s\n", expectHash.c_str(), hash);
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string tracePath, synthesizePath, expectHash;
+    double speed = 0.0;
+    int seconds = 120;
+    uint64_t seed = 1;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : std::string(); };
+        if (arg == "--speed") speed = std::atof(value().c_str());
+        else if (arg == "--expect-hash") expectHash = value();
+        else if (arg == "--synthesize") synthesizePath = value();
+        else if (arg == "--seconds") seconds = std::atoi(value().c_str());
+        else if (arg == "--seed") seed = std::strtoull(value().c_str(), nullptr, 10);
+        else if (arg == "--verbose") verbose = true;
+        else if (!arg.empty() && arg[0] != '-') tracePath = arg;
+        else {
+            tracePath.clear();
+            break;
+        }
+    }
+
+    if (!synthesizePath.empty()) return Synthesize(synthesizePath, seconds, seed);
+    if (tracePath.empty()) {
+        std::fprintf(stderr, "Uso: %s TRAZA [--speed 0|1|N] [--expect-hash HEX] [--verbose]\n"
+                             "     %s --synthesize TRAZA [--seconds 120] [--seed 1]\n", argv[0], argv[0]);
+        return 2;
+    }
+    return Replay(tracePath, speed, expectHash, verbose);
+}
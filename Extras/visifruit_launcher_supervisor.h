@@ -0,0 +1,403 @@
+/**
+ * VisiFruit Launcher - Núcleo del Supervisor y Trazas
+ * ====================================================
+ *
+ * Máquina de estados del supervisor alimentada únicamente por eventos de
+ * entrada (resultados de sondas, salida de hijos, salidas de procesos,
+ * ciclos del canario, arranques y paradas pedidos desde el launcher). No lee relojes ni sockets: el mismo flujo de eventos
+ * produce siempre el mismo estado, lo que permite grabarlo en una traza
+ * compacta y reproducirlo offline (visifruit_launcher_replay) para perfilar
+ * y probar ráfagas de reinicios, inundaciones de logs y timeouts.
+ *
+ * Formato de traza (binario, little-endian):
+ *   "VFTRACE1" | varint nServicios | (varint len + nombre)*
+ *   evento: varint deltaUs | u8 tipo | varint servicio | varint zigzag(valor)
+ *           | [f32 latenciaMs si Probe/Canary] | [varint len + bytes si Output]
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#pragma once
+
+#include "visifruit_launcher_metrics.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace visifruit {
+
+enum class EventType : uint8_t {
+    Probe = 1,          // value: 1 ok / 0 fallo, latencyMs
+    ChildOutput = 2,    // payload: bloque de stdout/stderr
+    ChildExit = 3,      // value: código de salida
+    Canary = 4,         // value: frames fallidos, latencyMs: peor latencia del ciclo
+    Expect = 5,         // value: 1 arrancado desde el launcher / 0 detenido
+};
+
+struct SupervisorEvent {
+    uint64_t timestampUs = 0;   // monotónico, relativo al inicio de la traza
+    EventType type = EventType::Probe;
+    uint32_t service = 0;
+    int32_t value = 0;
+    float latencyMs = 0.0f;
+    std::string payload;
+};
+
+struct ServiceState {
+    bool up = false;
+    // Debe estar en marcha: arrancado desde el launcher o visto sano sin
+    // que se haya pedido su parada. Solo entonces cuentan sus sondas para el SLO.
+    bool expected = false;
+    bool stopRequested = false;
+    uint32_t consecutiveFailures = 0;
+    uint64_t transitions = 0;
+    uint64_t probes = 0;
+    uint64_t outputBytes = 0;
+    uint64_t outputLines = 0;
+    uint64_t errorLines = 0;
+    uint64_t suppressedLines = 0;
+    uint64_t exits = 0;
+    int32_t lastExitCode = 0;
+    std::string partialLine;
+    uint64_t errorWindowStartUs = 0;
+    uint32_t errorLinesInWindow = 0;
+};
+
+/**
+ * Máquina de estados determinista del supervisor. Los efectos visibles
+ * (cambios de estado y mensajes de registro) se notifican por callbacks.
+ */
+class SupervisorCore {
+public:
+    using StatusCallback = std::function<void(uint32_t service, bool up)>;
+    using LogCallback = std::function<void(const std::wstring& message)>;
+
+    // Fallos consecutivos antes de marcar un servicio como caído
+    uint32_t failureThreshold = 1;
+    // Líneas de error reenviadas al registro por servicio y segundo (el resto se resume)
+    uint32_t errorLinesPerSecond = 20;
+
+    explicit SupervisorCore(std::vector<std::string> names) : serviceNames(std::move(names)) {
+        states.resize(serviceNames.size());
+    }
+
+    void SetStatusCallback(StatusCallback callback) { onStatus = std::move(callback); }
+    void SetLogCallback(LogCallback callback) { onLog = std::move(callback); }
+
+    // Registro de latencias por servicio; solo se alimenta mientras el servicio debe estar en marcha
+    void SetLatencyRegistry(LatencyRegistry* registry, SteadyClock::time_point origin) {
+        latencies = registry;
+        latencyOrigin = origin;
+    }
+
+    const std::vector<std::string>& ServiceNames() const { return serviceNames; }
+    const ServiceState& State(uint32_t service) const { return states[service]; }
+    uint64_t EventsApplied() const { return applied; }
+
+    void Apply(const SupervisorEvent& event) {
+        if (event.service >= states.size()) return;
+        applied++;
+        Mix(event.timestampUs);
+        Mix(static_cast<uint64_t>(event.type));
+        ServiceState& state = states[event.service];
+
+        switch (event.type) {
+            case EventType::Probe:
+                ApplyProbe(event, state, event.value != 0);
+                break;
+            case EventType::Canary:
+                ApplyProbe(event, state, event.value == 0);
+                break;
+            case EventType::ChildOutput:
+                ApplyOutput(event, state);
+                break;
+            case EventType::ChildExit:
+                state.exits++;
+                state.lastExitCode = event.value;
+                state.expected = false;
+                FlushPartialLine(event, state);
+                Log(Name(event.service) + L" terminó (código " + std::to_wstring(event.value) + L")");
+                SetUp(event.service, state, false);
+                break;
+            case EventType::Expect:
+                state.expected = event.value != 0;
+                state.stopRequested = !state.expected;
+                break;
+        }
+    }
+
+    /**
+     * Huella del estado completo (FNV-1a). Dos reproducciones de la misma
+     * traza deben dar la misma huella.
+     */
+    uint64_t StateHash() const {
+        uint64_t hash = digest;
+        for (const ServiceState& s : states) {
+            for (uint64_t v : {static_cast<uint64_t>(s.up), static_cast<uint64_t>(s.expected),
+                               static_cast<uint64_t>(s.stopRequested),
+                               static_cast<uint64_t>(s.consecutiveFailures),
+                               s.transitions, s.probes, s.outputBytes, s.outputLines, s.errorLines,
+                               s.suppressedLines, s.exits, static_cast<uint64_t>(static_cast<uint32_t>(s.lastExitCode))}) {
+                hash = (hash ^ v) * 1099511628211ULL;
+            }
+        }
+        return hash;
+    }
+
+private:
+    std::vector<std::string> serviceNames;
+    std::vector<ServiceState> states;
+    StatusCallback onStatus;
+    LogCallback onLog;
+    LatencyRegistry* latencies = nullptr;
+    SteadyClock::time_point latencyOrigin;
+    uint64_t applied = 0;
+    uint64_t digest = 1469598103934665603ULL;
+
+    void Mix(uint64_t value) { digest = (digest ^ value) * 1099511628211ULL; }
+
+    std::wstring Name(uint32_t service) const {
+        const std::string& name = serviceNames[service];
+        return std::wstring(name.begin(), name.end());
+    }
+
+    void Log(const std::wstring& message) {
+        for (wchar_t c : message) Mix(static_cast<uint64_t>(c));
+        if (onLog) onLog(message);
+    }
+
+    void SetUp(uint32_t service, ServiceState& state, bool up) {
+        if (state.up == up) return;
+        state.up = up;
+        state.transitions++;
+        if (onStatus) onStatus(service, up);
+    }
+
+    void ApplyProbe(const SupervisorEvent& event, ServiceState& state, bool ok) {
+        state.probes++;
+        // Un servicio arrancado por otra vía pasa a vigilarse en cuanto responde,
+        // salvo que se haya pedido su parada (puede tardar en cerrar el puerto)
+        if (ok && !state.stopRequested) state.expected = true;
+        // Las sondas de un servicio que nadie ha arrancado no consumen presupuesto de error
+        if (state.expected && latencies && event.service < latencies->Size()) {
+            latencies->At(event.service).Record(event.latencyMs, ok,
+                latencyOrigin + std::chrono::microseconds(event.timestampUs));
+        }
+        if (ok) {
+            state.consecutiveFailures = 0;
+            SetUp(event.service, state, true);
+        } else if (++state.consecutiveFailures >= failureThreshold) {
+            SetUp(event.service, state, false);
+        }
+    }
+
+    void ApplyOutput(const SupervisorEvent& event, ServiceState& state) {
+        state.outputBytes += event.payload.size();
+        size_t start = 0;
+        for (;;) {
+            size_t newline = event.payload.find('\n', start);
+            if (newline == std::string::npos) {
+                state.partialLine.append(event.payload, start, std::string::npos);
+                // Evitar que una salida sin saltos de línea crezca sin límite
+                if (state.partialLine.size() > 4096) FlushPartialLine(event, state);
+                return;
+            }
+            state.partialLine.append(event.payload, start, newline - start);
+            FlushPartialLine(event, state);
+            start = newline + 1;
+        }
+    }
+
+    void FlushPartialLine(const SupervisorEvent& event, ServiceState& state) {
+        if (state.partialLine.empty()) return;
+        std::string line;
+        line.swap(state.partialLine);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        state.outputLines++;
+
+        bool isError = line.find("ERROR") != std::string::npos ||
+                       line.find("CRITICAL") != std::string::npos ||
+                       line.find("Traceback") != std::string::npos;
+        if (!isError) return;
+        state.errorLines++;
+
+        // Limitar por segundo (de tiempo de traza) las líneas de error reenviadas
+        if (event.timestampUs - state.errorWindowStartUs >= 1000000) {
+            if (state.errorLinesInWindow > errorLinesPerSecond) {
+                Log(Name(event.service) + L": " +
+                    std::to_wstring(state.errorLinesInWindow - errorLinesPerSecond) + L" líneas de error omitidas");
+            }
+            state.errorWindowStartUs = event.timestampUs;
+            state.errorLinesInWindow = 0;
+        }
+        if (++state.errorLinesInWindow > errorLinesPerSecond) {
+            state.suppressedLines++;
+            return;
+        }
+        std::wstring text(line.begin(), line.end());
+        Log(Name(event.service) + L": " + text);
+    }
+};
+
+namespace detail {
+
+inline void PutVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline bool GetVarint(const std::string& in, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+inline uint64_t ZigZag(int32_t value) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(value)) << 1) ^ static_cast<uint64_t>(value >> 31);
+}
+
+inline int32_t UnZigZag(uint64_t value) {
+    return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+}  // namespace detail
+
+/**
+ * Grabador de trazas. Record() se llama desde el hilo que aplica los
+ * eventos, de modo que el orden de la traza es el orden de aplicación.
+ */
+class TraceRecorder {
+public:
+    bool Open(const std::string& path, const std::vector<std::string>& serviceNames) {
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        std::string header = "VFTRACE1";
+        detail::PutVarint(header, serviceNames.size());
+        for (const auto& name : serviceNames) {
+            detail::PutVarint(header, name.size());
+            header += name;
+        }
+        file.write(header.data(), static_cast<std::streamsize>(header.size()));
+        start = SteadyClock::now();
+        return true;
+    }
+
+    bool IsOpen() const { return file.is_open(); }
+
+    // Instante al que se refieren las marcas de tiempo de NowUs()
+    SteadyClock::time_point Origin() const { return start; }
+
+    // Microsegundos desde el inicio de la grabación, para sellar eventos nuevos
+    uint64_t NowUs() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            SteadyClock::now() - start).count());
+    }
+
+    void Record(const SupervisorEvent& event) {
+        if (!file) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer.clear();
+        uint64_t ts = event.timestampUs < lastUs ? lastUs : event.timestampUs;
+        detail::PutVarint(buffer, ts - lastUs);
+        lastUs = ts;
+        buffer.push_back(static_cast<char>(event.type));
+        detail::PutVarint(buffer, event.service);
+        detail::PutVarint(buffer, detail::ZigZag(event.value));
+        if (event.type == EventType::Probe || event.type == EventType::Canary) {
+            char bytes[sizeof(float)];
+            std::memcpy(bytes, &event.latencyMs, sizeof(float));
+            buffer.append(bytes, sizeof(float));
+        } else if (event.type == EventType::ChildOutput) {
+            detail::PutVarint(buffer, event.payload.size());
+            buffer += event.payload;
+        }
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+
+    void Flush() {
+        std::lock_guard<std::mutex> lock(mutex);
+        file.flush();
+    }
+
+private:
+    std::ofstream file;
+    std::mutex mutex;
+    std::string buffer;
+    SteadyClock::time_point start;
+    uint64_t lastUs = 0;
+};
+
+/**
+ * Lee una traza completa en memoria (las trazas son pequeñas: unos pocos
+ * bytes por sonda) y la entrega evento a evento.
+ */
+class TraceReader {
+public:
+    bool Open(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (data.compare(0, 8, "VFTRACE1") != 0) return false;
+        pos = 8;
+
+        uint64_t count = 0;
+        if (!detail::GetVarint(data, pos, count) || count > 1024) return false;
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t len = 0;
+            if (!detail::GetVarint(data, pos, len) || pos + len > data.size()) return false;
+            serviceNames.push_back(data.substr(pos, len));
+            pos += len;
+        }
+        return true;
+    }
+
+    const std::vector<std::string>& ServiceNames() const { return serviceNames; }
+
+    bool Next(SupervisorEvent& event) {
+        if (pos >= data.size()) return false;
+        uint64_t delta = 0, service = 0, value = 0;
+        if (!detail::GetVarint(data, pos, delta) || pos >= data.size()) return false;
+        event.type = static_cast<EventType>(static_cast<uint8_t>(data[pos++]));
+        if (!detail::GetVarint(data, pos, service) || !detail::GetVarint(data, pos, value)) return false;
+
+        lastUs += delta;
+        event.timestampUs = lastUs;
+        event.service = static_cast<uint32_t>(service);
+        event.value = detail::UnZigZag(value);
+        event.latencyMs = 0.0f;
+        event.payload.clear();
+
+        if (event.type == EventType::Probe || event.type == EventType::Canary) {
+            if (pos + sizeof(float) > data.size()) return false;
+            std::memcpy(&event.latencyMs, data.data() + pos, sizeof(float));
+            pos += sizeof(float);
+        } else if (event.type == EventType::ChildOutput) {
+            uint64_t len = 0;
+            if (!detail::GetVarint(data, pos, len) || pos + len > data.size()) return false;
+            event.payload.assign(data, pos, len);
+            pos += len;
+        }
+        return true;
+    }
+
+private:
+    std::string data;
+    size_t pos = 0;
+    uint64_t lastUs = 0;
+    std::vector<std::string> serviceNames;
+};
+
+}  // namespace visifruit
@@ -0,0 +1,142 @@
+/**
+ * VisiFruit - Servicio Simulado para Benchmarks del Launcher
+ * ===========================================================
+ *
+ * Servicio hijo mínimo que imita a los servicios reales frente al launcher:
+ * escucha en un puerto, responde "GET /health" con keep-alive, escribe
+ * líneas de log a stdout y termina de forma ordenada con SIGTERM/CTRL_BREAK.
+ *
+ * Uso:
+ *   visifruit_mock_service --port 18500 [--startup-ms 0] [--delay-ms 0] [--log-every-ms 0]
+ *
+ * Autor: Asistente IA para VisiFruit
+ * Versión: 1.0.0
+ */
+
+#include "visifruit_launcher_probe.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static volatile std::sig_atomic_t g_stop = 0;
+
+static void OnSignal(int) {
+    g_stop = 1;
+}
+
+int main(int argc, char** argv) {
+    int port = 18500;
+    int startupMs = 0;
+    int delayMs = 0;
+    int logEveryMs = 0;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        int value = std::atoi(argv[i + 1]);
+        if (flag == "--port") port = value;
+        else if (flag == "--startup-ms") startupMs = value;
+        else if (flag == "--delay-ms") delayMs = value;
+        else if (flag == "--log-every-ms") logEveryMs = value;
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+#ifdef SIGBREAK
+    std::signal(SIGBREAK, OnSignal);
+#endif
+
+    visifruit::SocketRuntime runtime;
+    if (startupMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(startupMs));
+
+    visifruit::socket_t listener = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        std::fprintf(stderr, "mock_service: no se pudo escuchar en %d\n", port);
+        return 1;
+    }
+    visifruit::detail::SetNonBlocking(listener);
+
+    static const char kResponse[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: 15\r\n"
+        "Connection: keep-alive\r\n\r\n"
+        "{\"status\":\"ok\"}";
+
+    std::vector<visifruit::socket_t> clients;
+    std::vector<std::string> pending;
+    char buffer[4096];
+    unsigned long long served = 0;
+    auto nextLog = visifruit::SteadyClock::now();
+
+    while (!g_stop) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(listener, &readable);
+        int maxFd = static_cast<int>(listener);
+        for (auto client : clients) {
+            FD_SET(client, &readable);
+            if (static_cast<int>(client) > maxFd) maxFd = static_cast<int>(client);
+        }
+        timeval tv;
+        tv.tv_sec = 0;
+        tv.tv_usec = 20000;
+        if (select(maxFd + 1, &readable, nullptr, nullptr, &tv) < 0) continue;
+
+        if (FD_ISSET(listener, &readable)) {
+            // Vaciar la cola de conexiones pendientes para no desbordar el backlog
+            for (;;) {
+                visifruit::socket_t client = accept(listener, nullptr, nullptr);
+                if (client == visifruit::kInvalidSocket) break;
+                visifruit::detail::SetNonBlocking(client);
+                clients.push_back(client);
+                pending.emplace_back();
+            }
+        }
+
+        for (size_t i = 0; i < clients.size();) {
+            bool closed = false;
+            if (FD_ISSET(clients[i], &readable)) {
+                int n = static_cast<int>(recv(clients[i], buffer, sizeof(buffer), 0));
+                if (n <= 0) {
+                    closed = true;
+                } else {
+                    pending[i].append(buffer, static_cast<size_t>(n));
+                    size_t end;
+                    while ((end = pending[i].find("\r\n\r\n")) != std::string::npos) {
+                        pending[i].erase(0, end + 4);
+                        if (delayMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+                        auto deadline = visifruit::SteadyClock::now() + std::chrono::seconds(1);
+                        visifruit::detail::SendAll(clients[i], kResponse, sizeof(kResponse) - 1, deadline);
+                        served++;
+                    }
+                }
+            }
+            if (closed) {
+                visifruit::detail::CloseSocket(clients[i]);
+                clients.erase(clients.begin() + static_cast<long>(i));
+                pending.erase(pending.begin() + static_cast<long>(i));
+            } else {
+                ++i;
+            }
+        }
+
+        if (logEveryMs > 0 && visifruit::SteadyClock::now() >= nextLog) {
+            std::printf("INFO mock_service: %llu peticiones atendidas\n", served);
+            std::fflush(stdout);
+            nextLog = visifruit::SteadyClock::now() + std::chrono::milliseconds(logEveryMs);
+        }
+    }
+
+    for (auto client : clients) visifruit::detail::CloseSocket(client);
+    visifruit::detail::CloseSocket(listener);
+    return 0;
+}
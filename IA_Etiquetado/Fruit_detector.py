@@ -27,10 +27,9 @@ import time
 import uuid
 import statistics
 import pickle
-import hashlib
 import gc
 from collections import deque, defaultdict
-from dataclasses import dataclass, field, asdict
+from dataclasses import dataclass, field, asdict, replace
 from typing import List, Tuple, Optional, Dict, Union, Any, Callable
 from threading import Thread, Event, Lock, RLock
 from queue import Queue, Empty, Full, PriorityQueue
@@ -44,6 +43,9 @@ import torch
 import psutil
 import cv2
 
+from utils.perceptual_hash import PerceptualHash, PerceptualHashCache
+from .detection_postprocess import postprocess_detections, to_numpy
+
 # Configuración del logger para este módulo
 logger = logging.getLogger(__name__)
 
@@ -159,7 +161,7 @@ class FrameAnalysisResult:
     timestamp: float = field(default_factory=time.time)
     frame_shape: Tuple[int, int] = (0, 0)  # (height, width)
     frame_id: str = field(default_factory=lambda: str(uuid.uuid4())[:8])
-    frame_hash: str = ""                   # Hash MD5 del frame para detección de duplicados
+    frame_hash: str = ""                   # Hash perceptual del frame para detección de duplicados
     quality: DetectionQuality = DetectionQuality.ACCEPTABLE
     confidence_avg: float = 0.0            # Confianza promedio de todas las detecciones
     confidence_std: float = 0.0            # Desviación estándar de confianzas
@@ -361,10 +363,14 @@ class AdvancedInferenceWorker(Thread):
         self._consecutive_errors = 0
         self._max_consecutive_errors = 5
         
-        # Caché para optimización
-        self._frame_cache = {}
-        self._cache_max_size = 100
-        self._duplicate_threshold = 0.95
+        # Caché de frames casi idénticos (banda detenida o vacía)
+        self._cache_max_size = self._config.get("duplicate_cache_size", 64)
+        self._frame_cache = PerceptualHashCache(
+            max_entries=self._cache_max_size,
+            max_distance=self._config.get("duplicate_max_distance", 4),
+            max_color_delta=self._config.get("duplicate_max_color_delta", 12),
+            ttl_s=self._config.get("duplicate_cache_ttl_s", 30.0)
+        )
         
         # Configuración adaptativa
         self._adaptive_batch_size = 1
@@ -593,23 +599,18 @@ class AdvancedInferenceWorker(Thread):
             except Exception as e:
                 logger.error(f"Error enviando alerta: {e}")
     
-    def _calculate_frame_hash(self, frame: np.ndarray) -> str:
-        """Calcula hash MD5 de un frame para detección de duplicados."""
-        frame_bytes = frame.tobytes()
-        return hashlib.md5(frame_bytes).hexdigest()
+    def _calculate_frame_hash(self, frame: np.ndarray) -> PerceptualHash:
+        """Calcula el hash perceptual de un frame para detección de duplicados."""
+        return PerceptualHash.compute(frame)
     
-    def _check_duplicate_frame(self, frame_hash: str) -> bool:
-        """Verifica si el frame es un duplicado reciente."""
-        return frame_hash in self._frame_cache
+    def _check_duplicate_frame(self, frame_hash: PerceptualHash) -> Optional[FrameAnalysisResult]:
+        """Devuelve el resultado de un frame casi idéntico reciente, si existe."""
+        # Los resultados dependen del umbral adaptativo vigente
+        return self._frame_cache.get(frame_hash, self._adaptive_confidence)
     
-    def _update_frame_cache(self, frame_hash: str, result: FrameAnalysisResult):
-        """Actualiza el caché de frames procesados."""
-        if len(self._frame_cache) >= self._cache_max_size:
-            # Remover el más antiguo (FIFO)
-            oldest_hash = next(iter(self._frame_cache))
-            del self._frame_cache[oldest_hash]
-        
-        self._frame_cache[frame_hash] = result
+    def _update_frame_cache(self, frame_hash: PerceptualHash, result: FrameAnalysisResult):
+        """Actualiza el caché de frames procesados (LRU acotada)."""
+        self._frame_cache.put(frame_hash, result, self._adaptive_confidence)
     
     def _analyze_frame_quality(self, frame: np.ndarray) -> Tuple[float, float]:
         """Analiza la calidad del frame (iluminación y nitidez)."""
@@ -770,11 +771,16 @@ class AdvancedInferenceWorker(Thread):
         # Calcular hash del frame para detección de duplicados
         frame_hash = self._calculate_frame_hash(frame)
         
-        # Verificar caché de duplicados
-        if self._check_duplicate_frame(frame_hash):
-            cached_result = self._frame_cache[frame_hash]
+        # Verificar caché de duplicados (tolerante al ruido del sensor)
+        cached_result = self._check_duplicate_frame(frame_hash)
+        if cached_result is not None:
             logger.debug(f"Worker-{self.worker_id}: Frame duplicado detectado, usando caché")
-            return cached_result
+            return replace(
+                cached_result,
+                frame_id=frame_id,
+                timestamp=time.time(),
+                total_processing_time_ms=(time.perf_counter() - start_total) * 1000
+            )
         
         # Análisis de calidad del frame
         start_preprocess = time.perf_counter()
@@ -828,7 +834,7 @@ class AdvancedInferenceWorker(Thread):
             total_processing_time_ms=total_time,
             frame_shape=(frame.shape[0], frame.shape[1]),
             frame_id=frame_id,
-            frame_hash=frame_hash,
+            frame_hash=frame_hash.hex(),
             quality=quality,
             lighting_score=lighting_score,
             blur_score=blur_score,
@@ -841,74 +847,22 @@ class AdvancedInferenceWorker(Thread):
         return result
     
     def _process_detections_advanced(self, results, frame_shape) -> List[FruitDetection]:
-        """Procesa las detecciones de YOLO con análisis avanzado."""
-        detections = []
-        
+        """Procesa las detecciones de YOLO con análisis avanzado (vectorizado)."""
         if not results or results[0].boxes is None:
-            return detections
+            return []
         
-        frame_height, frame_width = frame_shape[:2]
+        # Una sola copia (N, 6): x1 y1 x2 y2 conf cls
+        data = to_numpy(results[0].boxes.data)
+        if len(data) == 0:
+            return []
         
-        for box in results[0].boxes:
-            try:
-                x1, y1, x2, y2 = map(int, box.xyxy[0])
-                center_x = (x1 + x2) // 2
-                center_y = (y1 + y2) // 2
-                
-                # Calcular métricas avanzadas
-                width = x2 - x1
-                height = y2 - y1
-                area = width * height
-                aspect_ratio = width / height if height > 0 else 0.0
-                
-                # Distancia al borde (normalizada)
-                edge_distance = min(
-                    x1, y1, frame_width - x2, frame_height - y2
-                ) / min(frame_width, frame_height)
-                
-                # Puntuación de calidad basada en múltiples factores
-                quality_score = self._calculate_detection_quality_score(
-                    float(box.conf), area, aspect_ratio, edge_distance
-                )
-                
-                detection = FruitDetection(
-                    class_id=int(box.cls),
-                    class_name=self.model.names[int(box.cls)],
-                    confidence=float(box.conf),
-                    bbox=(x1, y1, x2, y2),
-                    center_px=(center_x, center_y),
-                    area_px=area,
-                    aspect_ratio=aspect_ratio,
-                    edge_distance=edge_distance,
-                    quality_score=quality_score
-                )
-                
-                detections.append(detection)
-                
-            except Exception as e:
-                logger.warning(f"Worker-{self.worker_id}: Error procesando detección: {e}")
-                continue
-        
-        return detections
-    
-    def _calculate_detection_quality_score(self, confidence: float, area: int, 
-                                         aspect_ratio: float, edge_distance: float) -> float:
-        """Calcula una puntuación de calidad para una detección individual."""
-        # Factores de calidad con pesos
-        confidence_factor = confidence  # 0-1
-        area_factor = min(1.0, area / 10000)  # Normalizado para área típica
-        ratio_factor = 1.0 - abs(aspect_ratio - 1.0)  # Mejor si es cercano a cuadrado
-        edge_factor = edge_distance  # Mejor si está lejos de los bordes
-        
-        # Promedio ponderado
-        quality = (
-            confidence_factor * 0.4 +
-            area_factor * 0.2 +
-            ratio_factor * 0.2 +
-            edge_factor * 0.2
+        arrays = postprocess_detections(
+            data[:, :4], data[:, 4], data[:, 5], frame_shape,
+            min_area=self._config.get("min_detection_area", 0),
+            edge_mode="bbox",
+            quality="weighted"
         )
-        
-        return min(1.0, max(0.0, quality))
+        return arrays.to_detections(self.model.names)
     
     def _assess_detection_quality(self, detections: List[FruitDetection], 
                                  lighting_score: float, blur_score: float) -> DetectionQuality:
@@ -1017,7 +971,8 @@ class AdvancedInferenceWorker(Thread):
                 'uptime_seconds': time.time() - self._start_time,
                 'avg_fps': self.statistics.get_average_fps(),
                 'adaptive_confidence': self._adaptive_confidence,
-                'cache_size': len(self._frame_cache)
+                'cache_size': len(self._frame_cache),
+                'cache_hit_rate': self._frame_cache.get_stats()['hit_rate']
             }
 
 # --- Gestor Principal de Detección Empresarial ---
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# IA_Etiquetado/IATraining/Export_Onnx.py
+"""
+Exportación ONNX para el Servidor de Inferencia Nativo - VisiFruit System
+=========================================================================
+
+Exporta un modelo YOLOv8 o RT-DETR de Ultralytics (.pt) al formato que
+carga Extras/visifruit_inference_server (ONNX Runtime CPU):
+
+- FP32 (half=False): ONNX Runtime CPU no acelera FP16
+- Forma estática [1, 3, imgsz, imgsz] (dynamic=False): permite preasignar
+  los tensores de entrada y salida
+- Sin NMS en el grafo (nms=False): el servidor nativo aplica la misma NMS
+  por clase que Ultralytics
+
+Junto al .onnx escribe <modelo>.onnx.json con el tipo de modelo, el tamaño
+de entrada y los nombres de clase, que el servidor lee al arrancar.
+
+La versión INT8 (MODEL_PRECISION=int8) se genera después a partir de este
+.onnx con Quantize_Onnx.py.
+
+Uso:
+    python IA_Etiquetado/IATraining/Export_Onnx.py --weights weights/best.pt
+    python IA_Etiquetado/IATraining/Export_Onnx.py --weights weights/rtdetr.pt --type rtdetr --imgsz 640
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import argparse
+import json
+import logging
+import sys
+from pathlib import Path
+from typing import Dict, List, Optional
+
+logging.basicConfig(
+    level=logging.INFO,
+    format='%(asctime)s - %(name)s - %(levelname)s - %(message)s'
+)
+logger = logging.getLogger(__name__)
+
+try:
+    from ultralytics import YOLO, RTDETR
+    ULTRALYTICS_AVAILABLE = True
+except ImportError:
+    ULTRALYTICS_AVAILABLE = False
+
+
+def guess_model_type(weights: Path) -> str:
+    """Deduce el tipo de modelo a partir del nombre del archivo."""
+    name = weights.stem.lower()
+    return "rtdetr" if "rtdetr" in name or "rt-detr" in name or "rt_detr" in name else "yolov8"
+
+
+def class_names_from(model) -> List[str]:
+    """Nombres de clase ordenados por índice."""
+    names = getattr(model, "names", None) or {}
+    if isinstance(names, dict):
+        return [str(names[k]) for k in sorted(names)]
+    return [str(n) for n in names]
+
+
+def export_onnx(weights: Path, model_type: str, imgsz: int, opset: int = 17,
+                output: Optional[Path] = None) -> Dict[str, str]:
+    """
+    Exporta el modelo y escribe el archivo de metadatos.
+
+    Returns:
+        Dict con las rutas del .onnx y del .onnx.json
+    """
+    if not ULTRALYTICS_AVAILABLE:
+        raise ImportError("Ultralytics no disponible (pip install ultralytics onnx onnxslim)")
+    if not weights.exists():
+        raise FileNotFoundError(f"Modelo no encontrado: {weights}")
+
+    model = RTDETR(str(weights)) if model_type == "rtdetr" else YOLO(str(weights))
+    logger.info(f"📦 Exportando {model_type.upper()}: {weights} (imgsz={imgsz}, opset={opset})")
+
+    exported = Path(model.export(
+        format="onnx",
+        imgsz=imgsz,
+        half=False,
+        int8=False,
+        dynamic=False,
+        simplify=True,
+        opset=opset,
+        nms=False,
+    ))
+
+    if output is not None and output.resolve() != exported.resolve():
+        output.parent.mkdir(parents=True, exist_ok=True)
+        exported.replace(output)
+        exported = output
+
+    metadata = {
+        "model_type": model_type,
+        "imgsz": imgsz,
+        "classes": class_names_from(model),
+        "source": str(weights),
+    }
+    metadata_path = exported.with_name(exported.name + ".json")
+    with open(metadata_path, "w", encoding="utf-8") as f:
+        json.dump(metadata, f, indent=2, ensure_ascii=False)
+
+    logger.info(f"✅ Modelo ONNX: {exported}")
+    logger.info(f"✅ Metadatos: {metadata_path} (clases: {', '.join(metadata['classes'])})")
+    return {"onnx": str(exported), "metadata": str(metadata_path)}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Exportación ONNX para el servidor de inferencia nativo')
+    parser.add_argument('--weights', type=str, default='weights/best.pt',
+                        help='Modelo Ultralytics (.pt) a exportar')
+    parser.add_argument('--type', type=str, choices=['yolov8', 'rtdetr'], default=None,
+                        help='Tipo de modelo (por defecto se deduce del nombre)')
+    parser.add_argument('--imgsz', type=int, default=640,
+                        help='Tamaño de entrada fijo del modelo exportado')
+    parser.add_argument('--opset', type=int, default=17,
+                        help='Versión de opset ONNX')
+    parser.add_argument('--output', type=str, default=None,
+                        help='Ruta del .onnx (por defecto junto al .pt)')
+    args = parser.parse_args()
+
+    weights = Path(args.weights)
+    model_type = args.type or guess_model_type(weights)
+    try:
+        export_onnx(weights, model_type, args.imgsz, args.opset,
+                    Path(args.output) if args.output else None)
+    except Exception as e:
+        logger.error(f"❌ Error exportando modelo: {e}")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
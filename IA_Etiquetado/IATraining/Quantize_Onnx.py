@@ -0,0 +1,720 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# IA_Etiquetado/IATraining/Quantize_Onnx.py
+"""
+Cuantización INT8 con Calibración - VisiFruit System
+====================================================
+
+Convierte un modelo exportado con Export_Onnx.py (FP32) en un modelo INT8
+para ONNX Runtime CPU y mide lo que se gana y lo que se pierde:
+
+1. Calibración: recorre imágenes de IA_Etiquetado/Dataset_Frutas (split de
+   entrenamiento) con el mismo letterbox que los servidores y registra el
+   rango de cada activación para fijar las escalas INT8.
+2. Cuantización estática QDQ: pesos INT8 por canal y activaciones UINT8.
+   Se cuantizan también las activaciones (SiLU), sumas y concatenaciones
+   para que los datos sigan en INT8 entre capas: cuantizar solo Conv deja
+   un par DQ/Q por capa y apenas acelera. El cabezal (últimas Conv/MatMul
+   y la decodificación de cajas y puntuaciones) queda en FP32, que es
+   donde más precisión se pierde.
+3. Informe: mAP50 y mAP50-95 de ambos modelos sobre el split de validación
+   (etiquetas YOLO) y latencia mediana/p90 de la inferencia. Sin etiquetas
+   se usan como referencia las detecciones del modelo FP32. Si la caída de
+   mAP50-95 supera --max-map-drop el script termina con código 1 para que
+   el modelo no se despliegue sin revisarlo.
+
+Salida junto al modelo FP32: <modelo>.int8.onnx, su .onnx.json (con la
+precisión y los datos de calibración) y <modelo>.int8.report.{json,md}.
+Los servidores lo usan con MODEL_PRECISION=int8.
+
+Con --uint8-input la entrada del modelo pasa a ser UINT8 (0-255): el
+servidor nativo escribe el tensor sin normalizar a float (4x menos
+memoria). Ultralytics no admite esa entrada; usarlo solo con el nativo.
+
+Uso:
+    python IA_Etiquetado/IATraining/Quantize_Onnx.py --model weights/best.onnx
+    python IA_Etiquetado/IATraining/Quantize_Onnx.py --model weights/best.onnx \\
+        --calibration percentile --calib-images 256 --uint8-input
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import argparse
+import json
+import logging
+import os
+import random
+import sys
+import time
+from datetime import datetime
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+import cv2
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).parent.parent.parent))
+
+from IA_Etiquetado.detection_postprocess import class_aware_nms
+
+logging.basicConfig(
+    level=logging.INFO,
+    format='%(asctime)s - %(name)s - %(levelname)s - %(message)s'
+)
+logger = logging.getLogger(__name__)
+
+try:
+    import onnx
+    import onnxruntime as ort
+    from onnxruntime.quantization import (CalibrationDataReader, CalibrationMethod, QuantFormat,
+                                          QuantType, quantize_static)
+    from onnxruntime.quantization.shape_inference import quant_pre_process
+    ORT_AVAILABLE = True
+except ImportError:
+    ORT_AVAILABLE = False
+
+IMAGE_EXTENSIONS = {".jpg", ".jpeg", ".png", ".bmp", ".webp"}
+IOU_THRESHOLDS = np.linspace(0.5, 0.95, 10)
+
+CALIBRATION_METHODS = {
+    "minmax": "MinMax",
+    "entropy": "Entropy",
+    "percentile": "Percentile",
+}
+
+
+# ==================== DATASET ====================
+
+def dataset_split_dirs(data_yaml: Path, split: str) -> List[Path]:
+    """Directorios de imágenes de un split según Data.yaml (formato Ultralytics)."""
+    import yaml
+
+    with open(data_yaml, "r", encoding="utf-8") as f:
+        data = yaml.safe_load(f) or {}
+
+    root = Path(data.get("path") or data_yaml.parent)
+    if not root.is_absolute() and not root.exists():
+        root = data_yaml.parent
+    entries = data.get(split) or []
+    if isinstance(entries, str):
+        entries = [entries]
+    return [(root / entry) if not Path(entry).is_absolute() else Path(entry) for entry in entries]
+
+
+def list_images(dirs: List[Path]) -> List[Path]:
+    images = []
+    for directory in dirs:
+        if directory.is_dir():
+            images.extend(p for p in sorted(directory.rglob("*")) if p.suffix.lower() in IMAGE_EXTENSIONS)
+    return images
+
+
+def label_path_for(image_path: Path) -> Path:
+    """Convención YOLO: .../images/<split>/x.jpg -> .../labels/<split>/x.txt"""
+    parts = list(image_path.parts)
+    for i in range(len(parts) - 1, -1, -1):
+        if parts[i] == "images":
+            parts[i] = "labels"
+            break
+    return Path(*parts).with_suffix(".txt")
+
+
+def load_labels(image_path: Path, width: int, height: int) -> Optional[np.ndarray]:
+    """Etiquetas YOLO (clase cx cy w h normalizados) -> (N, 5) clase x1 y1 x2 y2 en píxeles."""
+    path = label_path_for(image_path)
+    if not path.exists():
+        return None
+    rows = []
+    for line in path.read_text(encoding="utf-8").splitlines():
+        values = line.split()
+        if len(values) < 5:
+            continue
+        cls, cx, cy, w, h = int(values[0]), *map(float, values[1:5])
+        rows.append([cls, (cx - w / 2) * width, (cy - h / 2) * height,
+                     (cx + w / 2) * width, (cy + h / 2) * height])
+    return np.asarray(rows, np.float32).reshape(-1, 5)
+
+
+# ==================== PREPROCESADO ====================
+
+def letterbox(image: np.ndarray, size: int, stretch: bool) -> Tuple[np.ndarray, float, float, float, float]:
+    """
+    Mismo preprocesado que Ultralytics y el servidor nativo: letterbox con
+    relleno 114 (YOLOv8) o redimensionado sin proporción (RT-DETR).
+
+    Returns:
+        (imagen size x size BGR, ganancia x, ganancia y, relleno x, relleno y)
+    """
+    height, width = image.shape[:2]
+    if stretch:
+        resized = cv2.resize(image, (size, size), interpolation=cv2.INTER_LINEAR)
+        return resized, size / width, size / height, 0.0, 0.0
+
+    gain = min(size / height, size / width)
+    new_w, new_h = int(round(width * gain)), int(round(height * gain))
+    pad_x, pad_y = (size - new_w) / 2, (size - new_h) / 2
+    if (new_w, new_h) != (width, height):
+        image = cv2.resize(image, (new_w, new_h), interpolation=cv2.INTER_LINEAR)
+    top, bottom = int(round(pad_y - 0.1)), int(round(pad_y + 0.1))
+    left, right = int(round(pad_x - 0.1)), int(round(pad_x + 0.1))
+    image = cv2.copyMakeBorder(image, top, bottom, left, right, cv2.BORDER_CONSTANT, value=(114, 114, 114))
+    return image, gain, gain, float(left), float(top)
+
+
+def to_tensor(image: np.ndarray, uint8_input: bool = False) -> np.ndarray:
+    """BGR HWC -> RGB NCHW (float 0-1 o uint8 0-255)."""
+    chw = np.ascontiguousarray(image[:, :, ::-1].transpose(2, 0, 1))[None]
+    return chw if uint8_input else chw.astype(np.float32) / 255.0
+
+
+class FruitCalibrationReader(CalibrationDataReader if ORT_AVAILABLE else object):
+    """Entrega a ONNX Runtime las imágenes de calibración ya preprocesadas, una a una."""
+
+    def __init__(self, images: List[Path], input_name: str, size: int, stretch: bool):
+        self.images = images
+        self.input_name = input_name
+        self.size = size
+        self.stretch = stretch
+        self.index = 0
+
+    def get_next(self) -> Optional[Dict[str, np.ndarray]]:
+        while self.index < len(self.images):
+            path = self.images[self.index]
+            self.index += 1
+            image = cv2.imread(str(path))
+            if image is None:
+                logger.warning(f"⚠️ Imagen ilegible, se omite: {path}")
+                continue
+            if self.index % 25 == 0:
+                logger.info(f"   Calibración: {self.index}/{len(self.images)} imágenes")
+            return {self.input_name: to_tensor(letterbox(image, self.size, self.stretch)[0])}
+        return None
+
+    def rewind(self):
+        self.index = 0
+
+
+# ==================== CUANTIZACIÓN ====================
+
+def fold_uint8_input(model_path: Path):
+    """
+    Cambia la entrada a UINT8 (0-255) con Cast + Mul(1/255) al inicio del
+    grafo, para que el cliente no tenga que normalizar.
+    """
+    model = onnx.load(str(model_path))
+    graph = model.graph
+    graph_input = graph.input[0]
+    name = graph_input.name
+    # Sufijo propio: el cuantizador ya usa <entrada>_scale / _zero_point
+    prefix = name + "_uint8"
+    scaled = prefix + "_normalized"
+
+    for node in graph.node:
+        for i, value in enumerate(node.input):
+            if value == name:
+                node.input[i] = scaled
+
+    scale = onnx.helper.make_tensor(prefix + "_inv255", onnx.TensorProto.FLOAT, [], [1.0 / 255.0])
+    graph.initializer.append(scale)
+    cast = onnx.helper.make_node("Cast", [name], [prefix + "_float"], to=onnx.TensorProto.FLOAT,
+                                 name=prefix + "_cast")
+    mul = onnx.helper.make_node("Mul", [prefix + "_float", scale.name], [scaled], name=prefix + "_normalize")
+    graph.node.insert(0, mul)
+    graph.node.insert(0, cast)
+    graph_input.type.tensor_type.elem_type = onnx.TensorProto.UINT8
+    onnx.save(model, str(model_path))
+
+
+HEAVY_OPS = {"Conv", "ConvTranspose", "MatMul", "Gemm"}
+
+
+def head_nodes(model) -> List[str]:
+    """
+    Cabezal del detector: se recorre el grafo desde las salidas hacia atrás
+    hasta llegar a las Conv/MatMul que producen cajas y puntuaciones
+    (incluidas). En YOLOv8 es el DFL y dist2bbox con las Conv finales de
+    cada escala; en RT-DETR las proyecciones de cajas y clases.
+    """
+    producers = {output: node for node in model.graph.node for output in node.output}
+    pending = [output.name for output in model.graph.output]
+    seen, head = set(), []
+    while pending:
+        node = producers.get(pending.pop())
+        if node is None or node.name in seen:
+            continue
+        seen.add(node.name)
+        head.append(node.name)
+        if node.op_type not in HEAVY_OPS:
+            pending.extend(node.input)
+    return head
+
+
+def quantize_model(fp32_path: Path, int8_path: Path, calibration_images: List[Path], size: int,
+                   stretch: bool, method: str, per_channel: bool, reduce_range: bool,
+                   op_types: Optional[List[str]], quantize_head: bool, uint8_input: bool) -> float:
+    """
+    Calibra y cuantiza el modelo.
+
+    Returns:
+        Segundos empleados
+    """
+    start = time.perf_counter()
+    input_name = ort.InferenceSession(str(fp32_path), providers=["CPUExecutionProvider"]).get_inputs()[0].name
+
+    # Inferencia de formas y fusiones previas recomendadas por ONNX Runtime
+    prepared_path = int8_path.with_name(int8_path.stem + ".prep.onnx")
+    try:
+        quant_pre_process(str(fp32_path), str(prepared_path), skip_symbolic_shape=True)
+        source_path = prepared_path
+    except Exception as e:
+        logger.warning(f"⚠️ Preprocesado de cuantización omitido: {e}")
+        source_path = fp32_path
+
+    # nodes_to_exclude necesita nombres: el export deja nodos sin nombre
+    prepared = onnx.load(str(source_path))
+    for i, node in enumerate(prepared.graph.node):
+        if not node.name:
+            node.name = f"{node.op_type}_{i}"
+    onnx.save(prepared, str(prepared_path))
+    source_path = prepared_path
+    excluded = [] if quantize_head else head_nodes(prepared)
+    if excluded:
+        logger.info(f"   Cabezal en FP32: {len(excluded)} nodos")
+
+    reader = FruitCalibrationReader(calibration_images, input_name, size, stretch)
+    try:
+        quantize_static(
+            str(source_path),
+            str(int8_path),
+            reader,
+            quant_format=QuantFormat.QDQ,
+            op_types_to_quantize=op_types,
+            nodes_to_exclude=excluded,
+            per_channel=per_channel,
+            reduce_range=reduce_range,
+            activation_type=QuantType.QUInt8,
+            weight_type=QuantType.QInt8,
+            calibrate_method=getattr(CalibrationMethod, CALIBRATION_METHODS[method]),
+        )
+    finally:
+        if prepared_path.exists():
+            prepared_path.unlink()
+
+    # Ultralytics lee nombres de clase, stride e imgsz de los metadatos del .onnx
+    source_props = onnx.load(str(fp32_path), load_external_data=False).metadata_props
+    quantized = onnx.load(str(int8_path))
+    del quantized.metadata_props[:]
+    for prop in source_props:
+        quantized.metadata_props.add(key=prop.key, value=prop.value)
+    onnx.save(quantized, str(int8_path))
+
+    if uint8_input:
+        fold_uint8_input(int8_path)
+    return time.perf_counter() - start
+
+
+# ==================== EVALUACIÓN ====================
+
+class OnnxDetector:
+    """Sesión ONNX Runtime con el mismo decodificado que el servidor nativo."""
+
+    def __init__(self, path: Path, model_type: str, threads: int):
+        options = ort.SessionOptions()
+        options.graph_optimization_level = ort.GraphOptimizationLevel.ORT_ENABLE_ALL
+        options.intra_op_num_threads = threads
+        options.inter_op_num_threads = 1
+        self.session = ort.InferenceSession(str(path), options, providers=["CPUExecutionProvider"])
+        model_input = self.session.get_inputs()[0]
+        self.input_name = model_input.name
+        self.uint8_input = model_input.type == "tensor(uint8)"
+        self.size = int(model_input.shape[2])
+        self.model_type = model_type
+        self.stretch = model_type == "rtdetr"
+        # El decodificador sale del tipo de modelo, como en el servidor nativo:
+        # un RT-DETR de 2 clases también tiene 6 valores por fila (4 + 2).
+        # Solo un YOLOv8 cuya salida declarada es [1, K, 6] trae NMS integrado.
+        output_shape = self.session.get_outputs()[0].shape
+        self.nms_exported = (not self.stretch and len(output_shape) == 3
+                             and output_shape[2] == 6)
+
+    def run(self, tensor: np.ndarray) -> np.ndarray:
+        return self.session.run(None, {self.input_name: tensor})[0]
+
+    def detect(self, image: np.ndarray, conf: float = 0.001, iou: float = 0.7,
+               max_det: int = 300) -> np.ndarray:
+        """
+        Returns:
+            (N, 6) x1 y1 x2 y2 confianza clase en píxeles de la imagen
+        """
+        height, width = image.shape[:2]
+        boxed, gain_x, gain_y, pad_x, pad_y = letterbox(image, self.size, self.stretch)
+        output = self.run(to_tensor(boxed, self.uint8_input))[0]
+
+        if self.nms_exported:               # YOLOv8 con NMS integrado
+            boxes, scores, classes = output[:, :4], output[:, 4], output[:, 5]
+        elif self.stretch:                  # RT-DETR: cx cy w h normalizados
+            scores = output[:, 4:].max(axis=1)
+            classes = output[:, 4:].argmax(axis=1)
+            cx, cy, w, h = (output[:, i] for i in range(4))
+            boxes = np.stack([(cx - w / 2) * self.size, (cy - h / 2) * self.size,
+                              (cx + w / 2) * self.size, (cy + h / 2) * self.size], axis=1)
+        else:                               # YOLOv8 crudo [4+nc, N]
+            scores = output[4:].max(axis=0)
+            classes = output[4:].argmax(axis=0)
+            cx, cy, w, h = output[:4]
+            boxes = np.stack([cx - w / 2, cy - h / 2, cx + w / 2, cy + h / 2], axis=1)
+
+        keep = scores > conf
+        boxes, scores, classes = boxes[keep], scores[keep], classes[keep]
+        if not self.stretch and not self.nms_exported and len(scores):
+            keep = class_aware_nms(boxes, scores, classes, iou)
+            boxes, scores, classes = boxes[keep], scores[keep], classes[keep]
+        order = np.argsort(-scores, kind="stable")[:max_det]
+        boxes, scores, classes = boxes[order], scores[order], classes[order]
+
+        boxes = (boxes - [pad_x, pad_y, pad_x, pad_y]) / [gain_x, gain_y, gain_x, gain_y]
+        boxes = np.clip(boxes, 0, [width, height, width, height])
+        return np.column_stack([boxes, scores, classes]).astype(np.float32)
+
+
+def box_iou(a: np.ndarray, b: np.ndarray) -> np.ndarray:
+    """IoU (len(a), len(b)) entre cajas x1 y1 x2 y2."""
+    lt = np.maximum(a[:, None, :2], b[None, :, :2])
+    rb = np.minimum(a[:, None, 2:], b[None, :, 2:])
+    inter = np.prod(np.clip(rb - lt, 0, None), axis=2)
+    area_a = np.prod(a[:, 2:] - a[:, :2], axis=1)
+    area_b = np.prod(b[:, 2:] - b[:, :2], axis=1)
+    return inter / (area_a[:, None] + area_b[None, :] - inter + 1e-9)
+
+
+def match_predictions(predictions: np.ndarray, targets: np.ndarray) -> np.ndarray:
+    """
+    Aciertos por umbral de IoU (como el validador de Ultralytics): cada
+    objeto se asigna a la predicción de su clase con mayor IoU.
+
+    Returns:
+        (N, 10) bool
+    """
+    correct = np.zeros((len(predictions), len(IOU_THRESHOLDS)), bool)
+    if len(predictions) == 0 or len(targets) == 0:
+        return correct
+    iou = box_iou(targets[:, 1:5], predictions[:, :4])
+    iou = iou * (targets[:, :1] == predictions[None, :, 5])
+    for t, threshold in enumerate(IOU_THRESHOLDS):
+        target_idx, pred_idx = np.nonzero(iou >= threshold)
+        if len(target_idx) == 0:
+            continue
+        order = np.argsort(-iou[target_idx, pred_idx], kind="stable")
+        target_idx, pred_idx = target_idx[order], pred_idx[order]
+        _, first = np.unique(pred_idx, return_index=True)
+        target_idx, pred_idx = target_idx[first], pred_idx[first]
+        order = np.argsort(-iou[target_idx, pred_idx], kind="stable")
+        _, first = np.unique(target_idx[order], return_index=True)
+        correct[pred_idx[order][first], t] = True
+    return correct
+
+
+def average_precision(recall: np.ndarray, precision: np.ndarray) -> float:
+    """AP con interpolación de 101 puntos (COCO)."""
+    recall = np.concatenate([[0.0], recall, [1.0]])
+    precision = np.concatenate([[1.0], precision, [0.0]])
+    precision = np.flip(np.maximum.accumulate(np.flip(precision)))
+    points = np.linspace(0, 1, 101)
+    return float(np.mean(np.interp(points, recall, precision)))
+
+
+def mean_average_precision(correct: np.ndarray, scores: np.ndarray, pred_classes: np.ndarray,
+                           target_classes: np.ndarray) -> Tuple[float, float]:
+    """
+    Returns:
+        (mAP50, mAP50-95) sobre las clases con objetos
+    """
+    classes = np.unique(target_classes.astype(np.int64))
+    if len(classes) == 0:
+        return 0.0, 0.0
+    order = np.argsort(-scores, kind="stable")
+    correct, pred_classes = correct[order], pred_classes[order]
+
+    ap = np.zeros((len(classes), len(IOU_THRESHOLDS)))
+    for i, cls in enumerate(classes):
+        mask = pred_classes == cls
+        n_targets = int((target_classes == cls).sum())
+        if not mask.any():
+            continue
+        tp = np.cumsum(correct[mask], axis=0)
+        fp = np.cumsum(~correct[mask], axis=0)
+        for t in range(len(IOU_THRESHOLDS)):
+            recall = tp[:, t] / n_targets
+            precision = tp[:, t] / np.maximum(tp[:, t] + fp[:, t], 1)
+            ap[i, t] = average_precision(recall, precision)
+    return float(ap[:, 0].mean()), float(ap.mean())
+
+
+def evaluate_accuracy(detector: OnnxDetector, images: List[Path],
+                      references: Optional[Dict[Path, np.ndarray]] = None) -> Dict:
+    """
+    mAP del modelo sobre las imágenes. references sustituye a las etiquetas
+    del dataset (modo sin etiquetas: detecciones FP32 como referencia).
+    """
+    all_correct, all_scores, all_pred_classes, all_target_classes = [], [], [], []
+    evaluated = 0
+    for path in images:
+        image = cv2.imread(str(path))
+        if image is None:
+            continue
+        if references is not None:
+            targets = references.get(path)
+        else:
+            targets = load_labels(path, image.shape[1], image.shape[0])
+        if targets is None:
+            continue
+        predictions = detector.detect(image)
+        all_correct.append(match_predictions(predictions, targets))
+        all_scores.append(predictions[:, 4])
+        all_pred_classes.append(predictions[:, 5].astype(np.int64))
+        all_target_classes.append(targets[:, 0].astype(np.int64))
+        evaluated += 1
+
+    if evaluated == 0:
+        return {"images": 0, "map50": None, "map50_95": None}
+    map50, map50_95 = mean_average_precision(np.concatenate(all_correct), np.concatenate(all_scores),
+                                             np.concatenate(all_pred_classes),
+                                             np.concatenate(all_target_classes))
+    return {"images": evaluated, "map50": round(map50, 4), "map50_95": round(map50_95, 4)}
+
+
+def reference_detections(detector: OnnxDetector, images: List[Path], conf: float = 0.25) -> Dict[Path, np.ndarray]:
+    """Detecciones FP32 con confianza de producción como etiquetas (clase x1 y1 x2 y2)."""
+    references = {}
+    for path in images:
+        image = cv2.imread(str(path))
+        if image is None:
+            continue
+        detections = detector.detect(image, conf=conf, iou=0.45, max_det=100)
+        references[path] = np.column_stack([detections[:, 5], detections[:, :4]]).astype(np.float32)
+    return references
+
+
+def measure_latency(detector: OnnxDetector, sample: np.ndarray, runs: int, warmup: int = 5) -> Dict:
+    """Latencia de la inferencia (sin pre ni post) sobre el mismo frame."""
+    boxed = letterbox(sample, detector.size, detector.stretch)[0]
+    tensor = to_tensor(boxed, detector.uint8_input)
+    for _ in range(warmup):
+        detector.run(tensor)
+    times = []
+    for _ in range(runs):
+        start = time.perf_counter()
+        detector.run(tensor)
+        times.append((time.perf_counter() - start) * 1000)
+    return {
+        "median_ms": round(float(np.median(times)), 2),
+        "p90_ms": round(float(np.percentile(times, 90)), 2),
+        "runs": runs,
+    }
+
+
+# ==================== INFORME ====================
+
+def write_report(report: Dict, json_path: Path, markdown_path: Path):
+    with open(json_path, "w", encoding="utf-8") as f:
+        json.dump(report, f, indent=2, ensure_ascii=False)
+
+    fp32, int8 = report["fp32"], report["int8"]
+
+    def fmt(value, suffix=""):
+        return "-" if value is None else f"{value}{suffix}"
+
+    lines = [
+        f"# Informe de cuantización INT8 - {Path(report['int8_model']).name}",
+        "",
+        f"- Fecha: {report['date']}",
+        f"- Modelo FP32: `{report['fp32_model']}`",
+        f"- Calibración: {report['calibration']['method']} con {report['calibration']['images']} imágenes"
+        f" ({report['calibration']['seconds']} s)",
+        f"- Referencia de precisión: {report['accuracy_reference']} ({fp32['accuracy']['images']} imágenes)",
+        f"- Hilos de inferencia: {report['threads']}",
+        "",
+        "| Modelo | mAP50 | mAP50-95 | Mediana (ms) | p90 (ms) | Tamaño (MB) |",
+        "|---|---|---|---|---|---|",
+    ]
+    for name, data in (("FP32", fp32), ("INT8", int8)):
+        lines.append(f"| {name} | {fmt(data['accuracy']['map50'])} | {fmt(data['accuracy']['map50_95'])} | "
+                     f"{data['latency']['median_ms']} | {data['latency']['p90_ms']} | {data['size_mb']} |")
+    lines += [
+        "",
+        f"- Aceleración: **{report['speedup']}x**",
+        f"- Caída de mAP50-95: **{fmt(report['map50_95_drop'])}** (máximo permitido {report['max_map_drop']})",
+        f"- Resultado: **{'ACEPTADO' if report['accepted'] else 'RECHAZADO'}**",
+        "",
+    ]
+    markdown_path.write_text("\n".join(lines), encoding="utf-8")
+
+
+def run(args) -> bool:
+    if not ORT_AVAILABLE:
+        raise ImportError("ONNX Runtime no disponible (pip install onnxruntime onnx)")
+
+    fp32_path = Path(args.model)
+    if not fp32_path.exists():
+        raise FileNotFoundError(f"Modelo no encontrado: {fp32_path}")
+    int8_path = Path(args.output) if args.output else fp32_path.with_name(fp32_path.stem + ".int8.onnx")
+
+    metadata_path = fp32_path.with_name(fp32_path.name + ".json")
+    metadata = {}
+    if metadata_path.exists():
+        with open(metadata_path, "r", encoding="utf-8") as f:
+            metadata = json.load(f)
+    model_type = args.type or metadata.get("model_type", "yolov8")
+
+    threads = args.threads or os.cpu_count() or 4
+    fp32 = OnnxDetector(fp32_path, model_type, threads)
+
+    # Calibración con el split de entrenamiento y evaluación con el de validación
+    data_yaml = Path(args.data)
+    calibration_pool = list_images(dataset_split_dirs(data_yaml, "train"))
+    evaluation_images = list_images(dataset_split_dirs(data_yaml, "val"))
+    if not calibration_pool:
+        calibration_pool = evaluation_images
+    if not calibration_pool:
+        raise FileNotFoundError(f"Sin imágenes en el dataset de {data_yaml}")
+    if not evaluation_images:
+        evaluation_images = calibration_pool
+    rng = random.Random(args.seed)
+    calibration_images = rng.sample(calibration_pool, min(args.calib_images, len(calibration_pool)))
+    if args.eval_images > 0 and len(evaluation_images) > args.eval_images:
+        evaluation_images = rng.sample(evaluation_images, args.eval_images)
+
+    logger.info(f"📏 Calibrando {model_type.upper()} con {len(calibration_images)} imágenes "
+                f"({args.calibration}, per_channel={args.per_channel})")
+    op_types = [op.strip() for op in args.op_types.split(",") if op.strip()] or None
+    seconds = quantize_model(fp32_path, int8_path, calibration_images, fp32.size, fp32.stretch,
+                             args.calibration, args.per_channel, args.reduce_range,
+                             op_types, args.quantize_head, args.uint8_input)
+    logger.info(f"✅ Modelo INT8: {int8_path} ({seconds:.1f} s)")
+
+    int8_metadata = dict(metadata) if metadata else {"model_type": model_type, "imgsz": fp32.size}
+    int8_metadata.update({
+        "precision": "int8",
+        "input": "uint8" if args.uint8_input else "float32",
+        "source": str(fp32_path),
+        "calibration": {
+            "method": args.calibration,
+            "images": len(calibration_images),
+            "per_channel": args.per_channel,
+            "op_types": op_types or "todos",
+            "head_fp32": not args.quantize_head,
+        },
+    })
+    int8_metadata_path = int8_path.with_name(int8_path.name + ".json")
+    with open(int8_metadata_path, "w", encoding="utf-8") as f:
+        json.dump(int8_metadata, f, indent=2, ensure_ascii=False)
+
+    # Precisión: etiquetas del dataset o, si no hay, detecciones FP32
+    int8 = OnnxDetector(int8_path, model_type, threads)
+    labeled = [p for p in evaluation_images if label_path_for(p).exists()]
+    references = None
+    if labeled:
+        evaluation_images = labeled
+        accuracy_reference = "etiquetas del dataset"
+    else:
+        logger.warning("⚠️ Sin etiquetas de validación: se usan las detecciones FP32 como referencia")
+        references = reference_detections(fp32, evaluation_images)
+        accuracy_reference = "detecciones FP32 (conf 0.25)"
+
+    logger.info(f"🎯 Evaluando precisión sobre {len(evaluation_images)} imágenes...")
+    fp32_accuracy = evaluate_accuracy(fp32, evaluation_images, references)
+    int8_accuracy = evaluate_accuracy(int8, evaluation_images, references)
+
+    logger.info(f"⏱️ Midiendo latencia ({args.runs} inferencias, {threads} hilos)...")
+    sample = cv2.imread(str(evaluation_images[0]))
+    fp32_latency = measure_latency(fp32, sample, args.runs)
+    int8_latency = measure_latency(int8, sample, args.runs)
+
+    drop = None
+    if fp32_accuracy["map50_95"] is not None and int8_accuracy["map50_95"] is not None:
+        drop = round(fp32_accuracy["map50_95"] - int8_accuracy["map50_95"], 4)
+    speedup = round(fp32_latency["median_ms"] / max(int8_latency["median_ms"], 1e-6), 2)
+    accepted = drop is not None and drop <= args.max_map_drop
+
+    report = {
+        "date": datetime.now().isoformat(timespec="seconds"),
+        "fp32_model": str(fp32_path),
+        "int8_model": str(int8_path),
+        "model_type": model_type,
+        "threads": threads,
+        "calibration": {"method": args.calibration, "images": len(calibration_images),
+                        "seconds": round(seconds, 1)},
+        "accuracy_reference": accuracy_reference,
+        "fp32": {"accuracy": fp32_accuracy, "latency": fp32_latency,
+                 "size_mb": round(fp32_path.stat().st_size / 1e6, 2)},
+        "int8": {"accuracy": int8_accuracy, "latency": int8_latency,
+                 "size_mb": round(int8_path.stat().st_size / 1e6, 2)},
+        "speedup": speedup,
+        "map50_95_drop": drop,
+        "max_map_drop": args.max_map_drop,
+        "accepted": accepted,
+    }
+    report_json = int8_path.with_name(int8_path.stem + ".report.json")
+    report_markdown = int8_path.with_name(int8_path.stem + ".report.md")
+    write_report(report, report_json, report_markdown)
+
+    logger.info(f"📊 FP32: mAP50-95={fp32_accuracy['map50_95']}  {fp32_latency['median_ms']} ms")
+    logger.info(f"📊 INT8: mAP50-95={int8_accuracy['map50_95']}  {int8_latency['median_ms']} ms")
+    logger.info(f"⚡ Aceleración {speedup}x, caída de mAP50-95 {drop}")
+    logger.info(f"📝 Informe: {report_markdown}")
+    if speedup < 2.0:
+        logger.warning("⚠️ Aceleración menor de 2x: comprobar que la CPU tiene instrucciones de producto "
+                       "escalar (ARMv8.2 dotprod / AVX-VNNI) o probar --reduce-range en x86 antiguos")
+    if not accepted:
+        logger.error(f"❌ Caída de mAP50-95 por encima de {args.max_map_drop}: probar --calibration percentile, "
+                     f"más imágenes de calibración o limitar --op-types (p. ej. Conv,MatMul)")
+    return accepted
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Cuantización INT8 con calibración sobre Dataset_Frutas')
+    parser.add_argument('--model', type=str, default='weights/best.onnx',
+                        help='Modelo FP32 exportado con Export_Onnx.py')
+    parser.add_argument('--data', type=str, default='IA_Etiquetado/Dataset_Frutas/Data.yaml',
+                        help='Data.yaml del dataset (calibración: train, evaluación: val)')
+    parser.add_argument('--type', type=str, choices=['yolov8', 'rtdetr'], default=None,
+                        help='Tipo de modelo (por defecto el de <modelo>.onnx.json)')
+    parser.add_argument('--output', type=str, default=None,
+                        help='Ruta del modelo INT8 (por defecto <modelo>.int8.onnx)')
+    parser.add_argument('--calibration', type=str, choices=sorted(CALIBRATION_METHODS), default='minmax',
+                        help='Método de calibración de las activaciones')
+    parser.add_argument('--calib-images', type=int, default=128,
+                        help='Imágenes de calibración')
+    parser.add_argument('--eval-images', type=int, default=500,
+                        help='Máximo de imágenes de evaluación (0 = todas)')
+    parser.add_argument('--op-types', type=str, default='',
+                        help='Operadores a cuantizar, separados por comas (por defecto todos los soportados)')
+    parser.add_argument('--quantize-head', action='store_true',
+                        help='Cuantizar también el cabezal (más rápido, más pérdida de mAP)')
+    parser.add_argument('--no-per-channel', dest='per_channel', action='store_false',
+                        help='Escala de pesos por tensor en lugar de por canal')
+    parser.add_argument('--reduce-range', action='store_true',
+                        help='Pesos de 7 bits (CPUs x86 sin VNNI)')
+    parser.add_argument('--uint8-input', action='store_true',
+                        help='Entrada UINT8 0-255 (solo servidor nativo)')
+    parser.add_argument('--threads', type=int, default=0,
+                        help='Hilos de inferencia para medir latencia (0 = todos los núcleos)')
+    parser.add_argument('--runs', type=int, default=50,
+                        help='Inferencias para medir latencia')
+    parser.add_argument('--max-map-drop', type=float, default=0.02,
+                        help='Caída máxima admisible de mAP50-95 (absoluta)')
+    parser.add_argument('--seed', type=int, default=0,
+                        help='Semilla del muestreo de imágenes')
+    args = parser.parse_args()
+
+    try:
+        accepted = run(args)
+    except Exception as e:
+        logger.error(f"❌ Error cuantizando modelo: {e}")
+        sys.exit(1)
+    sys.exit(0 if accepted else 1)
+
+
+if __name__ == "__main__":
+    main()
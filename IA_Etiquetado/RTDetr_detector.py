@@ -75,6 +75,7 @@ from .Fruit_detector import (
     FruitDetection, FrameAnalysisResult, SystemMetrics, AlertMessage,
     DetectionStatistics
 )
+from .detection_postprocess import postprocess_detections
 
 class RTDetrBackend(Enum):
     """Backend de RT-DETR a utilizar."""
@@ -95,6 +96,7 @@ class RTDetrConfig:
     use_dynamic_input: bool = True
     optimize_for_speed: bool = True
     class_names: List[str] = field(default_factory=lambda: ["apple", "pear", "lemon"])
+    min_detection_area: int = 0  # Área mínima en píxeles (0 = sin filtro)
 
 
 class RTDetrInferenceWorker(Thread):
@@ -125,7 +127,9 @@ class RTDetrInferenceWorker(Thread):
             confidence_threshold=config.get("confidence_threshold", 0.5),
             nms_threshold=config.get("nms_threshold", 0.4),
             input_size=tuple(config.get("input_size", [640, 640])),
-            class_names=config.get("class_names", ["apple", "pear", "lemon"])
+            max_detections=config.get("max_detections", 100),
+            class_names=config.get("class_names", ["apple", "pear", "lemon"]),
+            min_detection_area=config.get("min_detection_area", 0)
         )
         
         # Estado del worker
@@ -475,121 +479,23 @@ class RTDetrInferenceWorker(Thread):
             return None
 
     def _process_detections_advanced(self, raw_results, frame_shape) -> List[FruitDetection]:
-        """Procesa las detecciones de RT-DETR con análisis avanzado."""
+        """Procesa las detecciones de RT-DETR con análisis avanzado (vectorizado)."""
         if not raw_results:
             return []
         
-        detections = []
-        frame_height, frame_width = frame_shape[:2]
-        
-        boxes = raw_results.get('boxes', [])
-        scores = raw_results.get('scores', [])
-        labels = raw_results.get('labels', [])
-        
-        # Convertir tensors a numpy si es necesario
-        if hasattr(boxes, 'cpu'):
-            boxes = boxes.cpu().numpy()
-        if hasattr(scores, 'cpu'):
-            scores = scores.cpu().numpy()
-        if hasattr(labels, 'cpu'):
-            labels = labels.cpu().numpy()
-        
-        # Asegurar que son arrays numpy
-        boxes = np.array(boxes) if not isinstance(boxes, np.ndarray) else boxes
-        scores = np.array(scores) if not isinstance(scores, np.ndarray) else scores
-        labels = np.array(labels) if not isinstance(labels, np.ndarray) else labels
-        
-        # Filtrar por confianza
-        confidence_mask = scores > self.rtdetr_config.confidence_threshold
-        
-        if not np.any(confidence_mask):
-            return []
-        
-        boxes = boxes[confidence_mask]
-        scores = scores[confidence_mask]
-        labels = labels[confidence_mask]
-        
-        for i, (box, score, label_id) in enumerate(zip(boxes, scores, labels)):
-            try:
-                # Procesar coordenadas del bounding box
-                x1, y1, x2, y2 = box
-                
-                # Asegurar que las coordenadas están en el rango válido
-                x1 = max(0, min(x1, frame_width))
-                y1 = max(0, min(y1, frame_height))
-                x2 = max(x1, min(x2, frame_width))
-                y2 = max(y1, min(y2, frame_height))
-                
-                # Calcular métricas adicionales
-                width = x2 - x1
-                height = y2 - y1
-                area = int(width * height)
-                aspect_ratio = width / height if height > 0 else 0
-                
-                center_x = int((x1 + x2) / 2)
-                center_y = int((y1 + y2) / 2)
-                
-                # Calcular distancia al borde (normalizada)
-                edge_distance = min(
-                    center_x / frame_width,
-                    center_y / frame_height,
-                    (frame_width - center_x) / frame_width,
-                    (frame_height - center_y) / frame_height
-                )
-                
-                # Obtener nombre de la clase
-                class_name = self.rtdetr_config.class_names[int(label_id)] if int(label_id) < len(self.rtdetr_config.class_names) else "unknown"
-                
-                # Calcular score de calidad
-                quality_score = self._calculate_detection_quality_score(
-                    float(score), area, aspect_ratio, edge_distance
-                )
-                
-                # Crear detección
-                detection = FruitDetection(
-                    class_id=int(label_id),
-                    class_name=class_name,
-                    confidence=float(score),
-                    bbox=(int(x1), int(y1), int(x2), int(y2)),
-                    center_px=(center_x, center_y),
-                    area_px=area,
-                    aspect_ratio=aspect_ratio,
-                    edge_distance=edge_distance,
-                    quality_score=quality_score
-                )
-                
-                detections.append(detection)
-                
-            except Exception as e:
-                logger.warning(f"Error procesando detección {i}: {e}")
-                continue
-        
-        return detections
-
-    def _calculate_detection_quality_score(self, confidence: float, area: int, 
-                                         aspect_ratio: float, edge_distance: float) -> float:
-        """Calcula un score de calidad para la detección."""
-        # Score base de confianza
-        confidence_score = confidence
-        
-        # Penalizar áreas muy pequeñas o muy grandes
-        area_score = 1.0
-        if area < 100:  # Muy pequeña
-            area_score = area / 100
-        elif area > 50000:  # Muy grande
-            area_score = 50000 / area
-        
-        # Penalizar aspect ratios extraños (frutas suelen ser ~redondas)
-        aspect_score = 1.0
-        if aspect_ratio < 0.5 or aspect_ratio > 2.0:
-            aspect_score = 0.7
-        
-        # Penalizar detecciones muy cerca del borde
-        edge_score = max(0.5, edge_distance * 2)
-        
-        # Combinar scores
-        final_score = confidence_score * area_score * aspect_score * edge_score
-        return min(1.0, max(0.0, final_score))
+        # Filtro de confianza, NMS por clase y puntuación sobre arreglos
+        arrays = postprocess_detections(
+            raw_results.get('boxes', []),
+            raw_results.get('scores', []),
+            raw_results.get('labels', []),
+            frame_shape,
+            conf_threshold=self.rtdetr_config.confidence_threshold,
+            iou_threshold=self.rtdetr_config.nms_threshold,
+            min_area=self.rtdetr_config.min_detection_area,
+            max_det=self.rtdetr_config.max_detections,
+            quality="product"
+        )
+        return arrays.to_detections(self.rtdetr_config.class_names)
 
     def _send_alert(self, alert_type: SystemAlert, message: str, details: Dict = None):
         """Envía una alerta al sistema."""
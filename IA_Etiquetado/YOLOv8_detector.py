@@ -63,6 +63,7 @@ from .Fruit_detector import (
     FruitDetection, FrameAnalysisResult, SystemMetrics, AlertMessage,
     DetectionStatistics
 )
+from .detection_postprocess import postprocess_detections, to_numpy
 
 logger = logging.getLogger(__name__)
 
@@ -82,6 +83,7 @@ class YOLOv8Config:
     num_threads: int = 4  # Cores de CPU
     augment: bool = False  # No aumentar en inferencia para mayor velocidad
     agnostic_nms: bool = False
+    min_detection_area: int = 0  # Área mínima en píxeles (0 = sin filtro)
 
 
 # RemoteInferenceClient DEPRECADO - Reemplazado por AsyncInferenceClient
@@ -129,7 +131,8 @@ class YOLOv8InferenceWorker(Thread):
             input_size=config.get("input_size", 640),
             max_detections=config.get("max_detections", 100),
             class_names=config.get("class_names", ["apple", "pear", "lemon"]),
-            num_threads=config.get("num_threads", 4)
+            num_threads=config.get("num_threads", 4),
+            min_detection_area=config.get("min_detection_area", 0)
         )
         
         # Estado del worker
@@ -281,100 +284,21 @@ class YOLOv8InferenceWorker(Thread):
             return None
 
     def _process_detections_advanced(self, yolo_result, frame_shape) -> List[FruitDetection]:
-        """Procesa los resultados de YOLOv8 a objetos FruitDetection."""
+        """Procesa los resultados de YOLOv8 a objetos FruitDetection (vectorizado)."""
         if yolo_result is None or yolo_result.boxes is None:
             return []
         
-        detections = []
-        frame_height, frame_width = frame_shape[:2]
-        
-        boxes = yolo_result.boxes
+        # Una sola copia (N, 6): x1 y1 x2 y2 conf cls. El NMS ya lo aplicó Ultralytics
+        data = to_numpy(yolo_result.boxes.data)
+        if len(data) == 0:
+            return []
         
-        for i in range(len(boxes)):
-            try:
-                # Extraer datos del box
-                box_xyxy = boxes.xyxy[i].cpu().numpy()  # [x1, y1, x2, y2]
-                confidence = float(boxes.conf[i].cpu().numpy())
-                class_id = int(boxes.cls[i].cpu().numpy())
-                
-                # Coordenadas
-                x1, y1, x2, y2 = map(int, box_xyxy)
-                
-                # Asegurar que están en rango válido
-                x1 = max(0, min(x1, frame_width))
-                y1 = max(0, min(y1, frame_height))
-                x2 = max(x1, min(x2, frame_width))
-                y2 = max(y1, min(y2, frame_height))
-                
-                # Calcular métricas
-                width = x2 - x1
-                height = y2 - y1
-                area = int(width * height)
-                aspect_ratio = width / height if height > 0 else 0
-                
-                center_x = int((x1 + x2) / 2)
-                center_y = int((y1 + y2) / 2)
-                
-                # Distancia al borde (normalizada)
-                edge_distance = min(
-                    center_x / frame_width,
-                    center_y / frame_height,
-                    (frame_width - center_x) / frame_width,
-                    (frame_height - center_y) / frame_height
-                )
-                
-                # Nombre de clase
-                class_name = self.yolo_config.class_names[class_id] if class_id < len(self.yolo_config.class_names) else "unknown"
-                
-                # Score de calidad
-                quality_score = self._calculate_detection_quality_score(
-                    confidence, area, aspect_ratio, edge_distance
-                )
-                
-                # Crear detección
-                detection = FruitDetection(
-                    class_id=class_id,
-                    class_name=class_name,
-                    confidence=confidence,
-                    bbox=(x1, y1, x2, y2),
-                    center_px=(center_x, center_y),
-                    area_px=area,
-                    aspect_ratio=aspect_ratio,
-                    edge_distance=edge_distance,
-                    quality_score=quality_score
-                )
-                
-                detections.append(detection)
-                
-            except Exception as e:
-                logger.warning(f"Error procesando detección {i}: {e}")
-                continue
-        
-        return detections
-
-    def _calculate_detection_quality_score(self, confidence: float, area: int, 
-                                         aspect_ratio: float, edge_distance: float) -> float:
-        """Calcula un score de calidad para la detección."""
-        confidence_score = confidence
-        
-        # Penalizar áreas muy pequeñas o muy grandes
-        area_score = 1.0
-        if area < 100:
-            area_score = area / 100
-        elif area > 50000:
-            area_score = 50000 / area
-        
-        # Penalizar aspect ratios extraños (frutas ~redondas)
-        aspect_score = 1.0
-        if aspect_ratio < 0.5 or aspect_ratio > 2.0:
-            aspect_score = 0.7
-        
-        # Penalizar detecciones cerca del borde
-        edge_score = max(0.5, edge_distance * 2)
-        
-        # Score final
-        final_score = confidence_score * area_score * aspect_score * edge_score
-        return min(1.0, max(0.0, final_score))
+        arrays = postprocess_detections(
+            data[:, :4], data[:, 4], data[:, 5], frame_shape,
+            min_area=self.yolo_config.min_detection_area,
+            quality="product"
+        )
+        return arrays.to_detections(self.yolo_config.class_names)
 
     def _process_frame_advanced(self, frame_id: str, frame: np.ndarray, 
                               priority: ProcessingPriority) -> FrameAnalysisResult:
@@ -14,6 +14,7 @@ Características:
 - Token de autenticación
 - Timeouts optimizados
 - Pool de conexiones reutilizables
+- Memoria compartida con servidores locales (sin JPEG ni imagen por HTTP)
 - Fallback inteligente
 
 Autor(es): Gabriel Calderón, Elias Bautista
@@ -32,6 +33,7 @@ from enum import Enum
 import numpy as np
 import cv2
 from datetime import datetime, timedelta
+from urllib.parse import urlparse
 
 try:
     import httpx
@@ -40,6 +42,11 @@ except ImportError:
     HTTPX_AVAILABLE = False
     print("⚠️ httpx no disponible. Instala con: pip install httpx")
 
+try:
+    from utils.shared_frame_ring import SharedFrameRing, SHARED_MEMORY_AVAILABLE
+except ImportError:
+    SHARED_MEMORY_AVAILABLE = False
+
 logger = logging.getLogger(__name__)
 
 
@@ -120,6 +127,8 @@ class AsyncInferenceClient:
                 - timeouts: Configuración de timeouts
                 - compression: Configuración de compresión
                 - circuit_breaker: Configuración del circuit breaker
+                - shared_memory: Transporte local por memoria compartida
+                  ("enabled": "auto" | true | false, "slots": 8)
         """
         if not HTTPX_AVAILABLE:
             raise ImportError("httpx es requerido. Instala con: pip install httpx")
@@ -144,6 +153,20 @@ class AsyncInferenceClient:
         self.jpeg_quality = int(compress_cfg.get("jpeg_quality", 85))
         self.max_dimension = int(compress_cfg.get("max_dimension", 640))
         self.auto_quality = bool(compress_cfg.get("auto_quality", True))
+        # Huffman óptimo: ~8% menos bytes pero más del doble de tiempo de codificación
+        self.optimize_huffman = bool(compress_cfg.get("optimize_huffman", False))
+        
+        # Buffers reutilizables para el redimensionado (evita reservas por frame)
+        self._resize_buffers: Dict[Tuple[int, ...], np.ndarray] = {}
+        
+        # Memoria compartida: "auto" solo si el servidor está en esta máquina
+        shm_cfg = config.get("shared_memory", {})
+        shm_mode = shm_cfg.get("enabled", "auto")
+        is_local = urlparse(self.server_url).hostname in ("localhost", "127.0.0.1", "::1")
+        self.shm_endpoint = shm_cfg.get("endpoint", "/infer_shm")
+        self.shm_slots = int(shm_cfg.get("slots", 8))
+        self._shm_enabled = SHARED_MEMORY_AVAILABLE and (shm_mode is True or (shm_mode == "auto" and is_local))
+        self._shm_ring = None
         
         # Circuit Breaker
         cb_cfg = config.get("circuit_breaker", {})
@@ -162,6 +185,7 @@ class AsyncInferenceClient:
             "requests_total": 0,
             "requests_success": 0,
             "requests_failed": 0,
+            "requests_shared_memory": 0,
             "total_latency_ms": 0.0,
             "last_success_time": None,
             "last_error_time": None
@@ -266,6 +290,7 @@ class AsyncInferenceClient:
             Tupla de (imagen_comprimida, metadatos)
         """
         original_shape = frame.shape
+        encode_start = time.perf_counter()
         
         # Redimensionar agresivamente si es necesario para maximizar FPS
         h, w = frame.shape[:2]
@@ -273,8 +298,7 @@ class AsyncInferenceClient:
             scale = self.max_dimension / max(h, w)
             new_w = int(w * scale)
             new_h = int(h * scale)
-            # INTER_AREA es mejor para redimensionar a menor resolución
-            frame = cv2.resize(frame, (new_w, new_h), interpolation=cv2.INTER_AREA)
+            frame = self._downscale(frame, new_w, new_h)
         
         # Determinar calidad JPEG ultra-adaptativa para streaming
         quality = self.jpeg_quality
@@ -292,7 +316,7 @@ class AsyncInferenceClient:
         # Optimizaciones JPEG para velocidad
         encode_params = [
             int(cv2.IMWRITE_JPEG_QUALITY), quality,
-            int(cv2.IMWRITE_JPEG_OPTIMIZE), 1,  # Huffman óptimo (un poco más lento, mejor compresión)
+            int(cv2.IMWRITE_JPEG_OPTIMIZE), int(self.optimize_huffman),  # Huffman óptimo (más lento, mejor compresión)
             int(cv2.IMWRITE_JPEG_PROGRESSIVE), 0  # No progresivo (más rápido)
         ]
         success, buffer = cv2.imencode('.jpg', frame, encode_params)
@@ -305,11 +329,55 @@ class AsyncInferenceClient:
             "compressed_shape": frame.shape,
             "quality": quality,
             "size_bytes": len(buffer),
-            "compression_ratio": (original_shape[0] * original_shape[1] * 3) / len(buffer)
+            "compression_ratio": (original_shape[0] * original_shape[1] * 3) / len(buffer),
+            "encode_ms": (time.perf_counter() - encode_start) * 1000
         }
         
         return buffer.tobytes(), metadata
     
+    def _downscale(self, frame: np.ndarray, new_w: int, new_h: int) -> np.ndarray:
+        """
+        Reduce la imagen con INTER_AREA a una fracción del coste.
+        
+        Con factor entero (1920x1080 -> 640x360) se usa INTER_AREA directo, que
+        ya tiene ruta rápida. Si no, encadena reducciones 2x exactas mientras
+        sobre al menos el doble del tamaño destino y termina con INTER_AREA
+        sobre la imagen ya reducida (factor < 2, barato); el resultado se
+        aproxima al de un único INTER_AREA sin ser idéntico. Todos los
+        destinos son buffers reutilizables.
+        """
+        height, width = frame.shape[:2]
+        if width % new_w == 0 and height % new_h == 0 and width // new_w == height // new_h:
+            return cv2.resize(frame, (new_w, new_h), interpolation=cv2.INTER_AREA,
+                              dst=self._get_resize_buffer((new_h, new_w) + frame.shape[2:]))
+        
+        source = frame
+        while source.shape[1] >= 2 * new_w and source.shape[0] >= 2 * new_h:
+            half_h, half_w = source.shape[0] // 2, source.shape[1] // 2
+            # Recortar a tamaño par para mantener la ruta 2x exacta
+            even = source[:half_h * 2, :half_w * 2]
+            source = cv2.resize(even, (half_w, half_h), interpolation=cv2.INTER_AREA,
+                                dst=self._get_resize_buffer((half_h, half_w) + frame.shape[2:]))
+        
+        if source.shape[:2] == (new_h, new_w):
+            return source
+        
+        # El último paso también promedia áreas: un ajuste lineal a factores de
+        # hasta 2x solo toma 2x2 muestras y produce aliasing
+        return cv2.resize(source, (new_w, new_h), interpolation=cv2.INTER_AREA,
+                          dst=self._get_resize_buffer((new_h, new_w) + frame.shape[2:]))
+    
+    def _get_resize_buffer(self, shape: Tuple[int, ...]) -> np.ndarray:
+        """Devuelve un buffer uint8 persistente para la forma indicada."""
+        buffer = self._resize_buffers.get(shape)
+        if buffer is None:
+            # Limitar el número de formas distintas retenidas
+            if len(self._resize_buffers) >= 8:
+                self._resize_buffers.clear()
+            buffer = np.empty(shape, dtype=np.uint8)
+            self._resize_buffers[shape] = buffer
+        return buffer
+    
     async def infer(self, frame: np.ndarray, params: Optional[Dict[str, Any]] = None) -> Optional[Dict[str, Any]]:
         """
         Realiza inferencia remota de manera asíncrona.
@@ -332,12 +400,7 @@ class AsyncInferenceClient:
         try:
             await self._ensure_client()
             
-            # Comprimir imagen
-            image_data, compression_metadata = self._compress_image(frame)
-            
             # Preparar datos del formulario
-            files = {"image": ("frame.jpg", image_data, "image/jpeg")}
-            
             data = {}
             if params:
                 data.update({
@@ -350,13 +413,27 @@ class AsyncInferenceClient:
                 # Enviar nombres de clases si están disponibles
                 if "class_names" in params:
                     data["class_names_json"] = json.dumps(params["class_names"])
+                
+                # Plazo del frame: el servidor lo usa para decidir cuánto agrupar (micro-batching)
+                if params.get("deadline_ms") is not None:
+                    data["deadline_ms"] = params["deadline_ms"]
             
-            # Realizar petición asíncrona
-            response = await self.client.post(
-                self.infer_endpoint,
-                files=files,
-                data=data
-            )
+            # Servidor local: el frame viaja por memoria compartida
+            shared = await self._infer_shared_memory(frame, data) if self._shm_enabled else None
+            
+            if shared is not None:
+                response, compression_metadata = shared
+            else:
+                # Comprimir imagen
+                image_data, compression_metadata = self._compress_image(frame)
+                files = {"image": ("frame.jpg", image_data, "image/jpeg")}
+                
+                # Realizar petición asíncrona
+                response = await self.client.post(
+                    self.infer_endpoint,
+                    files=files,
+                    data=data
+                )
             
             if response.status_code == 200:
                 result = response.json()
@@ -397,10 +474,74 @@ class AsyncInferenceClient:
             self.stats["last_error_time"] = datetime.now()
             return None
     
+    async def _infer_shared_memory(self, frame: np.ndarray, data: Dict[str, Any]):
+        """
+        Envía el frame por el anillo de memoria compartida.
+        
+        Returns:
+            (respuesta, metadatos) o None para usar el camino HTTP con JPEG
+        """
+        try:
+            if self._shm_ring is None:
+                self._shm_ring = SharedFrameRing.create(
+                    slot_count=self.shm_slots,
+                    slot_bytes=self.max_dimension * self.max_dimension * 3
+                )
+            
+            copy_start = time.perf_counter()
+            original_shape = frame.shape
+            h, w = frame.shape[:2]
+            if max(h, w) > self.max_dimension:
+                scale = self.max_dimension / max(h, w)
+                frame = self._downscale(frame, int(w * scale), int(h * scale))
+            
+            if frame.ndim != 3 or not self._shm_ring.fits(frame):
+                return None
+            slot, seq = self._shm_ring.write(frame)
+        except Exception as e:
+            self._disable_shared_memory(str(e))
+            return None
+        
+        metadata = {
+            "transport": "shared_memory",
+            "original_shape": original_shape,
+            "compressed_shape": frame.shape,
+            "size_bytes": frame.nbytes,
+            "encode_ms": (time.perf_counter() - copy_start) * 1000
+        }
+        
+        response = await self.client.post(
+            self.shm_endpoint,
+            data={**data, "ring": self._shm_ring.name, "slot": slot, "seq": seq}
+        )
+        
+        if response.status_code in (400, 403, 404):
+            # Servidor sin soporte o sin acceso al segmento: quedarse en HTTP
+            self._disable_shared_memory(f"servidor respondió {response.status_code}")
+            return None
+        if response.status_code == 409:
+            # Slot reutilizado antes de terminar: repetir este frame por HTTP
+            return None
+        
+        if response.status_code == 200:
+            self.stats["requests_shared_memory"] += 1
+        return response, metadata
+    
+    def _disable_shared_memory(self, reason: str):
+        """Desactiva el transporte por memoria compartida y libera el anillo."""
+        self._shm_enabled = False
+        if self._shm_ring is not None:
+            self._shm_ring.close()
+            self._shm_ring = None
+        logger.warning(f"⚠️ Memoria compartida desactivada ({reason}); usando HTTP con JPEG")
+    
     async def batch_infer(self, frames: list[np.ndarray], params: Optional[Dict[str, Any]] = None) -> list[Optional[Dict[str, Any]]]:
         """
         Realiza inferencia en batch de manera asíncrona.
         
+        Las peticiones se envían concurrentemente; el servidor las agrupa en
+        micro-batches (mismo imgsz/conf/iou/max_det) respetando deadline_ms.
+        
         Args:
             frames: Lista de imágenes para inferencia
             params: Parámetros adicionales de IA
@@ -430,6 +571,7 @@ class AsyncInferenceClient:
             "requests_total": self.stats["requests_total"],
             "requests_success": self.stats["requests_success"],
             "requests_failed": self.stats["requests_failed"],
+            "requests_shared_memory": self.stats["requests_shared_memory"],
             "success_rate": self.stats["requests_success"] / total_requests,
             "avg_latency_ms": self.stats["total_latency_ms"] / total_requests,
             "circuit_breaker_state": self.circuit_breaker.state.value,
@@ -443,6 +585,9 @@ class AsyncInferenceClient:
             await self.client.aclose()
             self.client = None
             logger.info("Cliente HTTP asíncrono cerrado")
+        if self._shm_ring is not None:
+            self._shm_ring.close()
+            self._shm_ring = None
     
     def __del__(self):
         """Limpieza al destruir el objeto."""
@@ -0,0 +1,233 @@
+# IA_Etiquetado/detection_postprocess.py
+"""
+Post-procesamiento Vectorizado de Detecciones
+=============================================
+
+Convierte la salida cruda de los detectores (YOLOv8, RT-DETR) en detecciones
+listas para el sistema trabajando sobre arreglos (estructura de arreglos) en
+lugar de objetos por caja:
+
+- Una sola conversión tensor -> numpy por campo (no .cpu() por caja)
+- Filtro de confianza, NMS por clase y filtro de área vectorizados
+- Geometría (recorte, centro, área, relación de aspecto, distancia al
+  borde) y puntuación de calidad calculadas para todas las cajas a la vez
+- Los objetos FruitDetection se crean solo para las cajas que sobreviven
+
+Uso:
+    arrays = postprocess_detections(boxes_xyxy, scores, class_ids, frame.shape,
+                                    conf_threshold=0.5, iou_threshold=0.45,
+                                    quality="product")
+    detections = arrays.to_detections(class_names)
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+from dataclasses import dataclass
+from typing import Any, Dict, List, Optional, Sequence, Tuple, Union
+
+import cv2
+import numpy as np
+
+
+def to_numpy(values: Any, dtype=np.float32) -> np.ndarray:
+    """Convierte tensores (torch/paddle), listas o arreglos a numpy."""
+    if hasattr(values, "detach"):
+        values = values.detach()
+    if hasattr(values, "cpu"):
+        values = values.cpu()
+    if hasattr(values, "numpy"):
+        values = values.numpy()
+    return np.asarray(values, dtype=dtype)
+
+
+@dataclass
+class DetectionArrays:
+    """Detecciones de un frame como arreglos paralelos (una fila por caja)."""
+    boxes: np.ndarray            # (N, 4) int32, x1 y1 x2 y2 recortadas al frame
+    scores: np.ndarray           # (N,) float32
+    class_ids: np.ndarray        # (N,) int32
+    centers: np.ndarray          # (N, 2) int32
+    areas: np.ndarray            # (N,) int64
+    aspect_ratios: np.ndarray    # (N,) float64
+    edge_distances: np.ndarray   # (N,) float64
+    quality_scores: np.ndarray   # (N,) float64
+
+    @classmethod
+    def empty(cls) -> "DetectionArrays":
+        return cls(np.empty((0, 4), np.int32), np.empty(0, np.float32), np.empty(0, np.int32),
+                   np.empty((0, 2), np.int32), np.empty(0, np.int64), np.empty(0),
+                   np.empty(0), np.empty(0))
+
+    def __len__(self) -> int:
+        return len(self.scores)
+
+    def select(self, index: np.ndarray) -> "DetectionArrays":
+        """Subconjunto por máscara booleana o índices."""
+        return DetectionArrays(self.boxes[index], self.scores[index], self.class_ids[index],
+                               self.centers[index], self.areas[index], self.aspect_ratios[index],
+                               self.edge_distances[index], self.quality_scores[index])
+
+    def to_detections(self, class_names: Union[Sequence[str], Dict[int, str]]) -> List[Any]:
+        """Crea los FruitDetection de las cajas resultantes."""
+        from .Fruit_detector import FruitDetection
+
+        if isinstance(class_names, dict):
+            lookup = class_names.get
+        else:
+            names = list(class_names)
+            lookup = lambda i, default: names[i] if 0 <= i < len(names) else default
+
+        return [
+            FruitDetection(
+                class_id=class_id,
+                class_name=lookup(class_id, "unknown"),
+                confidence=score,
+                bbox=tuple(box),
+                center_px=tuple(center),
+                area_px=area,
+                aspect_ratio=aspect,
+                edge_distance=edge,
+                quality_score=quality
+            )
+            for box, score, class_id, center, area, aspect, edge, quality in zip(
+                self.boxes.tolist(), self.scores.tolist(), self.class_ids.tolist(),
+                self.centers.tolist(), self.areas.tolist(), self.aspect_ratios.tolist(),
+                self.edge_distances.tolist(), self.quality_scores.tolist())
+        ]
+
+
+def class_aware_nms(boxes: np.ndarray, scores: np.ndarray, class_ids: np.ndarray,
+                    iou_threshold: float, agnostic: bool = False) -> np.ndarray:
+    """
+    NMS por clase en una sola llamada: las cajas de cada clase se desplazan a
+    una región disjunta para que nunca se supriman entre clases distintas.
+
+    Returns:
+        Índices conservados, ordenados por confianza descendente
+    """
+    if len(scores) == 0:
+        return np.empty(0, np.int64)
+
+    boxes = boxes.astype(np.float64, copy=True)
+    if not agnostic:
+        offset = (class_ids.astype(np.float64) * (float(boxes.max()) + 1.0))[:, None]
+        boxes += offset
+    xywh = np.concatenate([boxes[:, :2], boxes[:, 2:] - boxes[:, :2]], axis=1)
+
+    keep = cv2.dnn.NMSBoxes(xywh, scores.astype(np.float32), 0.0, float(iou_threshold))
+    return np.asarray(keep, dtype=np.int64).reshape(-1)
+
+
+def product_quality_scores(arrays: DetectionArrays) -> np.ndarray:
+    """
+    Calidad multiplicativa (detectores YOLOv8/RT-DETR): confianza penalizada
+    por área extrema, relación de aspecto poco redonda y cercanía al borde.
+    """
+    areas = arrays.areas.astype(np.float64)
+    area_score = np.ones_like(areas)
+    small = areas < 100
+    large = areas > 50000
+    area_score[small] = areas[small] / 100
+    area_score[large] = 50000 / areas[large]
+
+    aspect = arrays.aspect_ratios
+    aspect_score = np.where((aspect < 0.5) | (aspect > 2.0), 0.7, 1.0)
+    edge_score = np.maximum(0.5, arrays.edge_distances * 2)
+
+    return np.clip(arrays.scores * area_score * aspect_score * edge_score, 0.0, 1.0)
+
+
+def weighted_quality_scores(arrays: DetectionArrays) -> np.ndarray:
+    """Calidad como promedio ponderado (worker genérico de Fruit_detector)."""
+    quality = (arrays.scores * 0.4 +
+               np.minimum(1.0, arrays.areas / 10000) * 0.2 +
+               (1.0 - np.abs(arrays.aspect_ratios - 1.0)) * 0.2 +
+               arrays.edge_distances * 0.2)
+    return np.clip(quality, 0.0, 1.0)
+
+
+QUALITY_FUNCTIONS = {
+    "product": product_quality_scores,
+    "weighted": weighted_quality_scores,
+}
+
+
+def postprocess_detections(boxes: Any, scores: Any, class_ids: Any,
+                           frame_shape: Tuple[int, ...],
+                           conf_threshold: Optional[float] = None,
+                           iou_threshold: Optional[float] = None,
+                           agnostic: bool = False,
+                           min_area: int = 0,
+                           max_det: Optional[int] = None,
+                           edge_mode: str = "center",
+                           quality: str = "product") -> DetectionArrays:
+    """
+    Filtra, decodifica y puntúa las detecciones de un frame.
+
+    Args:
+        boxes: (N, 4) x1 y1 x2 y2 en píxeles del frame
+        scores: (N,) confianzas
+        class_ids: (N,) clases
+        frame_shape: Forma del frame (alto, ancho, ...)
+        conf_threshold: Descarta confianzas <= umbral (None = sin filtro)
+        iou_threshold: Umbral de NMS por clase (None = sin NMS)
+        agnostic: NMS sin distinguir clases
+        min_area: Área mínima en píxeles de la caja recortada
+        max_det: Máximo de detecciones (las de mayor confianza)
+        edge_mode: "center" (centro respecto al frame) o "bbox" (caja respecto al borde)
+        quality: "product" o "weighted"
+    """
+    boxes = to_numpy(boxes).reshape(-1, 4)
+    scores = to_numpy(scores).reshape(-1)
+    class_ids = to_numpy(class_ids, np.int32).reshape(-1)
+    if len(scores) == 0:
+        return DetectionArrays.empty()
+
+    if conf_threshold is not None:
+        keep = scores > conf_threshold
+        boxes, scores, class_ids = boxes[keep], scores[keep], class_ids[keep]
+
+    if iou_threshold is not None and len(scores) > 1:
+        keep = class_aware_nms(boxes, scores, class_ids, iou_threshold, agnostic)
+        boxes, scores, class_ids = boxes[keep], scores[keep], class_ids[keep]
+
+    # Recortar al frame y truncar a píxeles enteros
+    frame_height, frame_width = frame_shape[:2]
+    x1 = np.clip(boxes[:, 0], 0, frame_width)
+    y1 = np.clip(boxes[:, 1], 0, frame_height)
+    x2 = np.clip(boxes[:, 2], x1, frame_width)
+    y2 = np.clip(boxes[:, 3], y1, frame_height)
+    int_boxes = np.stack([x1, y1, x2, y2], axis=1).astype(np.int32)
+
+    widths = int_boxes[:, 2] - int_boxes[:, 0]
+    heights = int_boxes[:, 3] - int_boxes[:, 1]
+    areas = widths.astype(np.int64) * heights
+
+    if min_area > 0:
+        keep = areas >= min_area
+        int_boxes, scores, class_ids = int_boxes[keep], scores[keep], class_ids[keep]
+        widths, heights, areas = widths[keep], heights[keep], areas[keep]
+
+    if max_det is not None and len(scores) > max_det:
+        keep = np.argsort(-scores, kind="stable")[:max_det]
+        int_boxes, scores, class_ids = int_boxes[keep], scores[keep], class_ids[keep]
+        widths, heights, areas = widths[keep], heights[keep], areas[keep]
+
+    aspect_ratios = np.divide(widths, heights, out=np.zeros(len(widths)), where=heights > 0)
+    centers = np.stack([(int_boxes[:, 0] + int_boxes[:, 2]) // 2,
+                        (int_boxes[:, 1] + int_boxes[:, 3]) // 2], axis=1)
+
+    if edge_mode == "bbox":
+        margins = np.minimum.reduce([int_boxes[:, 0], int_boxes[:, 1],
+                                     frame_width - int_boxes[:, 2], frame_height - int_boxes[:, 3]])
+        edge_distances = margins / min(frame_width, frame_height)
+    else:
+        edge_distances = np.minimum.reduce([centers[:, 0] / frame_width, centers[:, 1] / frame_height,
+                                            (frame_width - centers[:, 0]) / frame_width,
+                                            (frame_height - centers[:, 1]) / frame_height])
+
+    arrays = DetectionArrays(int_boxes, scores, class_ids, centers, areas,
+                             aspect_ratios, edge_distances, np.empty(0))
+    arrays.quality_scores = QUALITY_FUNCTIONS[quality](arrays)
+    return arrays
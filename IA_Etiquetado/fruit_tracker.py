@@ -0,0 +1,353 @@
+# IA_Etiquetado/fruit_tracker.py
+"""
+Seguimiento Multi-Objeto de Frutas sobre la Banda
+=================================================
+
+Asigna identificadores estables a las detecciones de cada frame para que la
+clasificación temporal acumule evidencia por fruta y no por frame:
+
+- Estado de todos los tracks en arreglos paralelos (estructura de arreglos)
+- Filtro de Kalman de velocidad constante a lo largo del eje de la banda
+  (posición y velocidad con covarianza 2x2 por track, vectorizado); el eje
+  transversal y el tamaño de la caja se suavizan exponencialmente
+- Todas las frutas viajan con la banda: un track nuevo arranca con la
+  velocidad mediana de los tracks confirmados (o initial_velocity)
+- IoU solo entre pares candidatos cuyas cajas se solapan en X (barrido
+  sobre intervalos ordenados), no la matriz completa tracks x detecciones;
+  compuerta por clase opcional
+- Asignación voraz por IoU descendente (rondas vectorizadas de mejores
+  mutuos) o húngara (scipy, si está disponible)
+- Ciclo de vida: tentativo -> confirmado tras min_hits aciertos; se elimina
+  tras max_age frames sin detección o al salir del frame por el eje de banda
+
+Uso:
+    tracker = FruitTracker(belt_axis="x", min_hits=2, max_age=5)
+    result = tracker.update(boxes_xyxy, class_ids=class_ids, timestamp=ts)
+    for det, track_id, new in zip(detections, result.track_ids, result.new_mask):
+        ...
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import itertools
+import time
+from dataclasses import dataclass
+from typing import Any, Dict, Optional
+
+import numpy as np
+
+try:
+    from scipy.optimize import linear_sum_assignment
+    SCIPY_AVAILABLE = True
+except ImportError:
+    SCIPY_AVAILABLE = False
+
+
+def candidate_pairs(a: np.ndarray, b: np.ndarray):
+    """
+    Pares (i, j) de cajas de a y b que se solapan en X.
+
+    Las cajas de a se ordenan por x1; las que pueden solaparse con b[j]
+    tienen x1 en (b.x1 - ancho máximo de a, b.x2).
+    """
+    order = np.argsort(a[:, 0], kind="stable")
+    sorted_x1 = a[order, 0]
+    max_width = float((a[:, 2] - a[:, 0]).max())
+    lo = np.searchsorted(sorted_x1, b[:, 0] - max_width, side="left")
+    counts = np.searchsorted(sorted_x1, b[:, 2], side="left") - lo
+
+    j = np.repeat(np.arange(len(b)), counts)
+    start = np.cumsum(counts) - counts
+    i = order[lo[j] + np.arange(len(j)) - start[j]]
+    overlap = a[i, 2] > b[j, 0]
+    return i[overlap], j[overlap]
+
+
+def pair_iou(a: np.ndarray, b: np.ndarray) -> np.ndarray:
+    """IoU fila a fila entre a (K, 4) y b (K, 4) en formato x1 y1 x2 y2."""
+    iw = np.minimum(a[:, 2], b[:, 2]) - np.maximum(a[:, 0], b[:, 0])
+    ih = np.minimum(a[:, 3], b[:, 3]) - np.maximum(a[:, 1], b[:, 1])
+    inter = np.maximum(iw, 0) * np.maximum(ih, 0)
+    union = ((a[:, 2] - a[:, 0]) * (a[:, 3] - a[:, 1]) +
+             (b[:, 2] - b[:, 0]) * (b[:, 3] - b[:, 1]) - inter)
+    return np.divide(inter, union, out=np.zeros_like(inter), where=union > 0)
+
+
+def greedy_assignment(rows: np.ndarray, cols: np.ndarray, iou: np.ndarray):
+    """
+    Asignación voraz por IoU descendente sobre pares dispersos.
+
+    Un par que es el mejor de su fila y de su columna siempre entra en la
+    solución voraz; se aceptan todos los mejores mutuos a la vez y se repite
+    con los pares restantes (normalmente 1-3 rondas).
+    """
+    matched_rows, matched_cols = [], []
+    order = np.argsort(-iou, kind="stable")
+    rows, cols = rows[order], cols[order]
+    used_rows = np.zeros(int(rows.max()) + 1 if len(rows) else 0, bool)
+    used_cols = np.zeros(int(cols.max()) + 1 if len(cols) else 0, bool)
+    while len(rows):
+        _, first_in_row = np.unique(rows, return_index=True)
+        _, first_in_col = np.unique(cols, return_index=True)
+        best = np.zeros(len(rows), np.int8)
+        best[first_in_row] += 1
+        best[first_in_col] += 1
+        mutual = best == 2
+        matched_rows.append(rows[mutual])
+        matched_cols.append(cols[mutual])
+        used_rows[rows[mutual]] = True
+        used_cols[cols[mutual]] = True
+        free = ~used_rows[rows] & ~used_cols[cols]
+        rows, cols = rows[free], cols[free]
+    if not matched_rows:
+        return np.empty(0, np.int64), np.empty(0, np.int64)
+    return np.concatenate(matched_rows), np.concatenate(matched_cols)
+
+
+def hungarian_assignment(rows: np.ndarray, cols: np.ndarray, iou: np.ndarray, shape: tuple):
+    """Asignación óptima (máxima IoU total) entre los pares válidos."""
+    dense = np.zeros(shape)
+    dense[rows, cols] = iou
+    best_rows, best_cols = linear_sum_assignment(-dense)
+    valid = dense[best_rows, best_cols] > 0
+    return best_rows[valid], best_cols[valid]
+
+
+@dataclass
+class TrackingResult:
+    """Asignación de un frame, alineada con las detecciones de entrada."""
+    track_ids: np.ndarray        # (M,) int64
+    new_mask: np.ndarray         # (M,) bool, track creado en este frame
+    confirmed_mask: np.ndarray   # (M,) bool, track con min_hits aciertos
+    removed_ids: np.ndarray      # ids de tracks eliminados en este frame
+
+
+class FruitTracker:
+    """Tracker IoU + Kalman sobre el eje de la banda."""
+
+    def __init__(self, belt_axis: str = "x", iou_threshold: float = 0.2,
+                 min_hits: int = 2, max_age: int = 5, class_aware: bool = True,
+                 assignment: str = "greedy", frame_size: Optional[tuple] = None,
+                 initial_velocity: float = 0.0, velocity_std: float = 500.0,
+                 process_noise: float = 50.0, measurement_noise: float = 4.0,
+                 smoothing: float = 0.5):
+        """
+        Args:
+            belt_axis: Eje de avance de la banda en la imagen ("x" o "y")
+            iou_threshold: IoU mínima entre caja predicha y detección
+            min_hits: Aciertos para confirmar un track
+            max_age: Frames sin detección antes de eliminar un track
+            class_aware: Solo asociar detecciones de la misma clase
+            assignment: "greedy" o "hungarian" (requiere scipy)
+            frame_size: (ancho, alto) para eliminar tracks que salen del frame
+            initial_velocity: Velocidad (px/s) supuesta para el primer track
+            velocity_std: Incertidumbre (px/s) de la velocidad de un track nuevo
+            process_noise: Ruido de aceleración (px/s^2) del modelo de movimiento
+            measurement_noise: Desviación (px) de la posición medida
+            smoothing: Peso de la medida en el suavizado de eje transversal y tamaño
+        """
+        if belt_axis not in ("x", "y"):
+            raise ValueError(f"belt_axis inválido: {belt_axis}")
+        if assignment == "hungarian" and not SCIPY_AVAILABLE:
+            assignment = "greedy"
+
+        self.belt_axis = belt_axis
+        self.iou_threshold = iou_threshold
+        self.min_hits = max(1, min_hits)
+        self.max_age = max(0, max_age)
+        self.class_aware = class_aware
+        self.assignment = assignment
+        self.frame_size = frame_size
+        self.initial_velocity = initial_velocity
+        self.velocity_std = velocity_std
+        self.process_noise = process_noise
+        self.measurement_noise = measurement_noise
+        self.smoothing = smoothing
+
+        self._ids = itertools.count(1)
+        self._last_timestamp: Optional[float] = None
+        self._reset_state()
+        self.stats = {"frames": 0, "tracks_created": 0, "tracks_removed": 0}
+
+    def _reset_state(self):
+        # Eje de banda: posición u, velocidad du y covarianza 2x2
+        self.u = np.empty(0)
+        self.du = np.empty(0)
+        self.P = np.empty((0, 2, 2))
+        # Eje transversal y tamaño (ancho/alto de la caja)
+        self.v = np.empty(0)
+        self.size = np.empty((0, 2))
+        self.ids = np.empty(0, np.int64)
+        self.class_ids = np.empty(0, np.int64)
+        self.hits = np.empty(0, np.int64)
+        self.misses = np.empty(0, np.int64)
+
+    def __len__(self) -> int:
+        return len(self.ids)
+
+    def reset(self):
+        """Elimina todos los tracks."""
+        self._reset_state()
+        self._last_timestamp = None
+
+    # --- Modelo de movimiento ---
+
+    def _predict(self, dt: float):
+        if len(self.ids) == 0 or dt <= 0:
+            return
+        self.u = self.u + self.du * dt
+        F = np.array([[1.0, dt], [0.0, 1.0]])
+        q = self.process_noise ** 2
+        Q = q * np.array([[dt ** 4 / 4, dt ** 3 / 2], [dt ** 3 / 2, dt ** 2]])
+        self.P = F @ self.P @ F.T + Q
+
+    def _kalman_update(self, index: np.ndarray, measured_u: np.ndarray):
+        P = self.P[index]
+        S = P[:, 0, 0] + self.measurement_noise ** 2
+        K = P[:, :, 0] / S[:, None]                        # (k, 2)
+        residual = measured_u - self.u[index]
+        self.u[index] += K[:, 0] * residual
+        self.du[index] += K[:, 1] * residual
+        # P = (I - K H) P con H = [1, 0]
+        self.P[index] = P - K[:, :, None] * P[:, None, 0, :]
+
+    def predicted_boxes(self) -> np.ndarray:
+        """Cajas x1 y1 x2 y2 de los tracks según el estado actual."""
+        if self.belt_axis == "x":
+            cx, cy = self.u, self.v
+        else:
+            cx, cy = self.v, self.u
+        half_w, half_h = self.size[:, 0] / 2, self.size[:, 1] / 2
+        return np.stack([cx - half_w, cy - half_h, cx + half_w, cy + half_h], axis=1)
+
+    def _split_axes(self, boxes: np.ndarray):
+        cx = (boxes[:, 0] + boxes[:, 2]) / 2
+        cy = (boxes[:, 1] + boxes[:, 3]) / 2
+        size = np.stack([boxes[:, 2] - boxes[:, 0], boxes[:, 3] - boxes[:, 1]], axis=1)
+        return (cx, cy, size) if self.belt_axis == "x" else (cy, cx, size)
+
+    # --- Actualización por frame ---
+
+    def update(self, boxes: Any, class_ids: Any = None,
+               timestamp: Optional[float] = None) -> TrackingResult:
+        """
+        Asocia las detecciones de un frame con los tracks existentes.
+
+        Args:
+            boxes: (M, 4) cajas x1 y1 x2 y2
+            class_ids: (M,) clases (opcional)
+            timestamp: Instante de captura del frame (None = ahora)
+        """
+        boxes = np.asarray(boxes, dtype=np.float64).reshape(-1, 4)
+        m = len(boxes)
+        class_ids = (np.zeros(m, np.int64) if class_ids is None
+                     else np.asarray(class_ids, dtype=np.int64).reshape(-1))
+        timestamp = time.monotonic() if timestamp is None else timestamp
+        dt = 0.0 if self._last_timestamp is None else timestamp - self._last_timestamp
+        self._last_timestamp = timestamp
+        self.stats["frames"] += 1
+
+        self._predict(dt)
+
+        # Asociación sobre pares candidatos que superan el umbral de IoU
+        rows = cols = np.empty(0, np.int64)
+        if len(self.ids) and m:
+            predicted = self.predicted_boxes()
+            pair_rows, pair_cols = candidate_pairs(predicted, boxes)
+            if self.class_aware:
+                same_class = self.class_ids[pair_rows] == class_ids[pair_cols]
+                pair_rows, pair_cols = pair_rows[same_class], pair_cols[same_class]
+            iou = pair_iou(predicted[pair_rows], boxes[pair_cols])
+            valid = iou >= self.iou_threshold
+            pair_rows, pair_cols, iou = pair_rows[valid], pair_cols[valid], iou[valid]
+            if self.assignment == "hungarian":
+                rows, cols = hungarian_assignment(pair_rows, pair_cols, iou, (len(self.ids), m))
+            else:
+                rows, cols = greedy_assignment(pair_rows, pair_cols, iou)
+
+        measured_u, measured_v, measured_size = self._split_axes(boxes)
+        track_ids = np.empty(m, np.int64)
+        new_mask = np.ones(m, bool)
+
+        # Tracks asociados: corrección de Kalman y suavizado
+        if len(rows):
+            self._kalman_update(rows, measured_u[cols])
+            alpha = self.smoothing
+            self.v[rows] = (1 - alpha) * self.v[rows] + alpha * measured_v[cols]
+            self.size[rows] = (1 - alpha) * self.size[rows] + alpha * measured_size[cols]
+            self.hits[rows] += 1
+            self.misses[rows] = 0
+            track_ids[cols] = self.ids[rows]
+            new_mask[cols] = False
+
+        # Tracks sin detección
+        unmatched_tracks = np.ones(len(self.ids), bool)
+        unmatched_tracks[rows] = False
+        self.misses[unmatched_tracks] += 1
+
+        # Detecciones sin track: nuevos tracks tentativos
+        new_cols = np.nonzero(new_mask)[0]
+        if len(new_cols):
+            new_ids = np.fromiter((next(self._ids) for _ in new_cols), np.int64, len(new_cols))
+            track_ids[new_cols] = new_ids
+            confirmed = self.hits >= self.min_hits
+            belt_velocity = float(np.median(self.du[confirmed])) if confirmed.any() else self.initial_velocity
+            initial_P = np.diag([self.measurement_noise ** 2, self.velocity_std ** 2])
+            self.u = np.concatenate([self.u, measured_u[new_cols]])
+            self.du = np.concatenate([self.du, np.full(len(new_cols), belt_velocity)])
+            self.P = np.concatenate([self.P, np.tile(initial_P, (len(new_cols), 1, 1))])
+            self.v = np.concatenate([self.v, measured_v[new_cols]])
+            self.size = np.concatenate([self.size, measured_size[new_cols]])
+            self.ids = np.concatenate([self.ids, new_ids])
+            self.class_ids = np.concatenate([self.class_ids, class_ids[new_cols]])
+            self.hits = np.concatenate([self.hits, np.ones(len(new_cols), np.int64)])
+            self.misses = np.concatenate([self.misses, np.zeros(len(new_cols), np.int64)])
+            self.stats["tracks_created"] += len(new_cols)
+
+        hits_by_detection = np.empty(m, np.int64)
+        hits_by_detection[cols] = self.hits[rows]
+        hits_by_detection[new_cols] = 1
+        removed_ids = self._remove_stale()
+
+        return TrackingResult(track_ids, new_mask, hits_by_detection >= self.min_hits, removed_ids)
+
+    def _remove_stale(self) -> np.ndarray:
+        """Elimina tracks perdidos o fuera del frame; devuelve sus ids."""
+        stale = self.misses > self.max_age
+        # Tentativos que fallan el primer frame siguiente se descartan de inmediato
+        stale |= (self.hits < self.min_hits) & (self.misses > 0)
+        if self.frame_size is not None and len(self.ids):
+            limit = self.frame_size[0] if self.belt_axis == "x" else self.frame_size[1]
+            half = self.size[:, 0 if self.belt_axis == "x" else 1] / 2
+            stale |= (self.u - half > limit) | (self.u + half < 0)
+
+        if not stale.any():
+            return np.empty(0, np.int64)
+
+        removed = self.ids[stale]
+        keep = ~stale
+        self.u, self.du, self.P = self.u[keep], self.du[keep], self.P[keep]
+        self.v, self.size = self.v[keep], self.size[keep]
+        self.ids, self.class_ids = self.ids[keep], self.class_ids[keep]
+        self.hits, self.misses = self.hits[keep], self.misses[keep]
+        self.stats["tracks_removed"] += len(removed)
+        return removed
+
+    def get_tracks(self) -> Dict[int, Dict[str, Any]]:
+        """Estado de los tracks activos."""
+        boxes = self.predicted_boxes()
+        return {
+            int(track_id): {
+                "bbox": tuple(boxes[i].round(1).tolist()),
+                "velocity_px_s": float(self.du[i]),
+                "class_id": int(self.class_ids[i]),
+                "hits": int(self.hits[i]),
+                "misses": int(self.misses[i]),
+                "confirmed": bool(self.hits[i] >= self.min_hits),
+            }
+            for i, track_id in enumerate(self.ids.tolist())
+        }
+
+    def get_stats(self) -> Dict[str, Any]:
+        return {**self.stats, "active_tracks": len(self.ids)}
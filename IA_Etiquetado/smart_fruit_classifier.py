@@ -25,6 +25,7 @@ Versión: 2.0 - Smart Classification Edition
 """
 
 import asyncio
+import itertools
 import logging
 import time
 import numpy as np
@@ -33,7 +34,13 @@ from typing import Dict, List, Optional, Tuple, Any
 from dataclasses import dataclass, field
 from enum import Enum
 from collections import deque, defaultdict
-import statistics
+
+try:
+    from .fruit_tracker import FruitTracker
+    from .track_consensus import TrackConsensus, ConsensusStats
+except ImportError:
+    from fruit_tracker import FruitTracker
+    from track_consensus import TrackConsensus, ConsensusStats
 
 logger = logging.getLogger(__name__)
 
@@ -84,7 +91,6 @@ class SmartDetection:
     # Clasificación
     fruit_class: FruitClass
     confidence: float
-    alternative_classes: List[Tuple[FruitClass, float]] = field(default_factory=list)
     
     # Ubicación y geometría
     bbox: Tuple[int, int, int, int]  # (x1, y1, x2, y2)
@@ -92,6 +98,9 @@ class SmartDetection:
     area_px: int
     aspect_ratio: float
     
+    # Clases alternativas (tras los campos obligatorios para que el dataclass sea válido)
+    alternative_classes: List[Tuple[FruitClass, float]] = field(default_factory=list)
+    
     # Calidad
     quality_grade: QualityGrade = QualityGrade.UNKNOWN
     quality_score: float = 0.0
@@ -168,9 +177,35 @@ class SmartFruitClassifier:
         self.max_temporal_window_s = config.get("max_temporal_window_s", 2.0)
         self.consensus_threshold = config.get("consensus_threshold", 0.7)
         
-        # Historial de detecciones por objeto
+        # Historial de detecciones por objeto: buffers circulares preasignados
+        # con votos y estadísticas incrementales (memoria acotada por tracks activos)
         self.detection_history: Dict[int, deque] = defaultdict(lambda: deque(maxlen=10))
-        self.tracked_objects: Dict[int, List[SmartDetection]] = {}
+        self._fruit_classes = list(FruitClass)
+        self.consensus = TrackConsensus(
+            num_classes=len(self._fruit_classes),
+            max_tracks=config.get("max_active_tracks", 256),
+            capacity=config.get("track_history_size", 16),
+            window_s=self.max_temporal_window_s
+        )
+        # Tracks anónimos (sin track_id) con ids negativos para no chocar con el tracker
+        self._anonymous_track_ids = itertools.count(-1, -1)
+        
+        # Seguimiento multi-objeto: IDs estables por fruta entre frames.
+        # Sin compuerta por clase por defecto: el consenso temporal necesita
+        # que una fruta mal clasificada en un frame conserve su track.
+        tracking_cfg = config.get("tracking", {})
+        self.tracker = FruitTracker(
+            belt_axis=tracking_cfg.get("belt_axis", "x"),
+            iou_threshold=tracking_cfg.get("iou_threshold", 0.2),
+            min_hits=tracking_cfg.get("min_hits", 2),
+            max_age=tracking_cfg.get("max_age_frames", 5),
+            class_aware=tracking_cfg.get("class_aware", False),
+            assignment=tracking_cfg.get("assignment", "greedy"),
+            frame_size=tracking_cfg.get("frame_size"),
+            initial_velocity=tracking_cfg.get("initial_velocity_px_s", 0.0)
+        )
+        # Decisiones tomadas por track: una fruta se clasifica una sola vez
+        self.track_decisions: Dict[int, ClassificationResult] = {}
         
         # Estadísticas adaptativas
         self.class_statistics = {
@@ -195,7 +230,7 @@ class SmartFruitClassifier:
         self.stats = {
             "total_detections": 0,
             "classifications": defaultdict(int),
-            "average_confidence": defaultdict(list),
+            "confidence_sum": defaultdict(float),
             "quality_grades": defaultdict(int),
             "false_positives_corrected": 0,
             "multi_model_validations": 0
@@ -224,7 +259,7 @@ class SmartFruitClassifier:
             # Actualizar estadísticas
             self.stats["total_detections"] += 1
             self.stats["classifications"][detection.fruit_class] += 1
-            self.stats["average_confidence"][detection.fruit_class].append(detection.confidence)
+            self.stats["confidence_sum"][detection.fruit_class] += detection.confidence
             self.stats["quality_grades"][detection.quality_grade] += 1
             
             return detection
@@ -300,30 +335,25 @@ class SmartFruitClassifier:
             
             # Si no hay track_id, crear uno nuevo
             if track_id is None:
-                track_id = len(self.tracked_objects)
-            
-            # Agregar a historial
-            if track_id not in self.tracked_objects:
-                self.tracked_objects[track_id] = []
-            
-            self.tracked_objects[track_id].append(current_detection)
-            
-            # Limpiar detecciones antiguas (fuera de ventana temporal)
-            current_time = time.time()
-            self.tracked_objects[track_id] = [
-                d for d in self.tracked_objects[track_id]
-                if (current_time - d.timestamp) <= self.max_temporal_window_s
-            ]
-            
-            detections = self.tracked_objects[track_id]
+                track_id = next(self._anonymous_track_ids)
+            
+            # Agregar al buffer del track (expira lo que sale de la ventana temporal)
+            consensus = self.consensus.observe(
+                track_id,
+                self._fruit_classes.index(current_detection.fruit_class),
+                current_detection.confidence,
+                current_detection.quality_score,
+                current_detection.timestamp,
+                payload=current_detection
+            )
             
             # Verificar si tenemos suficientes detecciones
-            if len(detections) < self.min_detections:
-                logger.debug(f"⏳ Track {track_id}: {len(detections)}/{self.min_detections} detecciones")
+            if consensus.count < self.min_detections:
+                logger.debug(f"⏳ Track {track_id}: {consensus.count}/{self.min_detections} detecciones")
                 return None
             
             # Realizar clasificación con consenso
-            result = self._classify_with_consensus(detections, current_detection)
+            result = self._classify_with_consensus(consensus, current_detection)
             
             # Aprendizaje continuo
             if self.learning_enabled and result.decision_confidence > 0.8:
@@ -335,16 +365,64 @@ class SmartFruitClassifier:
             logger.error(f"❌ Error en clasificación temporal: {e}")
             return None
     
-    def _classify_with_consensus(
+    def classify_frame(
         self,
         detections: List[SmartDetection],
+        timestamp: Optional[float] = None
+    ) -> Dict[int, ClassificationResult]:
+        """
+        Asigna tracks a las detecciones de un frame y clasifica por track.
+        
+        Los tracks que ya tienen decisión la reutilizan sin volver a
+        analizarse; los tracks que el tracker elimina liberan su historial.
+        
+        Args:
+            detections: Detecciones del frame
+            timestamp: Instante de captura del frame (None = ahora)
+        
+        Returns:
+            {track_id: resultado} para los tracks con decisión en este frame
+        """
+        try:
+            boxes = np.array([d.bbox for d in detections], dtype=np.float64).reshape(-1, 4)
+            class_ids = [self._fruit_classes.index(d.fruit_class) for d in detections]
+            tracking = self.tracker.update(boxes, class_ids, timestamp)
+            
+            for track_id in tracking.removed_ids.tolist():
+                self.consensus.release(track_id)
+                self.track_decisions.pop(track_id, None)
+            
+            decisions = {}
+            for detection, track_id in zip(detections, tracking.track_ids.tolist()):
+                detection.track_id = track_id
+                if track_id in self.track_decisions:
+                    decisions[track_id] = self.track_decisions[track_id]
+                    continue
+                
+                result = self.classify_with_temporal_validation(detection, track_id)
+                if result is not None:
+                    self.track_decisions[track_id] = result
+                    decisions[track_id] = result
+            
+            return decisions
+            
+        except Exception as e:
+            logger.error(f"❌ Error clasificando frame: {e}")
+            return {}
+    
+    def _classify_with_consensus(
+        self,
+        consensus: ConsensusStats,
         primary: SmartDetection
     ) -> ClassificationResult:
         """
         Realiza clasificación basada en consenso de múltiples detecciones.
         
+        Los votos, medias y desviaciones por clase llegan ya agregados desde
+        el buffer del track; aquí solo se combinan en la decisión.
+        
         Args:
-            detections: Lista de detecciones del mismo objeto
+            consensus: Estado agregado del track
             primary: Detección principal (más reciente)
         
         Returns:
@@ -353,29 +431,13 @@ class SmartFruitClassifier:
         try:
             start_time = time.time()
             
-            # 1. Análisis de consenso por clase
-            class_votes = defaultdict(list)
-            for det in detections:
-                class_votes[det.fruit_class].append(det.confidence)
-            
-            # 2. Calcular confianzas promedio por clase
-            class_confidences = {
-                fruit_class: statistics.mean(confidences)
-                for fruit_class, confidences in class_votes.items()
-            }
-            
-            # 3. Seleccionar clase con mayor confianza
-            final_class = max(class_confidences, key=class_confidences.get)
-            final_confidence = class_confidences[final_class]
+            # 1-3. Clase con mayor confianza promedio
+            final_class = self._fruit_classes[consensus.final_class]
+            final_confidence = consensus.final_confidence
             
-            # 4. Calcular nivel de consenso
-            total_detections = len(detections)
-            class_count = len(class_votes[final_class])
-            consensus_level = class_count / total_detections
-            
-            # 5. Calcular estabilidad (variación de confidencias)
-            confidences = class_votes[final_class]
-            stability = 1.0 - (statistics.stdev(confidences) if len(confidences) > 1 else 0.0)
+            # 4-5. Nivel de consenso y estabilidad (variación de confidencias)
+            consensus_level = consensus.consensus_level
+            stability = consensus.stability
             
             # 6. Decisión de confianza combinada
             decision_confidence = (
@@ -385,9 +447,7 @@ class SmartFruitClassifier:
             )
             
             # 7. Calidad promedio
-            quality_scores = [d.quality_score for d in detections]
-            avg_quality = statistics.mean(quality_scores)
-            quality_grade = self._determine_quality_grade_from_score(avg_quality)
+            quality_grade = self._determine_quality_grade_from_score(consensus.average_quality)
             
             # 8. Decisiones de acción
             should_label = decision_confidence >= 0.7 and quality_grade != QualityGrade.DEFECTIVE
@@ -409,7 +469,7 @@ class SmartFruitClassifier:
                 final_class=final_class,
                 final_confidence=final_confidence,
                 quality_grade=quality_grade,
-                detections=detections,
+                detections=self.consensus.observations(consensus.track_id),
                 primary_detection=primary,
                 decision_confidence=decision_confidence,
                 consensus_level=consensus_level,
@@ -501,8 +561,8 @@ class SmartFruitClassifier:
             "total_detections": self.stats["total_detections"],
             "classifications_by_class": dict(self.stats["classifications"]),
             "average_confidences": {
-                fruit_class.value: statistics.mean(confs) if confs else 0.0
-                for fruit_class, confs in self.stats["average_confidence"].items()
+                fruit_class.value: total / max(1, self.stats["classifications"][fruit_class])
+                for fruit_class, total in self.stats["confidence_sum"].items()
             },
             "quality_distribution": dict(self.stats["quality_grades"]),
             "false_positives_corrected": self.stats["false_positives_corrected"],
@@ -514,16 +574,23 @@ class SmartFruitClassifier:
                 }
                 for fruit_class, stats in self.class_statistics.items()
             },
-            "current_min_confidence": self.min_confidence
+            "current_min_confidence": self.min_confidence,
+            "tracking": {
+                **self.tracker.get_stats(),
+                "decided_tracks": len(self.track_decisions),
+                "consensus": self.consensus.get_stats()
+            }
         }
     
     def reset_tracking(self, track_id: Optional[int] = None):
         """Reinicia el seguimiento de objetos."""
         if track_id is None:
-            self.tracked_objects.clear()
+            self.consensus.clear()
+            self.track_decisions.clear()
+            self.tracker.reset()
             logger.info("🔄 Seguimiento reiniciado (todos los objetos)")
-        elif track_id in self.tracked_objects:
-            del self.tracked_objects[track_id]
+        elif self.consensus.release(track_id):
+            self.track_decisions.pop(track_id, None)
             logger.debug(f"🔄 Seguimiento reiniciado (track {track_id})")
 
 # ==================== FUNCIONES DE UTILIDAD ====================
@@ -24,12 +24,16 @@ import json
 from dataclasses import dataclass, field
 from typing import List, Tuple, Dict, Optional, Any
 from pathlib import Path
-from sklearn.cluster import DBSCAN
 from collections import defaultdict
 import matplotlib.pyplot as plt
 import matplotlib.patches as patches
 from datetime import datetime
 
+try:
+    from .spatial_clustering import grid_dbscan, grid_positions
+except ImportError:
+    from spatial_clustering import grid_dbscan, grid_positions
+
 logger = logging.getLogger(__name__)
 
 @dataclass
@@ -106,34 +110,15 @@ class FruitCluster:
         if not self.fruits:
             return
             
-        # Agrupar por posiciones Y (filas - ancho de banda)
-        y_positions = sorted(set(round(f.center_y_m, 2) for f in self.fruits))
-        y_tolerance = 0.03  # 3cm de tolerancia
-        
-        rows = []
-        for y_target in y_positions:
-            row_fruits = [f for f in self.fruits if abs(f.center_y_m - y_target) <= y_tolerance]
-            if row_fruits:
-                rows.append(sorted(row_fruits, key=lambda x: x.center_x_m))
-        
-        # Agrupar por posiciones X (columnas - dirección de movimiento)
-        x_positions = sorted(set(round(f.center_x_m, 2) for f in self.fruits))
-        x_tolerance = 0.03
-        
-        cols = []
-        for x_target in x_positions:
-            col_fruits = [f for f in self.fruits if abs(f.center_x_m - x_target) <= x_tolerance]
-            if col_fruits:
-                cols.append(sorted(col_fruits, key=lambda x: x.center_y_m))
-        
-        self.rows = len(rows)
-        self.cols = len(cols)
+        # Filas por posiciones Y (ancho de banda), columnas por X (movimiento), 3cm de tolerancia
+        x_positions = np.array([f.center_x_m for f in self.fruits])
+        y_positions = np.array([f.center_y_m for f in self.fruits])
+        self.rows, self.cols, row_idx, col_idx = grid_positions(x_positions, y_positions, 0.03)
         
         # Asignar posiciones en grilla
-        for row_idx, row in enumerate(rows):
-            for col_idx, fruit in enumerate(row):
-                fruit.row_position = row_idx
-                fruit.col_position = col_idx
+        for fruit, row, col in zip(self.fruits, row_idx.tolist(), col_idx.tolist()):
+            fruit.row_position = row
+            fruit.col_position = col
 
 @dataclass
 class SpatialCalibration:
@@ -232,10 +217,8 @@ class SmartPositionDetector:
             # 2. Agrupar frutas en clústeres espaciales
             clusters = self._cluster_fruits(fruit_positions)
             
-            # 3. Analizar cada clúster
+            # 3. Calcular tiempos de cada clúster (dimensiones y grilla ya calculadas)
             for cluster in clusters:
-                cluster.calculate_dimensions()
-                cluster.organize_spatial_grid()
                 self._calculate_timing(cluster)
             
             # 4. Actualizar estadísticas
@@ -306,7 +289,7 @@ class SmartPositionDetector:
         return fruit_positions
     
     def _cluster_fruits(self, fruit_positions: List[FruitPosition]) -> List[FruitCluster]:
-        """Agrupar frutas en clústeres espaciales usando DBSCAN."""
+        """Agrupar frutas en clústeres espaciales (etiquetas equivalentes a DBSCAN)."""
         
         if not fruit_positions:
             return []
@@ -314,24 +297,27 @@ class SmartPositionDetector:
         # Preparar datos para clustering
         positions = np.array([[f.center_x_m, f.center_y_m] for f in fruit_positions])
         
-        # Aplicar DBSCAN
-        clustering = DBSCAN(
+        # Agrupamiento por grilla de celdas eps
+        labels = grid_dbscan(
+            positions,
             eps=self.calibration.cluster_eps_m,
             min_samples=self.calibration.cluster_min_samples
-        ).fit(positions)
+        )
         
         # Organizar en clústeres
         clusters_dict = defaultdict(list)
         
-        for fruit, cluster_id in zip(fruit_positions, clustering.labels_):
+        for fruit, cluster_id in zip(fruit_positions, labels.tolist()):
             fruit.cluster_id = cluster_id
             clusters_dict[cluster_id].append(fruit)
         
-        # Crear objetos FruitCluster
+        # Crear objetos FruitCluster con dimensiones y grilla espacial
         clusters = []
         for cluster_id, fruits in clusters_dict.items():
             if cluster_id >= 0:  # Ignorar ruido (-1)
                 cluster = FruitCluster(cluster_id=cluster_id, fruits=fruits)
+                cluster.calculate_dimensions()
+                cluster.organize_spatial_grid()
                 clusters.append(cluster)
         
         return clusters
@@ -0,0 +1,189 @@
+# IA_Etiquetado/spatial_clustering.py
+"""
+Agrupamiento Espacial por Grilla
+================================
+
+Motor de agrupamiento para posiciones de frutas en 2-D que reemplaza la
+llamada por frame a sklearn DBSCAN. Produce las mismas etiquetas que DBSCAN
+(distancia euclidiana, vecindad <= eps, el propio punto cuenta para
+min_samples) sin el coste de preparación de sklearn, también con puntos a
+distancia exactamente eps: las distancias se comparan con eps² en float64
+con la misma aritmética que el camino que sklearn elegiría.
+
+- Hasta 11 puntos sklearn usa fuerza bruta (|x|² - 2 x·y + |y|² con BLAS;
+  el redondeo puede hacer la vecindad asimétrica en un empate): se replica
+  esa aritmética y el recorrido de dbscan_inner.
+- Con más puntos sklearn usa el árbol KD (dx² + dy²):
+
+1. Grilla uniforme de celdas de tamaño eps: los vecinos de un punto solo
+   pueden estar en su celda o en las 8 adyacentes. Los pares candidatos se
+   obtienen con searchsorted sobre las claves de celda ordenadas.
+2. Componentes conexas entre puntos núcleo por propagación de la etiqueta
+   mínima con salto de punteros (unión de conjuntos vectorizada).
+3. Las etiquetas se numeran por el menor índice de núcleo de cada clúster y
+   cada punto frontera toma el menor clúster con un núcleo a distancia eps,
+   que es el orden en que DBSCAN los descubre.
+
+También incluye la organización en filas/columnas de un clúster
+(grid_positions) con los mismos resultados que el recorrido original.
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+from typing import Tuple
+
+import numpy as np
+
+_OFFSETS = np.array([(dx, dy) for dx in (-1, 0, 1) for dy in (-1, 0, 1)], dtype=np.int64)
+
+# NearestNeighbors de DBSCAN (n_neighbors=5) elige fuerza bruta si 5 >= n // 2
+_BRUTE_MAX_POINTS = 11
+
+
+def _brute_dbscan(points: np.ndarray, eps: float, min_samples: int) -> np.ndarray:
+    """
+    DBSCAN por fuerza bruta con la aritmética de sklearn. El redondeo de
+    |x|² - 2 x·y + |y|² puede hacer la vecindad asimétrica en un empate, así
+    que se recorre igual que dbscan_inner (orden de índices, pila LIFO).
+    """
+    n = len(points)
+    # Normas con ddot por fila (como sklearn) y término cruzado con GEMM
+    norms = np.array([row @ row for row in points])
+    squared = norms[:, None] + -2.0 * (points @ points.T) + norms[None, :]
+    within = np.maximum(squared, 0.0) <= eps * eps
+    neighborhoods = [np.flatnonzero(row).tolist() for row in within]
+    core = within.sum(axis=1) >= min_samples
+
+    labels = [-1] * n
+    label = 0
+    for start in range(n):
+        if labels[start] != -1 or not core[start]:
+            continue
+        stack = [start]
+        while stack:
+            i = stack.pop()
+            if labels[i] != -1:
+                continue
+            labels[i] = label
+            if core[i]:
+                stack.extend(v for v in neighborhoods[i] if labels[v] == -1)
+        label += 1
+    return np.array(labels, dtype=np.int64)
+
+
+def neighbor_pairs(points: np.ndarray, eps: float) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    Pares (i, j) con distancia <= eps, en ambos sentidos e incluyendo (i, i).
+
+    Args:
+        points: (N, 2) coordenadas
+        eps: Radio de vecindad
+    """
+    n = len(points)
+    # Celdas apenas mayores que eps para que el redondeo nunca separe vecinos a 2 celdas
+    cells = np.floor(points / (eps * (1.0 + 1e-9))).astype(np.int64)
+    cells -= cells.min(axis=0) - 1
+    stride = int(cells[:, 1].max()) + 2
+    keys = cells[:, 0] * stride + cells[:, 1]
+
+    order = np.argsort(keys, kind="stable")
+    sorted_keys = keys[order]
+
+    targets = (keys[:, None] + _OFFSETS[:, 0] * stride + _OFFSETS[:, 1]).reshape(-1)
+    lo = np.searchsorted(sorted_keys, targets, side="left")
+    counts = np.searchsorted(sorted_keys, targets, side="right") - lo
+
+    # Expandir cada (punto, celda vecina) a sus candidatos
+    slot = np.repeat(np.arange(len(targets)), counts)
+    start = np.cumsum(counts) - counts
+    i = slot // len(_OFFSETS)
+    j = order[lo[slot] + np.arange(len(slot)) - start[slot]]
+
+    # Misma comparación que el árbol KD de sklearn: distancia al cuadrado <= eps^2
+    x = np.ascontiguousarray(points[:, 0])
+    y = np.ascontiguousarray(points[:, 1])
+    dx = x[i] - x[j]
+    dy = y[i] - y[j]
+    close = dx * dx + dy * dy <= eps * eps
+    return i[close], j[close]
+
+
+def _min_label_components(n: int, i: np.ndarray, j: np.ndarray) -> np.ndarray:
+    """Etiqueta de cada nodo = menor índice de su componente conexa."""
+    label = np.arange(n)
+    if len(i) == 0:
+        return label
+    while True:
+        updated = label.copy()
+        np.minimum.at(updated, i, label[j])
+        np.minimum.at(updated, j, label[i])
+        updated = updated[updated]          # salto de punteros
+        if np.array_equal(updated, label):
+            return label
+        label = updated
+
+
+def grid_dbscan(points: np.ndarray, eps: float, min_samples: int) -> np.ndarray:
+    """
+    Etiquetas idénticas a sklearn.cluster.DBSCAN(eps, min_samples).fit(points).labels_.
+
+    Returns:
+        (N,) int64 con -1 para ruido
+    """
+    points = np.asarray(points, dtype=np.float64).reshape(-1, 2)
+    n = len(points)
+    labels = np.full(n, -1, dtype=np.int64)
+    if n == 0:
+        return labels
+
+    if n <= _BRUTE_MAX_POINTS:
+        return _brute_dbscan(points, eps, min_samples)
+
+    i, j = neighbor_pairs(points, eps)
+    core = np.bincount(i, minlength=n) >= min_samples
+    if not core.any():
+        return labels
+
+    # Componentes entre núcleos, numeradas por su menor índice
+    core_edges = core[i] & core[j] & (i < j)
+    component = _min_label_components(n, i[core_edges], j[core_edges])
+    roots = np.unique(component[core])
+    labels[core] = np.searchsorted(roots, component[core])
+
+    # Fronteras: el clúster de menor etiqueta con un núcleo vecino
+    border_edges = ~core[i] & core[j]
+    if border_edges.any():
+        border = np.full(n, n, dtype=np.int64)
+        np.minimum.at(border, i[border_edges], labels[j[border_edges]])
+        reached = border < n
+        labels[reached] = border[reached]
+    return labels
+
+
+def grid_positions(x: np.ndarray, y: np.ndarray,
+                   tolerance: float = 0.03) -> Tuple[int, int, np.ndarray, np.ndarray]:
+    """
+    Organiza un clúster en filas (por Y) y columnas (por X).
+
+    Las filas/columnas son los valores distintos de la coordenada redondeada
+    a centímetros. Cada fruta queda en la última fila cuyo valor está a
+    tolerance o menos, y su columna es su rango por X dentro de esa fila.
+
+    Returns:
+        (filas, columnas, fila de cada fruta, columna de cada fruta)
+    """
+    n = len(x)
+    row_targets = np.array(sorted({round(v, 2) for v in y.tolist()}))
+    col_count = len({round(v, 2) for v in x.tolist()})
+
+    row = np.searchsorted(row_targets, y + tolerance, side="right") - 1
+    row -= np.abs(y - row_targets[row]) > tolerance
+
+    # Rango por X (desempate por orden original) entre las frutas de la misma fila
+    in_row = np.abs(y[None, :] - row_targets[row][:, None]) <= tolerance
+    before = (x[None, :] < x[:, None]) | ((x[None, :] == x[:, None]) &
+                                          (np.arange(n)[None, :] < np.arange(n)[:, None]))
+    col = np.count_nonzero(in_row & before, axis=1)
+
+    return len(row_targets), col_count, row, col
@@ -0,0 +1,233 @@
+# IA_Etiquetado/track_consensus.py
+"""
+Motor de Consenso Temporal por Track
+====================================
+
+Acumula las observaciones de cada fruta seguida (track) en buffers
+circulares preasignados y mantiene de forma incremental los agregados que
+necesita la decisión de clasificación:
+
+- Un slot por track activo con capacidad fija de observaciones; la memoria
+  queda acotada por max_tracks x capacity desde el arranque
+- Votos por clase, suma y suma de cuadrados de confianza por clase y suma
+  de calidad se actualizan al entrar y salir cada observación, de modo que
+  cada observación nueva cuesta O(1) (O(clases) para la decisión)
+- Las observaciones fuera de la ventana temporal salen por la cola del
+  buffer; los tracks se liberan al salir del frame (release) o, si faltan
+  slots, se desaloja el track con la observación más antigua
+
+Uso:
+    engine = TrackConsensus(num_classes=4, max_tracks=256, capacity=16, window_s=2.0)
+    stats = engine.observe(track_id, class_index, confidence, quality, timestamp)
+    if stats.count >= min_detections:
+        decidir(stats.final_class, stats.final_confidence, stats.consensus_level, ...)
+    engine.release(track_id)
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import math
+from dataclasses import dataclass
+from typing import Any, Dict, List, Optional
+
+import numpy as np
+
+
+@dataclass
+class ConsensusStats:
+    """Estado agregado de un track tras una observación."""
+    track_id: int
+    count: int                 # Observaciones dentro de la ventana
+    final_class: int           # Clase con mayor confianza media
+    final_confidence: float    # Confianza media de esa clase
+    consensus_level: float     # Fracción de observaciones de esa clase
+    stability: float           # 1 - desviación estándar de su confianza
+    average_quality: float     # Calidad media de todas las observaciones
+
+
+class TrackConsensus:
+    """Buffers circulares por track con votos y estadísticas incrementales."""
+
+    def __init__(self, num_classes: int, max_tracks: int = 256, capacity: int = 16,
+                 window_s: Optional[float] = 2.0):
+        """
+        Args:
+            num_classes: Número de clases posibles
+            max_tracks: Tracks activos simultáneos (slots preasignados)
+            capacity: Observaciones conservadas por track
+            window_s: Antigüedad máxima de una observación (None = sin límite)
+        """
+        self.num_classes = num_classes
+        self.max_tracks = max(1, max_tracks)
+        self.capacity = max(1, capacity)
+        self.window_s = window_s
+
+        shape = (self.max_tracks, self.capacity)
+        self._timestamps = np.zeros(shape)
+        self._classes = np.zeros(shape, np.int32)
+        self._confidences = np.zeros(shape)
+        self._qualities = np.zeros(shape)
+        self._payloads: List[List[Any]] = [[None] * self.capacity for _ in range(self.max_tracks)]
+
+        self._head = np.zeros(self.max_tracks, np.int64)     # Posición de la más antigua
+        self._count = np.zeros(self.max_tracks, np.int64)
+        self._last_seen = np.full(self.max_tracks, -np.inf)
+
+        self._votes = np.zeros((self.max_tracks, num_classes), np.int64)
+        self._conf_sum = np.zeros((self.max_tracks, num_classes))
+        self._conf_sumsq = np.zeros((self.max_tracks, num_classes))
+        self._quality_sum = np.zeros(self.max_tracks)
+
+        self._slots: Dict[int, int] = {}
+        self._track_of_slot: List[Optional[int]] = [None] * self.max_tracks
+        self._free = list(range(self.max_tracks - 1, -1, -1))
+        self.evictions = 0
+
+    def __len__(self) -> int:
+        return len(self._slots)
+
+    def __contains__(self, track_id: int) -> bool:
+        return track_id in self._slots
+
+    # --- Slots ---
+
+    def _acquire(self, track_id: int) -> int:
+        slot = self._slots.get(track_id)
+        if slot is not None:
+            return slot
+        if not self._free:
+            # Desalojar el track con la observación más antigua
+            victim = int(np.argmin(self._last_seen))
+            self.release(self._track_of_slot[victim])
+            self.evictions += 1
+        slot = self._free.pop()
+        self._slots[track_id] = slot
+        self._track_of_slot[slot] = track_id
+        return slot
+
+    def release(self, track_id: int) -> bool:
+        """Libera el slot de un track (p. ej. al salir del frame)."""
+        slot = self._slots.pop(track_id, None)
+        if slot is None:
+            return False
+        self._head[slot] = 0
+        self._count[slot] = 0
+        self._last_seen[slot] = -np.inf
+        self._votes[slot] = 0
+        self._conf_sum[slot] = 0.0
+        self._conf_sumsq[slot] = 0.0
+        self._quality_sum[slot] = 0.0
+        self._payloads[slot] = [None] * self.capacity
+        self._track_of_slot[slot] = None
+        self._free.append(slot)
+        return True
+
+    def clear(self):
+        """Libera todos los tracks."""
+        for track_id in list(self._slots):
+            self.release(track_id)
+
+    # --- Buffer circular ---
+
+    def _pop_oldest(self, slot: int):
+        position = self._head[slot]
+        cls = self._classes[slot, position]
+        conf = self._confidences[slot, position]
+        self._votes[slot, cls] -= 1
+        if self._votes[slot, cls] == 0:
+            # Evita arrastrar error de redondeo en sumas que deberían ser 0
+            self._conf_sum[slot, cls] = 0.0
+            self._conf_sumsq[slot, cls] = 0.0
+        else:
+            self._conf_sum[slot, cls] -= conf
+            self._conf_sumsq[slot, cls] -= conf * conf
+        self._quality_sum[slot] -= self._qualities[slot, position]
+        self._payloads[slot][position] = None
+        self._head[slot] = (position + 1) % self.capacity
+        self._count[slot] -= 1
+        if self._count[slot] == 0:
+            self._quality_sum[slot] = 0.0
+
+    def observe(self, track_id: int, class_index: int, confidence: float,
+                quality: float = 0.0, timestamp: float = 0.0,
+                payload: Any = None) -> ConsensusStats:
+        """
+        Agrega una observación al track y devuelve su estado de consenso.
+
+        Args:
+            track_id: Identificador del track
+            class_index: Índice de la clase observada
+            confidence: Confianza de la observación
+            quality: Puntuación de calidad de la observación
+            timestamp: Instante de la observación
+            payload: Objeto asociado (se devuelve en observations())
+        """
+        slot = self._acquire(track_id)
+
+        # Expirar por antigüedad (siempre por la cola) y por capacidad
+        if self.window_s is not None:
+            while (self._count[slot] and
+                   timestamp - self._timestamps[slot, self._head[slot]] > self.window_s):
+                self._pop_oldest(slot)
+        if self._count[slot] == self.capacity:
+            self._pop_oldest(slot)
+
+        position = (self._head[slot] + self._count[slot]) % self.capacity
+        self._timestamps[slot, position] = timestamp
+        self._classes[slot, position] = class_index
+        self._confidences[slot, position] = confidence
+        self._qualities[slot, position] = quality
+        self._payloads[slot][position] = payload
+        self._count[slot] += 1
+        self._last_seen[slot] = timestamp
+
+        self._votes[slot, class_index] += 1
+        self._conf_sum[slot, class_index] += confidence
+        self._conf_sumsq[slot, class_index] += confidence * confidence
+        self._quality_sum[slot] += quality
+
+        return self._stats(track_id, slot)
+
+    def _stats(self, track_id: int, slot: int) -> ConsensusStats:
+        votes = self._votes[slot]
+        count = int(self._count[slot])
+        means = np.divide(self._conf_sum[slot], votes, out=np.full(self.num_classes, -np.inf),
+                          where=votes > 0)
+        final_class = int(np.argmax(means))
+        n = int(votes[final_class])
+        mean = float(means[final_class])
+
+        # Desviación estándar muestral a partir de suma y suma de cuadrados
+        if n > 1:
+            variance = (self._conf_sumsq[slot, final_class] - n * mean * mean) / (n - 1)
+            stdev = math.sqrt(max(variance, 0.0))
+        else:
+            stdev = 0.0
+
+        return ConsensusStats(
+            track_id=track_id,
+            count=count,
+            final_class=final_class,
+            final_confidence=mean,
+            consensus_level=n / count,
+            stability=1.0 - stdev,
+            average_quality=float(self._quality_sum[slot] / count)
+        )
+
+    def observations(self, track_id: int) -> List[Any]:
+        """Payloads del track en orden cronológico."""
+        slot = self._slots.get(track_id)
+        if slot is None:
+            return []
+        head, count = int(self._head[slot]), int(self._count[slot])
+        payloads = self._payloads[slot]
+        return [payloads[(head + k) % self.capacity] for k in range(count)]
+
+    def get_stats(self) -> Dict[str, Any]:
+        return {
+            "active_tracks": len(self._slots),
+            "max_tracks": self.max_tracks,
+            "capacity": self.capacity,
+            "evictions": self.evictions,
+        }
@@ -93,6 +93,12 @@ except ImportError as e:
     print(f"⚠️ ConveyorBeltController no disponible: {e}")
     ConveyorBeltController = None
 
+try:
+    from Control_Etiquetado.belt_odometry import BeltOdometry
+except ImportError as e:
+    print(f"⚠️ BeltOdometry no disponible: {e}")
+    BeltOdometry = None
+
 try:
     from Control_Etiquetado.fruit_diverter_controller import (
         FruitDiverterController,
@@ -173,6 +179,7 @@ class DetectionEvent:
     processed: bool = False
     labeled: bool = False
     classified: bool = False
+    classification_position_m: Optional[float] = None  # Posición de banda para clasificar
     
 # SimpleBeltController DEPRECADO - Usar ConveyorBeltController con RelayMotorDriverPi5
 # Se mantiene solo para compatibilidad temporal
@@ -239,6 +246,14 @@ class SmartFruitClassifier:
         
         self.labeling_delay_s = sensor_to_camera_m / belt_speed
         self.classification_delay_s = camera_to_classifier_m / belt_speed
+        self.sensor_to_camera_m = sensor_to_camera_m
+        self.camera_to_classifier_m = camera_to_classifier_m
+        self.max_belt_wait_s = float(self.config.get("timing", {}).get("max_belt_wait_s", 10.0))
+        
+        # Odometría de banda: los tránsitos se miden en distancia recorrida, no en
+        # tiempo, para que pausas y reanudaciones no desincronicen la clasificación
+        self.odometry = BeltOdometry(belt_speed) if BeltOdometry else None
+        self._belt_speed_mps = belt_speed
         
         # Debug y visualización
         self.debug: Dict[str, Any] = self.config.get("debug", {})
@@ -551,6 +566,11 @@ class SmartFruitClassifier:
             
             # Inicializar (automáticamente usará RelayMotorDriverPi5 si está en Pi5)
             if await self.belt.initialize():
+                # La banda arranca detenida; la odometría sigue sus arranques y paradas
+                if self.odometry and hasattr(self.belt, 'add_motion_listener'):
+                    self.odometry.pause()
+                    self.belt.add_motion_listener(self._on_belt_motion)
+
                 # Obtener info del driver
                 driver_info = ""
                 if hasattr(self.belt, 'driver') and self.belt.driver:
@@ -1772,9 +1792,36 @@ class SmartFruitClassifier:
             logger.error(f"❌ Error inicializando API REST: {e}")
             logger.exception(e)
     
+    def _on_belt_motion(self, running: bool, speed_percent: float):
+        """Observador de la banda: arranques y paradas alimentan la odometría."""
+        # Banda ON/OFF por relays: en marcha siempre a la velocidad nominal calibrada
+        if running:
+            self.odometry.resume()
+        else:
+            self.odometry.pause()
+    
+    def _belt_position(self) -> float:
+        """Posición acumulada de la banda (o tiempo x velocidad nominal sin odometría)."""
+        if self.odometry:
+            return self.odometry.position_at()
+        return time.monotonic() * self._belt_speed_mps
+    
+    async def _wait_for_belt_travel(self, distance_m: float):
+        """Espera a que la banda avance distance_m, respetando pausas y reanudaciones."""
+        target = self._belt_position() + distance_m
+        deadline = time.monotonic() + self.max_belt_wait_s
+        while time.monotonic() < deadline:
+            remaining_m = target - self._belt_position()
+            if remaining_m <= 0:
+                return
+            speed = self.odometry.speed if self.odometry else self._belt_speed_mps
+            # Re-evaluar periódicamente por si la banda cambia de estado
+            await asyncio.sleep(min(remaining_m / speed, 0.05) if speed > 0 else 0.05)
+        logger.warning(f"⚠️ La banda no avanzó {distance_m:.2f}m en {self.max_belt_wait_s:.0f}s; capturando igualmente")
+    
     async def _delayed_capture(self):
-        """Captura con delay después de trigger del sensor."""
-        await asyncio.sleep(self.labeling_delay_s)
+        """Captura cuando la fruta recorrió la distancia sensor→cámara."""
+        await self._wait_for_belt_travel(self.sensor_to_camera_m)
         await self._capture_and_detect()
     
     async def start_production(self):
@@ -2050,7 +2097,8 @@ class SmartFruitClassifier:
                     fruit_class=fruit_class,
                     confidence=confidence,
                     category=category,
-                    bbox=bbox
+                    bbox=bbox,
+                    classification_position_m=self._belt_position() + self.camera_to_classifier_m
                 )
 
                 self.detection_queue.append(event)
@@ -2093,7 +2141,7 @@ class SmartFruitClassifier:
                     logger.info(f"   🏷️ Etiquetadora activada para {fruit_class}")
                 
                 # Log de clasificación pendiente
-                logger.info(f"   ⏳ Clasificación programada en {self.classification_delay_s:.1f}s")
+                logger.info(f"   ⏳ Clasificación programada tras {self.camera_to_classifier_m:.2f}m de banda")
             
             # 5. Visualización/guardado (anotar todas las detecciones)
             self._maybe_preview_or_save(frame, result.detections)
@@ -2457,6 +2505,7 @@ class SmartFruitClassifier:
             try:
                 # Buscar eventos pendientes de clasificación
                 current_time = time.time()
+                belt_position = self._belt_position()
                 events_to_process = []
                 
                 # Recolectar eventos listos para clasificar
@@ -2465,9 +2514,11 @@ class SmartFruitClassifier:
                         self.pending_classifications.remove(event)
                         continue
                     
-                    # Verificar si ya pasó el tiempo de clasificación
-                    elapsed = current_time - event.timestamp
-                    if elapsed >= self.classification_delay_s:
+                    # Verificar si la fruta ya recorrió la distancia hasta el clasificador
+                    if event.classification_position_m is not None:
+                        if belt_position >= event.classification_position_m:
+                            events_to_process.append(event)
+                    elif current_time - event.timestamp >= self.classification_delay_s:
                         events_to_process.append(event)
                 
                 # Procesar eventos UNO A LA VEZ para evitar activaciones simultáneas
@@ -2606,6 +2657,7 @@ class SmartFruitClassifier:
             },
             "stats": self.stats,
             "pending_classifications": len(self.pending_classifications),
+            "belt_odometry": self.odometry.get_stats() if self.odometry else None,
             "timestamp": time.time()
         }
     
@@ -12,7 +12,6 @@ load_dotenv()
 import asyncio
 import logging
 import time
-import hashlib
 import json
 import os
 import sys
@@ -56,6 +55,21 @@ except ImportError:
 # Usamos requests que ya está disponible
 ROBOFLOW_INFERENCE_AVAILABLE = True  # Siempre disponible con requests
 
+# Anillo de frames en memoria compartida (clientes en la misma máquina)
+try:
+    from utils.shared_frame_ring import SharedFrameRing, SHARED_MEMORY_AVAILABLE
+except ImportError:
+    SHARED_MEMORY_AVAILABLE = False
+
+# Hash perceptual para reutilizar resultados de frames casi idénticos
+from utils.perceptual_hash import PerceptualHash, PerceptualHashCache
+
+# Micro-batching de peticiones concurrentes con plazos por frame
+from utils.micro_batcher import MicroBatcher
+
+# Frame anotado del stream MJPEG: render y JPEG únicos, solo con clientes conectados
+from utils.stream_compositor import StreamCompositor
+
 # Rate limiting
 from slowapi import Limiter, _rate_limit_exceeded_handler
 from slowapi.util import get_remote_address
@@ -87,6 +101,11 @@ class ServerConfig:
     
     MODEL_DEVICE = os.getenv("MODEL_DEVICE", "cuda" if torch.cuda.is_available() else "cpu")
     MODEL_FP16 = os.getenv("MODEL_FP16", "true").lower() == "true" and MODEL_DEVICE == "cuda"
+    # "int8": modelo cuantizado de Quantize_Onnx.py (<MODEL_PATH>.int8.onnx, solo CPU)
+    MODEL_PRECISION = os.getenv("MODEL_PRECISION", "fp32").lower()
+    if MODEL_PRECISION == "int8":
+        MODEL_DEVICE = "cpu"
+        MODEL_FP16 = False
     
     # Autenticación
     AUTH_ENABLED = os.getenv("AUTH_ENABLED", "true").lower() == "true"
@@ -113,6 +132,15 @@ class ServerConfig:
     # Cache
     ENABLE_CACHE = os.getenv("ENABLE_CACHE", "true").lower() == "true"
     CACHE_TTL = int(os.getenv("CACHE_TTL", "60"))  # segundos
+    CACHE_MAX_ENTRIES = int(os.getenv("CACHE_MAX_ENTRIES", "64"))
+    CACHE_MAX_DISTANCE = int(os.getenv("CACHE_MAX_DISTANCE", "4"))  # bits de Hamming
+    CACHE_MAX_COLOR_DELTA = int(os.getenv("CACHE_MAX_COLOR_DELTA", "12"))  # por celda
+    
+    # Micro-batching (YOLOv8/RT-DETR): agrupa frames concurrentes en un solo forward
+    ENABLE_BATCHING = os.getenv("ENABLE_BATCHING", "true").lower() == "true"
+    BATCH_MAX_SIZE = int(os.getenv("BATCH_MAX_SIZE", "4"))
+    BATCH_MAX_WAIT_MS = float(os.getenv("BATCH_MAX_WAIT_MS", "5"))
+    BATCH_DEFAULT_DEADLINE_MS = float(os.getenv("BATCH_DEFAULT_DEADLINE_MS", "150"))  # si el cliente no envía deadline_ms
     
     # Visualización y logging
     LOG_EVERY_N_FRAMES = int(os.getenv("LOG_EVERY_N_FRAMES", "30"))  # Log cada N frames
@@ -121,6 +149,10 @@ class ServerConfig:
     ENABLE_MJPEG_STREAM = os.getenv("ENABLE_MJPEG_STREAM", "true").lower() == "true"
     STREAM_MAX_FPS = int(os.getenv("STREAM_MAX_FPS", "10"))
     STREAM_KEEPALIVE_MS = int(os.getenv("STREAM_KEEPALIVE_MS", "250"))
+    
+    # Transporte por memoria compartida para clientes locales (/infer_shm)
+    ENABLE_SHARED_MEMORY = os.getenv("ENABLE_SHARED_MEMORY", "true").lower() == "true" and SHARED_MEMORY_AVAILABLE
+    MAX_SHARED_RINGS = int(os.getenv("MAX_SHARED_RINGS", "4"))
 
 
 # ==================== MODELOS DE DATOS ====================
@@ -132,6 +164,8 @@ class InferenceRequest(BaseModel):
     iou: float = Field(default=0.45, ge=0.0, le=1.0)
     max_det: int = Field(default=100, ge=1, le=300)
     class_names_json: Optional[str] = None
+    use_cache: bool = True  # False para medir el modelo real (canario del launcher)
+    deadline_ms: Optional[float] = Field(default=None, gt=0, le=10000)  # Plazo del frame desde su llegada
 
 
 class Detection(BaseModel):
@@ -154,6 +188,8 @@ class InferenceResponse(BaseModel):
     total_ms: float
     model_device: str
     timestamp: str
+    batch_size: int = 1  # Frames procesados en el mismo forward
+    queue_ms: float = 0.0  # Espera en la cola de micro-batching
 
 
 class HealthResponse(BaseModel):
@@ -188,6 +224,7 @@ class InferenceServer:
             "requests_total": 0,
             "requests_success": 0,
             "requests_failed": 0,
+            "requests_cached": 0,
             "total_inference_time_ms": 0.0,
             "startup_time": time.time()
         }
@@ -202,32 +239,46 @@ class InferenceServer:
             "last_log_time": time.time()
         }
         
-        # Para streaming MJPEG
-        self.latest_annotated_frame: Optional[bytes] = None
-        self.frame_condition: Optional[asyncio.Condition] = None
-        self.last_frame_id = 0
+        # Para streaming MJPEG y frames anotados en disco (se crea al inicializar)
+        self.compositor: Optional[StreamCompositor] = None
         
-        # Cache de resultados
-        self.cache: Dict[str, Any] = {}
+        # Cache de resultados por hash perceptual (tolera ruido del sensor)
+        self.cache = PerceptualHashCache(
+            max_entries=ServerConfig.CACHE_MAX_ENTRIES,
+            max_distance=ServerConfig.CACHE_MAX_DISTANCE,
+            max_color_delta=ServerConfig.CACHE_MAX_COLOR_DELTA,
+            ttl_s=ServerConfig.CACHE_TTL
+        )
         self.cache_enabled = ServerConfig.ENABLE_CACHE
         
+        # Anillos de memoria compartida abiertos, por nombre
+        self.shared_rings: Dict[str, Any] = {}
+        
+        # Planificador de micro-batches (solo modelos Ultralytics, se crea al cargar)
+        self.batcher: Optional[MicroBatcher] = None
+        
         logger.info(f"📊 Servidor configurado: Device={self.device}, FP16={self.fp16}")
     
     async def initialize(self):
         """Inicializa el modelo YOLOv8."""
         try:
-            # Inicializar condition para streaming
-            self.frame_condition = asyncio.Condition()
-            try:
-                placeholder = np.zeros((480, 640, 3), dtype=np.uint8)
-                cv2.putText(placeholder, "Esperando frames...", (20, 40), cv2.FONT_HERSHEY_SIMPLEX, 0.9, (0, 255, 0), 2)
-                # Convertir BGR a RGB para navegadores web
-                placeholder_rgb = cv2.cvtColor(placeholder, cv2.COLOR_BGR2RGB)
-                _, buf = cv2.imencode('.jpg', placeholder_rgb, [cv2.IMWRITE_JPEG_QUALITY, ServerConfig.JPEG_QUALITY])
-                self.latest_annotated_frame = buf.tobytes()
-                self.last_frame_id = 0
-            except Exception:
-                pass
+            # Compositor del stream (también guarda los frames anotados si está habilitado)
+            if ServerConfig.ENABLE_MJPEG_STREAM or ServerConfig.SAVE_ANNOTATED_FRAMES:
+                self.compositor = StreamCompositor(
+                    max_fps=ServerConfig.STREAM_MAX_FPS,
+                    jpeg_quality=ServerConfig.JPEG_QUALITY,
+                    save_callback=self._save_annotated_frame if ServerConfig.SAVE_ANNOTATED_FRAMES else None
+                )
+                self.compositor.start()
+                try:
+                    placeholder = np.zeros((480, 640, 3), dtype=np.uint8)
+                    cv2.putText(placeholder, "Esperando frames...", (20, 40), cv2.FONT_HERSHEY_SIMPLEX, 0.9, (0, 255, 0), 2)
+                    # Convertir BGR a RGB para navegadores web
+                    placeholder_rgb = cv2.cvtColor(placeholder, cv2.COLOR_BGR2RGB)
+                    _, buf = cv2.imencode('.jpg', placeholder_rgb, [cv2.IMWRITE_JPEG_QUALITY, ServerConfig.JPEG_QUALITY])
+                    self.compositor.publish(buf.tobytes())
+                except Exception:
+                    pass
             
             # Validar tipo de modelo
             model_type = ServerConfig.MODEL_TYPE
@@ -250,11 +301,13 @@ class InferenceServer:
             
             # Verificar que el archivo existe (no requerido para RF-DETR pre-entrenado ni Roboflow)
             model_path = Path(ServerConfig.MODEL_PATH)
+            if ServerConfig.MODEL_PRECISION == "int8" and model_type in ["yolov8", "rtdetr"]:
+                model_path = self._quantized_model_path(model_path)
             if model_type in ["yolov8", "rtdetr"] and not model_path.exists():
-                raise FileNotFoundError(f"Modelo no encontrado: {ServerConfig.MODEL_PATH}")
+                raise FileNotFoundError(f"Modelo no encontrado: {model_path}")
             
             if model_path.exists() and model_type not in ["roboflow"]:
-                logger.info(f"📂 Usando pesos desde: {ServerConfig.MODEL_PATH}")
+                logger.info(f"📂 Usando pesos desde: {model_path}")
             
             # Cargar modelo según el tipo seleccionado
             if model_type == "rfdetr_local":
@@ -405,10 +458,26 @@ class InferenceServer:
                 self.device = "cpu"
                 self.fp16 = False
             
+            if ServerConfig.MODEL_PRECISION == "int8" and model_type in ["yolov8", "rtdetr"]:
+                self.model_type = f"{self.model_type} INT8"
+            
             # Warmup (solo para modelos locales, no para Roboflow API)
             if "Roboflow" not in self.model_type:
                 await self._warmup()
             
+            # Micro-batching solo para la ruta Ultralytics de infer() (predict acepta listas);
+            # el ONNX cuantizado tiene batch fijo 1
+            if (ServerConfig.ENABLE_BATCHING and "RF-DETR" not in self.model_type and
+                    "Roboflow" not in self.model_type and "INT8" not in self.model_type):
+                self.batcher = MicroBatcher(
+                    self._predict_batch,
+                    max_batch_size=ServerConfig.BATCH_MAX_SIZE,
+                    max_wait_ms=ServerConfig.BATCH_MAX_WAIT_MS,
+                    default_deadline_ms=ServerConfig.BATCH_DEFAULT_DEADLINE_MS
+                )
+                self._profile_batches()
+                self.batcher.start()
+            
             self.model_loaded = True
             logger.info(f"✅ Modelo {self.model_type} cargado y listo")
             
@@ -417,6 +486,32 @@ class InferenceServer:
             self.model_loaded = False
             raise
     
+    @staticmethod
+    def _quantized_model_path(model_path: Path) -> Path:
+        """
+        Modelo INT8 de Quantize_Onnx.py junto a los pesos: best.pt -> best.int8.onnx.
+        Ultralytics lo ejecuta con ONNX Runtime (CPU).
+        """
+        if model_path.name.endswith(".int8.onnx"):
+            quantized = model_path
+        else:
+            quantized = model_path.with_name(model_path.stem + ".int8.onnx")
+        if not quantized.exists():
+            raise FileNotFoundError(
+                f"Modelo INT8 no encontrado: {quantized}. Generarlo con "
+                f"IA_Etiquetado/IATraining/Export_Onnx.py y Quantize_Onnx.py"
+            )
+        
+        metadata_path = quantized.with_name(quantized.name + ".json")
+        if metadata_path.exists():
+            with open(metadata_path, "r", encoding="utf-8") as f:
+                metadata = json.load(f)
+            if metadata.get("input") == "uint8":
+                raise ValueError(f"{quantized} tiene entrada UINT8 (--uint8-input): solo lo carga el servidor nativo")
+        
+        logger.info(f"⚡ Precisión INT8: {quantized}")
+        return quantized
+    
     async def _warmup(self):
         """Realiza warmup del modelo."""
         logger.info("🔥 Realizando warmup del modelo...")
@@ -438,11 +533,35 @@ class InferenceServer:
             warmup_time = (time.time() - start) * 1000
             logger.info(f"   Warmup {i+1}/3: {warmup_time:.1f}ms")
     
-    def _calculate_image_hash(self, image: np.ndarray) -> str:
-        """Calcula hash de la imagen para cache."""
-        # Reducir imagen para hash más rápido
-        small = cv2.resize(image, (64, 64))
-        return hashlib.md5(small.tobytes()).hexdigest()
+    def _profile_batches(self):
+        """Mide la latencia de cada tamaño de batch para que el planificador decida cuándo agrupar."""
+        logger.info(f"📦 Perfilando micro-batches (hasta {self.batcher.max_batch_size} frames)...")
+        dummy_img = np.random.randint(0, 255, (640, 640, 3), dtype=np.uint8)
+        key = (640, 0.5, 0.45, 100)
+        for size in range(1, self.batcher.max_batch_size + 1):
+            start = time.time()
+            self._predict_batch(key, [dummy_img] * size)
+            batch_ms = (time.time() - start) * 1000
+            self.batcher.seed(size, batch_ms)
+            logger.info(f"   Batch {size}: {batch_ms:.1f}ms ({batch_ms / size:.1f}ms/frame)")
+    
+    def _predict_batch(self, key: tuple, images: List[np.ndarray]) -> list:
+        """Forward de un micro-batch (se ejecuta en el hilo del planificador)."""
+        imgsz, conf, iou, max_det = key
+        return list(self.model.predict(
+            images,
+            imgsz=imgsz,
+            conf=conf,
+            iou=iou,
+            max_det=max_det,
+            device=self.device,
+            half=self.fp16,
+            verbose=False
+        ))
+    
+    def _calculate_image_hash(self, image: np.ndarray) -> PerceptualHash:
+        """Calcula el hash perceptual de la imagen para cache."""
+        return PerceptualHash.compute(image)
     
     def _verify_color_space(self, image: np.ndarray) -> np.ndarray:
         """
@@ -496,18 +615,19 @@ class InferenceServer:
             # Esto corrige el problema de colores rosados/magentas de la cámara
             image = self._verify_color_space(image)
             
-            # Verificar cache si está habilitado
-            if self.cache_enabled:
+            # Verificar cache si está habilitado (frames casi idénticos: banda detenida o vacía)
+            img_hash = None
+            if self.cache_enabled and params.use_cache:
                 img_hash = self._calculate_image_hash(image)
-                cache_key = f"{img_hash}_{params.imgsz}_{params.conf}_{params.iou}"
+                cache_context = (params.imgsz, params.conf, params.iou,
+                                 params.max_det, params.class_names_json)
                 
-                if cache_key in self.cache:
-                    cached = self.cache[cache_key]
-                    # Verificar TTL
-                    if time.time() - cached["timestamp"] < ServerConfig.CACHE_TTL:
-                        logger.debug("✨ Resultado desde cache")
-                        self.stats["requests_success"] += 1
-                        return cached["response"]
+                cached = self.cache.get(img_hash, cache_context)
+                if cached is not None:
+                    logger.debug("✨ Resultado desde cache")
+                    self.stats["requests_success"] += 1
+                    self.stats["requests_cached"] += 1
+                    return cached
             
             # Pre-procesamiento
             pre_start = time.time()
@@ -529,6 +649,7 @@ class InferenceServer:
             # Determinar tipo de modelo
             is_rfdetr = "RF-DETR" in self.model_type
             is_roboflow = "Roboflow" in self.model_type
+            batch_info = None
             
             if is_roboflow:
                 # Roboflow Inference API (REST)
@@ -581,6 +702,17 @@ class InferenceServer:
                 results = None  # RF-DETR no usa formato Results de Ultralytics
                 roboflow_results = None
                 
+            elif self.batcher is not None:
+                # YOLO/RT-DETR agrupados con otros frames concurrentes compatibles
+                key = (params.imgsz, params.conf, params.iou, params.max_det)
+                remaining_ms = None
+                if params.deadline_ms is not None:
+                    remaining_ms = params.deadline_ms - (time.time() - start_time) * 1000
+                result, batch_info = await self.batcher.submit(key, image, remaining_ms)
+                results = [result]
+                detections_sv = None
+                roboflow_results = None
+                
             else:
                 # YOLO/RT-DETR usan API de Ultralytics
                 results = self.model.predict(
@@ -597,6 +729,11 @@ class InferenceServer:
                 roboflow_results = None
             
             inference_ms = (time.time() - inference_start) * 1000
+            batch_size, queue_ms = 1, 0.0
+            if batch_info is not None:
+                # El forward es compartido; la espera en cola se informa aparte
+                inference_ms = batch_info.batch_ms
+                batch_size, queue_ms = batch_info.batch_size, batch_info.queue_ms
             
             # Post-procesamiento
             post_start = time.time()
@@ -749,23 +886,14 @@ class InferenceServer:
                 post_ms=post_ms,
                 total_ms=total_ms,
                 model_device=self.device,
-                timestamp=datetime.now().isoformat()
+                timestamp=datetime.now().isoformat(),
+                batch_size=batch_size,
+                queue_ms=queue_ms
             )
             
-            # Guardar en cache si está habilitado
-            if self.cache_enabled and 'cache_key' in locals():
-                self.cache[cache_key] = {
-                    "response": response,
-                    "timestamp": time.time()
-                }
-                
-                # Limpiar cache antiguo
-                if len(self.cache) > 100:
-                    # Eliminar entradas más antiguas
-                    oldest_keys = sorted(self.cache.keys(), 
-                                       key=lambda k: self.cache[k]["timestamp"])[:20]
-                    for key in oldest_keys:
-                        del self.cache[key]
+            # Guardar en cache (LRU acotada, la TTL la aplica la propia cache)
+            if img_hash is not None:
+                self.cache.put(img_hash, response, cache_context)
             
             # Actualizar estadísticas de rendimiento
             self.perf_stats["frame_count"] += 1
@@ -794,26 +922,10 @@ class InferenceServer:
                 logger.info(f"✅ {len(detections)} frutas en {total_ms:.1f}ms "
                           f"(inf:{inference_ms:.1f}ms) | FPS: {self.perf_stats['current_fps']:.1f}")
             
-            # Crear frame anotado para streaming
-            if ServerConfig.ENABLE_MJPEG_STREAM or ServerConfig.SAVE_ANNOTATED_FRAMES:
-                annotated_img = self._create_annotated_image(image.copy(), detections)
-                
-                # Guardar frame si está habilitado
-                if ServerConfig.SAVE_ANNOTATED_FRAMES and len(detections) > 0:
-                    self._save_annotated_frame(annotated_img, detections)
-                
-                # Encodear para streaming
-                if ServerConfig.ENABLE_MJPEG_STREAM:
-                    # Convertir BGR a RGB para navegadores web
-                    annotated_img_rgb = cv2.cvtColor(annotated_img, cv2.COLOR_BGR2RGB)
-                    _, buffer = cv2.imencode('.jpg', annotated_img_rgb, 
-                                            [cv2.IMWRITE_JPEG_QUALITY, ServerConfig.JPEG_QUALITY])
-                    self.latest_annotated_frame = buffer.tobytes()
-                    self.last_frame_id += 1
-                    # Notificar a TODOS los consumidores que hay un frame nuevo
-                    if self.frame_condition is not None:
-                        async with self.frame_condition:
-                            self.frame_condition.notify_all()
+            # Frame anotado para /stream y disco: sin clientes ni guardado no cuesta nada;
+            # el dibujo y el JPEG se hacen fuera del event loop
+            if self.compositor is not None:
+                self.compositor.submit(image, detections, self.perf_stats["current_fps"])
             
             return response
             
@@ -822,47 +934,14 @@ class InferenceServer:
             logger.error(f"❌ Error en inferencia: {e}")
             raise
     
-    def _create_annotated_image(self, image: np.ndarray, detections: List[Detection]) -> np.ndarray:
-        """Crea una imagen anotada con bounding boxes."""
-        # Colores por clase (formato BGR para OpenCV)
-        colors = {
-            "apple": (0, 255, 0),    # Verde (BGR)
-            "pear": (255, 0, 0),     # Azul (BGR)
-            "lemon": (0, 255, 255),  # Amarillo (BGR)
-            "unknown": (128, 128, 128)  # Gris (BGR)
-        }
-        
-        for det in detections:
-            x1, y1, x2, y2 = det.bbox
-            color = colors.get(det.class_name, (255, 255, 255))
-            
-            # Dibujar bbox
-            cv2.rectangle(image, (x1, y1), (x2, y2), color, 2)
-            
-            # Etiqueta
-            label = f"{det.class_name} {det.confidence:.2f}"
-            (w, h), _ = cv2.getTextSize(label, cv2.FONT_HERSHEY_SIMPLEX, 0.5, 1)
-            
-            # Fondo para el texto
-            cv2.rectangle(image, (x1, y1 - h - 4), (x1 + w, y1), color, -1)
-            cv2.putText(image, label, (x1, y1 - 2), 
-                       cv2.FONT_HERSHEY_SIMPLEX, 0.5, (0, 0, 0), 1)
-        
-        # Agregar info de FPS y stats
-        info_text = f"FPS: {self.perf_stats['current_fps']:.1f} | Detecciones: {len(detections)}"
-        cv2.putText(image, info_text, (10, 30), 
-                   cv2.FONT_HERSHEY_SIMPLEX, 0.7, (0, 255, 0), 2)
-        
-        return image
-    
-    def _save_annotated_frame(self, image: np.ndarray, detections: List[Detection]):
-        """Guarda frame anotado en disco."""
+    def _save_annotated_frame(self, image: np.ndarray, num_detections: int):
+        """Guarda frame anotado en disco (desde el hilo del compositor)."""
         try:
             save_dir = Path(ServerConfig.ANNOTATED_FRAMES_DIR)
             save_dir.mkdir(parents=True, exist_ok=True)
             
             timestamp = datetime.now().strftime("%Y%m%d_%H%M%S_%f")
-            filename = f"detection_{timestamp}_{len(detections)}fruits.jpg"
+            filename = f"detection_{timestamp}_{num_detections}fruits.jpg"
             filepath = save_dir / filename
             
             cv2.imwrite(str(filepath), image, 
@@ -871,6 +950,29 @@ class InferenceServer:
         except Exception as e:
             logger.warning(f"Error guardando frame: {e}")
     
+    def get_shared_ring(self, name: str):
+        """
+        Abre (o reutiliza) el anillo de frames de un cliente local y lo marca
+        en uso: el llamador debe hacer ring.release() al terminar. Un anillo
+        desalojado mientras otra petición lo lee se cierra en su release().
+        """
+        ring = self.shared_rings.get(name)
+        if ring is None:
+            if len(self.shared_rings) >= ServerConfig.MAX_SHARED_RINGS:
+                # Cerrar el anillo más antiguo (cliente probablemente reiniciado)
+                oldest = next(iter(self.shared_rings))
+                self.shared_rings.pop(oldest).close()
+            ring = SharedFrameRing.attach(name)
+            self.shared_rings[name] = ring
+            logger.info(f"🧠 Cliente local conectado por memoria compartida: {name}")
+        return ring.acquire()
+    
+    def close_shared_rings(self):
+        """Cierra los anillos de memoria compartida abiertos."""
+        for ring in self.shared_rings.values():
+            ring.close()
+        self.shared_rings.clear()
+    
     def get_health_status(self) -> HealthResponse:
         """Obtiene el estado de salud del servidor."""
         uptime = time.time() - self.stats["startup_time"]
@@ -937,6 +1039,11 @@ async def lifespan(app: FastAPI):
     yield
     # Shutdown
     logger.info("🛑 Apagando servidor...")
+    if inference_server.batcher is not None:
+        await inference_server.batcher.stop()
+    if inference_server.compositor is not None:
+        await inference_server.compositor.stop()
+    inference_server.close_shared_rings()
 
 # Crear aplicación FastAPI
 app = FastAPI(
@@ -965,6 +1072,16 @@ app.add_exception_handler(RateLimitExceeded, _rate_limit_exceeded_handler)
 
 # ==================== ENDPOINTS ====================
 
+# Formatos aceptados en /infer_shm (mismo contrato que el servidor nativo, que los lee sin convertir)
+SHM_PIXEL_FORMATS = {
+    "bgr": None,
+    "rgb": cv2.COLOR_RGB2BGR,
+    "gray": cv2.COLOR_GRAY2BGR,
+    "i420": cv2.COLOR_YUV2BGR_I420,
+    "yuv420": cv2.COLOR_YUV2BGR_I420,
+    "nv12": cv2.COLOR_YUV2BGR_NV12,
+}
+
 @app.get("/")
 async def root():
     """Endpoint raíz."""
@@ -991,6 +1108,8 @@ async def infer(
     iou: float = Form(0.45),
     max_det: int = Form(100),
     class_names_json: Optional[str] = Form(None),
+    use_cache: bool = Form(True),
+    deadline_ms: Optional[float] = Form(None),
     token: str = Depends(verify_token)
 ):
     """
@@ -1003,6 +1122,8 @@ async def infer(
         iou: Umbral de IoU para NMS (0.0-1.0)
         max_det: Máximo número de detecciones (1-300)
         class_names_json: Nombres de clases en formato JSON
+        use_cache: Permitir respuesta desde cache (False para canarios/benchmarks)
+        deadline_ms: Plazo del frame desde su llegada (micro-batching; None = por defecto)
     
     Returns:
         Resultado de inferencia con detecciones
@@ -1032,7 +1153,9 @@ async def infer(
             conf=conf,
             iou=iou,
             max_det=max_det,
-            class_names_json=class_names_json
+            class_names_json=class_names_json,
+            use_cache=use_cache,
+            deadline_ms=deadline_ms
         )
         
         # Realizar inferencia
@@ -1050,6 +1173,110 @@ async def infer(
         )
 
 
+@app.post("/infer_shm")
+@limiter.limit(ServerConfig.RATE_LIMIT)
+async def infer_shared_memory(
+    request: Request,
+    ring: str = Form(...),
+    slot: int = Form(...),
+    seq: int = Form(...),
+    imgsz: int = Form(640),
+    conf: float = Form(0.2),
+    iou: float = Form(0.45),
+    max_det: int = Form(100),
+    class_names_json: Optional[str] = Form(None),
+    use_cache: bool = Form(True),
+    deadline_ms: Optional[float] = Form(None),
+    pixel_format: Optional[str] = Form(None),
+    token: str = Depends(verify_token)
+):
+    """
+    Inferencia sobre un frame BGR en el anillo de memoria compartida del cliente.
+    
+    Solo para clientes en la misma máquina: la imagen no viaja por HTTP ni se
+    decodifica; se lee sin copia del slot indicado.
+    
+    Args:
+        ring: Nombre del segmento de memoria compartida
+        slot: Índice del slot en el anillo
+        seq: Número de secuencia escrito en el slot
+        pixel_format: bgr (por defecto), rgb, gray, i420 o nv12 (YUV 4:2:0 de la cámara,
+                      slot con forma (alto * 3/2, ancho))
+        (resto de parámetros igual que /infer)
+    
+    Returns:
+        Resultado de inferencia con detecciones (409 si el slot fue sobrescrito)
+    """
+    if not ServerConfig.ENABLE_SHARED_MEMORY:
+        raise HTTPException(status_code=status.HTTP_404_NOT_FOUND,
+                            detail="Memoria compartida deshabilitada")
+    
+    client_host = request.client.host if request.client else ""
+    if client_host not in ("127.0.0.1", "::1", "localhost"):
+        raise HTTPException(status_code=status.HTTP_403_FORBIDDEN,
+                            detail="Memoria compartida solo para clientes locales")
+    
+    if not inference_server.model_loaded:
+        raise HTTPException(
+            status_code=status.HTTP_503_SERVICE_UNAVAILABLE,
+            detail="Modelo no está cargado"
+        )
+    
+    try:
+        shared_ring = inference_server.get_shared_ring(ring)
+    except (FileNotFoundError, ValueError) as e:
+        raise HTTPException(status_code=status.HTTP_400_BAD_REQUEST,
+                            detail=f"Anillo no disponible: {e}")
+    
+    try:
+        img = shared_ring.read(slot, seq)
+        if img is None:
+            raise HTTPException(status_code=status.HTTP_409_CONFLICT,
+                                detail="Slot sobrescrito o inválido")
+    
+        if pixel_format:
+            fmt = pixel_format.lower()
+            if fmt not in SHM_PIXEL_FORMATS:
+                raise HTTPException(status_code=status.HTTP_422_UNPROCESSABLE_ENTITY,
+                                    detail="Formato de píxel incompatible con el frame")
+            if SHM_PIXEL_FORMATS[fmt] is not None:
+                try:
+                    img = cv2.cvtColor(img, SHM_PIXEL_FORMATS[fmt])
+                except cv2.error:
+                    raise HTTPException(status_code=status.HTTP_422_UNPROCESSABLE_ENTITY,
+                                        detail="Formato de píxel incompatible con el frame")
+    
+        params = InferenceRequest(
+            imgsz=imgsz,
+            conf=conf,
+            iou=iou,
+            max_det=max_det,
+            class_names_json=class_names_json,
+            use_cache=use_cache,
+            deadline_ms=deadline_ms
+        )
+    
+        try:
+            result = await inference_server.infer(img, params)
+        except Exception as e:
+            logger.error(f"Error en endpoint de inferencia (memoria compartida): {e}")
+            raise HTTPException(
+                status_code=status.HTTP_500_INTERNAL_SERVER_ERROR,
+                detail=str(e)
+            )
+        finally:
+            del img
+    
+        # El productor pudo reutilizar el slot durante la inferencia
+        if not shared_ring.is_valid(slot, seq):
+            raise HTTPException(status_code=status.HTTP_409_CONFLICT,
+                                detail="Slot sobrescrito durante la inferencia")
+    
+        return result
+    finally:
+        shared_ring.release()
+
+
 @app.get("/stats")
 async def get_stats(token: str = Depends(verify_token)):
     """Obtiene estadísticas del servidor."""
@@ -1071,7 +1298,12 @@ async def get_stats(token: str = Depends(verify_token)):
     stats.update({
         "fps": inference_server.perf_stats["current_fps"],
         "total_detections": inference_server.perf_stats["detections_count"],
-        "frames_processed": inference_server.perf_stats["frame_count"]
+        "frames_processed": inference_server.perf_stats["frame_count"],
+        "cache": inference_server.cache.get_stats(),
+        "batching": ({"enabled": True, **inference_server.batcher.get_stats()}
+                     if inference_server.batcher is not None else {"enabled": False}),
+        "stream": ({"enabled": True, **inference_server.compositor.get_stats()}
+                   if inference_server.compositor is not None else {"enabled": False})
     })
     
     return stats
@@ -1087,36 +1319,39 @@ async def mjpeg_stream():
     """
     from fastapi.responses import StreamingResponse
     
-    if not ServerConfig.ENABLE_MJPEG_STREAM:
+    compositor = inference_server.compositor
+    if not ServerConfig.ENABLE_MJPEG_STREAM or compositor is None:
         raise HTTPException(
             status_code=status.HTTP_503_SERVICE_UNAVAILABLE,
             detail="Streaming MJPEG deshabilitado"
         )
     
     async def generate_frames():
-        """Generador de frames MJPEG con keepalive y límite de FPS por cliente."""
+        """
+        Generador de frames MJPEG con keepalive y límite de FPS por cliente.
+        Mientras esté abierto cuenta como suscriptor: el compositor solo
+        dibuja y codifica frames si hay alguno.
+        """
         last_sent_frame_id = -1
         last_send_time = 0.0
         min_interval = 1.0 / ServerConfig.STREAM_MAX_FPS if ServerConfig.STREAM_MAX_FPS > 0 else 0.0
         keepalive_s = ServerConfig.STREAM_KEEPALIVE_MS / 1000.0
 
-        while True:
-            async with inference_server.frame_condition:
-                try:
-                    await asyncio.wait_for(inference_server.frame_condition.wait(), timeout=keepalive_s)
-                except asyncio.TimeoutError:
-                    pass
+        with compositor.subscribe():
+            while True:
+                # Vuelve enseguida si se publicó un frame mientras se enviaba el anterior
+                await compositor.wait_frame(last_sent_frame_id, keepalive_s)
 
                 now = time.time()
-                if (inference_server.latest_annotated_frame is not None and 
-                    (inference_server.last_frame_id != last_sent_frame_id or (now - last_send_time) >= keepalive_s)):
+                if (compositor.latest_jpeg is not None and 
+                    (compositor.frame_id != last_sent_frame_id or (now - last_send_time) >= keepalive_s)):
 
                     if min_interval > 0 and (now - last_send_time) < min_interval:
                         await asyncio.sleep(min_interval - (now - last_send_time))
                         now = time.time()
 
-                    last_sent_frame_id = inference_server.last_frame_id
-                    frame_data = inference_server.latest_annotated_frame
+                    last_sent_frame_id = compositor.frame_id
+                    frame_data = compositor.latest_jpeg
                     last_send_time = now
 
                     yield (b'--frame\r\n'
@@ -1182,6 +1417,7 @@ if __name__ == "__main__":
     logger.info(f"   Modelo: {ServerConfig.MODEL_PATH}")
     logger.info(f"   Device: {ServerConfig.MODEL_DEVICE}")
     logger.info(f"   FP16: {ServerConfig.MODEL_FP16}")
+    logger.info(f"   Precisión: {ServerConfig.MODEL_PRECISION.upper()}")
     logger.info(f"   Autenticación: {ServerConfig.AUTH_ENABLED}")
     logger.info(f"   Host: {ServerConfig.SERVER_HOST}")
     logger.info(f"   Puerto: {ServerConfig.SERVER_PORT}")
@@ -1191,12 +1427,16 @@ if __name__ == "__main__":
     logger.info(f"   Log cada N frames: {ServerConfig.LOG_EVERY_N_FRAMES}")
     logger.info(f"   Streaming MJPEG: {ServerConfig.ENABLE_MJPEG_STREAM}")
     logger.info(f"   Guardar frames: {ServerConfig.SAVE_ANNOTATED_FRAMES}")
+    logger.info(f"   Micro-batching: {ServerConfig.ENABLE_BATCHING} "
+                f"(máx {ServerConfig.BATCH_MAX_SIZE} frames, ventana {ServerConfig.BATCH_MAX_WAIT_MS:.0f}ms)")
     if ServerConfig.SAVE_ANNOTATED_FRAMES:
         logger.info(f"   Directorio: {ServerConfig.ANNOTATED_FRAMES_DIR}")
     logger.info("")
     logger.info("🌐 ENDPOINTS DISPONIBLES")
     logger.info(f"   http://{ServerConfig.SERVER_HOST}:{ServerConfig.SERVER_PORT}/health")
     logger.info(f"   http://{ServerConfig.SERVER_HOST}:{ServerConfig.SERVER_PORT}/infer")
+    if ServerConfig.ENABLE_SHARED_MEMORY:
+        logger.info(f"   http://127.0.0.1:{ServerConfig.SERVER_PORT}/infer_shm (memoria compartida, local)")
     logger.info(f"   http://{ServerConfig.SERVER_HOST}:{ServerConfig.SERVER_PORT}/stats")
     logger.info(f"   http://{ServerConfig.SERVER_HOST}:{ServerConfig.SERVER_PORT}/perf")
     if ServerConfig.ENABLE_MJPEG_STREAM:
@@ -12,6 +12,7 @@ Módulo de control de cámara de alta performance para sistemas industriales:
 - Sistema de métricas y telemetría avanzada
 - Recuperación automática de errores y reconexión
 - Compresión adaptativa y streaming eficiente
+- Fuente de reproducción (vídeo o carpeta de imágenes) para pruebas sin cámara
 
 Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
 Fecha: Julio 2025
@@ -36,6 +37,8 @@ from pathlib import Path
 from typing import Dict, Optional, List, Callable, Any, Union, Tuple
 from contextlib import contextmanager
 
+from utils.frame_preprocessor import FrameStatistics
+
 # Configuración del logger
 logger = logging.getLogger(__name__)
 
@@ -67,6 +70,7 @@ class CameraType(Enum):
     IP_CAMERA = "ip_camera"
     INDUSTRIAL = "industrial"
     MOCK = "mock"  # Para pruebas sin hardware
+    REPLAY = "replay"  # Reproducción de vídeo/imágenes con la interfaz de una cámara
 
 class CameraState(Enum):
     """Estados de la cámara."""
@@ -173,6 +177,24 @@ class BaseCameraDriver(ABC):
     async def cleanup(self):
         """Limpia recursos del driver."""
         pass
+    
+    def read_frame(self) -> Tuple[Optional[np.ndarray], float]:
+        """
+        Captura síncrona para el hilo de captura continua.
+        
+        Returns:
+            (frame, marca de tiempo en segundos de time.monotonic()). Los drivers
+            que no la implementan se usan a través de capture_frame().
+        """
+        raise NotImplementedError
+    
+    @staticmethod
+    def _monotonic_or_now(timestamp_s: float) -> float:
+        """Acepta una marca del kernel solo si está en el reloj monotónico actual."""
+        now = time.monotonic()
+        if timestamp_s > 0 and abs(now - timestamp_s) < 1.0:
+            return timestamp_s
+        return now
 
 class OpenCVCameraDriver(BaseCameraDriver):
     """Driver para cámaras OpenCV (USB, CSI)."""
@@ -249,6 +271,17 @@ class OpenCVCameraDriver(BaseCameraDriver):
             self.last_error = f"Error capturando frame: {e}"
             logger.error(self.last_error)
             return None
+    
+    def read_frame(self) -> Tuple[Optional[np.ndarray], float]:
+        """Captura síncrona con la marca de tiempo del buffer V4L2."""
+        if not self.is_initialized or not self.cap:
+            return None, time.monotonic()
+        ret, frame = self.cap.read()
+        if not ret or frame is None:
+            logger.warning("Captura de frame falló")
+            return None, time.monotonic()
+        # El backend V4L2 expone la marca del buffer del kernel (CLOCK_MONOTONIC) en ms
+        return frame, self._monotonic_or_now(self.cap.get(cv2.CAP_PROP_POS_MSEC) / 1000.0)
 
     async def start_streaming(self) -> bool:
         self.is_streaming = True
@@ -449,22 +482,41 @@ class Picamera2CameraDriver(BaseCameraDriver):
             if frame is None:
                 return None
             
-            # Convertir al formato BGR que espera OpenCV
-            if self._convert_to_bgr:
-                if self.capture_format == "YUV420":
-                    # YUV420 -> BGR (conversión directa, más eficiente)
-                    frame = cv2.cvtColor(frame, cv2.COLOR_YUV2BGR_I420)
-                elif self.capture_format == "RGB888":
-                    # RGB888 -> BGR (intercambio de canales)
-                    frame = cv2.cvtColor(frame, cv2.COLOR_RGB2BGR)
-                # Si ya está en BGR o formato desconocido, dejar como está
-            
-            return frame
+            return self._to_bgr(frame)
         except Exception as e:
             self.last_error = f"Error capturando frame (Picamera2): {e}"
             logger.error(self.last_error)
             return None
     
+    def read_frame(self) -> Tuple[Optional[np.ndarray], float]:
+        """Captura síncrona con la marca SensorTimestamp de libcamera."""
+        try:
+            if not self.is_initialized or not self.picam2:
+                return None, time.monotonic()
+            request = self.picam2.capture_request()  # type: ignore
+            try:
+                frame = request.make_array("main")
+                sensor_ns = request.get_metadata().get("SensorTimestamp", 0)
+            finally:
+                request.release()
+            return self._to_bgr(frame), self._monotonic_or_now(sensor_ns / 1e9)
+        except Exception as e:
+            self.last_error = f"Error capturando frame (Picamera2): {e}"
+            logger.error(self.last_error)
+            return None, time.monotonic()
+    
+    def _to_bgr(self, frame: np.ndarray) -> np.ndarray:
+        """Convierte al formato BGR que espera OpenCV."""
+        if self._convert_to_bgr:
+            if self.capture_format == "YUV420":
+                # YUV420 -> BGR (conversión directa, más eficiente)
+                frame = cv2.cvtColor(frame, cv2.COLOR_YUV2BGR_I420)
+            elif self.capture_format == "RGB888":
+                # RGB888 -> BGR (intercambio de canales)
+                frame = cv2.cvtColor(frame, cv2.COLOR_RGB2BGR)
+            # Si ya está en BGR o formato desconocido, dejar como está
+        return frame
+    
     async def start_streaming(self) -> bool:
         self.is_streaming = True
         return True
@@ -594,6 +646,134 @@ class MockCameraDriver(BaseCameraDriver):
     async def cleanup(self):
         self.is_initialized = False
 
+class ReplayCameraDriver(BaseCameraDriver):
+    """
+    Driver de reproducción con la misma interfaz que una cámara real.
+    
+    Reproduce un vídeo o una carpeta de imágenes (orden alfabético), en bucle
+    y a la cadencia de la fuente o a máxima velocidad. Permite probar todo el
+    pipeline de captura sin hardware y con entradas repetibles.
+    
+    Config:
+        replay_source: ruta a vídeo o carpeta de imágenes
+        replay_loop: volver al inicio al terminar (True)
+        replay_realtime: respetar los FPS de la fuente (True)
+    """
+    
+    IMAGE_EXTENSIONS = {".jpg", ".jpeg", ".png", ".bmp"}
+    
+    def __init__(self, config: Dict[str, Any]):
+        super().__init__(config)
+        self.source = Path(config.get("replay_source", ""))
+        self.loop = bool(config.get("replay_loop", True))
+        self.realtime = bool(config.get("replay_realtime", True))
+        self.fps = float(config.get("fps", 30))
+        self.width = 0
+        self.height = 0
+        self.frame_index = 0
+        self._images: List[Path] = []
+        self._video: Optional[cv2.VideoCapture] = None
+        self._next_due = 0.0
+    
+    async def initialize(self) -> bool:
+        """Abre la fuente de reproducción."""
+        try:
+            if self.source.is_dir():
+                self._images = sorted(p for p in self.source.iterdir()
+                                      if p.suffix.lower() in self.IMAGE_EXTENSIONS)
+                if not self._images:
+                    raise RuntimeError(f"Sin imágenes en {self.source}")
+            elif self.source.is_file():
+                self._video = cv2.VideoCapture(str(self.source))
+                if not self._video.isOpened():
+                    raise RuntimeError(f"No se pudo abrir {self.source}")
+                source_fps = self._video.get(cv2.CAP_PROP_FPS)
+                if source_fps and source_fps > 0 and "fps" not in self.config:
+                    self.fps = float(source_fps)
+            else:
+                raise RuntimeError(f"Fuente de reproducción no encontrada: '{self.source}'")
+            
+            frame, _ = self._next_frame()
+            if frame is None:
+                raise RuntimeError("La fuente de reproducción no contiene frames")
+            self.height, self.width = frame.shape[:2]
+            self._rewind()
+            
+            logger.info(f"Reproducción inicializada: {self.source} ({self.width}x{self.height} @ {self.fps:.1f}fps)")
+            self.is_initialized = True
+            return True
+        except Exception as e:
+            self.last_error = f"Error inicializando reproducción: {e}"
+            logger.error(self.last_error)
+            return False
+    
+    def _rewind(self):
+        self.frame_index = 0
+        if self._video is not None:
+            self._video.set(cv2.CAP_PROP_POS_FRAMES, 0)
+    
+    def _next_frame(self) -> Tuple[Optional[np.ndarray], bool]:
+        """Lee el siguiente frame de la fuente; devuelve (frame, fin_de_fuente)."""
+        if self._images:
+            if self.frame_index >= len(self._images):
+                return None, True
+            frame = cv2.imread(str(self._images[self.frame_index]), cv2.IMREAD_COLOR)
+        else:
+            ret, frame = self._video.read()
+            if not ret:
+                return None, True
+        self.frame_index += 1
+        return frame, False
+    
+    def read_frame(self) -> Tuple[Optional[np.ndarray], float]:
+        """Entrega el siguiente frame respetando la cadencia de la fuente."""
+        if not self.is_initialized:
+            return None, time.monotonic()
+        
+        frame, finished = self._next_frame()
+        if finished and self.loop:
+            self._rewind()
+            frame, finished = self._next_frame()
+        if frame is None:
+            return None, time.monotonic()
+        
+        if self.realtime and self.fps > 0:
+            now = time.monotonic()
+            self._next_due = max(self._next_due + 1.0 / self.fps, now)
+            if self._next_due > now:
+                time.sleep(self._next_due - now)
+        return frame, time.monotonic()
+    
+    async def capture_frame(self) -> Optional[np.ndarray]:
+        return self.read_frame()[0]
+    
+    async def start_streaming(self) -> bool:
+        return True
+    
+    async def stop_streaming(self) -> bool:
+        return True
+    
+    async def set_parameter(self, param: str, value: Any) -> bool:
+        if param == "fps":
+            self.fps = float(value)
+            return True
+        return False
+    
+    async def get_parameter(self, param: str) -> Any:
+        values = {
+            'fps': self.fps,
+            'width': self.width,
+            'height': self.height,
+            'frame_index': self.frame_index
+        }
+        return values.get(param, 0)
+    
+    async def cleanup(self):
+        if self._video is not None:
+            self._video.release()
+            self._video = None
+        self.is_initialized = False
+
 class CameraController:
     """
     Sistema de control de cámara industrial avanzado.
@@ -650,6 +830,9 @@ class CameraController:
         self.min_fps = config.get("min_fps", 15.0)
         self.target_fps = config.get("fps", 30.0)
         self.quality_threshold = config.get("quality_threshold", 0.7)
+        self.frame_statistics = FrameStatistics(config.get("quality_analysis_stride", 1))
+        # Analizar calidad cada N frames (los intermedios reutilizan la última métrica)
+        self.quality_analysis_interval = max(1, int(config.get("quality_analysis_interval", 3)))
         
         self._start_time = time.time()
         
@@ -668,6 +851,8 @@ class CameraController:
             return OpenCVCameraDriver(self.config)
         elif self.camera_type == CameraType.MOCK:
             return MockCameraDriver(self.config)
+        elif self.camera_type == CameraType.REPLAY:
+            return ReplayCameraDriver(self.config)
         else:
             raise ValueError(f"Tipo de cámara no soportado: {self.camera_type}")
     
@@ -807,22 +992,28 @@ class CameraController:
         last_fps_update = time.time()
         frame_count = 0
         last_fps_log = time.time()
+        sequence = 0
+        quality_metrics: Optional[FrameMetrics] = None
         
         try:
             none_count = 0
             while not self.stop_capture.is_set():
                 try:
-                    # Capturar frame
-                    frame = loop.run_until_complete(self.driver.capture_frame())
+                    # Capturar frame (lectura síncrona si el driver la soporta)
+                    frame, capture_ts = self._read_from_driver(loop)
                     
                     if frame is not None:
-                        # Analizar calidad
-                        quality_metrics = self._analyze_frame_quality(frame)
+                        # Analizar calidad cada quality_analysis_interval frames
+                        if quality_metrics is None or sequence % self.quality_analysis_interval == 0:
+                            quality_metrics = self._analyze_frame_quality(frame)
+                        sequence += 1
                         
-                        # Agregar al buffer
+                        # Agregar al buffer (capture_ts en reloj monotónico)
                         frame_data = {
                             'frame': frame,
                             'timestamp': time.time(),
+                            'capture_ts': capture_ts,
+                            'sequence': sequence,
                             'metrics': quality_metrics
                         }
                         
@@ -856,7 +1047,8 @@ class CameraController:
                                 last_fps_log = current_time
                         
                         # Auto-optimización periódica
-                        if self.auto_optimize:
+                        if self.auto_optimize and \
+                           current_time - self.last_optimization >= self.optimization_interval:
                             loop.run_until_complete(self._auto_optimize_settings())
                     
                     else:
@@ -889,6 +1081,13 @@ class CameraController:
             loop.close()
             logger.info("Worker de captura continua terminado")
     
+    def _read_from_driver(self, loop: asyncio.AbstractEventLoop) -> Tuple[Optional[np.ndarray], float]:
+        """Lee un frame del driver actual, sin event loop si implementa read_frame()."""
+        driver = self.driver
+        if type(driver).read_frame is not BaseCameraDriver.read_frame:
+            return driver.read_frame()
+        return loop.run_until_complete(driver.capture_frame()), time.monotonic()
+    
     def capture_frame(self) -> Optional[np.ndarray]:
         """Captura un frame único de forma síncrona."""
         try:
@@ -954,24 +1153,15 @@ class CameraController:
         try:
             start_time = time.time()
             
-            # Convertir a escala de grises para análisis
-            gray = cv2.cvtColor(frame, cv2.COLOR_BGR2GRAY)
-            
             # Métricas básicas
             height, width = frame.shape[:2]
             
-            # Análisis de nitidez (varianza del Laplaciano)
-            laplacian = cv2.Laplacian(gray, cv2.CV_64F)
-            sharpness = np.var(laplacian)
-            
-            # Análisis de brillo
-            brightness = np.mean(gray)
-            
-            # Análisis de contraste
-            contrast = np.std(gray)
-            
-            # Análisis de ruido (simplificado)
-            noise_level = np.std(gray - cv2.GaussianBlur(gray, (5, 5), 0))
+            # Brillo, contraste, nitidez (varianza del Laplaciano) y ruido
+            statistics = self.frame_statistics.compute(frame)
+            sharpness = statistics.sharpness
+            brightness = statistics.brightness
+            contrast = statistics.contrast
+            noise_level = statistics.noise_level
             
             # Determinar calidad general
             quality_score = self._calculate_quality_score(sharpness, brightness, contrast, noise_level)
@@ -1131,12 +1321,18 @@ class CameraController:
         except Exception as e:
             logger.error(f"Error guardando calibración: {e}")
     
-    def get_latest_frame(self) -> Optional[np.ndarray]:
-        """Obtiene el frame más reciente del buffer."""
+    def get_latest_frame(self, copy: bool = True) -> Optional[np.ndarray]:
+        """
+        Obtiene el frame más reciente del buffer.
+        
+        Args:
+            copy: False devuelve el frame del buffer sin copiarlo (solo lectura)
+        """
         try:
             with self.buffer_lock:
                 if self.frame_buffer:
-                    return self.frame_buffer[-1]['frame'].copy()
+                    frame = self.frame_buffer[-1]['frame']
+                    return frame.copy() if copy else frame
             return None
             
         except Exception as e:
@@ -18,6 +18,8 @@ Versión: 1.0 - OV5647 Edition
 import cv2
 import numpy as np
 import logging
+import threading
+import time
 from typing import Tuple, Optional, Dict, Any
 from dataclasses import dataclass
 from enum import Enum
@@ -25,6 +27,13 @@ from enum import Enum
 logger = logging.getLogger(__name__)
 
 
+class DenoiseMethod(Enum):
+    """Métodos de reducción de ruido, del más caro al más barato."""
+    BILATERAL = "bilateral"    # Bilateral sobre BGR completo (original)
+    LUMA = "luma"              # Bilateral solo sobre luminancia
+    GUIDED = "guided"          # Filtro guiado (cajas O(1)) sobre luminancia
+
+
 class PreprocessingMode(Enum):
     """Modos de pre-procesamiento."""
     NONE = "none"              # Sin procesamiento
@@ -44,6 +53,72 @@ class FrameMetrics:
     color_balance: float = 0.0   # Balance de color
 
 
+class FrameStatistics:
+    """
+    Cálculo de métricas de calidad con reducciones nativas de OpenCV.
+    
+    Todas las pasadas trabajan en uint8/int16 sobre buffers persistentes
+    (sin imágenes float64 intermedias) y meanStdDev obtiene media y
+    desviación en un solo recorrido. Con stride > 1 se analiza una versión
+    submuestreada del frame (vecino más cercano); con stride=1 los valores
+    son idénticos al cálculo numpy original.
+    """
+    
+    def __init__(self, stride: int = 1):
+        self.stride = max(1, int(stride))
+        self._buffers: Dict[str, np.ndarray] = {}
+    
+    def _get_buffer(self, name: str, shape: Tuple[int, ...], dtype=np.uint8) -> np.ndarray:
+        buffer = self._buffers.get(name)
+        if buffer is None or buffer.shape != shape or buffer.dtype != dtype:
+            buffer = np.empty(shape, dtype=dtype)
+            self._buffers[name] = buffer
+        return buffer
+    
+    def compute(self, frame: np.ndarray) -> FrameMetrics:
+        """
+        Calcula brillo, contraste, nitidez, ruido y balance de color.
+        
+        Args:
+            frame: Frame BGR de OpenCV
+            
+        Returns:
+            FrameMetrics con las métricas del frame
+        """
+        if self.stride > 1:
+            h, w = frame.shape[:2]
+            size = (max(1, w // self.stride), max(1, h // self.stride))
+            frame = cv2.resize(frame, size, dst=self._get_buffer("sample", (size[1], size[0], 3)),
+                               interpolation=cv2.INTER_NEAREST)
+        
+        shape = frame.shape[:2]
+        gray = cv2.cvtColor(frame, cv2.COLOR_BGR2GRAY, dst=self._get_buffer("gray", shape))
+        
+        # Brillo y contraste (media y desviación estándar) en una pasada
+        mean, std = cv2.meanStdDev(gray)
+        
+        # Nitidez: el Laplaciano 3x3 de uint8 cabe en int16 sin pérdida
+        laplacian = cv2.Laplacian(gray, cv2.CV_16S, dst=self._get_buffer("laplacian", shape, np.int16))
+        _, laplacian_std = cv2.meanStdDev(laplacian)
+        
+        # Ruido: residuo respecto al desenfoque gaussiano, con signo
+        blur = cv2.GaussianBlur(gray, (5, 5), 0, dst=self._get_buffer("blur", shape))
+        residual = cv2.subtract(gray, blur, dst=self._get_buffer("residual", shape, np.int16),
+                                dtype=cv2.CV_16S)
+        _, noise_std = cv2.meanStdDev(residual)
+        
+        # Balance de color (diferencia entre medias de canal)
+        channel_means = cv2.mean(frame)[:3]
+        
+        return FrameMetrics(
+            brightness=float(mean[0, 0]),
+            contrast=float(std[0, 0]),
+            sharpness=float(laplacian_std[0, 0]) ** 2,
+            noise_level=float(noise_std[0, 0]),
+            color_balance=float(np.std(channel_means))
+        )
+
+
 class FramePreprocessor:
     """
     Pre-procesador de frames optimizado para OV5647 + YOLOv8.
@@ -69,6 +144,14 @@ class FramePreprocessor:
         self.auto_brightness = self.config.get("auto_brightness", True)
         self.auto_contrast = self.config.get("auto_contrast", True)
         self.denoise_enabled = self.config.get("denoise", False)
+        
+        # Reducción de ruido con presupuesto: si un frame excede denoise_budget_ms
+        # se baja al siguiente método más barato; tras una racha holgada se vuelve a subir
+        self.denoise_method = DenoiseMethod(self.config.get("denoise_method", "bilateral"))
+        self.denoise_budget_ms = self.config.get("denoise_budget_ms")
+        self._denoise_ladder = list(DenoiseMethod)
+        self._denoise_level = self._denoise_ladder.index(self.denoise_method)
+        self._denoise_fast_streak = 0
         self.sharpen_enabled = self.config.get("sharpen", True)
         self.color_correction = self.config.get("color_correction", True)
         
@@ -77,6 +160,12 @@ class FramePreprocessor:
         self.camera_matrix = None
         self.dist_coeffs = None
         
+        # Tablas de remapeo precalculadas: (tamaño, map1, map2), reemplazadas atómicamente
+        self._undistort_maps: Optional[Tuple[Tuple[int, int], np.ndarray, np.ndarray]] = None
+        self._undistort_lock = threading.Lock()
+        self._undistort_pending: Optional[Tuple[int, int]] = None
+        self._calibration_version = 0
+        
         # Rangos objetivo para normalización
         self.target_brightness = 128  # Brillo objetivo
         self.brightness_tolerance = 30
@@ -86,14 +175,55 @@ class FramePreprocessor:
         self.frame_history = []
         self.max_history = 30
         
-        logger.info(f"FramePreprocessor inicializado - Modo: {self.mode.value}")
+        # Pipeline fusionado (opcional): una sola conversión BGR↔LAB y buffers
+        # reutilizables, unas 2x más rápido pero con salida distinta (hasta ~20
+        # niveles, media ~2): revalidar los umbrales de detección antes de
+        # activarlo. Por defecto se usa la secuencia original paso a paso
+        # (salida idéntica bit a bit a versiones anteriores).
+        self.fused_pipeline = self.config.get("fused_pipeline", False)
+        # CLAHE persistente (OpenCV reparte histogramas e interpolación entre núcleos)
+        self._clahe = cv2.createCLAHE(
+            clipLimit=self.config.get("clahe_clip_limit", 2.0),
+            tileGridSize=tuple(self.config.get("clahe_tile_grid", (8, 8)))
+        )
+        self._brightness_luts: Dict[int, np.ndarray] = {}
+        # Sharpening + mezcla 60/40 con el original en un único kernel
+        self._sharpen_blend_kernel = np.array([
+            [0, -0.6, 0],
+            [-0.6, 3.4, -0.6],
+            [0, -0.6, 0]
+        ], dtype=np.float32)
+        self._buffers: Dict[str, np.ndarray] = {}
+        
+        # Métricas de calidad (stride > 1 submuestrea el análisis)
+        self._statistics = FrameStatistics(self.config.get("analysis_stride", 1))
+        
+        logger.info(f"FramePreprocessor inicializado - Modo: {self.mode.value} "
+                    f"(pipeline {'fusionado' if self.fused_pipeline else 'secuencial'})")
     
-    def load_camera_calibration(self, camera_matrix: np.ndarray, dist_coeffs: np.ndarray):
-        """Carga datos de calibración de cámara para corrección de distorsión."""
-        self.camera_matrix = camera_matrix
-        self.dist_coeffs = dist_coeffs
+    def load_camera_calibration(self, camera_matrix: np.ndarray, dist_coeffs: np.ndarray,
+                                frame_size: Optional[Tuple[int, int]] = None):
+        """
+        Carga datos de calibración de cámara para corrección de distorsión.
+        
+        Las tablas de remapeo se construyen en segundo plano; mientras tanto
+        los frames se corrigen con cv2.undistort como antes.
+        
+        Args:
+            camera_matrix: Matriz intrínseca 3x3
+            dist_coeffs: Coeficientes de distorsión
+            frame_size: (ancho, alto) para construir las tablas de inmediato
+        """
+        with self._undistort_lock:
+            self.camera_matrix = camera_matrix
+            self.dist_coeffs = dist_coeffs
+            self._calibration_version += 1
+            self._undistort_pending = None
         self.lens_correction = True
         logger.info("Calibración de cámara cargada para corrección de distorsión")
+        
+        if frame_size is not None:
+            self._schedule_undistort_maps(tuple(frame_size))
     
     def analyze_frame(self, frame: np.ndarray) -> FrameMetrics:
         """
@@ -105,34 +235,7 @@ class FramePreprocessor:
         Returns:
             FrameMetrics con métricas del frame
         """
-        gray = cv2.cvtColor(frame, cv2.COLOR_BGR2GRAY)
-        
-        # Brillo (luminosidad promedio)
-        brightness = float(np.mean(gray))
-        
-        # Contraste (desviación estándar)
-        contrast = float(np.std(gray))
-        
-        # Nitidez (varianza del Laplaciano)
-        laplacian = cv2.Laplacian(gray, cv2.CV_64F)
-        sharpness = float(np.var(laplacian))
-        
-        # Estimación de ruido
-        blur = cv2.GaussianBlur(gray, (5, 5), 0)
-        noise = gray.astype(float) - blur.astype(float)
-        noise_level = float(np.std(noise))
-        
-        # Balance de color (diferencia entre canales)
-        b, g, r = cv2.split(frame)
-        color_balance = float(np.std([np.mean(b), np.mean(g), np.mean(r)]))
-        
-        return FrameMetrics(
-            brightness=brightness,
-            contrast=contrast,
-            sharpness=sharpness,
-            noise_level=noise_level,
-            color_balance=color_balance
-        )
+        return self._statistics.compute(frame)
     
     def preprocess(self, frame: np.ndarray) -> np.ndarray:
         """
@@ -147,6 +250,9 @@ class FramePreprocessor:
         if self.mode == PreprocessingMode.NONE:
             return frame
         
+        if self.fused_pipeline:
+            return self._preprocess_fused(frame)
+        
         processed = frame.copy()
         
         # 1. Corrección de distorsión de lente (si está calibrado)
@@ -181,9 +287,138 @@ class FramePreprocessor:
         
         return processed
     
+    def _preprocess_fused(self, frame: np.ndarray) -> np.ndarray:
+        """
+        Variante fusionada de preprocess().
+        
+        Brillo, CLAHE y balance de blancos se aplican sobre el mismo frame LAB
+        (una ida y vuelta en lugar de tres), y el sharpening con mezcla se hace
+        con un solo filter2D. Los intermedios usan buffers persistentes; solo
+        el frame devuelto se reserva en cada llamada. La salida es visualmente
+        equivalente a la secuencial, pero no idéntica bit a bit.
+        """
+        source = frame
+        if self.lens_correction and self.camera_matrix is not None:
+            source = self._correct_lens_distortion(source)
+        
+        metrics = self.analyze_frame(source)
+        
+        brightness_delta = self.target_brightness - metrics.brightness
+        apply_brightness = self.auto_brightness and abs(brightness_delta) > self.brightness_tolerance
+        apply_contrast = self.auto_contrast and metrics.contrast < self.min_contrast
+        apply_lab = apply_brightness or apply_contrast or self.color_correction
+        apply_denoise = self.denoise_enabled and metrics.noise_level > 10
+        apply_sharpen = self.sharpen_enabled and metrics.sharpness < 500
+        
+        remaining = int(apply_lab) + int(apply_denoise) + int(apply_sharpen)
+        processed = source
+        stage = 0
+        
+        if apply_lab:
+            remaining -= 1
+            processed = self._apply_lab_corrections(
+                processed,
+                self._stage_output(stage, remaining, processed.shape),
+                int(np.clip(brightness_delta, -50, 50)) if apply_brightness else 0,
+                apply_contrast
+            )
+            stage += 1
+        
+        if apply_denoise:
+            remaining -= 1
+            processed = self._reduce_noise(processed, metrics.noise_level)
+            stage += 1
+        
+        if apply_sharpen:
+            remaining -= 1
+            processed = cv2.filter2D(processed, -1, self._sharpen_blend_kernel,
+                                     dst=self._stage_output(stage, remaining, processed.shape))
+            stage += 1
+        
+        self._update_history(metrics)
+        
+        # El llamador puede conservar el frame: nunca devolver la entrada ni un buffer interno
+        if processed is frame:
+            return frame.copy()
+        return processed
+    
+    def _apply_lab_corrections(self, frame: np.ndarray, output: np.ndarray,
+                               brightness_delta: int, apply_contrast: bool) -> np.ndarray:
+        """Brillo, CLAHE y balance de blancos sobre una única conversión LAB."""
+        h, w = frame.shape[:2]
+        lab = cv2.cvtColor(frame, cv2.COLOR_BGR2LAB, dst=self._get_buffer("lab", frame.shape))
+        l = cv2.extractChannel(lab, 0, dst=self._get_buffer("l", (h, w)))
+        
+        self._correct_luminance(l, brightness_delta, apply_contrast)
+        
+        if self.color_correction:
+            # a/b no cambian con brillo ni CLAHE: sus medias salen del mismo LAB
+            _, avg_a, avg_b, _ = cv2.mean(lab)
+            a = cv2.extractChannel(lab, 1, dst=self._get_buffer("a", (h, w)))
+            b = cv2.extractChannel(lab, 2, dst=self._get_buffer("b", (h, w)))
+            cv2.addWeighted(a, 1.0, l, -(avg_a - 128) * 1.1 / 255.0, 0.0, dst=a)
+            cv2.addWeighted(b, 1.0, l, -(avg_b - 128) * 1.1 / 255.0, 0.0, dst=b)
+            cv2.merge([l, a, b], dst=lab)
+        else:
+            cv2.insertChannel(l, lab, 0)
+        
+        return cv2.cvtColor(lab, cv2.COLOR_LAB2BGR, dst=output)
+    
+    def _correct_luminance(self, l: np.ndarray, brightness_delta: int, apply_contrast: bool):
+        """Aplica brillo (LUT saturada) y CLAHE in situ sobre el plano L."""
+        if brightness_delta:
+            cv2.LUT(l, self._get_brightness_lut(brightness_delta), dst=l)
+        
+        if apply_contrast:
+            self._clahe.apply(l, dst=l)
+    
+    def _get_brightness_lut(self, delta: int) -> np.ndarray:
+        """LUT de suma saturada (equivalente a cv2.add), cacheada por delta."""
+        lut = self._brightness_luts.get(delta)
+        if lut is None:
+            lut = np.clip(np.arange(256, dtype=np.int16) + delta, 0, 255).astype(np.uint8)
+            self._brightness_luts[delta] = lut
+        return lut
+    
+    def _apply_luminance_correction(self, frame: np.ndarray, brightness_delta: int,
+                                    apply_contrast: bool) -> np.ndarray:
+        """
+        Ida y vuelta LAB corrigiendo solo L, con buffers persistentes. El
+        resultado se escribe sobre frame (la copia propia de preprocess()).
+        """
+        h, w = frame.shape[:2]
+        lab = cv2.cvtColor(frame, cv2.COLOR_BGR2LAB, dst=self._get_buffer("lab", frame.shape))
+        l = cv2.extractChannel(lab, 0, dst=self._get_buffer("l", (h, w)))
+        self._correct_luminance(l, brightness_delta, apply_contrast)
+        cv2.insertChannel(l, lab, 0)
+        return cv2.cvtColor(lab, cv2.COLOR_LAB2BGR, dst=frame)
+    
+    def _stage_output(self, stage: int, remaining: int, shape: Tuple[int, ...]) -> np.ndarray:
+        """Destino de una etapa: buffer alterno si quedan etapas, frame nuevo si es la última."""
+        if remaining == 0:
+            return np.empty(shape, dtype=np.uint8)
+        return self._get_buffer(f"stage{stage % 2}", shape)
+    
+    def _get_buffer(self, name: str, shape: Tuple[int, ...], dtype=np.uint8) -> np.ndarray:
+        """Devuelve un buffer persistente, re-reservándolo solo si cambia la forma."""
+        buffer = self._buffers.get(name)
+        if buffer is None or buffer.shape != shape or buffer.dtype != dtype:
+            buffer = np.empty(shape, dtype=dtype)
+            self._buffers[name] = buffer
+        return buffer
+    
     def _correct_lens_distortion(self, frame: np.ndarray) -> np.ndarray:
         """Corrige distorsión de lente usando calibración."""
         h, w = frame.shape[:2]
+        
+        maps = self._undistort_maps
+        if maps is not None and maps[0] == (w, h):
+            # Remapeo en punto fijo con el recorte del ROI ya incluido en las tablas
+            return cv2.remap(frame, maps[1], maps[2], cv2.INTER_LINEAR)
+        
+        # Sin tablas para este tamaño: construirlas en segundo plano y corregir directamente
+        self._schedule_undistort_maps((w, h))
+        
         new_camera_matrix, roi = cv2.getOptimalNewCameraMatrix(
             self.camera_matrix, self.dist_coeffs, (w, h), 1, (w, h)
         )
@@ -199,8 +434,55 @@ class FramePreprocessor:
         
         return undistorted
     
+    def _schedule_undistort_maps(self, size: Tuple[int, int]):
+        """Lanza la construcción de tablas de remapeo sin bloquear la captura."""
+        with self._undistort_lock:
+            if self._undistort_pending == size:
+                return
+            self._undistort_pending = size
+            version = self._calibration_version
+            camera_matrix, dist_coeffs = self.camera_matrix, self.dist_coeffs
+        
+        threading.Thread(
+            target=self._build_undistort_maps,
+            args=(size, camera_matrix, dist_coeffs, version),
+            name="UndistortMaps",
+            daemon=True
+        ).start()
+    
+    def _build_undistort_maps(self, size: Tuple[int, int], camera_matrix: np.ndarray,
+                              dist_coeffs: np.ndarray, version: int):
+        """Construye tablas CV_16SC2 (punto fijo) equivalentes a cv2.undistort."""
+        try:
+            w, h = size
+            new_camera_matrix, roi = cv2.getOptimalNewCameraMatrix(
+                camera_matrix, dist_coeffs, (w, h), 1, (w, h)
+            )
+            map1, map2 = cv2.initUndistortRectifyMap(
+                camera_matrix, dist_coeffs, None, new_camera_matrix, (w, h), cv2.CV_16SC2
+            )
+            
+            # Recortar el área válida en las tablas: remap produce directamente el ROI
+            x, y, rw, rh = roi
+            if rw > 0 and rh > 0:
+                map1 = np.ascontiguousarray(map1[y:y+rh, x:x+rw])
+                map2 = np.ascontiguousarray(map2[y:y+rh, x:x+rw])
+            
+            with self._undistort_lock:
+                # Descartar si la calibración cambió mientras se construían
+                if version != self._calibration_version:
+                    return
+                self._undistort_maps = (size, map1, map2)
+                self._undistort_pending = None
+            logger.info(f"Tablas de corrección de lente listas para {w}x{h}")
+        except Exception as e:
+            with self._undistort_lock:
+                if self._undistort_pending == size:
+                    self._undistort_pending = None
+            logger.error(f"Error construyendo tablas de corrección de lente: {e}")
+    
     def _adjust_brightness(self, frame: np.ndarray, current_brightness: float) -> np.ndarray:
-        """Ajusta brillo del frame."""
+        """Ajusta brillo del frame (in situ)."""
         # Calcular ajuste necesario
         delta = self.target_brightness - current_brightness
         
@@ -209,48 +491,112 @@ class FramePreprocessor:
             # Limitar ajuste para evitar cambios bruscos
             delta = np.clip(delta, -50, 50)
             
-            # Convertir a espacio de color más apropiado (LAB)
-            lab = cv2.cvtColor(frame, cv2.COLOR_BGR2LAB)
-            l, a, b = cv2.split(lab)
-            
-            # Ajustar canal L (luminosidad)
-            l = cv2.add(l, int(delta))
-            
-            # Recombinar y convertir de vuelta
-            lab = cv2.merge([l, a, b])
-            adjusted = cv2.cvtColor(lab, cv2.COLOR_LAB2BGR)
-            
-            return adjusted
+            # Ajustar canal L (luminosidad) en espacio LAB
+            return self._apply_luminance_correction(frame, int(delta), False)
         
         return frame
     
     def _enhance_contrast(self, frame: np.ndarray, current_contrast: float) -> np.ndarray:
-        """Mejora el contraste del frame."""
+        """Mejora el contraste del frame (in situ)."""
         if current_contrast < self.min_contrast:
-            # Usar CLAHE (Contrast Limited Adaptive Histogram Equalization)
-            lab = cv2.cvtColor(frame, cv2.COLOR_BGR2LAB)
-            l, a, b = cv2.split(lab)
-            
-            clahe = cv2.createCLAHE(clipLimit=2.0, tileGridSize=(8, 8))
-            l = clahe.apply(l)
-            
-            lab = cv2.merge([l, a, b])
-            enhanced = cv2.cvtColor(lab, cv2.COLOR_LAB2BGR)
-            
-            return enhanced
+            # Usar CLAHE (Contrast Limited Adaptive Histogram Equalization) sobre L
+            return self._apply_luminance_correction(frame, 0, True)
         
         return frame
     
     def _reduce_noise(self, frame: np.ndarray, noise_level: float) -> np.ndarray:
         """Reduce ruido del frame de forma inteligente."""
-        # Usar filtro bilateral para preservar bordes
+        method = self._denoise_ladder[self._denoise_level]
+        start = time.perf_counter()
+        denoised = self.denoise(frame, noise_level, method)
+        
+        if self.denoise_budget_ms:
+            self._update_denoise_level((time.perf_counter() - start) * 1000)
+        
+        return denoised
+    
+    def denoise(self, frame: np.ndarray, noise_level: float,
+                method: DenoiseMethod = DenoiseMethod.BILATERAL) -> np.ndarray:
+        """
+        Aplica un método concreto de reducción de ruido.
+        
+        Los métodos de luminancia filtran solo el plano gris y suman la
+        corrección a los tres canales, sin conversión de espacio de color.
+        """
         # Parámetros basados en nivel de ruido
         d = 5 if noise_level < 15 else 7
         sigma_color = min(75, noise_level * 3)
         sigma_space = min(75, noise_level * 3)
         
-        denoised = cv2.bilateralFilter(frame, d, sigma_color, sigma_space)
-        return denoised
+        if method == DenoiseMethod.BILATERAL:
+            # Usar filtro bilateral para preservar bordes
+            return cv2.bilateralFilter(frame, d, sigma_color, sigma_space)
+        
+        h, w = frame.shape[:2]
+        gray = cv2.cvtColor(frame, cv2.COLOR_BGR2GRAY, dst=self._get_buffer("denoise_gray", (h, w)))
+        
+        if method == DenoiseMethod.LUMA:
+            filtered = cv2.bilateralFilter(gray, d, sigma_color, sigma_space,
+                                           dst=self._get_buffer("denoise_filtered", (h, w)))
+        else:
+            filtered = self._guided_filter(gray, d // 2, (2.0 * noise_level) ** 2)
+        
+        # Corrección de luminancia con signo, replicada en B, G y R
+        correction = cv2.subtract(filtered, gray, dst=self._get_buffer("denoise_delta", (h, w), np.int16),
+                                  dtype=cv2.CV_16S)
+        correction3 = cv2.merge([correction, correction, correction],
+                                dst=self._get_buffer("denoise_delta3", frame.shape, np.int16))
+        return cv2.add(frame, correction3, dtype=cv2.CV_8U)
+    
+    def _guided_filter(self, gray: np.ndarray, radius: int, eps: float) -> np.ndarray:
+        """
+        Filtro guiado rápido autoguiado (He et al.): los coeficientes lineales
+        se calculan a media resolución y solo la combinación final es a
+        resolución completa. Coste independiente del radio.
+        """
+        h, w = gray.shape
+        small = cv2.resize(gray, (max(1, w // 2), max(1, h // 2)), interpolation=cv2.INTER_AREA)
+        small = small.astype(np.float32)
+        ksize = (2 * max(1, radius // 2) + 1,) * 2
+        
+        # var = E[I²] - E[I]²; a = var / (var + eps); b = (1 - a) * E[I]
+        mean = cv2.boxFilter(small, -1, ksize)
+        variance = cv2.sqrBoxFilter(small, cv2.CV_32F, ksize) - mean * mean
+        a = variance / (variance + eps)
+        b = mean - a * mean
+        
+        # Promediar coeficientes y cuantizarlos a 8 bits (A en 1/255, B en niveles)
+        # para que la combinación q = A * I + B a resolución completa sea aritmética uint8
+        a8 = cv2.convertScaleAbs(cv2.boxFilter(a, -1, ksize), alpha=255.0)
+        b8 = cv2.convertScaleAbs(cv2.boxFilter(b, -1, ksize))
+        a_full = cv2.resize(a8, (w, h), interpolation=cv2.INTER_LINEAR,
+                            dst=self._get_buffer("guided_a", (h, w)))
+        b_full = cv2.resize(b8, (w, h), interpolation=cv2.INTER_LINEAR,
+                            dst=self._get_buffer("guided_b", (h, w)))
+        result = cv2.multiply(gray, a_full, scale=1.0 / 255.0,
+                              dst=self._get_buffer("denoise_filtered", (h, w)))
+        return cv2.add(result, b_full, dst=result)
+    
+    def _update_denoise_level(self, elapsed_ms: float):
+        """Ajusta el método de reducción de ruido según el presupuesto por frame."""
+        base_level = self._denoise_ladder.index(self.denoise_method)
+        previous = self._denoise_level
+        
+        if elapsed_ms > self.denoise_budget_ms and self._denoise_level < len(self._denoise_ladder) - 1:
+            self._denoise_level += 1
+            self._denoise_fast_streak = 0
+        elif elapsed_ms < self.denoise_budget_ms / 3 and self._denoise_level > base_level:
+            self._denoise_fast_streak += 1
+            if self._denoise_fast_streak >= 30:
+                self._denoise_level -= 1
+                self._denoise_fast_streak = 0
+        else:
+            self._denoise_fast_streak = 0
+        
+        if self._denoise_level != previous:
+            logger.info(f"Reducción de ruido: {self._denoise_ladder[previous].value} -> "
+                        f"{self._denoise_ladder[self._denoise_level].value} "
+                        f"({elapsed_ms:.1f}ms, presupuesto {self.denoise_budget_ms}ms)")
     
     def _enhance_sharpness(self, frame: np.ndarray) -> np.ndarray:
         """Mejora la nitidez del frame."""
@@ -318,9 +664,13 @@ def create_ov5647_preprocessor(config: Optional[Dict[str, Any]] = None) -> Frame
         "auto_brightness": True,
         "auto_contrast": True,
         "denoise": False,  # La OV5647 tiene buena calidad en buena luz
+        "denoise_method": "luma",
+        "denoise_budget_ms": 8.0,  # Degradar a filtro guiado si se excede
         "sharpen": True,
         "color_correction": True,
-        "lens_correction": False  # Activar si tienes calibración
+        "lens_correction": False,  # Activar si tienes calibración
+        "fused_pipeline": False,   # True = ~2x más rápido, salida no idéntica (revalidar umbrales)
+        "analysis_stride": 1       # >1 submuestrea el análisis de calidad
     }
     
     if config:
@@ -351,6 +701,16 @@ if __name__ == "__main__":
     
     print(f"✓ Frame procesado en {duration:.2f}ms")
     
+    # Comparar pipeline fusionado vs secuencial
+    fused = create_ov5647_preprocessor({"fused_pipeline": True})
+    for name, candidate in (("fusionado", fused), ("secuencial", preprocessor)):
+        start = time.time()
+        for _ in range(10):
+            candidate.preprocess(test_frame)
+        print(f"   {name}: {(time.time() - start) * 100:.2f}ms/frame")
+    difference = cv2.absdiff(processed, fused.preprocess(test_frame))
+    print(f"   Diferencia fusionado/secuencial: media {difference.mean():.2f}, máx {difference.max()}")
+    
     # Analizar métricas
     metrics = preprocessor.analyze_frame(processed)
     print(f"📊 Métricas:")
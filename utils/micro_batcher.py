@@ -0,0 +1,368 @@
+# utils/micro_batcher.py
+"""
+Micro-Batching Dinámico con Plazos
+==================================
+
+Agrupa peticiones de inferencia concurrentes en micro-batches para que el
+modelo procese varias imágenes en un solo forward (mejor uso de SIMD e
+hilos que N forwards de una imagen), sin que ningún frame llegue tarde a
+su etiquetadora.
+
+Funcionamiento:
+- Cada petición lleva un plazo absoluto (deadline). Las pendientes se
+  agrupan por clave (parámetros que deben coincidir dentro de un batch,
+  p. ej. imgsz/conf/iou/max_det) y se atienden por plazo más cercano (EDF).
+- Mientras el modelo está ocupado las peticiones se acumulan solas; al
+  quedar libre se despachan todas las compatibles (hasta max_batch_size)
+  sin espera adicional.
+- Con el modelo libre, un batch incompleto solo espera compañeros si la
+  tasa de llegada reciente indica que pueden llegar dentro de la ventana
+  (max_wait_ms) y si la espera no hace tarde al plazo más cercano según la
+  latencia estimada del batch resultante.
+- El tamaño del batch se elige con la latencia estimada por tamaño (media
+  móvil exponencial) para minimizar los frames que terminarían tarde entre
+  este batch y el siguiente: si el plazo más cercano se cumple con un
+  batch pequeño, no se agranda a costa de incumplirlo; en sobrecarga
+  (plazos imposibles) se prefiere el batch grande, que vacía antes la cola.
+- El modelo se ejecuta en un único hilo de trabajo: el event loop sigue
+  recibiendo peticiones durante la inferencia.
+
+Uso:
+    batcher = MicroBatcher(lambda key, images: modelo.predict(images, **dict(key)),
+                           max_batch_size=4, max_wait_ms=5.0)
+    batcher.start()
+    batcher.seed(4, 48.0)         # Perfil del warmup (opcional, por tamaño)
+    result, info = await batcher.submit(key, image, deadline_ms=120)
+    stats = batcher.get_stats()   # throughput/latencia por tamaño de batch
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import asyncio
+import heapq
+import itertools
+import logging
+import time
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, Hashable, List, Optional, Sequence, Tuple
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass(order=True)
+class _PendingRequest:
+    """Petición en cola, ordenada por plazo y orden de llegada."""
+    deadline: float
+    seq: int
+    payload: Any = field(compare=False)
+    future: asyncio.Future = field(compare=False)
+    enqueued: float = field(compare=False)
+
+
+@dataclass
+class BatchInfo:
+    """Datos del batch en el que se procesó una petición."""
+    batch_size: int
+    batch_ms: float       # Duración del forward del batch completo
+    queue_ms: float       # Espera de la petición hasta iniciar el batch
+    late: bool            # Terminó después de su plazo
+
+
+class BatchSizeStats:
+    """Contadores de un tamaño de batch."""
+
+    __slots__ = ("batches", "frames", "batch_ms_total", "queue_ms_total",
+                 "deadline_misses", "ewma_ms")
+
+    def __init__(self):
+        self.batches = 0
+        self.frames = 0
+        self.batch_ms_total = 0.0
+        self.queue_ms_total = 0.0
+        self.deadline_misses = 0
+        self.ewma_ms: Optional[float] = None
+
+    def record(self, size: int, batch_ms: float, queue_ms_sum: float, misses: int, alpha: float):
+        self.batches += 1
+        self.frames += size
+        self.batch_ms_total += batch_ms
+        self.queue_ms_total += queue_ms_sum
+        self.deadline_misses += misses
+        self.ewma_ms = batch_ms if self.ewma_ms is None else self.ewma_ms + alpha * (batch_ms - self.ewma_ms)
+
+    def to_dict(self) -> Dict[str, Any]:
+        batch_ms = self.batch_ms_total / self.batches if self.batches else 0.0
+        return {
+            "batches": self.batches,
+            "frames": self.frames,
+            "avg_batch_ms": round(batch_ms, 2),
+            "avg_frame_ms": round(self.batch_ms_total / self.frames, 2) if self.frames else 0.0,
+            "throughput_fps": round(self.frames * 1000.0 / self.batch_ms_total, 2) if self.batch_ms_total > 0 else 0.0,
+            "avg_queue_ms": round(self.queue_ms_total / self.frames, 2) if self.frames else 0.0,
+            "deadline_misses": self.deadline_misses,
+        }
+
+
+class MicroBatcher:
+    """
+    Planificador de micro-batches con plazos por petición.
+
+    Args:
+        run_batch: Función síncrona (clave, lista de payloads) -> lista de
+                   resultados en el mismo orden; se ejecuta en el hilo de trabajo
+        max_batch_size: Máximo de peticiones por batch
+        max_wait_ms: Espera máxima de un batch incompleto con el modelo libre
+        default_deadline_ms: Plazo de las peticiones que no indican uno
+        ewma_alpha: Peso de la última medición en la latencia estimada
+    """
+
+    def __init__(self, run_batch: Callable[[Hashable, List[Any]], Sequence[Any]],
+                 max_batch_size: int = 4, max_wait_ms: float = 5.0,
+                 default_deadline_ms: float = 150.0, ewma_alpha: float = 0.2):
+        self.run_batch = run_batch
+        self.max_batch_size = max(1, int(max_batch_size))
+        self.max_wait_s = max(0.0, max_wait_ms) / 1000.0
+        self.default_deadline_s = default_deadline_ms / 1000.0
+        self.ewma_alpha = ewma_alpha
+
+        self._pending: Dict[Hashable, List[_PendingRequest]] = {}
+        self._seq = itertools.count()
+        self._wakeup: Optional[asyncio.Event] = None
+        self._task: Optional[asyncio.Task] = None
+        self._executor: Optional[ThreadPoolExecutor] = None
+        self._idle_since = 0.0      # Fin del último batch (la ventana cuenta con el modelo libre)
+
+        # Fracción reciente de llegadas a menos de max_wait_ms de la anterior:
+        # decide si merece la pena esperar compañeros (tráfico en ráfagas)
+        self._last_arrival: Optional[float] = None
+        self._burst_ratio = 0.0
+
+        self.size_stats: Dict[int, BatchSizeStats] = {}
+        self.stats = {
+            "requests": 0,
+            "batches": 0,
+            "deadline_misses": 0,
+            "expired_on_arrival": 0,
+            "waits": 0,
+        }
+
+    # ==================== CICLO DE VIDA ====================
+
+    def start(self):
+        """Arranca el despachador en el event loop actual."""
+        if self._task is not None:
+            return
+        self._wakeup = asyncio.Event()
+        self._executor = ThreadPoolExecutor(max_workers=1, thread_name_prefix="micro_batcher")
+        self._task = asyncio.get_running_loop().create_task(self._dispatch_loop())
+
+    async def stop(self):
+        """Detiene el despachador; las peticiones pendientes reciben CancelledError."""
+        if self._task is not None:
+            self._task.cancel()
+            try:
+                await self._task
+            except asyncio.CancelledError:
+                pass
+            self._task = None
+        for queue in self._pending.values():
+            for request in queue:
+                if not request.future.done():
+                    request.future.cancel()
+        self._pending.clear()
+        if self._executor is not None:
+            self._executor.shutdown(wait=True)
+            self._executor = None
+
+    @property
+    def running(self) -> bool:
+        return self._task is not None
+
+    # ==================== API ====================
+
+    async def submit(self, key: Hashable, payload: Any,
+                     deadline_ms: Optional[float] = None) -> Tuple[Any, BatchInfo]:
+        """
+        Encola una petición y espera su resultado.
+
+        Args:
+            key: Clave de compatibilidad (solo se agrupan peticiones con la misma)
+            payload: Entrada para run_batch
+            deadline_ms: Plazo relativo a ahora (None = default_deadline_ms)
+
+        Returns:
+            (resultado, BatchInfo)
+        """
+        if self._task is None:
+            raise RuntimeError("MicroBatcher no iniciado")
+
+        loop = asyncio.get_running_loop()
+        now = time.perf_counter()
+        budget = self.default_deadline_s if deadline_ms is None else max(0.0, deadline_ms / 1000.0)
+        if budget <= 0.0:
+            self.stats["expired_on_arrival"] += 1
+
+        if self._last_arrival is not None:
+            in_burst = 1.0 if now - self._last_arrival <= self.max_wait_s else 0.0
+            self._burst_ratio += 0.1 * (in_burst - self._burst_ratio)
+        self._last_arrival = now
+
+        request = _PendingRequest(now + budget, next(self._seq), payload, loop.create_future(), now)
+        heapq.heappush(self._pending.setdefault(key, []), request)
+        self.stats["requests"] += 1
+        self._wakeup.set()
+        return await request.future
+
+    def seed(self, size: int, batch_ms: float):
+        """
+        Latencia inicial de un tamaño de batch (perfil medido en el warmup).
+        Sin ella la estimación se extrapola linealmente, lo que nunca
+        favorece esperar compañeros para un tamaño aún no observado.
+        """
+        stats = self.size_stats.setdefault(size, BatchSizeStats())
+        stats.ewma_ms = batch_ms
+
+    def estimate_batch_ms(self, size: int) -> Optional[float]:
+        """Latencia estimada de un batch; sin medición propia, escala linealmente la del mayor tamaño medido inferior."""
+        stats = self.size_stats.get(size)
+        if stats is not None and stats.ewma_ms is not None:
+            return stats.ewma_ms
+        known = [s for s, st in self.size_stats.items() if st.ewma_ms is not None]
+        if not known:
+            return None
+        smaller = [s for s in known if s < size]
+        base = max(smaller) if smaller else min(known)
+        return self.size_stats[base].ewma_ms * size / base
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Contadores globales y de throughput/latencia por tamaño de batch."""
+        frames = sum(st.frames for st in self.size_stats.values())
+        return {
+            **self.stats,
+            "max_batch_size": self.max_batch_size,
+            "max_wait_ms": self.max_wait_s * 1000.0,
+            "default_deadline_ms": self.default_deadline_s * 1000.0,
+            "avg_batch_size": round(frames / self.stats["batches"], 2) if self.stats["batches"] else 0.0,
+            "queue_depth": sum(len(queue) for queue in self._pending.values()),
+            "by_batch_size": {str(size): self.size_stats[size].to_dict() for size in sorted(self.size_stats)},
+        }
+
+    # ==================== DESPACHO ====================
+
+    def _next_group(self) -> Optional[Hashable]:
+        """Clave cuyo primer plazo es el más cercano (EDF entre grupos)."""
+        best_key, best_deadline = None, None
+        for key, queue in self._pending.items():
+            while queue and queue[0].future.done():
+                heapq.heappop(queue)     # Cancelada (cliente desconectado)
+            if queue and (best_deadline is None or queue[0].deadline < best_deadline):
+                best_key, best_deadline = key, queue[0].deadline
+        return best_key
+
+    def _batch_limit(self, queue: List[_PendingRequest], now: float) -> int:
+        """
+        Tamaño del próximo batch: el que minimiza los plazos incumplidos
+        previstos entre este batch y el siguiente (empate: el mayor).
+        """
+        available = min(len(queue), self.max_batch_size)
+        if available <= 1 or self.estimate_batch_ms(1) is None:
+            return available
+        # heapq garantiza solo queue[0]; los candidatos se ordenan por plazo
+        candidates = heapq.nsmallest(min(len(queue), 2 * self.max_batch_size), queue)
+        deadlines = [request.deadline for request in candidates]
+
+        best_size, best_misses = available, None
+        for size in range(available, 0, -1):
+            end = now + self.estimate_batch_ms(size) / 1000.0
+            misses = sum(1 for d in deadlines[:size] if d < end)
+            rest = min(len(deadlines) - size, self.max_batch_size)
+            if rest > 0:
+                rest_end = end + self.estimate_batch_ms(rest) / 1000.0
+                misses += sum(1 for d in deadlines[size:size + rest] if d < rest_end)
+            if best_misses is None or misses < best_misses:
+                best_size, best_misses = size, misses
+        return best_size
+
+    def _wait_budget(self, queue: List[_PendingRequest], now: float) -> float:
+        """Segundos que un batch incompleto puede esperar compañeros (0 = despachar ya)."""
+        if self.max_wait_s <= 0.0 or len(queue) >= self.max_batch_size:
+            return 0.0
+        # Sin ráfagas recientes no llegarán compañeros dentro de la ventana; esperar
+        # en vano cuesta como mucho max_wait_ms, así que basta una llegada de cada cuatro
+        if self._burst_ratio < 0.25:
+            return 0.0
+        oldest = min(request.enqueued for request in queue)
+        window = max(oldest, self._idle_since) + self.max_wait_s - now
+        estimate = self.estimate_batch_ms(len(queue) + 1)
+        slack = queue[0].deadline - now - (estimate / 1000.0 if estimate is not None else 0.0)
+        return max(0.0, min(window, slack))
+
+    async def _dispatch_loop(self):
+        loop = asyncio.get_running_loop()
+        while True:
+            key = self._next_group()
+            if key is None:
+                self._wakeup.clear()
+                await self._wakeup.wait()
+                continue
+
+            queue = self._pending[key]
+            wait = self._wait_budget(queue, time.perf_counter())
+            if wait > 0.0:
+                self.stats["waits"] += 1
+                self._wakeup.clear()
+                try:
+                    await asyncio.wait_for(self._wakeup.wait(), timeout=wait)
+                except asyncio.TimeoutError:
+                    pass
+                # Reevaluar con las llegadas nuevas (otro grupo puede ser ahora más urgente)
+                if self._wait_budget(self._pending.get(key, []), time.perf_counter()) > 0.0:
+                    continue
+
+            queue = self._pending.get(key, [])
+            while queue and queue[0].future.done():
+                heapq.heappop(queue)
+            if not queue:
+                continue
+            start = time.perf_counter()
+            size = self._batch_limit(queue, start)
+            batch = [heapq.heappop(queue) for _ in range(size)]
+            if not queue:
+                del self._pending[key]
+
+            try:
+                results = await loop.run_in_executor(self._executor, self.run_batch, key,
+                                                     [request.payload for request in batch])
+                if len(results) != len(batch):
+                    raise RuntimeError(f"run_batch devolvió {len(results)} resultados para {len(batch)} entradas")
+            except asyncio.CancelledError:
+                for request in batch:
+                    if not request.future.done():
+                        request.future.cancel()
+                raise
+            except Exception as e:
+                for request in batch:
+                    if not request.future.done():
+                        request.future.set_exception(e)
+                continue
+
+            end = time.perf_counter()
+            self._idle_since = end
+            batch_ms = (end - start) * 1000.0
+            misses = sum(1 for request in batch if end > request.deadline)
+            queue_ms_sum = sum((start - request.enqueued) * 1000.0 for request in batch)
+            self.size_stats.setdefault(size, BatchSizeStats()).record(
+                size, batch_ms, queue_ms_sum, misses, self.ewma_alpha)
+            self.stats["batches"] += 1
+            self.stats["deadline_misses"] += misses
+
+            for request, result in zip(batch, results):
+                if not request.future.done():
+                    request.future.set_result((result, BatchInfo(
+                        batch_size=size,
+                        batch_ms=batch_ms,
+                        queue_ms=(start - request.enqueued) * 1000.0,
+                        late=end > request.deadline,
+                    )))
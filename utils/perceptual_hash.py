@@ -0,0 +1,174 @@
+# utils/perceptual_hash.py
+"""
+Hash Perceptual de Frames y Caché Tolerante
+===========================================
+
+Detección de frames casi idénticos (banda detenida o vacía) para reutilizar
+resultados de inferencia. Un MD5 sobre los píxeles cambia con cualquier
+ruido del sensor; el dHash compara gradientes de luminancia sobre una
+miniatura de 17x16 celdas, de modo que el ruido se promedia dentro de cada
+celda y dos frames de la misma escena dan el mismo hash o uno muy cercano.
+
+Detalles:
+- La miniatura se obtiene en dos pasos (muestreo lineal a 8x la miniatura y
+  promedio INTER_AREA) para no recorrer el frame completo; la luminancia se
+  calcula sobre las celdas, no sobre el frame.
+- Los gradientes dentro de una zona muerta (|diferencia| < margin) no tienen
+  signo fiable: en escenas planas (banda vacía) es aleatorio. Dos signos
+  opuestos cuentan en la distancia si ambos son fiables; un borde marcado
+  (|diferencia| >= strong_margin) cuenta si en el otro hash esa posición es
+  plana. Así una fruta que se desplaza (su borde aparece sobre banda vacía
+  y desaparece de donde estaba) aleja los hashes aunque la zona que deja y
+  la que ocupa sean planas en uno de los dos frames.
+- El dHash es invariante al brillo y al color; la miniatura BGR se compara
+  aparte (máxima diferencia por celda) para no confundir frutas de forma
+  similar y distinto color.
+
+Uso:
+    cache = PerceptualHashCache(max_entries=64, max_distance=4)
+    phash = PerceptualHash.compute(frame)
+    result = cache.get(phash, context=(imgsz, conf))
+    if result is None:
+        result = inferir(frame)
+        cache.put(phash, result, context=(imgsz, conf))
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import time
+import threading
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import Any, Hashable, Optional, Tuple
+
+import cv2
+import numpy as np
+
+HASH_SIZE = 16
+_SAMPLING_FACTOR = 8   # muestras por celda y eje antes del promedio
+
+
+@dataclass(frozen=True, eq=False)
+class PerceptualHash:
+    """dHash de HASH_SIZE^2 bits con máscaras de bits fiables/bordes y miniatura BGR."""
+    bits: int
+    mask: int
+    strong: int
+    thumb: np.ndarray
+
+    @classmethod
+    def compute(cls, image: np.ndarray, margin: int = 2, strong_margin: int = 8) -> "PerceptualHash":
+        """
+        Calcula el hash de un frame BGR o en escala de grises.
+
+        Args:
+            image: Frame uint8 (H, W, 3) o (H, W)
+            margin: Diferencia mínima de luminancia para considerar un bit fiable
+            strong_margin: Diferencia mínima para considerar la posición un borde
+        """
+        size = (HASH_SIZE + 1, HASH_SIZE)
+        h, w = image.shape[:2]
+        sampled = (size[0] * _SAMPLING_FACTOR, size[1] * _SAMPLING_FACTOR)
+        if w > sampled[0] and h > sampled[1]:
+            image = cv2.resize(image, sampled, interpolation=cv2.INTER_LINEAR)
+        thumb = cv2.resize(image, size, interpolation=cv2.INTER_AREA)
+        luma = cv2.cvtColor(thumb, cv2.COLOR_BGR2GRAY) if thumb.ndim == 3 else thumb
+
+        diff = luma[:, 1:].astype(np.int16) - luma[:, :-1]
+        bits = int.from_bytes(np.packbits(diff > 0).tobytes(), "big")
+        magnitude = np.abs(diff)
+        mask = int.from_bytes(np.packbits(magnitude >= margin).tobytes(), "big")
+        strong = int.from_bytes(np.packbits(magnitude >= max(margin, strong_margin)).tobytes(), "big")
+        return cls(bits, mask, strong, thumb)
+
+    def distance(self, other: "PerceptualHash") -> int:
+        """
+        Distancia de Hamming: signos opuestos fiables en ambos hashes más
+        bordes de uno que en el otro son zona plana.
+        """
+        differing = ((self.bits ^ other.bits) & self.mask & other.mask) \
+            | (self.strong & ~other.mask) | (other.strong & ~self.mask)
+        return bin(differing).count("1")
+
+    def color_delta(self, other: "PerceptualHash") -> int:
+        """Máxima diferencia entre celdas homólogas de las miniaturas."""
+        if self.thumb.shape != other.thumb.shape:
+            return 255
+        return int(cv2.norm(self.thumb, other.thumb, cv2.NORM_INF))
+
+    def hex(self) -> str:
+        return f"{self.bits:0{HASH_SIZE * HASH_SIZE // 4}x}"
+
+
+class PerceptualHashCache:
+    """
+    Caché LRU acotada que resuelve por distancia de Hamming.
+
+    La búsqueda recorre las entradas de la más reciente a la más antigua, así
+    que con la banda detenida el acierto es la primera comparación.
+    """
+
+    def __init__(self, max_entries: int = 64, max_distance: int = 4,
+                 max_color_delta: int = 12, ttl_s: Optional[float] = None):
+        self.max_entries = max(1, int(max_entries))
+        self.max_distance = int(max_distance)
+        self.max_color_delta = int(max_color_delta)
+        self.ttl_s = ttl_s
+        self.hits = 0
+        self.misses = 0
+
+        self._entries: "OrderedDict[int, Tuple[PerceptualHash, Hashable, Any, float]]" = OrderedDict()
+        self._next_id = 0
+        self._lock = threading.Lock()
+
+    def __len__(self) -> int:
+        return len(self._entries)
+
+    def get(self, phash: PerceptualHash, context: Hashable = None) -> Optional[Any]:
+        """Devuelve el valor de la entrada más reciente compatible, o None."""
+        now = time.monotonic()
+        with self._lock:
+            expired = []
+            found = None
+            for entry_id in reversed(self._entries):
+                stored, stored_context, value, created = self._entries[entry_id]
+                if self.ttl_s is not None and now - created > self.ttl_s:
+                    expired.append(entry_id)
+                    continue
+                if (stored_context == context
+                        and stored.distance(phash) <= self.max_distance
+                        and stored.color_delta(phash) <= self.max_color_delta):
+                    found = entry_id
+                    break
+
+            for entry_id in expired:
+                del self._entries[entry_id]
+
+            if found is None:
+                self.misses += 1
+                return None
+            self._entries.move_to_end(found)
+            self.hits += 1
+            return self._entries[found][2]
+
+    def put(self, phash: PerceptualHash, value: Any, context: Hashable = None):
+        """Inserta un resultado, desalojando el menos usado si está llena."""
+        with self._lock:
+            self._entries[self._next_id] = (phash, context, value, time.monotonic())
+            self._next_id += 1
+            while len(self._entries) > self.max_entries:
+                self._entries.popitem(last=False)
+
+    def clear(self):
+        with self._lock:
+            self._entries.clear()
+
+    def get_stats(self) -> dict:
+        total = self.hits + self.misses
+        return {
+            "entries": len(self._entries),
+            "hits": self.hits,
+            "misses": self.misses,
+            "hit_rate": self.hits / total if total else 0.0,
+        }
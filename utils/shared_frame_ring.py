@@ -0,0 +1,220 @@
+# utils/shared_frame_ring.py
+"""
+Anillo de Frames en Memoria Compartida
+======================================
+
+Transporte local de frames entre la captura y el servidor de inferencia
+cuando ambos corren en la misma máquina. Evita JPEG, HTTP con la imagen y
+cv2.imdecode: el productor copia el frame BGR a un slot y solo envía por
+HTTP la referencia (anillo, slot, secuencia).
+
+Formato del segmento:
+- Cabecera: magic, número de slots, bytes por slot, último número de secuencia
+- Slots: cabecera (secuencia tipo seqlock, alto, ancho, canales, bytes) + datos
+
+Cada slot usa un seqlock: el productor marca la secuencia como impar mientras
+escribe y la deja en 2*seq al terminar. El consumidor lee una vista sin copia
+y vuelve a validar la secuencia al terminar; si el slot fue sobrescrito
+entretanto, el resultado se descarta.
+
+Uso:
+    ring = SharedFrameRing.create(slot_count=8, slot_bytes=640 * 640 * 3)
+    slot, seq = ring.write(frame)              # productor
+
+    ring = SharedFrameRing.attach(ring_name)   # consumidor
+    ring.acquire()
+    try:
+        view = ring.read(slot, seq)
+        ...
+        if not ring.is_valid(slot, seq): descartar
+    finally:
+        ring.release()                         # un close() pendiente se completa aquí
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import os
+import struct
+import logging
+from typing import Optional, Tuple
+
+import numpy as np
+
+try:
+    from multiprocessing import shared_memory, resource_tracker
+    SHARED_MEMORY_AVAILABLE = True
+except ImportError:
+    SHARED_MEMORY_AVAILABLE = False
+
+logger = logging.getLogger(__name__)
+
+RING_MAGIC = b"VFRING01"
+RING_NAME_PREFIX = "visifruit_ring_"
+
+_HEADER = struct.Struct("<8sIIQ")          # magic, slots, bytes por slot, última secuencia
+_SLOT_HEADER = struct.Struct("<QIIIQ")     # seqlock, alto, ancho, canales, bytes
+_HEADER_SIZE = 64
+_SLOT_HEADER_SIZE = 64                     # datos alineados a línea de caché
+
+
+class SharedFrameRing:
+    """Anillo de slots de tamaño fijo en memoria compartida (un productor)."""
+
+    def __init__(self, shm, owner: bool):
+        self._shm = shm
+        self.owner = owner
+        self.name = shm.name
+
+        magic, self.slot_count, self.slot_bytes, _ = _HEADER.unpack_from(shm.buf, 0)
+        if magic != RING_MAGIC:
+            raise ValueError(f"Segmento {shm.name} no es un anillo de frames VisiFruit")
+
+        self._slot_stride = _SLOT_HEADER_SIZE + self.slot_bytes
+        self._next_seq = _HEADER.unpack_from(shm.buf, 0)[3] + 1
+
+        # Peticiones que están leyendo el anillo: close() espera a que terminen
+        self._users = 0
+        self._close_pending = False
+        self._unlinked = False
+
+    @classmethod
+    def create(cls, slot_count: int = 8, slot_bytes: int = 640 * 640 * 3,
+               name: Optional[str] = None) -> "SharedFrameRing":
+        """Crea un anillo nuevo; el creador lo elimina al cerrarlo."""
+        if not SHARED_MEMORY_AVAILABLE:
+            raise RuntimeError("multiprocessing.shared_memory no disponible")
+
+        slot_bytes = (slot_bytes + 63) // 64 * 64
+        size = _HEADER_SIZE + slot_count * (_SLOT_HEADER_SIZE + slot_bytes)
+        name = name or f"{RING_NAME_PREFIX}{os.getpid()}_{os.urandom(3).hex()}"
+        shm = shared_memory.SharedMemory(name=name, create=True, size=size)
+
+        _HEADER.pack_into(shm.buf, 0, RING_MAGIC, slot_count, slot_bytes, 0)
+        for slot in range(slot_count):
+            _SLOT_HEADER.pack_into(shm.buf, _HEADER_SIZE + slot * (_SLOT_HEADER_SIZE + slot_bytes),
+                                   0, 0, 0, 0, 0)
+
+        logger.info(f"🧠 Anillo de frames creado: {name} ({slot_count} slots x {slot_bytes / 1e6:.1f} MB)")
+        return cls(shm, owner=True)
+
+    @classmethod
+    def attach(cls, name: str) -> "SharedFrameRing":
+        """Abre un anillo existente como consumidor."""
+        if not SHARED_MEMORY_AVAILABLE:
+            raise RuntimeError("multiprocessing.shared_memory no disponible")
+        if not name.startswith(RING_NAME_PREFIX):
+            raise ValueError(f"Nombre de anillo no permitido: {name}")
+
+        shm = shared_memory.SharedMemory(name=name, create=False)
+        # El consumidor no es dueño: evitar que el resource_tracker lo elimine al salir
+        try:
+            resource_tracker.unregister(shm._name, "shared_memory")  # type: ignore[attr-defined]
+        except Exception:
+            pass
+        return cls(shm, owner=False)
+
+    @property
+    def closed(self) -> bool:
+        return self._shm is None or self._close_pending
+
+    def acquire(self) -> "SharedFrameRing":
+        """Marca el anillo en uso por una petición (llamar a release() al terminar)."""
+        if self.closed:
+            raise ValueError(f"Anillo {self.name} cerrado")
+        self._users += 1
+        return self
+
+    def release(self):
+        """Libera el uso; si se pidió close() entretanto, lo completa el último usuario."""
+        self._users = max(0, self._users - 1)
+        if self._close_pending and self._users == 0:
+            self.close()
+
+    def _slot_offset(self, slot: int) -> int:
+        return _HEADER_SIZE + slot * self._slot_stride
+
+    def fits(self, frame: np.ndarray) -> bool:
+        """Indica si el frame cabe en un slot."""
+        return frame.dtype == np.uint8 and frame.nbytes <= self.slot_bytes
+
+    def write(self, frame: np.ndarray) -> Tuple[int, int]:
+        """
+        Copia un frame uint8 al siguiente slot.
+
+        Returns:
+            (slot, secuencia) para referenciar el frame
+        """
+        if not self.fits(frame):
+            raise ValueError(f"Frame de {frame.nbytes} bytes no cabe en slot de {self.slot_bytes}")
+
+        seq = self._next_seq
+        self._next_seq += 1
+        slot = seq % self.slot_count
+        offset = self._slot_offset(slot)
+        buf = self._shm.buf
+
+        height, width = frame.shape[:2]
+        channels = frame.shape[2] if frame.ndim == 3 else 1
+
+        # Seqlock: impar mientras se escribe
+        struct.pack_into("<Q", buf, offset, 2 * seq + 1)
+        data = np.ndarray(frame.shape, dtype=np.uint8, buffer=buf,
+                          offset=offset + _SLOT_HEADER_SIZE)
+        np.copyto(data, frame)
+        _SLOT_HEADER.pack_into(buf, offset, 2 * seq, height, width, channels, frame.nbytes)
+        struct.pack_into("<Q", buf, 16, seq)
+
+        return slot, seq
+
+    def read(self, slot: int, seq: int) -> Optional[np.ndarray]:
+        """Vista sin copia del frame (None si el slot ya no contiene esa secuencia)."""
+        if self._shm is None or not 0 <= slot < self.slot_count:
+            return None
+
+        offset = self._slot_offset(slot)
+        marker, height, width, channels, nbytes = _SLOT_HEADER.unpack_from(self._shm.buf, offset)
+        if marker != 2 * seq or nbytes != height * width * channels or nbytes > self.slot_bytes:
+            return None
+
+        shape = (height, width, channels) if channels > 1 else (height, width)
+        view = np.ndarray(shape, dtype=np.uint8, buffer=self._shm.buf,
+                          offset=offset + _SLOT_HEADER_SIZE)
+        view.flags.writeable = False
+        return view
+
+    def is_valid(self, slot: int, seq: int) -> bool:
+        """Comprueba que el slot sigue conteniendo la secuencia indicada."""
+        if self._shm is None or not 0 <= slot < self.slot_count:
+            return False
+        return struct.unpack_from("<Q", self._shm.buf, self._slot_offset(slot))[0] == 2 * seq
+
+    def close(self):
+        """
+        Libera el mapeo (y elimina el segmento si este proceso lo creó).
+
+        Con peticiones en curso el cierre se aplaza hasta el último release()
+        (las vistas de read() no impiden desmapear el segmento). Si el buffer
+        aún tiene exportaciones (BufferError), el mapeo se conserva y se
+        reintenta en el siguiente close()/release().
+        """
+        if self._shm is None:
+            return
+        self._close_pending = True
+        if self._users > 0:
+            return
+
+        # El nombre se elimina siempre: los procesos que lo tengan mapeado siguen leyendo
+        if self.owner and not self._unlinked:
+            try:
+                self._shm.unlink()
+            except FileNotFoundError:
+                pass
+            self._unlinked = True
+
+        try:
+            self._shm.close()
+        except BufferError:
+            logger.warning(f"⚠️ Anillo {self.name} con vistas vivas; se cerrará más tarde")
+            return
+        self._shm = None
@@ -0,0 +1,401 @@
+# utils/stream_compositor.py
+"""
+Compositor de Frames Anotados para el Stream MJPEG
+==================================================
+
+Dibuja las detecciones sobre el frame y lo codifica a JPEG para /stream,
+con el menor coste posible para la ruta de inferencia:
+
+- Solo trabaja si hay alguien mirando (suscriptores de /stream) o si hay
+  que guardar el frame en disco; sin dashboard abierto el coste es nulo.
+- Como mucho max_fps frames por segundo (ningún cliente recibe más) y
+  solo el último pendiente: si llegan frames mientras se codifica el
+  anterior, los intermedios se descartan.
+- Un solo render y una sola codificación por frame, compartidos por
+  todos los suscriptores.
+- Las etiquetas ("apple 0.87", la línea de FPS) se rasterizan una vez y
+  se guardan en caché (LRU) como sprites con máscara; cada frame solo
+  copia sus píxeles en el lienzo en lugar de volver a dibujar el texto.
+- El lienzo se reutiliza entre frames: la copia del frame y el cambio de
+  orden de canales para el navegador son una sola pasada.
+- El dibujo y el JPEG se hacen en un hilo de trabajo, fuera del event loop.
+
+Uso:
+    compositor = StreamCompositor(max_fps=10, jpeg_quality=70)
+    compositor.start()
+    compositor.submit(frame_bgr, detections, fps)     # desde infer(), no bloquea
+    with compositor.subscribe():                      # en el generador de /stream
+        await compositor.wait_frame(last_id, timeout_s)
+        last_id, jpeg = compositor.frame_id, compositor.latest_jpeg
+
+Autor(es): Gabriel Calderón, Elias Bautista, Cristian Hernandez
+Fecha: Octubre 2025
+"""
+
+import asyncio
+import logging
+import time
+from collections import OrderedDict
+from concurrent.futures import ThreadPoolExecutor
+from contextlib import contextmanager
+from dataclasses import dataclass
+from typing import Any, Callable, Dict, List, Optional, Sequence, Tuple
+
+import cv2
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+# Colores por clase (formato BGR para OpenCV)
+CLASS_COLORS = {
+    "apple": (0, 255, 0),         # Verde
+    "pear": (255, 0, 0),          # Azul
+    "lemon": (0, 255, 255),       # Amarillo
+    "unknown": (128, 128, 128),   # Gris
+}
+DEFAULT_COLOR = (255, 255, 255)
+
+FONT = cv2.FONT_HERSHEY_SIMPLEX
+LABEL_SCALE, LABEL_THICKNESS = 0.5, 1
+INFO_SCALE, INFO_THICKNESS = 0.7, 2
+INFO_ORIGIN = (10, 30)
+INFO_COLOR = (0, 255, 0)
+
+
+@dataclass
+class Sprite:
+    """
+    Texto rasterizado: color, cobertura (alfa 0-255) y posición del ancla
+    dentro del sprite. Con el trazo por defecto de OpenCV 4 (LINE_8) la
+    cobertura es 0/255 y el pegado es una copia con máscara; con texto
+    suavizado se mezcla con el fondo.
+    """
+    pixels: np.ndarray
+    alpha: np.ndarray
+    anchor_x: int
+    anchor_y: int
+    mask: Optional[np.ndarray] = None         # Solo si la cobertura es binaria
+    premultiplied: Optional[np.ndarray] = None
+    inverse_alpha: Optional[np.ndarray] = None
+
+    def __post_init__(self):
+        if np.isin(self.alpha, (0, 255)).all():
+            self.mask = self.alpha > 0
+        else:
+            alpha = self.alpha[:, :, None].astype(np.uint16)
+            self.premultiplied = self.pixels * alpha + 127
+            self.inverse_alpha = 255 - alpha
+
+
+def blit(canvas: np.ndarray, sprite: Sprite, x: int, y: int):
+    """Pega el sprite con su ancla en (x, y), recortando al lienzo."""
+    left, top = x - sprite.anchor_x, y - sprite.anchor_y
+    height, width = sprite.alpha.shape
+    x0, y0 = max(left, 0), max(top, 0)
+    x1, y1 = min(left + width, canvas.shape[1]), min(top + height, canvas.shape[0])
+    if x0 >= x1 or y0 >= y1:
+        return
+    src = (slice(y0 - top, y1 - top), slice(x0 - left, x1 - left))
+    region = canvas[y0:y1, x0:x1]
+    if sprite.mask is not None:
+        np.copyto(region, sprite.pixels[src], where=sprite.mask[src][:, :, None])
+    else:
+        region[:] = (region * sprite.inverse_alpha[src] + sprite.premultiplied[src]) // 255
+
+
+class LabelGlyphCache:
+    """Sprites de texto rasterizados una sola vez (LRU por texto, color y estilo)."""
+
+    def __init__(self, max_entries: int = 512):
+        self.max_entries = max_entries
+        self._sprites: "OrderedDict[Tuple, Sprite]" = OrderedDict()
+        self.hits = 0
+        self.misses = 0
+
+    def label(self, text: str, color: Tuple[int, int, int]) -> Sprite:
+        """Etiqueta de caja: fondo del color de la clase y texto negro; ancla en la esquina (x1, y1)."""
+        return self._get(("label", text, color), lambda: self._rasterize_label(text, color))
+
+    def overlay(self, text: str, color: Tuple[int, int, int]) -> Sprite:
+        """Texto sin fondo (línea de FPS); ancla en el origen de cv2.putText."""
+        return self._get(("overlay", text, color), lambda: self._rasterize_overlay(text, color))
+
+    def _get(self, key: Tuple, build: Callable[[], Sprite]) -> Sprite:
+        sprite = self._sprites.get(key)
+        if sprite is not None:
+            self._sprites.move_to_end(key)
+            self.hits += 1
+            return sprite
+        self.misses += 1
+        sprite = build()
+        self._sprites[key] = sprite
+        if len(self._sprites) > self.max_entries:
+            self._sprites.popitem(last=False)
+        return sprite
+
+    @staticmethod
+    def _rasterize_label(text: str, color: Tuple[int, int, int]) -> Sprite:
+        (w, h), baseline = cv2.getTextSize(text, FONT, LABEL_SCALE, LABEL_THICKNESS)
+        margin = LABEL_THICKNESS + 2
+        # Fondo de (x1, y1-h-4) a (x1+w, y1); el texto puede salirse por abajo (descendentes)
+        pixels = np.zeros((h + 4 + baseline + 2 * margin + 1, w + 2 * margin + 1, 3), np.uint8)
+        alpha = np.zeros(pixels.shape[:2], np.uint8)
+        coverage = np.zeros_like(alpha)
+        ax, ay = margin, margin + h + 4
+        cv2.rectangle(pixels, (ax, ay - h - 4), (ax + w, ay), color, -1)
+        cv2.rectangle(alpha, (ax, ay - h - 4), (ax + w, ay), 255, -1)
+        cv2.putText(pixels, text, (ax, ay - 2), FONT, LABEL_SCALE, (0, 0, 0), LABEL_THICKNESS)
+        cv2.putText(coverage, text, (ax, ay - 2), FONT, LABEL_SCALE, 255, LABEL_THICKNESS)
+        return Sprite(pixels, np.maximum(alpha, coverage), ax, ay)
+
+    @staticmethod
+    def _rasterize_overlay(text: str, color: Tuple[int, int, int]) -> Sprite:
+        (w, h), baseline = cv2.getTextSize(text, FONT, INFO_SCALE, INFO_THICKNESS)
+        margin = INFO_THICKNESS + 2
+        alpha = np.zeros((h + baseline + 2 * margin + 1, w + 2 * margin + 1), np.uint8)
+        ax, ay = margin, margin + h
+        cv2.putText(alpha, text, (ax, ay), FONT, INFO_SCALE, 255, INFO_THICKNESS)
+        pixels = np.empty(alpha.shape + (3,), np.uint8)
+        pixels[:] = color
+        return Sprite(pixels, alpha, ax, ay)
+
+
+@dataclass
+class _RenderJob:
+    frame: np.ndarray
+    boxes: List[Tuple[int, int, int, int, str, float]]
+    info_text: str
+    publish: bool           # Para /stream (hay suscriptores)
+    save: bool              # Para save_callback
+
+
+class StreamCompositor:
+    """
+    Render y codificación únicos del frame anotado para todos los clientes
+    de /stream.
+
+    Args:
+        max_fps: Frames renderizados por segundo como máximo (0 = sin límite)
+        jpeg_quality: Calidad JPEG del stream
+        swap_channels: Invertir el orden de canales antes de codificar
+            (el stream se ha servido siempre así para los navegadores)
+        save_callback: Recibe (frame anotado BGR, nº de detecciones) de los
+            frames con detecciones; se llama en el hilo de trabajo
+        class_colors: Colores BGR por nombre de clase
+    """
+
+    def __init__(self, max_fps: float = 10.0, jpeg_quality: int = 70, swap_channels: bool = True,
+                 save_callback: Optional[Callable[[np.ndarray, int], None]] = None,
+                 class_colors: Optional[Dict[str, Tuple[int, int, int]]] = None):
+        self.min_interval_s = 1.0 / max_fps if max_fps > 0 else 0.0
+        self.jpeg_quality = int(jpeg_quality)
+        self.swap_channels = swap_channels
+        self.save_callback = save_callback
+        self.class_colors = dict(class_colors or CLASS_COLORS)
+        self.glyphs = LabelGlyphCache()
+
+        # Último JPEG publicado; /stream espera con wait_frame a que cambie frame_id
+        self.latest_jpeg: Optional[bytes] = None
+        self.frame_id = 0
+        self._next_frame: Optional[asyncio.Future] = None
+
+        self._subscribers = 0
+        self._pending: Optional[_RenderJob] = None
+        self._wakeup: Optional[asyncio.Event] = None
+        self._task: Optional[asyncio.Task] = None
+        self._executor: Optional[ThreadPoolExecutor] = None
+        self._last_publish_submit = 0.0
+        self._canvas: Optional[np.ndarray] = None     # Solo lo toca el hilo de trabajo
+
+        self.stats = {
+            "submitted": 0,
+            "skipped_idle": 0,
+            "skipped_rate": 0,
+            "dropped": 0,
+            "rendered": 0,
+            "saved": 0,
+            "render_ms_total": 0.0,
+        }
+
+    # ==================== CICLO DE VIDA ====================
+
+    def start(self):
+        """Arranca el hilo de render en el event loop actual."""
+        if self._task is not None:
+            return
+        self._wakeup = asyncio.Event()
+        self._executor = ThreadPoolExecutor(max_workers=1, thread_name_prefix="stream_compositor")
+        self._task = asyncio.get_running_loop().create_task(self._render_loop())
+
+    async def stop(self):
+        """Detiene el render; el frame pendiente se descarta."""
+        if self._task is not None:
+            self._task.cancel()
+            try:
+                await self._task
+            except asyncio.CancelledError:
+                pass
+            self._task = None
+        self._pending = None
+        if self._executor is not None:
+            self._executor.shutdown(wait=True)
+            self._executor = None
+
+    # ==================== SUSCRIPTORES ====================
+
+    @contextmanager
+    def subscribe(self):
+        """Registra un cliente de /stream mientras dure el bloque."""
+        self._subscribers += 1
+        try:
+            yield self
+        finally:
+            self._subscribers -= 1
+
+    @property
+    def subscribers(self) -> int:
+        return self._subscribers
+
+    # ==================== API ====================
+
+    def submit(self, frame: np.ndarray, detections: Sequence[Any], fps: float) -> bool:
+        """
+        Ofrece un frame recién inferido. No bloquea: solo decide si hay que
+        renderizarlo y lo deja como pendiente para el hilo de trabajo.
+
+        Args:
+            frame: Imagen BGR (o gris) sobre la que se infirió
+            detections: Objetos con bbox [x1, y1, x2, y2], class_name y confidence
+            fps: FPS actuales para la línea de información
+
+        Returns:
+            True si el frame se encoló para render
+        """
+        if self._task is None:
+            return False
+        now = time.perf_counter()
+        publish = self._subscribers > 0
+        if publish and self.min_interval_s > 0 and now - self._last_publish_submit < self.min_interval_s:
+            publish = False
+            if not (self.save_callback is not None and len(detections) > 0):
+                self.stats["skipped_rate"] += 1
+                return False
+        save = self.save_callback is not None and len(detections) > 0
+        if not publish and not save:
+            self.stats["skipped_idle"] += 1
+            return False
+
+        if publish:
+            self._last_publish_submit = now
+        # Vistas de solo lectura (slot de memoria compartida): el productor
+        # puede reutilizar el slot antes de que llegue el render
+        if not frame.flags.writeable:
+            frame = frame.copy()
+        if self._pending is not None:
+            self.stats["dropped"] += 1
+        self._pending = _RenderJob(
+            frame=frame,
+            boxes=[(*map(int, det.bbox[:4]), det.class_name, float(det.confidence)) for det in detections],
+            info_text=f"FPS: {fps:.1f} | Detecciones: {len(detections)}",
+            publish=publish,
+            save=save,
+        )
+        self.stats["submitted"] += 1
+        self._wakeup.set()
+        return True
+
+    def publish(self, jpeg: bytes):
+        """Publica un JPEG ya codificado (placeholder inicial) y avisa a los clientes."""
+        self.latest_jpeg = jpeg
+        self.frame_id += 1
+        if self._next_frame is not None and not self._next_frame.done():
+            self._next_frame.set_result(self.frame_id)
+
+    async def wait_frame(self, last_frame_id: int, timeout_s: float):
+        """
+        Espera a que se publique un frame posterior a last_frame_id (o a que
+        pase timeout_s). Todos los clientes esperan el mismo futuro; que
+        uno se desconecte no afecta a los demás.
+        """
+        if self.frame_id != last_frame_id:
+            return
+        if self._next_frame is None or self._next_frame.done():
+            self._next_frame = asyncio.get_running_loop().create_future()
+        try:
+            await asyncio.wait_for(asyncio.shield(self._next_frame), timeout=timeout_s)
+        except asyncio.TimeoutError:
+            pass
+
+    def get_stats(self) -> Dict[str, Any]:
+        rendered = self.stats["rendered"]
+        return {
+            "subscribers": self._subscribers,
+            "submitted": self.stats["submitted"],
+            "rendered": rendered,
+            "saved": self.stats["saved"],
+            "skipped_idle": self.stats["skipped_idle"],
+            "skipped_rate": self.stats["skipped_rate"],
+            "dropped": self.stats["dropped"],
+            "avg_render_ms": round(self.stats["render_ms_total"] / rendered, 3) if rendered else 0.0,
+            "glyph_cache": {"entries": len(self.glyphs._sprites), "hits": self.glyphs.hits,
+                            "misses": self.glyphs.misses},
+        }
+
+    # ==================== RENDER ====================
+
+    async def _render_loop(self):
+        loop = asyncio.get_running_loop()
+        while True:
+            if self._pending is None:
+                self._wakeup.clear()
+                await self._wakeup.wait()
+                continue
+            job, self._pending = self._pending, None
+            try:
+                jpeg = await loop.run_in_executor(self._executor, self._render, job)
+            except asyncio.CancelledError:
+                raise
+            except Exception as e:
+                logger.warning(f"Error renderizando frame del stream: {e}")
+                continue
+            if jpeg is not None:
+                self.publish(jpeg)
+
+    def _color(self, bgr: Tuple[int, int, int]) -> Tuple[int, int, int]:
+        return bgr[::-1] if self.swap_channels else bgr
+
+    def _render(self, job: _RenderJob) -> Optional[bytes]:
+        start = time.perf_counter()
+        frame = job.frame
+        height, width = frame.shape[:2]
+        if self._canvas is None or self._canvas.shape[:2] != (height, width):
+            self._canvas = np.empty((height, width, 3), np.uint8)
+        canvas = self._canvas
+
+        # Copia y orden de canales del stream en una sola pasada
+        if frame.ndim == 2:
+            cv2.cvtColor(frame, cv2.COLOR_GRAY2BGR, dst=canvas)
+        elif self.swap_channels:
+            cv2.cvtColor(frame, cv2.COLOR_BGR2RGB, dst=canvas)
+        else:
+            np.copyto(canvas, frame)
+
+        for x1, y1, x2, y2, class_name, confidence in job.boxes:
+            color = self._color(self.class_colors.get(class_name, DEFAULT_COLOR))
+            cv2.rectangle(canvas, (x1, y1), (x2, y2), color, 2)
+            blit(canvas, self.glyphs.label(f"{class_name} {confidence:.2f}", color), x1, y1)
+        blit(canvas, self.glyphs.overlay(job.info_text, self._color(INFO_COLOR)), *INFO_ORIGIN)
+
+        jpeg = None
+        if job.publish:
+            ok, buffer = cv2.imencode('.jpg', canvas, [cv2.IMWRITE_JPEG_QUALITY, self.jpeg_quality])
+            if ok:
+                jpeg = buffer.tobytes()
+        if job.save:
+            annotated = cv2.cvtColor(canvas, cv2.COLOR_RGB2BGR) if self.swap_channels else canvas.copy()
+            self.save_callback(annotated, len(job.boxes))
+            self.stats["saved"] += 1
+
+        self.stats["rendered"] += 1
+        self.stats["render_ms_total"] += (time.perf_counter() - start) * 1000.0
+        return jpeg